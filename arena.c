@@ -0,0 +1,116 @@
+/*  arena.c  –  bump allocator for per-frame scratch data
+ *  ─────────────────────────────────────────────────────────────────
+ *  Transient buffers (visited bitmaps, per-band sprite lists) come from
+ *  an arena instead of large stack frames.  Sizes can follow the map
+ *  rather than the compile-time maximum, and the high-water marks show
+ *  how much scratch a frame really needs.
+ *  No SDL headers.  No heap: thread arenas are static per-thread storage.
+ */
+#include "arena.h"
+#include "memstat.h"
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <threads.h>
+
+void arena_init(Arena *a, void *buf, size_t cap)
+{
+    a->base   = buf;
+    a->cap    = cap;
+    a->used   = 0;
+    a->high   = 0;
+    a->failed = 0;
+}
+
+void *arena_alloc(Arena *a, size_t size)
+{
+    size_t start = (a->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    size_t top   = start + size;
+    if (top < start) top = SIZE_MAX;          /* size near SIZE_MAX */
+    if (top > a->high) a->high = top;
+    if (top > a->cap) {
+        a->failed++;
+        return NULL;
+    }
+    a->used = top;
+    return a->base + start;
+}
+
+/* Thread arenas publish their marks when scratch is given back */
+static void publish(const Arena *a);
+
+void arena_reset(Arena *a)
+{
+    publish(a);
+    a->used = 0;
+}
+
+size_t arena_mark(const Arena *a)
+{
+    return a->used;
+}
+
+void arena_release(Arena *a, size_t mark)
+{
+    publish(a);
+    if (mark < a->used) a->used = mark;
+}
+
+/* ── Thread arenas ─────────────────────────────────────────────────── */
+
+static _Thread_local alignas(ARENA_ALIGN)
+    unsigned char tls_buf[ARENA_THREAD_SIZE];
+static _Thread_local Arena    tls_arena;
+static _Thread_local unsigned tls_reported;   /* failures already counted */
+
+/* Maxima over every thread arena, kept after their threads exit */
+static atomic_size_t peak_high;
+static atomic_uint   peak_failed;
+
+static void publish(const Arena *a)
+{
+    if (a != &tls_arena) return;
+    size_t seen = atomic_load_explicit(&peak_high, memory_order_relaxed);
+    while (a->high > seen
+           && !atomic_compare_exchange_weak(&peak_high, &seen, a->high)) { }
+    if (a->failed != tls_reported) {
+        atomic_fetch_add(&peak_failed, a->failed - tls_reported);
+        tls_reported = a->failed;
+    }
+}
+
+/* A thread arena counts as scratch from first use until its thread
+ * exits; the key's destructor is the only hook C11 offers for that */
+static once_flag exit_once = ONCE_FLAG_INIT;
+static tss_t     exit_key;
+static bool      exit_hook;
+
+static void on_thread_exit(void *arena)
+{
+    (void)arena;
+    mem_release(MEM_SCRATCH, ARENA_THREAD_SIZE);
+}
+
+static void make_exit_key(void)
+{
+    exit_hook = tss_create(&exit_key, on_thread_exit) == thrd_success;
+}
+
+Arena *arena_thread(void)
+{
+    Arena *a = &tls_arena;
+    if (!a->base) {
+        arena_init(a, tls_buf, sizeof(tls_buf));
+        mem_account(MEM_SCRATCH, ARENA_THREAD_SIZE);
+        call_once(&exit_once, make_exit_key);
+        if (exit_hook) tss_set(exit_key, a);
+    }
+    return a;
+}
+
+size_t arena_thread_peak(unsigned *failed)
+{
+    if (failed) *failed = atomic_load(&peak_failed);
+    return atomic_load(&peak_high);
+}
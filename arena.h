@@ -0,0 +1,50 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ── Frame arena ──────────────────────────────────────────────────── */
+#define ARENA_THREAD_SIZE (64 * 1024) /* per-thread scratch (bytes)     */
+#define ARENA_ALIGN       16          /* alignment of every allocation  */
+
+/* A bump allocator over a fixed buffer.  Allocating moves `used` up;
+ * resetting (or releasing to a mark) moves it back down, so freeing a
+ * whole frame's scratch costs one store.  Nothing is ever freed one
+ * piece at a time. */
+typedef struct Arena {
+    unsigned char *base;
+    size_t         cap;
+    size_t         used;
+    size_t         high;          /* most ever asked for, failures too   */
+    unsigned       failed;        /* allocations that did not fit        */
+} Arena;
+
+/**  Use buf[0 .. cap) as an empty arena.  buf must be ARENA_ALIGN aligned. */
+void arena_init(Arena *a, void *buf, size_t cap);
+
+/**  size bytes, ARENA_ALIGN aligned and not cleared; NULL if they do not
+ *   fit.  A failure still raises the high-water mark, so it shows how
+ *   much the arena would have needed. */
+void *arena_alloc(Arena *a, size_t size);
+
+/**  Drop every allocation.  O(1). */
+void arena_reset(Arena *a);
+
+/**  Current top, for arena_release(). */
+size_t arena_mark(const Arena *a);
+
+/**  Drop everything allocated since `mark` was taken.  O(1). */
+void arena_release(Arena *a, size_t mark);
+
+/**  The calling thread's scratch arena (ARENA_THREAD_SIZE bytes of
+ *   static per-thread storage, set up on first use).  Only that thread
+ *   may touch it: the render thread resets its own at frame start, and
+ *   code that may run on any thread brackets its use with a mark. */
+Arena *arena_thread(void);
+
+/**  Highest high-water mark of any thread arena so far, in bytes, and
+ *   (if failed is not NULL) how many of their allocations failed. */
+size_t arena_thread_peak(unsigned *failed);
+
+#endif /* ARENA_H */
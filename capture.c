@@ -0,0 +1,307 @@
+/*  capture.c  –  gameplay capture to a Y4M stream off the render thread
+ *  ─────────────────────────────────────────────────────────────────
+ *  Y4M is a text header followed by raw planar frames, so any player or
+ *  encoder (ffmpeg -i capture.y4m, or a pipe into one) reads it without
+ *  a codec here.  The render thread only converts RGBA to YUV 4:2:0 —
+ *  eight pixels at a time with SSE2 — into a queue slot; the blocking
+ *  fwrite() happens on the writer thread, and a full queue drops the
+ *  frame instead of stalling the render loop.
+ *  No SDL headers.  Pure C11 threads.
+ */
+#include "capture.h"
+#include "memstat.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* ── Colour conversion ─────────────────────────────────────────────── */
+/* BT.601 studio range in 8-bit fixed point.  The chroma sums carry a
+ * +128·256 bias so every intermediate is non-negative and fits 16 bits,
+ * which lets the SIMD path use plain unsigned 16-bit lanes. */
+
+#define Y_R  66
+#define Y_G  129
+#define Y_B  25
+#define U_R  (-38)
+#define U_G  (-74)
+#define U_B  112
+#define V_R  112
+#define V_G  (-94)
+#define V_B  (-18)
+#define C_BIAS (128 * 256 + 128)  /* chroma offset plus rounding     */
+
+static inline uint8_t luma(int r, int g, int b)
+{
+    return (uint8_t)(((Y_R * r + Y_G * g + Y_B * b + 128) >> 8) + 16);
+}
+
+static inline uint8_t chroma(int r, int g, int b, int kr, int kg, int kb)
+{
+    return (uint8_t)((kr * r + kg * g + kb * b + C_BIAS) >> 8);
+}
+
+/** Columns [x0, w) of the row pair starting at row j (scalar path). */
+static void convert_tail(const uint32_t *fb, int stride, int w, int j, int x0,
+                         uint8_t *y, uint8_t *u, uint8_t *v)
+{
+    const uint32_t *r0 = fb + (size_t)j * stride;
+    const uint32_t *r1 = r0 + stride;
+    uint8_t *y0 = y + (size_t)j * w;
+    uint8_t *y1 = y0 + w;
+    uint8_t *uo = u + (size_t)(j / 2) * (w / 2);
+    uint8_t *vo = v + (size_t)(j / 2) * (w / 2);
+
+    for (int x = x0; x < w; x += 2) {
+        int rs = 0, gs = 0, bs = 0;
+        for (int k = 0; k < 4; k++) {
+            uint32_t px = (k < 2 ? r0 : r1)[x + (k & 1)];
+            int r = (int)(px >> 24), g = (int)(px >> 16 & 0xFF), b = (int)(px >> 8 & 0xFF);
+            (k < 2 ? y0 : y1)[x + (k & 1)] = luma(r, g, b);
+            rs += r; gs += g; bs += b;
+        }
+        rs = (rs + 2) >> 2;
+        gs = (gs + 2) >> 2;
+        bs = (bs + 2) >> 2;
+        uo[x / 2] = chroma(rs, gs, bs, U_R, U_G, U_B);
+        vo[x / 2] = chroma(rs, gs, bs, V_R, V_G, V_B);
+    }
+}
+
+void cap_convert_scalar(const uint32_t *fb, int stride, int w, int h,
+                        uint8_t *y, uint8_t *u, uint8_t *v)
+{
+    for (int j = 0; j < h; j += 2)
+        convert_tail(fb, stride, w, j, 0, y, u, v);
+}
+
+#if defined(__SSE2__)
+
+/** Eight pixels to 16-bit R, G and B lanes. */
+static inline void split8(const uint32_t *p, __m128i *r, __m128i *g, __m128i *b)
+{
+    __m128i a0 = _mm_loadu_si128((const __m128i *)p);
+    __m128i a1 = _mm_loadu_si128((const __m128i *)(p + 4));
+    __m128i m  = _mm_set1_epi32(0xFF);
+    *r = _mm_packs_epi32(_mm_srli_epi32(a0, 24), _mm_srli_epi32(a1, 24));
+    *g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a0, 16), m),
+                         _mm_and_si128(_mm_srli_epi32(a1, 16), m));
+    *b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a0, 8), m),
+                         _mm_and_si128(_mm_srli_epi32(a1, 8), m));
+}
+
+/** kr·r + kg·g + kb·b + bias, >> 8, in wrapping 16-bit lanes. */
+static inline __m128i dot8(__m128i r, __m128i g, __m128i b,
+                           int kr, int kg, int kb, int bias)
+{
+    __m128i s = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16((short)kr)),
+                              _mm_mullo_epi16(g, _mm_set1_epi16((short)kg)));
+    s = _mm_add_epi16(s, _mm_mullo_epi16(b, _mm_set1_epi16((short)kb)));
+    s = _mm_add_epi16(s, _mm_set1_epi16((short)bias));
+    return _mm_srli_epi16(s, 8);
+}
+
+static inline void store_luma8(uint8_t *dst, __m128i r, __m128i g, __m128i b)
+{
+    __m128i yv = _mm_add_epi16(dot8(r, g, b, Y_R, Y_G, Y_B, 128),
+                               _mm_set1_epi16(16));
+    _mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(yv, yv));
+}
+
+/** Average horizontal pairs of two rows' lanes: four rounded means,
+ *  repeated in the upper half. */
+static inline __m128i avg2x2(__m128i top, __m128i bottom)
+{
+    __m128i s = _mm_madd_epi16(_mm_add_epi16(top, bottom), _mm_set1_epi16(1));
+    s = _mm_srli_epi32(_mm_add_epi32(s, _mm_set1_epi32(2)), 2);
+    return _mm_packs_epi32(s, s);
+}
+
+static inline void store_chroma4(uint8_t *dst, __m128i r, __m128i g, __m128i b,
+                                 int kr, int kg, int kb)
+{
+    __m128i c = dot8(r, g, b, kr, kg, kb, C_BIAS);
+    int32_t four = _mm_cvtsi128_si32(_mm_packus_epi16(c, c));
+    memcpy(dst, &four, 4);
+}
+
+void cap_convert(const uint32_t *fb, int stride, int w, int h,
+                 uint8_t *y, uint8_t *u, uint8_t *v)
+{
+    int wide = w & ~7;
+    for (int j = 0; j < h; j += 2) {
+        const uint32_t *r0 = fb + (size_t)j * stride;
+        const uint32_t *r1 = r0 + stride;
+        uint8_t *y0 = y + (size_t)j * w;
+        uint8_t *y1 = y0 + w;
+        uint8_t *uo = u + (size_t)(j / 2) * (w / 2);
+        uint8_t *vo = v + (size_t)(j / 2) * (w / 2);
+
+        for (int x = 0; x < wide; x += 8) {
+            __m128i ra, ga, ba, rb, gb, bb;
+            split8(r0 + x, &ra, &ga, &ba);
+            split8(r1 + x, &rb, &gb, &bb);
+            store_luma8(y0 + x, ra, ga, ba);
+            store_luma8(y1 + x, rb, gb, bb);
+
+            __m128i rm = avg2x2(ra, rb), gm = avg2x2(ga, gb), bm = avg2x2(ba, bb);
+            store_chroma4(uo + x / 2, rm, gm, bm, U_R, U_G, U_B);
+            store_chroma4(vo + x / 2, rm, gm, bm, V_R, V_G, V_B);
+        }
+        if (wide < w) convert_tail(fb, stride, w, j, wide, y, u, v);
+    }
+}
+
+#else
+
+void cap_convert(const uint32_t *fb, int stride, int w, int h,
+                 uint8_t *y, uint8_t *u, uint8_t *v)
+{
+    cap_convert_scalar(fb, stride, w, h, y, u, v);
+}
+
+#endif
+
+/* ── Writer thread ─────────────────────────────────────────────────── */
+
+static int writer_main(void *arg)
+{
+    Capture *cap = arg;
+    for (;;) {
+        unsigned tail = atomic_load_explicit(&cap->tail, memory_order_relaxed);
+        if (atomic_load_explicit(&cap->head, memory_order_acquire) == tail) {
+            mtx_lock(&cap->lock);
+            while (!cap->quit && atomic_load(&cap->head) == tail)
+                cnd_wait(&cap->wake, &cap->lock);
+            bool done = cap->quit && atomic_load(&cap->head) == tail;
+            mtx_unlock(&cap->lock);
+            if (done) break;
+            continue;
+        }
+
+        /* After an error the queue still drains, so nothing waits */
+        const uint8_t *f = cap->frames[tail % CAP_QUEUE];
+        if (!atomic_load(&cap->io_error)) {
+            bool ok = fputs("FRAME\n", cap->out) >= 0
+                   && fwrite(f, 1, CAP_FRAME_BYTES, cap->out) == CAP_FRAME_BYTES;
+            if (ok) cap->written++;
+            else    atomic_store(&cap->io_error, true);
+        }
+        atomic_store_explicit(&cap->tail, tail + 1, memory_order_release);
+    }
+    if (fflush(cap->out) != 0) atomic_store(&cap->io_error, true);
+    return 0;
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+bool cap_open(Capture *cap, FILE *out, int fps)
+{
+    cap->out       = out;
+    cap->quit      = false;
+    cap->submitted = 0;
+    cap->dropped   = 0;
+    cap->written   = 0;
+    cap->period    = 1.0 / (fps > 0 ? fps : CAP_DEFAULT_FPS);
+    cap->next      = 0.0;
+    cap->clock_started = false;
+    atomic_init(&cap->head, 0);
+    atomic_init(&cap->tail, 0);
+    atomic_init(&cap->io_error, false);
+
+    /* C420jpeg: chroma sited between the 2x2 block it averages */
+    if (fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                SCREEN_W, SCREEN_H, fps > 0 ? fps : CAP_DEFAULT_FPS) < 0) {
+        fprintf(stderr, "cap_open: cannot write the stream header\n");
+        return false;
+    }
+    /* Undo exactly what was set up before a failure */
+    bool locked = mtx_init(&cap->lock, mtx_plain) == thrd_success;
+    bool waits  = locked && cnd_init(&cap->wake) == thrd_success;
+    if (!waits || thrd_create(&cap->writer, writer_main, cap) != thrd_success) {
+        fprintf(stderr, "cap_open: cannot start the writer thread\n");
+        if (waits)  cnd_destroy(&cap->wake);
+        if (locked) mtx_destroy(&cap->lock);
+        return false;
+    }
+    mem_account(MEM_FRAMES, sizeof(*cap));
+    return true;
+}
+
+/** The free slot to fill next, or NULL (counting a drop) if none. */
+static uint8_t *claim_slot(Capture *cap)
+{
+    cap->submitted++;
+    unsigned head = atomic_load_explicit(&cap->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&cap->tail, memory_order_acquire);
+    if (head - tail >= CAP_QUEUE || atomic_load(&cap->io_error)) {
+        cap->dropped++;
+        return NULL;
+    }
+    return cap->frames[head % CAP_QUEUE];
+}
+
+static void queue_slot(Capture *cap)
+{
+    unsigned head = atomic_load_explicit(&cap->head, memory_order_relaxed);
+    atomic_store_explicit(&cap->head, head + 1, memory_order_release);
+
+    mtx_lock(&cap->lock);
+    cnd_signal(&cap->wake);
+    mtx_unlock(&cap->lock);
+}
+
+bool cap_submit(Capture *cap, const uint32_t *fb, int stride)
+{
+    uint8_t *f = claim_slot(cap);
+    if (!f) return false;
+    cap_convert(fb, stride, SCREEN_W, SCREEN_H,
+                f, f + CAP_Y_BYTES, f + CAP_Y_BYTES + CAP_C_BYTES);
+    queue_slot(cap);
+    return true;
+}
+
+int cap_repeat(Capture *cap, int n)
+{
+    /* Only this thread fills slots, so the last queued one stays intact
+     * while the writer reads it */
+    int queued = 0;
+    for (int i = 0; i < n; i++) {
+        unsigned head = atomic_load_explicit(&cap->head, memory_order_relaxed);
+        if (head == 0) break;
+        uint8_t *f = claim_slot(cap);
+        if (!f) continue;
+        memcpy(f, cap->frames[(head - 1) % CAP_QUEUE], CAP_FRAME_BYTES);
+        queue_slot(cap);
+        queued++;
+    }
+    return queued;
+}
+
+int cap_frames_due(Capture *cap, double now)
+{
+    if (!cap->clock_started) {
+        cap->clock_started = true;
+        cap->next = now + cap->period;
+        return 1;
+    }
+    if (now < cap->next) return 0;
+    int n = (int)((now - cap->next) / cap->period) + 1;
+    cap->next += n * cap->period;
+    return n;
+}
+
+uint64_t cap_close(Capture *cap)
+{
+    mtx_lock(&cap->lock);
+    cap->quit = true;
+    cnd_signal(&cap->wake);
+    mtx_unlock(&cap->lock);
+    thrd_join(cap->writer, NULL);
+    cnd_destroy(&cap->wake);
+    mtx_destroy(&cap->lock);
+    mem_release(MEM_FRAMES, sizeof(*cap));
+    return cap->written;
+}
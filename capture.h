@@ -0,0 +1,79 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "game_globals.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <threads.h>
+
+/* ── Video capture ────────────────────────────────────────────────── */
+#define CAP_QUEUE       4         /* converted frames waiting to be written */
+#define CAP_Y_BYTES     (SCREEN_W * SCREEN_H)
+#define CAP_C_BYTES     (SCREEN_W / 2 * (SCREEN_H / 2))
+#define CAP_FRAME_BYTES (CAP_Y_BYTES + 2 * CAP_C_BYTES) /* Y, then U, V  */
+#define CAP_DEFAULT_FPS 60        /* stream rate without an --fps cap    */
+
+/* The render thread converts a finished frame to YUV 4:2:0 into a free
+ * queue slot and returns; a writer thread streams queued frames as Y4M.
+ * The queue is single-producer / single-consumer on two counters.  When
+ * every slot is still waiting for the writer (slow disk, full pipe) the
+ * new frame is dropped, so the render loop never waits on I/O.
+ * The stream runs on its own clock at the header rate: the render loop
+ * asks how many stream frames are due and submits or repeats that many,
+ * so uncapped or idle rendering still plays back at real speed. */
+typedef struct Capture {
+    FILE        *out;
+    uint8_t      frames[CAP_QUEUE][CAP_FRAME_BYTES];
+    atomic_uint  head;            /* frames queued (render thread)       */
+    atomic_uint  tail;            /* frames written (writer thread)      */
+    thrd_t       writer;
+    mtx_t        lock;            /* only for sleeping, never for slots  */
+    cnd_t        wake;            /* a frame was queued, or closing      */
+    bool         quit;            /* under lock                          */
+    atomic_bool  io_error;        /* a write failed; later frames drop   */
+    uint64_t     submitted;       /* frames offered to cap_submit()      */
+    uint64_t     dropped;         /* of those, discarded under pressure  */
+    uint64_t     written;         /* writer thread; read after close     */
+    double       period;          /* seconds per stream frame            */
+    double       next;            /* clock time of the next stream frame */
+    bool         clock_started;   /* first cap_frames_due() seen         */
+} Capture;
+
+/**  Write the Y4M stream header for SCREEN_W x SCREEN_H at fps frames
+ *   per second (CAP_DEFAULT_FPS when fps <= 0) to `out` and start the
+ *   writer thread.  The caller keeps
+ *   ownership of `out` (a file, stdout or a pipe) and closes it after
+ *   cap_close().  Returns false on a write or thread error. */
+bool cap_open(Capture *cap, FILE *out, int fps);
+
+/**  Convert a SCREEN_W x SCREEN_H RGBA8888 frame (rows of `stride`
+ *   pixels) and queue it.  Never blocks: returns false, counting a drop,
+ *   when the queue is full or the stream has failed. */
+bool cap_submit(Capture *cap, const uint32_t *fb, int stride);
+
+/**  Queue the last submitted frame n more times (nothing before the
+ *   first submit), for stream frames during which the picture did not
+ *   change.  Drops like cap_submit().  Returns the copies queued. */
+int cap_repeat(Capture *cap, int n);
+
+/**  Stream frames due by `now` (seconds on any steady clock) since the
+ *   last call; the first call returns 1.  Submit one frame and repeat
+ *   it for the rest, or only repeat while nothing is drawn. */
+int cap_frames_due(Capture *cap, double now);
+
+/**  Write out every queued frame, then stop the writer.  Returns the
+ *   number of frames written; a failed write also sets cap->io_error. */
+uint64_t cap_close(Capture *cap);
+
+/**  RGBA8888 to planar YUV 4:2:0 (BT.601 studio range, each chroma
+ *   sample the average of a 2x2 block).  w and h must be even.  Uses
+ *   SSE2 where the compiler targets it. */
+void cap_convert(const uint32_t *fb, int stride, int w, int h,
+                 uint8_t *y, uint8_t *u, uint8_t *v);
+
+/**  The portable reference for cap_convert(); results are identical. */
+void cap_convert_scalar(const uint32_t *fb, int stride, int w, int h,
+                        uint8_t *y, uint8_t *u, uint8_t *v);
+
+#endif /* CAPTURE_H */
@@ -0,0 +1,191 @@
+/*  entity.c  –  structure-of-arrays NPC simulation
+ *  ─────────────────────────────────────────────────────────────────
+ *  Entities are updated ENT_BATCH at a time in separate passes:
+ *  integrate all positions, then resolve X collisions, then Y.  The
+ *  integrate pass has no branches and vectorises; the collision passes
+ *  are one occupancy bit test per entity and axis.
+ *  No SDL headers.  Pure C + math.
+ */
+#include "entity.h"
+#include "raycaster.h"
+#include "render.h"
+
+#include <math.h>
+#include <string.h>
+
+#define PI 3.14159265358979323846f
+
+#define ENT_NEAR_PLANE  0.1f     /* closer billboards are not collected  */
+#define ENT_ANGLE_STEPS 3600     /* spawn headings per full turn         */
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+/** Solid test against occupancy bits; out-of-bounds counts as solid,
+ *  exactly like is_wall() in raycaster.c. */
+static inline bool solid_at(const MapOccupancy *occ, float fx, float fy)
+{
+    int cx = (int)fx;
+    int cy = (int)fy;
+    if (cx < 0 || cy < 0 || cx >= occ->w || cy >= occ->h) return true;
+    return (occ->rows[cy] >> cx) & 1;
+}
+
+/** xorshift32 – small, deterministic PRNG for placement. */
+static uint32_t next_rand(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+/* ── Pool ──────────────────────────────────────────────────────────── */
+
+void ent_clear(EntityPool *ep)
+{
+    ep->count = 0;
+}
+
+int ent_spawn(EntityPool *ep, float x, float y, float vx, float vy,
+              uint16_t texture_id)
+{
+    if (ep->count >= MAX_ENTITIES) return -1;
+    int i = ep->count++;
+    ep->x[i]  = x;
+    ep->y[i]  = y;
+    ep->vx[i] = vx;
+    ep->vy[i] = vy;
+    ep->texture_id[i] = texture_id;
+    ep->damage[i]     = 0;
+    return i;
+}
+
+int ent_populate(EntityPool *ep, const MapOccupancy *occ, int n,
+                 uint32_t seed)
+{
+    ent_clear(ep);
+    uint32_t rng = seed * 2654435761u + 0x9E3779B9u;
+    if (rng == 0) rng = 1;
+
+    /* Bounded attempts so a nearly solid map cannot loop forever */
+    for (int tries = 0; ep->count < n && tries < n * 16; tries++) {
+        int cx = (int)(next_rand(&rng) % (uint32_t)(occ->w > 0 ? occ->w : 1));
+        int cy = (int)(next_rand(&rng) % (uint32_t)(occ->h > 0 ? occ->h : 1));
+        if (map_occupancy_solid(occ, cx, cy)) continue;
+
+        float angle = (float)(next_rand(&rng) % ENT_ANGLE_STEPS)
+                    * (2.0f * PI / ENT_ANGLE_STEPS);
+        uint16_t tex = (uint16_t)(next_rand(&rng) % SPRITE_TEX_COUNT);
+        ent_spawn(ep, cx + 0.5f, cy + 0.5f, cosf(angle) * ENT_SPEED,
+                  sinf(angle) * ENT_SPEED, tex);
+    }
+    return ep->count;
+}
+
+/* ── Fixed-step update ─────────────────────────────────────────────── */
+
+void ent_update(EntityPool *ep, const MapOccupancy *occ, float dt)
+{
+    ent_update_range(ep, occ, dt, 0, ep->count);
+}
+
+void ent_update_range(EntityPool *ep, const MapOccupancy *occ, float dt,
+                      int begin, int end)
+{
+    float nx[ENT_BATCH], ny[ENT_BATCH];
+
+    for (int base = begin; base < end; base += ENT_BATCH) {
+        int n = end - base < ENT_BATCH ? end - base : ENT_BATCH;
+        float *x  = ep->x  + base, *y  = ep->y  + base;
+        float *vx = ep->vx + base, *vy = ep->vy + base;
+
+        /* Pass 1: integrate (branch-free) */
+        for (int i = 0; i < n; i++) {
+            nx[i] = x[i] + vx[i] * dt;
+            ny[i] = y[i] + vy[i] * dt;
+        }
+
+        /* Pass 2: X axis, probing one margin ahead of the motion */
+        for (int i = 0; i < n; i++) {
+            float probe = nx[i] + (vx[i] > 0.0f ? ENT_RADIUS : -ENT_RADIUS);
+            if (solid_at(occ, probe, y[i]))
+                vx[i] = -vx[i];
+            else
+                x[i] = nx[i];
+        }
+
+        /* Pass 3: Y axis against the updated X (no corner cutting) */
+        for (int i = 0; i < n; i++) {
+            float probe = ny[i] + (vy[i] > 0.0f ? ENT_RADIUS : -ENT_RADIUS);
+            if (solid_at(occ, x[i], probe))
+                vy[i] = -vy[i];
+            else
+                y[i] = ny[i];
+        }
+    }
+}
+
+/* ── Rendering ─────────────────────────────────────────────────────── */
+
+/** Restore the max-heap on perp_dist below slot i of h[0, n). */
+static void sift_down(Sprite *h, int n, int i)
+{
+    for (;;) {
+        int big = i, l = 2 * i + 1, r = l + 1;
+        if (l < n && h[l].perp_dist > h[big].perp_dist) big = l;
+        if (r < n && h[r].perp_dist > h[big].perp_dist) big = r;
+        if (big == i) return;
+        Sprite t = h[i];
+        h[i] = h[big];
+        h[big] = t;
+        i = big;
+    }
+}
+
+void ent_collect_sprites(const EntityPool *ep, GameState *gs)
+{
+    const Player *p = &gs->player;
+    float inv_det = 1.0f / (p->plane_x * p->dir_y - p->dir_x * p->plane_y);
+    int   before  = gs->visible_sprite_count;
+    bool  heaped  = false;
+    Sprite *list  = gs->visible_sprites;
+
+    for (int i = 0; i < ep->count; i++) {
+        float sx = ep->x[i] - p->x;
+        float sy = ep->y[i] - p->y;
+
+        /* Same camera transform as the sprite renderer */
+        float pd = inv_det * (-p->plane_y * sx + p->plane_x * sy);
+        if (pd <= ENT_NEAR_PLANE) continue;
+        float tx = inv_det * (p->dir_y * sx - p->dir_x * sy);
+
+        /* Cull sprites whose whole billboard is off-screen */
+        float screen_x = (SCREEN_W / 2) * (1.0f + tx / pd);
+        float half_w   = (SCREEN_H / pd) * 0.5f;
+        if (screen_x + half_w < 0.0f || screen_x - half_w >= SCREEN_W)
+            continue;
+
+        /* Full list: a max-heap on perp_dist, so the nearest survive */
+        Sprite *sp;
+        if (gs->visible_sprite_count < MAX_VISIBLE_SPRITES) {
+            sp = &list[gs->visible_sprite_count++];
+        } else {
+            if (!heaped) {
+                for (int k = MAX_VISIBLE_SPRITES / 2 - 1; k >= 0; k--)
+                    sift_down(list, MAX_VISIBLE_SPRITES, k);
+                heaped = true;
+            }
+            if (pd >= list[0].perp_dist) continue;
+            sp = &list[0];
+        }
+        sp->x          = ep->x[i];
+        sp->y          = ep->y[i];
+        sp->perp_dist  = pd;
+        sp->texture_id = ep->texture_id[i];
+        sp->id         = MAKE_ID(ID_ENTITY, sp->texture_id, i);
+        if (heaped) sift_down(list, MAX_VISIBLE_SPRITES, 0);
+    }
+
+    if (gs->visible_sprite_count != before || heaped) rc_sort_sprites(gs);
+}
@@ -0,0 +1,54 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include "game_globals.h"
+#include "map_edit.h"
+
+/* ── Entity limits ────────────────────────────────────────────────── */
+#define MAX_ENTITIES   4096      /* entities per pool                   */
+#define ENT_BATCH      64        /* entities integrated per batch       */
+#define ENT_RADIUS     0.15f     /* collision margin, same as the player*/
+#define ENT_SPEED      1.5f      /* wander speed (map units / second)   */
+
+/* ── Entity pool, stored as structure-of-arrays ───────────────────── */
+/* Each field is its own array so the batched update streams through
+ * contiguous floats.  Entity i is x[i], y[i], vx[i], … for i < count. */
+typedef struct EntityPool {
+    float    x[MAX_ENTITIES];    /* position (map units)                */
+    float    y[MAX_ENTITIES];
+    float    vx[MAX_ENTITIES];   /* velocity (map units / second)       */
+    float    vy[MAX_ENTITIES];
+    uint16_t texture_id[MAX_ENTITIES]; /* sprite atlas index            */
+    uint16_t damage[MAX_ENTITIES]; /* ticks spent in damage zones       */
+    int      count;
+} EntityPool;
+
+/**  Empty the pool. */
+void ent_clear(EntityPool *ep);
+
+/**  Add one entity.  Returns its index, or -1 when the pool is full. */
+int ent_spawn(EntityPool *ep, float x, float y, float vx, float vy,
+              uint16_t texture_id);
+
+/**  Replace the pool with n wanderers on random free cells, heading in
+ *   random directions at ENT_SPEED.  Same seed, same placement.
+ *   Returns the number spawned (fewer if the map has no room). */
+int ent_populate(EntityPool *ep, const MapOccupancy *occ, int n,
+                 uint32_t seed);
+
+/**  Advance every entity by one fixed step.  Collision is the player's
+ *   wall slide (X then Y, with ENT_RADIUS), done in batches against the
+ *   occupancy bits; a blocked axis reverses that velocity component. */
+void ent_update(EntityPool *ep, const MapOccupancy *occ, float dt);
+
+/**  ent_update() for entities [begin, end) only.  Entities never affect
+ *   each other, so disjoint ranges may be updated concurrently. */
+void ent_update_range(EntityPool *ep, const MapOccupancy *occ, float dt,
+                      int begin, int end);
+
+/**  Append entities in front of the player to gs->visible_sprites and
+ *   re-sort them.  When more than MAX_VISIBLE_SPRITES are in view, the
+ *   nearest are kept, map sprites included.  Call after rc_cast(). */
+void ent_collect_sprites(const EntityPool *ep, GameState *gs);
+
+#endif /* ENTITY_H */
@@ -0,0 +1,181 @@
+/*  env.c  –  many independent game instances stepped in lockstep
+ *  ─────────────────────────────────────────────────────────────────
+ *  For automated testing and agent training: one process holds up to
+ *  ENV_MAX_INSTANCES games on one shared, copy-on-write map and trigger
+ *  index, each with its own occupancy bits and SimWorld.  A step hands
+ *  every instance its own Input, ticks it, casts its rays and
+ *  (optionally) renders its frame with the software renderer, plus
+ *  per-pixel depth and object IDs if asked.  Instances are spread over
+ *  the caller's job pool, one job per instance, so no instance ever
+ *  waits on another.
+ *  No SDL headers.
+ */
+#include "env.h"
+#include "entity.h"
+#include "jobs.h"
+#include "map_edit.h"
+#include "memstat.h"
+#include "raycaster.h"
+#include "trigger.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* ── One instance ──────────────────────────────────────────────────── */
+
+static bool renders(EnvObs obs)
+{
+    return obs == ENV_OBS_PIXELS || obs == ENV_OBS_AUX;
+}
+
+static void observe(Env *env, int i)
+{
+    EnvInstance *in = &env->inst[i];
+    if (env->config.obs == ENV_OBS_SENSE) {
+        rc_sense(in->world.map, &in->world.state.player, env->sense_angles,
+                 env->config.sense_count, env->config.sense_range, env->sense[i]);
+        return;
+    }
+
+    in->view.player = in->world.state.player;
+    rc_cast(&in->view, in->world.map);
+    memcpy(env->hits[i], in->view.hits, sizeof(env->hits[i]));
+    if (renders(env->config.obs)) {
+        RenderAux aux = { env->depth[i], env->ids[i] };
+        ent_collect_sprites(&in->world.npcs, &in->view);
+        render_frame_aux(&in->view, &env->config.atlas->atlas, env->pixels[i],
+                         SCREEN_W, env->config.obs == ENV_OBS_AUX ? &aux : NULL);
+    }
+}
+
+static void step_instance(Env *env, int i)
+{
+    EnvInstance *in = &env->inst[i];
+    if (env->inputs && !env->done[i]) {
+        sim_world_tick(&in->world, &env->inputs[i], env->config.dt);
+        env->done[i] = in->world.state.game_over;
+    }
+    observe(env, i);
+}
+
+/** Starting state: the shared map with fresh occupancy bits, the spawn
+ *  pose and seeded wanderers (seed i + 1, so instances differ). */
+static void init_instance(Env *env, int i)
+{
+    EnvInstance *in = &env->inst[i];
+    SimWorld    *w  = &in->world;
+    map_cow_init(&in->cow, env->config.map, &env->own[i]);
+    map_occupancy_build(&in->occupancy, in->cow.map);
+
+    memset(w, 0, sizeof(*w));
+    w->map            = in->cow.map;
+    w->state.player   = env->config.spawn;
+    w->state.triggers = &env->triggers;
+    w->state.cow      = &in->cow;
+    w->occupancy      = &in->occupancy;
+    w->npc_count      = env->config.npc_count;
+    ent_populate(&w->npcs, w->occupancy, w->npc_count, (uint32_t)i + 1);
+    w->prev_player    = w->state.player;
+
+    env->done[i] = false;
+}
+
+void env_reset(Env *env, int i)
+{
+    map_cow_release(&env->inst[i].cow);
+    init_instance(env, i);
+    observe(env, i);
+}
+
+/* ── Stepping ──────────────────────────────────────────────────────── */
+
+static void step_range(void *arg, int begin, int end)
+{
+    Env *env = arg;
+    for (int i = begin; i < end; i++)
+        step_instance(env, i);
+}
+
+/** Step (or, with no inputs, only observe) every instance on the pool
+ *  and the caller; returns when all are done. */
+static void run_step(Env *env, const Input *inputs)
+{
+    env->inputs = inputs;
+    job_parallel_for(env->config.pool, 0, env->config.count, 1,
+                     step_range, env);
+}
+
+/* ── Accounting ────────────────────────────────────────────────────── */
+
+/** Report the parts of env that config->count instances use.  A private
+ *  map counts from the start, since any door can fault it in. */
+static void account(const Env *env, bool hold)
+{
+    const EnvInstance *in = &env->inst[0];
+    size_t n = (size_t)env->config.count;
+    size_t ents = sizeof(in->world.npcs) + sizeof(in->world.npc_prev_x)
+                + sizeof(in->world.npc_prev_y);
+    size_t frame = env->config.obs == ENV_OBS_AUX
+                 ? sizeof(env->pixels[0]) + sizeof(env->depth[0])
+                   + sizeof(env->ids[0])
+                 : renders(env->config.obs) ? sizeof(env->pixels[0]) : 0;
+    void (*op)(MemTag, size_t) = hold ? mem_account : mem_release;
+    op(MEM_MAP,      n * (sizeof(env->own[0]) + sizeof(in->cow)));
+    op(MEM_DERIVED,  n * sizeof(in->occupancy) + sizeof(env->triggers));
+    op(MEM_ENTITIES, n * ents);
+    op(MEM_SIM,      n * (sizeof(in->world) - ents));
+    op(MEM_VIEW,     n * (sizeof(in->view) + sizeof(env->hits[0])
+                          + sizeof(env->sense[0])));
+    op(MEM_FRAMES,   n * frame);
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+bool env_create(Env *env, const EnvConfig *config)
+{
+    if (config->count < 1 || config->count > ENV_MAX_INSTANCES || !config->map
+        || (renders(config->obs) && !config->atlas)
+        || (config->obs == ENV_OBS_SENSE
+            && (!config->sense_angles || config->sense_count < 1
+                || config->sense_count > SENSE_MAX_RAYS))) {
+        fprintf(stderr, "env_create: bad config (%d instances)\n", config->count);
+        return false;
+    }
+    env->config = *config;
+    if (config->obs == ENV_OBS_SENSE) {
+        memcpy(env->sense_angles, config->sense_angles,
+               (size_t)config->sense_count * sizeof(float));
+        env->config.sense_angles = env->sense_angles;
+    }
+    if (env->config.dt <= 0.0f) env->config.dt = SIM_DT;
+    env->steps  = 0;
+    env->inputs = NULL;
+
+    /* Door toggles only edit tiles, so one index serves every copy */
+    trig_build(&env->triggers, &config->map->map);
+    map_share_retain(config->map);
+    if (config->atlas) render_atlas_retain(config->atlas);
+
+    /* Instances are set up serially; the pool then observes them */
+    for (int i = 0; i < config->count; i++)
+        init_instance(env, i);
+    account(env, true);
+
+    run_step(env, NULL);
+    return true;
+}
+
+void env_step(Env *env, const Input *inputs)
+{
+    run_step(env, inputs);
+    env->steps++;
+}
+
+void env_destroy(Env *env)
+{
+    for (int i = 0; i < env->config.count; i++)
+        map_cow_release(&env->inst[i].cow);
+    map_share_release(env->config.map);
+    if (env->config.atlas) render_atlas_release(env->config.atlas);
+    account(env, false);
+}
@@ -0,0 +1,88 @@
+#ifndef ENV_H
+#define ENV_H
+
+#include "game_globals.h"
+#include "map_edit.h"
+#include "raycaster.h"
+#include "render.h"
+#include "sim.h"
+
+/* ── Environment limits ───────────────────────────────────────────── */
+#define ENV_MAX_INSTANCES 32     /* game instances per Env              */
+
+/* ── What each step observes ──────────────────────────────────────── */
+typedef enum EnvObs {
+    ENV_OBS_HITS,                /* ray hits only (cheap)               */
+    ENV_OBS_PIXELS,              /* ray hits and a rendered frame       */
+    ENV_OBS_AUX,                 /* the frame plus depth and object IDs */
+    ENV_OBS_SENSE,               /* sparse ray sensor only (cheapest)   */
+} EnvObs;
+
+typedef struct EnvConfig {
+    int                 count;   /* instances, 1 .. ENV_MAX_INSTANCES   */
+    SharedMap          *map;     /* read by all until an instance edits */
+    Player              spawn;   /* pose after every reset              */
+    int                 npc_count; /* wanderers per instance            */
+    EnvObs              obs;
+    SharedAtlas        *atlas;   /* ENV_OBS_PIXELS / _AUX only, shared  */
+    struct JobPool     *pool;    /* steps instances, NULL = caller only */
+    float               dt;      /* seconds per step, 0 = SIM_DT        */
+    const float        *sense_angles; /* ENV_OBS_SENSE: rc_sense() rays */
+    int                 sense_count;  /* 1 .. SENSE_MAX_RAYS (copied)    */
+    float               sense_range;  /* max range, 0 = unlimited        */
+} EnvConfig;
+
+/* ── One self-contained game ──────────────────────────────────────── */
+/* Instances read the level through a MapCow and share nothing mutable,
+ * so they can step on any thread.  Instance i's private map, own[i] in
+ * the Env, is only written (and its pages faulted in) once one of its
+ * doors moves. */
+typedef struct EnvInstance {
+    MapCow       cow;
+    MapOccupancy occupancy;
+    SimWorld     world;
+    GameState    view;           /* cast / render buffers               */
+} EnvInstance;
+
+/* ── N instances stepped in lockstep ──────────────────────────────── */
+/* Observations are contiguous per kind: instance i's rays are hits[i]
+ * and its frame is pixels[i] (SCREEN_H rows of SCREEN_W, RGBA8888);
+ * with ENV_OBS_AUX, depth[i] and ids[i] match the frame pixel for pixel.
+ * ENV_OBS_SENSE skips the full cast and fills only sense[i]. */
+typedef struct Env {
+    EnvConfig   config;
+    TriggerSet  triggers;        /* built once from the shared map      */
+    EnvInstance inst[ENV_MAX_INSTANCES];
+    RayHit      hits[ENV_MAX_INSTANCES][SCREEN_W];
+    uint32_t    pixels[ENV_MAX_INSTANCES][SCREEN_H * SCREEN_W];
+    float       depth[ENV_MAX_INSTANCES][SCREEN_H * SCREEN_W];
+    uint32_t    ids[ENV_MAX_INSTANCES][SCREEN_H * SCREEN_W];
+    SenseHit    sense[ENV_MAX_INSTANCES][SENSE_MAX_RAYS];
+    float       sense_angles[SENSE_MAX_RAYS];
+    bool        done[ENV_MAX_INSTANCES]; /* reached the endgame         */
+    uint64_t    steps;           /* env_step() calls so far             */
+    const Input *inputs;         /* this step's input, NULL = none      */
+
+    Map          own[ENV_MAX_INSTANCES]; /* private copies, see MapCow  */
+} Env;
+
+/**  Create config->count instances on config->map and fill the first
+ *   observations.  Takes a reference to the shared map and atlas.
+ *   Only the used parts of env are touched.  Returns false on a bad
+ *   config. */
+bool env_create(Env *env, const EnvConfig *config);
+
+/**  Advance every instance one tick with inputs[i] (count entries),
+ *   then observe.  Instances that are done hold still until reset.
+ *   Blocks until all instances have stepped. */
+void env_step(Env *env, const Input *inputs);
+
+/**  Put instance i back in its starting state (sharing the map again)
+ *   and observe it. */
+void env_reset(Env *env, int i);
+
+/**  Drop every shared reference.  The pool is the caller's and keeps
+ *   running. */
+void env_destroy(Env *env);
+
+#endif /* ENV_H */
@@ -0,0 +1,382 @@
+/*  flow.c  –  shared flow fields: one sweep per goal, one lookup per agent
+ *  ─────────────────────────────────────────────────────────────────
+ *  A flow field stores, for every cell, the cost to one goal and the
+ *  first step of a shortest route there.  Any number of agents heading
+ *  for the same goal then steer with a single array read each, instead
+ *  of each running its own search.  Fields are cached per goal cell and
+ *  follow map edits through the change log: only the cells whose route
+ *  crossed an edited cell are re-solved.
+ *  No SDL headers.  Several fields sync at once on the job pool.
+ */
+#include "flow.h"
+#include "jobs.h"
+#include "map_edit.h"
+#include "raycaster.h"
+
+#include <math.h>
+#include <string.h>
+
+_Static_assert(MAP_MAX_W <= 64, "open rows must fit in 64 bits");
+
+/* Same direction order as path.c: odd directions are diagonal */
+static const int DX[PATH_DIRS] = {  0,  1, 1, 1, 0, -1, -1, -1 };
+static const int DY[PATH_DIRS] = { -1, -1, 0, 1, 1,  1,  0, -1 };
+
+#define CELLS (MAP_MAX_W * MAP_MAX_H)
+
+/* ── Grid helpers ──────────────────────────────────────────────────── */
+
+static bool in_field(const FlowField *f, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < f->w && y < f->h;
+}
+
+static bool is_open(const FlowField *f, int x, int y)
+{
+    return in_field(f, x, y) && (f->open[y] >> x & 1u);
+}
+
+static void set_open(FlowField *f, const Map *map, int x, int y)
+{
+    uint64_t bit = (uint64_t)1 << x;
+    if (map->tiles[y][x] > TILE_FLOOR)
+        f->open[y] &= ~bit;
+    else
+        f->open[y] |= bit;
+}
+
+/** One step along d; diagonals need both orthogonal neighbours open.
+ *  The rule is symmetric, so the sweep can run backwards from the goal. */
+static bool can_step(const FlowField *f, int x, int y, int d)
+{
+    int nx = x + DX[d], ny = y + DY[d];
+    if (!is_open(f, nx, ny)) return false;
+    if (d & 1) return is_open(f, nx, y) && is_open(f, x, ny);
+    return true;
+}
+
+static uint32_t step_cost(int d)
+{
+    return (d & 1) ? PATH_COST_DIAGONAL : PATH_COST_STRAIGHT;
+}
+
+static void mark(uint64_t bits[MAP_MAX_H], int x, int y)
+{
+    bits[y] |= (uint64_t)1 << x;
+}
+
+/* ── Priority queue on cost (binary heap with decrease-key) ───────── */
+
+typedef struct Queue {
+    uint16_t heap[CELLS];
+    int16_t  pos[CELLS];         /* index in heap, -1 = not queued      */
+    int      n;
+} Queue;
+
+static void queue_init(Queue *q)
+{
+    memset(q->pos, 0xFF, sizeof(q->pos));
+    q->n = 0;
+}
+
+static void queue_swap(Queue *q, int a, int b)
+{
+    uint16_t t = q->heap[a];
+    q->heap[a] = q->heap[b];
+    q->heap[b] = t;
+    q->pos[q->heap[a]] = (int16_t)a;
+    q->pos[q->heap[b]] = (int16_t)b;
+}
+
+/** Insert cell, or move it up after its key dropped. */
+static void queue_push(Queue *q, const uint32_t *key, int cell)
+{
+    if (q->pos[cell] < 0) {
+        q->pos[cell] = (int16_t)q->n;
+        q->heap[q->n++] = (uint16_t)cell;
+    }
+    int i = q->pos[cell];
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (key[q->heap[p]] <= key[q->heap[i]]) break;
+        queue_swap(q, i, p);
+        i = p;
+    }
+}
+
+static int queue_pop(Queue *q, const uint32_t *key)
+{
+    int top = q->heap[0];
+    q->pos[top] = -1;
+    if (--q->n > 0) {
+        q->heap[0] = q->heap[q->n];
+        q->pos[q->heap[0]] = 0;
+        int i = 0;
+        for (;;) {
+            int l = 2 * i + 1, r = l + 1, m = i;
+            if (l < q->n && key[q->heap[l]] < key[q->heap[m]]) m = l;
+            if (r < q->n && key[q->heap[r]] < key[q->heap[m]]) m = r;
+            if (m == i) break;
+            queue_swap(q, i, m);
+            i = m;
+        }
+    }
+    return top;
+}
+
+/* ── Sweep ─────────────────────────────────────────────────────────── */
+
+/** Dijkstra from the queued cells: lower every cost it can reach and
+ *  note each lowered cell in `changed` (if given). */
+static void relax_queue(FlowField *f, Queue *q, uint64_t changed[MAP_MAX_H])
+{
+    uint32_t *key = &f->cost[0][0];
+    while (q->n > 0) {
+        int u  = queue_pop(q, key);
+        int ux = u % MAP_MAX_W, uy = u / MAP_MAX_W;
+        for (int d = 0; d < PATH_DIRS; d++) {
+            if (!can_step(f, ux, uy, d)) continue;
+            int vx = ux + DX[d], vy = uy + DY[d];
+            uint32_t c = key[u] + step_cost(d);
+            if (c >= f->cost[vy][vx]) continue;
+            f->cost[vy][vx] = c;
+            queue_push(q, key, vy * MAP_MAX_W + vx);
+            if (changed) mark(changed, vx, vy);
+        }
+    }
+}
+
+/** First step of a shortest route out of (x, y), read from the costs:
+ *  the cheapest legal neighbour, lowest direction index on ties. */
+static void set_dir(FlowField *f, int x, int y)
+{
+    uint8_t  best_d = FLOW_NONE;
+    uint32_t best   = FLOW_UNREACHED;
+    if (is_open(f, x, y) && f->cost[y][x] != FLOW_UNREACHED
+        && !(x == f->gx && y == f->gy)) {
+        for (int d = 0; d < PATH_DIRS; d++) {
+            if (!can_step(f, x, y, d)) continue;
+            uint32_t c = f->cost[y + DY[d]][x + DX[d]];
+            if (c == FLOW_UNREACHED) continue;
+            if (c + step_cost(d) < best) {
+                best   = c + step_cost(d);
+                best_d = (uint8_t)d;
+            }
+        }
+    }
+    f->dir[y][x] = best_d;
+}
+
+void flow_build(FlowField *f, const Map *map, int gx, int gy)
+{
+    memset(f->open, 0, sizeof(f->open));
+    memset(f->cost, 0xFF, sizeof(f->cost));
+    f->w  = map->w;
+    f->h  = map->h;
+    f->gx = gx;
+    f->gy = gy;
+    for (int y = 0; y < f->h; y++)
+        for (int x = 0; x < f->w; x++)
+            set_open(f, map, x, y);
+
+    if (is_open(f, gx, gy)) {
+        Queue q;
+        queue_init(&q);
+        f->cost[gy][gx] = 0;
+        queue_push(&q, &f->cost[0][0], gy * MAP_MAX_W + gx);
+        relax_queue(f, &q, NULL);
+    }
+    for (int y = 0; y < f->h; y++)
+        for (int x = 0; x < f->w; x++)
+            set_dir(f, x, y);
+
+    f->revision = map->revision;
+    f->valid    = true;
+}
+
+/* ── Incremental repair ────────────────────────────────────────────── */
+
+/** The step out of (x, y) lands on (tx, ty). */
+static bool steps_to(const FlowField *f, int x, int y, int tx, int ty)
+{
+    int d = f->dir[y][x];
+    return d != FLOW_NONE && x + DX[d] == tx && y + DY[d] == ty;
+}
+
+void flow_field_sync(FlowField *f, const Map *map)
+{
+    if (f->revision == map->revision) return;
+
+    if (!map_changes_available(map, f->revision)
+        || f->w != map->w || f->h != map->h) {
+        flow_build(f, map, f->gx, f->gy);
+        return;
+    }
+
+    /* Cells that opened or closed since the last sync */
+    uint16_t flipped[MAP_CHANGE_LOG];
+    int nflip = 0;
+    for (uint32_t r = f->revision + 1; r <= map->revision; r++) {
+        MapChange c = map_change_at(map, r);
+        bool was_open = is_open(f, c.x, c.y);
+        set_open(f, map, c.x, c.y);
+        if (is_open(f, c.x, c.y) == was_open) continue;
+        if (c.x == f->gx && c.y == f->gy) {
+            flow_build(f, map, f->gx, f->gy);
+            return;
+        }
+        flipped[nflip++] = (uint16_t)(c.y * MAP_MAX_W + c.x);
+    }
+    f->revision = map->revision;
+    if (nflip == 0) return;
+
+    /* 1. Closed cells: every cell whose route ran through one (or
+     *    squeezed diagonally past it) loses its cost */
+    uint16_t stack[CELLS + 5 * MAP_CHANGE_LOG];
+    uint64_t lost[MAP_MAX_H], dirty[MAP_MAX_H];
+    memset(lost, 0, sizeof(lost));
+    memset(dirty, 0, sizeof(dirty));
+    int top = 0;
+    for (int i = 0; i < nflip; i++) {
+        int qx = flipped[i] % MAP_MAX_W, qy = flipped[i] / MAP_MAX_W;
+        if (is_open(f, qx, qy)) continue;
+        stack[top++] = flipped[i];
+        for (int d = 0; d < PATH_DIRS; d += 2) {
+            int cx = qx + DX[d], cy = qy + DY[d];
+            if (!in_field(f, cx, cy)) continue;
+            int cd = f->dir[cy][cx];
+            if (cd != FLOW_NONE && (cd & 1)
+                && ((cx + DX[cd] == qx && cy == qy) || (cx == qx && cy + DY[cd] == qy)))
+                stack[top++] = (uint16_t)(cy * MAP_MAX_W + cx);
+        }
+    }
+    while (top > 0) {
+        int u = stack[--top];
+        int ux = u % MAP_MAX_W, uy = u / MAP_MAX_W;
+        if (lost[uy] >> ux & 1u) continue;
+        mark(lost, ux, uy);
+        mark(dirty, ux, uy);
+        f->cost[uy][ux] = FLOW_UNREACHED;
+        for (int d = 0; d < PATH_DIRS; d++) {
+            int nx = ux + DX[d], ny = uy + DY[d];
+            if (in_field(f, nx, ny) && steps_to(f, nx, ny, ux, uy))
+                stack[top++] = (uint16_t)(ny * MAP_MAX_W + nx);
+        }
+    }
+
+    /* 2. Re-solve from the intact cells bordering the lost region and
+     *    every flipped cell (an opened cell can only lower costs) */
+    uint64_t around[MAP_MAX_H];
+    memcpy(around, lost, sizeof(around));
+    for (int i = 0; i < nflip; i++)
+        mark(around, flipped[i] % MAP_MAX_W, flipped[i] / MAP_MAX_W);
+    Queue q;
+    queue_init(&q);
+    for (int y = 0; y < f->h; y++)
+        for (int x = 0; x < f->w; x++) {
+            if (!(around[y] >> x & 1u)) continue;
+            for (int d = 0; d < PATH_DIRS; d++) {
+                int nx = x + DX[d], ny = y + DY[d];
+                if (is_open(f, nx, ny) && !(lost[ny] >> nx & 1u)
+                    && f->cost[ny][nx] != FLOW_UNREACHED)
+                    queue_push(&q, &f->cost[0][0], ny * MAP_MAX_W + nx);
+            }
+        }
+    relax_queue(f, &q, dirty);
+
+    /* 3. Directions around every changed cost or flipped cell */
+    for (int y = 0; y < f->h; y++)
+        dirty[y] |= around[y];
+    uint64_t near[MAP_MAX_H];
+    for (int y = 0; y < f->h; y++) {
+        uint64_t rows = dirty[y];
+        if (y > 0)        rows |= dirty[y - 1];
+        if (y < f->h - 1) rows |= dirty[y + 1];
+        near[y] = rows | rows << 1 | rows >> 1;
+    }
+    for (int y = 0; y < f->h; y++)
+        for (int x = 0; x < f->w; x++)
+            if (near[y] >> x & 1u) set_dir(f, x, y);
+}
+
+/* ── Cache ─────────────────────────────────────────────────────────── */
+
+void flow_clear(FlowCache *fc)
+{
+    for (int i = 0; i < FLOW_MAX_FIELDS; i++)
+        fc->fields[i].valid = false;
+}
+
+const FlowField *flow_get(FlowCache *fc, const Map *map, int gx, int gy)
+{
+    if (gx < 0 || gy < 0 || gx >= map->w || gy >= map->h) return NULL;
+    fc->clock++;
+
+    FlowField *victim = &fc->fields[0];
+    for (int i = 0; i < FLOW_MAX_FIELDS; i++) {
+        FlowField *f = &fc->fields[i];
+        if (f->valid && f->gx == gx && f->gy == gy) {
+            if (f->revision != map->revision) {
+                flow_field_sync(f, map);
+                fc->repairs++;
+            }
+            f->last_used = fc->clock;
+            return f;
+        }
+        if (victim->valid && (!f->valid || f->last_used < victim->last_used))
+            victim = f;
+    }
+
+    flow_build(victim, map, gx, gy);
+    fc->builds++;
+    victim->last_used = fc->clock;
+    return victim;
+}
+
+typedef struct SyncJob {
+    FlowField  *fields[FLOW_MAX_FIELDS];
+    int         n;
+    const Map  *map;
+} SyncJob;
+
+static void sync_range(void *arg, int begin, int end)
+{
+    SyncJob *job = arg;
+    for (int i = begin; i < end; i++)
+        flow_field_sync(job->fields[i], job->map);
+}
+
+void flow_sync(FlowCache *fc, const Map *map, struct JobPool *pool)
+{
+    /* Gather the fields behind the map's revision */
+    SyncJob job = { .n = 0, .map = map };
+    for (int i = 0; i < FLOW_MAX_FIELDS; i++) {
+        FlowField *f = &fc->fields[i];
+        if (f->valid && f->revision != map->revision)
+            job.fields[job.n++] = f;
+    }
+    fc->repairs += job.n;
+    job_parallel_for(pool, 0, job.n, 1, sync_range, &job);
+}
+
+bool flow_step(const FlowField *f, int x, int y, int *dx, int *dy)
+{
+    if (!in_field(f, x, y) || f->dir[y][x] == FLOW_NONE) return false;
+    *dx = DX[f->dir[y][x]];
+    *dy = DY[f->dir[y][x]];
+    return true;
+}
+
+void flow_steer(const FlowField *f, EntityPool *ep)
+{
+    for (int i = 0; i < ep->count; i++) {
+        int cx = (int)ep->x[i], cy = (int)ep->y[i], dx, dy;
+        if (!flow_step(f, cx, cy, &dx, &dy)) continue;
+        float tx = (float)(cx + dx) + 0.5f - ep->x[i];
+        float ty = (float)(cy + dy) + 0.5f - ep->y[i];
+        float len = sqrtf(tx * tx + ty * ty);
+        if (len <= 0.0f) continue;
+        ep->vx[i] = tx / len * ENT_SPEED;
+        ep->vy[i] = ty / len * ENT_SPEED;
+    }
+}
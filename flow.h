@@ -0,0 +1,68 @@
+#ifndef FLOW_H
+#define FLOW_H
+
+#include "game_globals.h"
+#include "entity.h"
+#include "path.h"
+
+/* ── Flow field limits ────────────────────────────────────────────── */
+#define FLOW_MAX_FIELDS  8       /* goals cached at once (LRU)          */
+#define FLOW_UNREACHED   UINT32_MAX /* cost of cells with no route      */
+#define FLOW_NONE        PATH_DIRS  /* dir at the goal / when unreached */
+
+/* ── One goal's field ─────────────────────────────────────────────── */
+/* cost is the exact 8-way path cost to the goal (PATH_COST_* units,
+ * no corner cutting, as in path.h).  dir is the first step of a
+ * shortest path, taken from the costs alone (lowest direction index on
+ * ties), so an incrementally repaired field equals a fresh build. */
+typedef struct FlowField {
+    uint32_t cost[MAP_MAX_H][MAP_MAX_W];
+    uint8_t  dir[MAP_MAX_H][MAP_MAX_W];
+    uint64_t open[MAP_MAX_H];    /* bit x of open[y] = walkable cell    */
+    int      w, h;
+    int      gx, gy;             /* goal cell                           */
+    uint32_t revision;           /* map revision this field reflects    */
+    uint32_t last_used;          /* FlowCache clock, for eviction       */
+    bool     valid;
+} FlowField;
+
+/* ── Per-goal cache ───────────────────────────────────────────────── */
+typedef struct FlowCache {
+    FlowField fields[FLOW_MAX_FIELDS];
+    uint32_t  clock;             /* bumped by every flow_get()          */
+    int       builds;            /* full sweeps so far (diagnostic)     */
+    int       repairs;           /* incremental updates so far          */
+} FlowCache;
+
+/**  Full Dijkstra sweep from (gx, gy) over the tiles plane. */
+void flow_build(FlowField *f, const Map *map, int gx, int gy);
+
+/**  Bring a field up to date with the map.  Closing a cell re-solves
+ *   only the cells whose route went through it; opening one relaxes
+ *   outward from it.  A wrapped change log or a bulk change rebuilds. */
+void flow_field_sync(FlowField *f, const Map *map);
+
+/**  Forget every cached field (e.g. when the map is replaced). */
+void flow_clear(FlowCache *fc);
+
+/**  The field for goal (gx, gy), synced to the map: reused when cached,
+ *   otherwise built in the least recently used slot.  NULL if the goal
+ *   is outside the map. */
+const FlowField *flow_get(FlowCache *fc, const Map *map, int gx, int gy);
+
+struct JobPool;
+
+/**  Sync every cached field, one job per stale field on pool (NULL =
+ *   all on the caller). */
+void flow_sync(FlowCache *fc, const Map *map, struct JobPool *pool);
+
+/**  Step (dx, dy) out of cell (x, y) toward the goal.  Returns false at
+ *   the goal, on solid or unreachable cells and outside the map. */
+bool flow_step(const FlowField *f, int x, int y, int *dx, int *dy);
+
+/**  Point every entity at the centre of its next cell on the field, at
+ *   ENT_SPEED.  One lookup each; entities with no step (at the goal or
+ *   cut off) keep their velocity. */
+void flow_steer(const FlowField *f, EntityPool *ep);
+
+#endif /* FLOW_H */
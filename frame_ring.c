@@ -0,0 +1,200 @@
+/*  frame_ring.c  –  zero-copy frame export through POSIX shared memory
+ *  ─────────────────────────────────────────────────────────────────
+ *  The renderer draws straight into a slot of a shm_open() mapping, so
+ *  recorders and analysis tools in other processes read frames without
+ *  a copy and without ever blocking the render loop.  The protocol is a
+ *  per-slot seqlock (see frame_ring.h): the producer never waits, and
+ *  a reader that was lapped finds out from the sequence counter.
+ *  No SDL headers.  POSIX shm + mmap.
+ */
+#define _POSIX_C_SOURCE 200809L  /* shm_open(), ftruncate(), fstat() */
+
+#include "frame_ring.h"
+#include "memstat.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PAGE_BYTES 4096           /* header page and slot alignment      */
+
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+               "ring counters must be lock-free to work across processes");
+_Static_assert(sizeof(FrameRingHeader) <= PAGE_BYTES, "header fits a page");
+
+static size_t slot_bytes(void)
+{
+    size_t n = (size_t)SCREEN_W * SCREEN_H * sizeof(uint32_t);
+    return (n + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+}
+
+static bool set_name(FrameRing *r, const char *name, const char *fn)
+{
+    if (!name || name[0] != '/' || strlen(name) >= FRING_NAME_MAX) {
+        fprintf(stderr, "%s: bad ring name '%s' (want '/name')\n",
+                fn, name ? name : "(null)");
+        return false;
+    }
+    strcpy(r->name, name);
+    return true;
+}
+
+/* ── Producer ──────────────────────────────────────────────────────── */
+
+bool fring_create(FrameRing *r, const char *name)
+{
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+    if (!set_name(r, name, "fring_create")) return false;
+
+    /* A ring left behind by a crashed producer is replaced */
+    shm_unlink(r->name);
+    r->fd = shm_open(r->name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (r->fd < 0) {
+        perror("fring_create: shm_open");
+        return false;
+    }
+    r->owner = true;
+    r->size  = PAGE_BYTES + FRING_SLOTS * slot_bytes();
+    if (ftruncate(r->fd, (off_t)r->size) != 0) {
+        perror("fring_create: ftruncate");
+        fring_close(r);
+        return false;
+    }
+    void *p = mmap(NULL, r->size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, 0);
+    if (p == MAP_FAILED) {
+        perror("fring_create: mmap");
+        fring_close(r);
+        return false;
+    }
+    r->base = p;
+    mem_account(MEM_FRAMES, r->size);
+    r->hdr  = p;
+
+    FrameRingHeader *h = r->hdr;
+    h->version     = FRING_VERSION;
+    h->width       = SCREEN_W;
+    h->height      = SCREEN_H;
+    h->stride      = SCREEN_W;
+    h->slots       = FRING_SLOTS;
+    h->slot_bytes  = slot_bytes();
+    h->data_offset = PAGE_BYTES;
+    atomic_init(&h->latest, 0);
+    for (int i = 0; i < FRING_SLOTS; i++) atomic_init(&h->seq[i], 0);
+    atomic_thread_fence(memory_order_release);
+    h->magic = FRING_MAGIC;       /* written last: the header is ready */
+
+    r->next = 1;
+    return true;
+}
+
+uint32_t *fring_acquire(FrameRing *r)
+{
+    FrameRingHeader *h = r->hdr;
+    int slot = (int)(r->next % FRING_SLOTS);
+
+    /* Odd: readers that catch the slot from here on discard it.  The
+     * fence keeps the pixel writes after the counter. */
+    atomic_store_explicit(&h->seq[slot], 2 * r->next - 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    return (uint32_t *)(r->base + h->data_offset + (size_t)slot * h->slot_bytes);
+}
+
+void fring_publish(FrameRing *r)
+{
+    FrameRingHeader *h = r->hdr;
+    int slot = (int)(r->next % FRING_SLOTS);
+    atomic_store_explicit(&h->seq[slot], 2 * r->next, memory_order_release);
+    atomic_store_explicit(&h->latest, r->next, memory_order_release);
+    r->next++;
+}
+
+/* ── Reader ────────────────────────────────────────────────────────── */
+
+bool fring_attach(FrameRing *r, const char *name)
+{
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+    if (!set_name(r, name, "fring_attach")) return false;
+
+    r->fd = shm_open(r->name, O_RDONLY, 0);
+    if (r->fd < 0) {
+        perror("fring_attach: shm_open");
+        return false;
+    }
+    /* Mapping past the end of a short object would fault on first read */
+    r->size = PAGE_BYTES + FRING_SLOTS * slot_bytes();
+    struct stat st;
+    if (fstat(r->fd, &st) != 0 || (size_t)st.st_size < r->size) {
+        fprintf(stderr, "fring_attach: '%s' is smaller than a frame ring\n",
+                r->name);
+        fring_close(r);
+        return false;
+    }
+    void *p = mmap(NULL, r->size, PROT_READ, MAP_SHARED, r->fd, 0);
+    if (p == MAP_FAILED) {
+        perror("fring_attach: mmap");
+        fring_close(r);
+        return false;
+    }
+    r->base = p;
+    mem_account(MEM_FRAMES, r->size);
+    r->hdr  = p;
+
+    const FrameRingHeader *h = r->hdr;
+    bool ok = h->magic == FRING_MAGIC;
+    atomic_thread_fence(memory_order_acquire);
+    ok = ok && h->version == FRING_VERSION && h->slots == FRING_SLOTS
+            && h->width == SCREEN_W && h->height == SCREEN_H
+            && h->slot_bytes == slot_bytes() && h->data_offset == PAGE_BYTES;
+    if (!ok) {
+        fprintf(stderr, "fring_attach: '%s' is not a compatible frame ring\n",
+                r->name);
+        fring_close(r);
+        return false;
+    }
+    return true;
+}
+
+const uint32_t *fring_read_begin(const FrameRing *r, uint64_t *frame)
+{
+    FrameRingHeader *h = r->hdr;
+    uint64_t n = atomic_load_explicit(&h->latest, memory_order_acquire);
+    if (n == 0) return NULL;
+
+    int slot = (int)(n % FRING_SLOTS);
+    if (atomic_load_explicit(&h->seq[slot], memory_order_acquire) != 2 * n)
+        return NULL;             /* lapped between the two loads */
+    *frame = n;
+    return (const uint32_t *)(r->base + h->data_offset
+                              + (size_t)slot * h->slot_bytes);
+}
+
+bool fring_read_end(const FrameRing *r, uint64_t frame)
+{
+    FrameRingHeader *h = r->hdr;
+    int slot = (int)(frame % FRING_SLOTS);
+
+    /* The fence keeps the pixel reads before the second counter load */
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&h->seq[slot], memory_order_relaxed) == 2 * frame;
+}
+
+/* ── Teardown ──────────────────────────────────────────────────────── */
+
+void fring_close(FrameRing *r)
+{
+    if (r->base) {
+        munmap(r->base, r->size);
+        mem_release(MEM_FRAMES, r->size);
+    }
+    if (r->fd >= 0) close(r->fd);
+    if (r->owner) shm_unlink(r->name);
+    r->base  = NULL;
+    r->hdr   = NULL;
+    r->fd    = -1;
+    r->owner = false;
+}
@@ -0,0 +1,76 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "game_globals.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* ── Shared-memory frame ring ─────────────────────────────────────── */
+#define FRING_SLOTS    4          /* frames in flight                    */
+#define FRING_MAGIC    0x52464352u /* "RCFR"                            */
+#define FRING_VERSION  1          /* bump when the layout changes        */
+#define FRING_NAME_MAX 64         /* shm object name, with leading '/'   */
+
+/* One producer renders straight into a slot and publishes it; any
+ * number of readers in other processes map the same object and read
+ * the pixels in place.  Each slot has a sequence counter (a seqlock):
+ * odd while the producer writes frame n, 2n once it is complete.  A
+ * reader checks the counter before and after using the pixels, so a
+ * slot overwritten mid-read is detected instead of locked against.
+ * The header sits at the start of the mapping; slots follow at
+ * data_offset, slot_bytes apart, RGBA8888 rows of `stride` pixels. */
+typedef struct FrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width, height;       /* pixels                              */
+    uint32_t stride;              /* pixels per row                      */
+    uint32_t slots;               /* FRING_SLOTS                         */
+    uint64_t slot_bytes;          /* distance between slots              */
+    uint64_t data_offset;         /* first slot, from the mapping start  */
+    atomic_uint_least64_t latest; /* newest complete frame, 0 = none     */
+    atomic_uint_least64_t seq[FRING_SLOTS]; /* frame n lives in n % slots*/
+} FrameRingHeader;
+
+/* Process-local handle on a mapped ring */
+typedef struct FrameRing {
+    FrameRingHeader *hdr;
+    uint8_t         *base;        /* start of the mapping                */
+    size_t           size;        /* mapped bytes                        */
+    int              fd;
+    bool             owner;       /* producer: unlinks the name on close */
+    uint64_t         next;        /* producer: frame being written       */
+    char             name[FRING_NAME_MAX];
+} FrameRing;
+
+/**  Create (or replace) the shm object `name` ("/..." per shm_open)
+ *   holding a ring of SCREEN_W x SCREEN_H frames, and map it for
+ *   writing.  Returns false on any system error. */
+bool fring_create(FrameRing *r, const char *name);
+
+/**  Map an existing ring read-only.  Returns false if it does not
+ *   exist, is too small to hold the ring, or its header does not
+ *   match this build. */
+bool fring_attach(FrameRing *r, const char *name);
+
+/**  Unmap; the producer also removes the name (readers keep their
+ *   mapping until they close). */
+void fring_close(FrameRing *r);
+
+/**  Producer: claim the next slot and return its pixels to render
+ *   into.  Readers see the slot as busy until fring_publish(). */
+uint32_t *fring_acquire(FrameRing *r);
+
+/**  Producer: mark the acquired frame complete and newest. */
+void fring_publish(FrameRing *r);
+
+/**  Reader: the newest complete frame, in place, or NULL if none has
+ *   been published (or it is already being overwritten).  *frame gets
+ *   its number; pass it to fring_read_end() when done with the pixels. */
+const uint32_t *fring_read_begin(const FrameRing *r, uint64_t *frame);
+
+/**  Reader: true if the pixels of `frame` were not overwritten while
+ *   they were being used, i.e. what was read is that whole frame. */
+bool fring_read_end(const FrameRing *r, uint64_t frame);
+
+#endif /* FRAME_RING_H */
@@ -2,11 +2,7 @@
 #define FRONTEND_H
 
 #include "game_globals.h"
-
-/* ── Rendering colours (RGBA8888) ──────────────────────────────────── */
-#define COL_CEIL       0xAAAAAAFF   /* ceiling (light grey)              */
-#define COL_FLOOR      0x66666666   /* floor (dark grey)                 */
-#define COL_WALL_SHADE 0x000068FF   /* shading reference (darker blue)   */
+#include "render.h"              /* rendering colours, TextureAtlas     */
 
 /**  Initialize the frontend and load textures.
  *   tiles_path: path to wall texture atlas BMP
@@ -17,6 +13,23 @@ void frontend_shutdown(void);
 bool frontend_poll_input(Input *in);
 void frontend_render(const GameState *gs);
 
+struct JobPool;
+
+/**  Draw frames with column bands on this pool (NULL = on the caller). */
+void frontend_set_jobs(struct JobPool *pool);
+
+/**  Like frontend_render(), but draw into a caller-owned framebuffer
+ *   of SCREEN_W-pixel rows (e.g. a frame ring slot) and show that. */
+void frontend_render_to(const GameState *gs, uint32_t *fb);
+
+/**  Block until an event is queued or timeout_ms passes, leaving the
+ *   event for the next poll.  Returns true if an event arrived. */
+bool frontend_wait_events(int timeout_ms);
+
+/**  Queue a wake-up event, so a pending or the next
+ *   frontend_wait_events() returns at once (any thread). */
+void frontend_wake(void);
+
 /**  Render the end-game screen */
 void frontend_render_end_screen(void);
 
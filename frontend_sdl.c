@@ -1,10 +1,12 @@
 /*  frontend_sdl.c  –  SDL3 frontend / renderer
  *  ────────────────────────────────────────────
- *  Reads the RayHit buffer from the core and draws vertical strips.
- *  Renders billboarded sprites after walls using a 1D z-buffer.
+ *  Draws each frame with the software renderer (render.c) into a
+ *  streaming texture, then presents it.
  *  Handles window lifecycle and keyboard input.
  */
 #include "frontend.h"
+#include "jobs.h"
+#include "memstat.h"
 #include "raycaster.h"
 #include "textures_sdl.h"
 
@@ -12,14 +14,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
-#include <stdlib.h>
 
 #define WINDOW_TITLE "Simple 3D Raycaster"
+#define FB_TEX_BYTES ((size_t)SCREEN_W * SCREEN_H * 4) /* RGBA8888, driver side */
 
 /* ── Internal state ────────────────────────────────────────────────── */
 static SDL_Window   *window   = NULL;
 static SDL_Renderer *renderer = NULL;
 static SDL_Texture  *fb_tex   = NULL;  /* streaming framebuffer       */
+static JobPool      *jobs     = NULL;  /* draws column bands, or NULL */
 
 /* ── Public API ────────────────────────────────────────────────────── */
 
@@ -76,11 +79,15 @@ bool frontend_init(const char *tiles_path, const char *sprites_path)
         return false;
     }
 
+    mem_account(MEM_TEXTURE, FB_TEX_BYTES);
+    mem_account(MEM_ATLAS, sizeof(*tm_atlas()));
     return true;
 }
 
 void frontend_shutdown(void)
 {
+    mem_release(MEM_ATLAS, sizeof(*tm_atlas()));
+    mem_release(MEM_TEXTURE, FB_TEX_BYTES);
     tm_shutdown();
     if (fb_tex)   SDL_DestroyTexture(fb_tex);
     if (renderer) SDL_DestroyRenderer(renderer);
@@ -109,98 +116,39 @@ bool frontend_poll_input(Input *in)
     return true;   /* keep running */
 }
 
-/* ── Helpers: darken a colour for y-side shading ─────────────────── */
+bool frontend_wait_events(int timeout_ms)
+{
+    return SDL_WaitEventTimeout(NULL, timeout_ms);
+}
 
-static unsigned int darken(unsigned int c)
+void frontend_wake(void)
 {
-    int r = (c >> 24) & 0xFF;
-    int g = (c >> 16) & 0xFF;
-    int b = (c >>  8) & 0xFF;
-    int a =  c        & 0xFF;
-    return (unsigned int)((r >> 1) << 24 | (g >> 1) << 16 | (b >> 1) << 8 | a);
+    SDL_Event ev;
+    SDL_zero(ev);
+    ev.type = SDL_EVENT_USER;
+    SDL_PushEvent(&ev);           /* the next poll drops it unread */
 }
 
-/* ── Sprite rendering (billboarded, z-buffered) ──────────────────── */
+/* ── Main rendering ───────────────────────────────────────────────── */
 
-static void render_sprites(unsigned int *fb, int fb_stride,
-                           const GameState *gs)
+void frontend_set_jobs(JobPool *pool)
 {
-    const Player *p = &gs->player;
-    int n = gs->visible_sprite_count;
-    if (n <= 0) return;
-
-    /* Inverse camera matrix determinant (for transform_x computation):
-     * | plane_x  dir_x |   inv_det = 1 / (plane_x*dir_y - dir_x*plane_y)
-     * | plane_y  dir_y |
-     */
-    float inv_det = 1.0f / (p->plane_x * p->dir_y - p->dir_x * p->plane_y);
-
-    for (int i = 0; i < n; i++) {
-        const Sprite *sp = &gs->visible_sprites[i];
-        float depth = sp->perp_dist;
-
-        /* Translate sprite position relative to player */
-        float sx = sp->x - p->x;
-        float sy = sp->y - p->y;
-
-        /* Camera-space X (horizontal offset on screen) */
-        float transform_x = inv_det * (p->dir_y * sx - p->dir_x * sy);
-
-        /* Project: screen X position and sprite dimensions */
-        int sprite_screen_x = (int)((SCREEN_W / 2) *
-                              (1.0f + transform_x / depth));
-
-        int sprite_h = abs((int)(SCREEN_H / depth));
-        int sprite_w = sprite_h;  /* square sprites */
-
-        /* Vertical draw bounds */
-        int draw_start_y = -sprite_h / 2 + SCREEN_H / 2;
-        int draw_end_y   =  sprite_h / 2 + SCREEN_H / 2;
-
-        int y_start = draw_start_y < 0 ? 0 : draw_start_y;
-        int y_end   = draw_end_y >= SCREEN_H ? SCREEN_H - 1 : draw_end_y;
-
-        /* Horizontal draw bounds */
-        int draw_start_x = -sprite_w / 2 + sprite_screen_x;
-        int draw_end_x   =  sprite_w / 2 + sprite_screen_x;
-
-        /* Skip entirely if outside screen (FOV culling) */
-        if (draw_end_x < 0 || draw_start_x >= SCREEN_W) continue;
-
-        int x_start = draw_start_x < 0 ? 0 : draw_start_x;
-        int x_end   = draw_end_x >= SCREEN_W ? SCREEN_W - 1 : draw_end_x;
-
-        /* Draw sprite columns */
-        for (int x = x_start; x <= x_end; x++) {
-            /* Z-buffer test: skip if wall is closer */
-            if (depth >= gs->z_buffer[x]) continue;
-
-            /* Texture X coordinate */
-            int tex_x = (int)((x - draw_start_x) * TEX_SIZE / sprite_w);
-            if (tex_x < 0)          tex_x = 0;
-            if (tex_x >= TEX_SIZE)  tex_x = TEX_SIZE - 1;
-
-            /* Draw vertical stripe */
-            for (int y = y_start; y <= y_end; y++) {
-                /* Texture Y coordinate */
-                int d = y * 2 - SCREEN_H + sprite_h;
-                int tex_y = (d * TEX_SIZE) / (sprite_h * 2);
-                if (tex_y < 0)          tex_y = 0;
-                if (tex_y >= TEX_SIZE)  tex_y = TEX_SIZE - 1;
-
-                unsigned int col = tm_get_sprite_pixel(sp->texture_id,
-                                                       tex_x, tex_y);
-
-                /* Transparency: skip magenta alpha-key pixels */
-                if (col == SPRITE_ALPHA_KEY) continue;
-
-                fb[y * fb_stride + x] = col;
-            }
-        }
-    }
+    jobs = pool;
 }
 
-/* ── Main rendering ───────────────────────────────────────────────── */
+/** Blit the framebuffer texture and draw the overlay on top. */
+static void present_texture(const GameState *gs)
+{
+    SDL_RenderTexture(renderer, fb_tex, NULL, NULL);
+
+    /* Debug overlay showing player coords */
+    char dbg[64];
+    snprintf(dbg, sizeof(dbg), "pos %.1f, %.1f", gs->player.x, gs->player.y);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderDebugText(renderer, 8, 8, dbg);
+
+    SDL_RenderPresent(renderer);
+}
 
 void frontend_render(const GameState *gs)
 {
@@ -210,68 +158,20 @@ void frontend_render(const GameState *gs)
     if (!SDL_LockTexture(fb_tex, NULL, &tex_pixels, &tex_pitch)) {
         return;
     }
-    unsigned int *fb = (unsigned int *)tex_pixels;
-    int fb_stride = tex_pitch / 4;
-
-    /* Fill the entire framebuffer with ceiling and floor colours */
-    for (int y = 0; y < SCREEN_H / 2; y++)
-        for (int x = 0; x < SCREEN_W; x++)
-            fb[y * fb_stride + x] = COL_CEIL;
-    for (int y = SCREEN_H / 2; y < SCREEN_H; y++)
-        for (int x = 0; x < SCREEN_W; x++)
-            fb[y * fb_stride + x] = COL_FLOOR;
-
-    /* Draw textured wall strips from the hit buffer */
-    for (int x = 0; x < SCREEN_W; x++) {
-        float dist = gs->hits[x].wall_dist;
-        int line_h = (int)(SCREEN_H / dist);
-
-        int draw_start = -line_h / 2 + SCREEN_H / 2;
-        int draw_end   =  line_h / 2 + SCREEN_H / 2;
-
-        /* Texture X coordinate from fractional wall hit position */
-        int tex_x = (int)(gs->hits[x].wall_x * TEX_SIZE);
-        if (tex_x >= TEX_SIZE) tex_x = TEX_SIZE - 1;
-
-        uint16_t wt = gs->hits[x].tile_type;
-        int side = gs->hits[x].side;
-
-        /* Clamp visible range to screen */
-        int y_start = draw_start < 0 ? 0 : draw_start;
-        int y_end   = draw_end >= SCREEN_H ? SCREEN_H - 1 : draw_end;
-
-        for (int y = y_start; y <= y_end; y++) {
-            /* Map screen Y to texture Y (0 .. TEX_SIZE-1) */
-            int d = y * 2 - SCREEN_H + line_h;  /* offset from strip top */
-            int tex_y = (d * TEX_SIZE) / (line_h * 2);
-            if (tex_y < 0)            tex_y = 0;
-            if (tex_y >= TEX_SIZE)    tex_y = TEX_SIZE - 1;
-
-            unsigned int col = tm_get_tile_pixel(wt, tex_x, tex_y);
-
-            /* Darken y-side hits for depth cue */
-            if (side == 1) col = darken(col);
-
-            fb[y * fb_stride + x] = col;
-        }
-
-    }
 
-    /* Sprite rendering pass (after walls, before unlock) */
-    render_sprites(fb, fb_stride, gs);
+    /* Walls and sprites in software, shared with headless instances */
+    render_frame_jobs(gs, tm_atlas(), (uint32_t *)tex_pixels, tex_pitch / 4,
+                      NULL, jobs);
 
     SDL_UnlockTexture(fb_tex);
+    present_texture(gs);
+}
 
-    /* Blit the framebuffer to screen */
-    SDL_RenderTexture(renderer, fb_tex, NULL, NULL);
-
-    /* Debug overlay showing player coords */
-    char dbg[64];
-    snprintf(dbg, sizeof(dbg), "pos %.1f, %.1f", gs->player.x, gs->player.y);
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderDebugText(renderer, 8, 8, dbg);
-
-    SDL_RenderPresent(renderer);
+void frontend_render_to(const GameState *gs, uint32_t *fb)
+{
+    render_frame_jobs(gs, tm_atlas(), fb, SCREEN_W, NULL, jobs);
+    SDL_UpdateTexture(fb_tex, NULL, fb, SCREEN_W * (int)sizeof(uint32_t));
+    present_texture(gs);
 }
 
 /* ── End-screen rendering ─────────────────────────────────────────── */
@@ -12,16 +12,39 @@
 #define MAP_MAX_W 64
 #define MAP_MAX_H 64
 
+/* ── Map revision tracking ─────────────────────────────────────────── */
+#define MAP_CHANGE_LOG 1024       /* recent cell edits kept for sync     */
+
+/* ── Trigger events ────────────────────────────────────────────────── */
+#define MAX_EVENTS 1024           /* trigger events queued per tick      */
+
 /* ── Sprite constants ─────────────────────────────────────────────── */
 #define SPRITE_EMPTY 0            /* no sprite in this cell              */
 #define MAX_VISIBLE_SPRITES 256   /* max sprites collected per frame     */
 
+/* ── Object IDs (per-pixel render output) ─────────────────────────── */
+/* kind << 28 | material << 16 | object.  The material is the tile type
+ * or sprite texture; the object is the map cell (y * MAP_MAX_W + x) or,
+ * for entities, the index in the EntityPool. */
+#define ID_CEIL     1u            /* ceiling pixel (no material/object)  */
+#define ID_FLOOR    2u            /* floor pixel                         */
+#define ID_WALL     3u            /* wall strip                          */
+#define ID_SPRITE   4u            /* sprite placed in the map            */
+#define ID_ENTITY   5u            /* moving entity                       */
+#define ID_NO_CELL  0xFFFFu       /* wall hit outside the map            */
+#define MAKE_ID(kind, material, object) \
+    ((uint32_t)(kind) << 28 | (uint32_t)(material) << 16 | (uint32_t)(object))
+#define ID_KIND(id)     ((id) >> 28)
+#define ID_MATERIAL(id) ((id) >> 16 & 0xFFFu)
+#define ID_OBJECT(id)   ((id) & 0xFFFFu)
+
 /* ── Per-column ray result ─────────────────────────────────────────── */
 typedef struct RayHit {
     float    wall_dist;     /* perpendicular distance to wall          */
     float    wall_x;        /* where on the wall face the ray hit 0-1  */
     int      side;          /* 0 = x-side hit, 1 = y-side hit          */
     uint16_t tile_type;     /* texture index (0 .. TEX_COUNT-1)        */
+    uint16_t cell;          /* y * MAP_MAX_W + x, ID_NO_CELL outside   */
 } RayHit;
 
 /* ── Player state ──────────────────────────────────────────────────── */
@@ -36,24 +59,60 @@ typedef struct Sprite {
     float    x, y;        /* position in map units (cell centre)       */
     float    perp_dist;   /* perpendicular distance to camera plane    */
     uint16_t texture_id;  /* index into sprite texture atlas           */
+    uint32_t id;          /* MAKE_ID(ID_SPRITE or ID_ENTITY, ...)      */
 } Sprite;
 
+/* ── Edited cell (one entry in the map change log) ────────────────── */
+typedef struct MapChange {
+    uint16_t x, y;
+} MapChange;
+
 /* ── World map ─────────────────────────────────────────────────────── */
 typedef struct Map {
     uint16_t  tiles[MAP_MAX_H][MAP_MAX_W];   /* geometry: 0=floor, >0=wall  */
     uint16_t  info[MAP_MAX_H][MAP_MAX_W];    /* metadata: spawn, triggers   */
     uint16_t  sprites[MAP_MAX_H][MAP_MAX_W]; /* sprites: 0=empty, >0=tex+1  */
     int       w, h;
+    uint32_t  revision;          /* bumped by every map_set_* edit      */
+    uint32_t  rebuild_revision;  /* last bulk change (full rebuild)     */
+    MapChange changes[MAP_CHANGE_LOG]; /* ring: edit r at (r-1) % LOG  */
 } Map;
 
-/* ── Game state (excludes map — managed separately) ───────────────── */
-typedef struct GameState {
+/* ── Trigger event (queued when an entity touches a trigger cell) ─── */
+typedef struct TriggerEvent {
+    uint16_t type;        /* INFO_TRIGGER_* value of the cell          */
+    uint16_t x, y;        /* trigger cell                              */
+    int      entity;      /* TRIG_ENTITY_PLAYER (-1) or entity index   */
+} TriggerEvent;
+
+typedef struct EventQueue {
+    TriggerEvent events[MAX_EVENTS];
+    int          count;
+    int          dropped; /* events lost to a full queue (diagnostic) */
+} EventQueue;
+
+struct TriggerSet;        /* per-cell trigger index, see trigger.h     */
+
+/* ── Simulation state (authoritative, advanced by rc_update) ──────── */
+/* Everything a tick reads and writes besides the map.  Kept apart from
+ * the render buffers so it stays small enough to snapshot every tick. */
+typedef struct SimState {
     Player  player;
+    bool    game_over;           /* true when player reaches endgame   */
+    int     damage_taken;        /* accumulated from damage zones      */
+    EventQueue events;           /* filled and drained by rc_update()  */
+    const struct TriggerSet *triggers; /* NULL = info plane only     */
+    struct MapCow *cow;          /* map shared until edited, NULL = own */
+    const struct EntityPool *npcs; /* keep doors open on them, or NULL */
+} SimState;
+
+/* ── Render state (derived, rebuilt every frame by rc_cast) ───────── */
+typedef struct GameState {
+    Player  player;              /* camera pose for this frame         */
     RayHit  hits[SCREEN_W];      /* filled every frame by rc_cast()    */
     float   z_buffer[SCREEN_W];  /* 1D depth buffer for sprite clipping*/
     Sprite  visible_sprites[MAX_VISIBLE_SPRITES]; /* collected by rc_cast */
     int     visible_sprite_count;                 /* number of visible   */
-    bool    game_over;           /* true when player reaches endgame   */
 } GameState;
 
 /* ── Input flags (set by platform layer) ───────────────────────────── */
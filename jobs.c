@@ -0,0 +1,288 @@
+/*  jobs.c  –  work-stealing job pool shared by casting, drawing and ticks
+ *  ─────────────────────────────────────────────────────────────────
+ *  One set of threads for the whole engine instead of a few per
+ *  subsystem: the render thread splits columns over it, the simulation
+ *  thread splits entities and flow-field repairs, and each caller runs
+ *  jobs itself while it waits, so a wait never idles a core.
+ *  No SDL headers.  Pure C11 threads.
+ */
+#include "jobs.h"
+#include "memstat.h"
+
+#include <stdio.h>
+
+/* Which deque the calling thread owns, if it is one of this pool's */
+static _Thread_local const JobPool *tls_pool;
+static _Thread_local int            tls_index;
+
+static int own_deque(const JobPool *pool)
+{
+    return tls_pool == pool ? tls_index : pool->workers;
+}
+
+/* ── Deques ────────────────────────────────────────────────────────── */
+
+static bool push(JobPool *pool, int d, const Job *job)
+{
+    JobDeque *q = &pool->deques[d];
+    mtx_lock(&q->lock);
+    bool ok = q->bottom - q->top < JOB_DEQUE_SIZE;
+    if (ok) q->ring[q->bottom++ % JOB_DEQUE_SIZE] = *job;
+    mtx_unlock(&q->lock);
+    if (ok) atomic_fetch_add(&pool->queued, 1);
+    return ok;
+}
+
+/** Newest job from deque d (its owner), or oldest (a thief). */
+static bool take_from(JobPool *pool, int d, bool newest, Job *out)
+{
+    JobDeque *q = &pool->deques[d];
+    mtx_lock(&q->lock);
+    bool ok = q->bottom != q->top;
+    if (ok) *out = newest ? q->ring[--q->bottom % JOB_DEQUE_SIZE]
+                          : q->ring[q->top++ % JOB_DEQUE_SIZE];
+    mtx_unlock(&q->lock);
+    if (ok) atomic_fetch_sub(&pool->queued, 1);
+    return ok;
+}
+
+static bool take(JobPool *pool, int self, Job *out)
+{
+    if (atomic_load(&pool->queued) == 0) return false;
+    if (take_from(pool, self, true, out)) return true;
+    int n = pool->workers + 1;
+    for (int i = 1; i < n; i++)
+        if (take_from(pool, (self + i) % n, false, out)) {
+            atomic_fetch_add_explicit(&pool->stolen, 1, memory_order_relaxed);
+            return true;
+        }
+    return false;
+}
+
+/* ── Running ───────────────────────────────────────────────────────── */
+
+static void queue_jobs(JobPool *pool, const Job *jobs, int n);
+
+static void run(JobPool *pool, const Job *job)
+{
+    job->fn(job->arg, job->begin, job->end);
+    atomic_fetch_add_explicit(&pool->executed, 1, memory_order_relaxed);
+
+    /* Read the continuations first: once pending hits zero, the owner
+     * of a counter without any may return and let it go out of scope */
+    JobCounter *c = job->done;
+    if (!c) return;
+    int n = c->then_count;
+    if (atomic_fetch_sub_explicit(&c->pending, 1, memory_order_acq_rel) == 1
+        && n > 0) {
+        /* Last one out releases the next stage, already counted */
+        c->then_count = 0;
+        queue_jobs(pool, c->then, n);
+    }
+}
+
+static void wake_workers(JobPool *pool)
+{
+    /* queued was raised first: a worker about to sleep either sees the
+     * job or is already counted in `sleeping` */
+    if (atomic_load(&pool->sleeping) == 0) return;
+    mtx_lock(&pool->lock);
+    cnd_broadcast(&pool->wake);
+    mtx_unlock(&pool->lock);
+}
+
+/** Push jobs whose counters are already raised. */
+static void queue_jobs(JobPool *pool, const Job *jobs, int n)
+{
+    int d = own_deque(pool);
+    bool queued = false;
+    for (int i = 0; i < n; i++) {
+        if (push(pool, d, &jobs[i])) queued = true;
+        else                         run(pool, &jobs[i]);
+    }
+    if (queued) wake_workers(pool);
+}
+
+static int worker_main(void *arg)
+{
+    JobPool *pool = arg;
+    int self = tls_index;
+    int idle = 0;
+    while (!atomic_load(&pool->quit)) {
+        Job job;
+        if (take(pool, self, &job)) {
+            run(pool, &job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < JOB_SPIN) {
+            thrd_yield();
+            continue;
+        }
+        mtx_lock(&pool->lock);
+        atomic_fetch_add(&pool->sleeping, 1);
+        while (!atomic_load(&pool->quit) && atomic_load(&pool->queued) == 0)
+            cnd_wait(&pool->wake, &pool->lock);
+        atomic_fetch_sub(&pool->sleeping, 1);
+        mtx_unlock(&pool->lock);
+        idle = 0;
+    }
+    return 0;
+}
+
+/* ── Start-up: each thread learns its index before it runs ─────────── */
+
+typedef struct Launch {
+    JobPool *pool;
+    int      index;
+    mtx_t    lock;
+    cnd_t    ready;
+    bool     taken;
+} Launch;
+
+static int worker_entry(void *arg)
+{
+    Launch *l = arg;
+    JobPool *pool = l->pool;
+    tls_pool  = pool;
+    tls_index = l->index;
+    mtx_lock(&l->lock);
+    l->taken = true;
+    cnd_signal(&l->ready);
+    mtx_unlock(&l->lock);
+    return worker_main(pool);
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+bool job_pool_start(JobPool *pool, int workers)
+{
+    if (workers < 0)               workers = 0;
+    if (workers > JOB_MAX_WORKERS) workers = JOB_MAX_WORKERS;
+    pool->workers = 0;
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->sleeping, 0);
+    atomic_init(&pool->quit, false);
+    atomic_init(&pool->executed, 0u);
+    atomic_init(&pool->stolen, 0u);
+    int deques = 0;
+    for (; deques <= JOB_MAX_WORKERS; deques++) {
+        pool->deques[deques].top = pool->deques[deques].bottom = 0;
+        if (mtx_init(&pool->deques[deques].lock, mtx_plain) != thrd_success)
+            break;
+    }
+    bool locked = deques > JOB_MAX_WORKERS
+               && mtx_init(&pool->lock, mtx_plain) == thrd_success;
+    bool waits  = locked && cnd_init(&pool->wake) == thrd_success;
+    if (!waits) {
+        fprintf(stderr, "job_pool_start: cannot create the pool locks\n");
+        if (locked) mtx_destroy(&pool->lock);
+        while (deques-- > 0) mtx_destroy(&pool->deques[deques].lock);
+        return false;
+    }
+    mem_account(MEM_SCRATCH, sizeof(*pool));
+
+    /* The outside deque is the last one, so fix the count up front */
+    pool->workers = workers;
+    Launch l = { .pool = pool };
+    bool launch_locked = mtx_init(&l.lock, mtx_plain) == thrd_success;
+    bool launch_waits  = launch_locked && cnd_init(&l.ready) == thrd_success;
+    int started = 0;
+    for (; launch_waits && started < workers; started++) {
+        l.index = started;
+        l.taken = false;
+        if (thrd_create(&pool->threads[started], worker_entry, &l) != thrd_success)
+            break;
+        mtx_lock(&l.lock);
+        while (!l.taken) cnd_wait(&l.ready, &l.lock);
+        mtx_unlock(&l.lock);
+    }
+    if (launch_waits)  cnd_destroy(&l.ready);
+    if (launch_locked) mtx_destroy(&l.lock);
+
+    if (started < workers) {
+        fprintf(stderr, "job_pool_start: cannot start worker %d\n", started);
+        pool->workers = started;
+        job_pool_stop(pool);
+        return false;
+    }
+    return true;
+}
+
+void job_pool_stop(JobPool *pool)
+{
+    atomic_store(&pool->quit, true);
+    mtx_lock(&pool->lock);
+    cnd_broadcast(&pool->wake);
+    mtx_unlock(&pool->lock);
+    for (int i = 0; i < pool->workers; i++) thrd_join(pool->threads[i], NULL);
+    for (int i = 0; i <= JOB_MAX_WORKERS; i++) mtx_destroy(&pool->deques[i].lock);
+    cnd_destroy(&pool->wake);
+    mtx_destroy(&pool->lock);
+    mem_release(MEM_SCRATCH, sizeof(*pool));
+    pool->workers = 0;
+}
+
+void job_counter_init(JobCounter *c)
+{
+    atomic_init(&c->pending, 0);
+    c->then_count = 0;
+}
+
+bool job_then(JobCounter *c, const Job *job)
+{
+    if (c->then_count >= JOB_MAX_THEN) return false;
+    if (job->done) atomic_fetch_add(&job->done->pending, 1);
+    c->then[c->then_count++] = *job;
+    return true;
+}
+
+void job_submit(JobPool *pool, const Job *jobs, int n)
+{
+    for (int i = 0; i < n; i++)
+        if (jobs[i].done) atomic_fetch_add(&jobs[i].done->pending, 1);
+    queue_jobs(pool, jobs, n);
+}
+
+void job_wait(JobPool *pool, JobCounter *c)
+{
+    int self = own_deque(pool);
+    while (atomic_load_explicit(&c->pending, memory_order_acquire) > 0) {
+        Job job;
+        if (take(pool, self, &job)) run(pool, &job);
+        else                        thrd_yield();  /* last ones in flight */
+    }
+}
+
+void job_parallel_for(JobPool *pool, int begin, int end, int grain,
+                      JobFn fn, void *arg)
+{
+    if (grain < 1) grain = 1;
+    int range = end - begin;
+    if (!pool || range <= grain) {
+        if (range > 0) fn(arg, begin, end);
+        return;
+    }
+
+    /* Enough pieces to balance, never so many the queues overflow */
+    int pieces = (range + grain - 1) / grain;
+    if (pieces > JOB_FOR_CHUNKS) pieces = JOB_FOR_CHUNKS;
+
+    JobCounter done;
+    job_counter_init(&done);
+    Job jobs[JOB_FOR_CHUNKS];
+    for (int i = 0; i < pieces; i++) {
+        jobs[i] = (Job){
+            .fn    = fn,
+            .arg   = arg,
+            .begin = begin + (int)((long long)range * i / pieces),
+            .end   = begin + (int)((long long)range * (i + 1) / pieces),
+            .done  = &done,
+        };
+    }
+
+    /* Queue the rest and start on the first piece here */
+    job_submit(pool, jobs + 1, pieces - 1);
+    fn(arg, jobs[0].begin, jobs[0].end);
+    job_wait(pool, &done);
+}
@@ -0,0 +1,92 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <threads.h>
+
+/* ── Job system ───────────────────────────────────────────────────── */
+#define JOB_MAX_WORKERS  16       /* pool threads, not counting callers  */
+#define JOB_DEFAULT_WORKERS 3     /* --jobs default; callers help too   */
+#define JOB_DEQUE_SIZE   256      /* queued jobs per deque (power of 2)  */
+#define JOB_MAX_THEN     8        /* continuations per counter           */
+#define JOB_FOR_CHUNKS   64       /* most pieces one parallel-for makes  */
+#define JOB_SPIN         64       /* failed steals before a worker sleeps*/
+
+/* One piece of work: fn(arg, begin, end) over a half-open range. */
+typedef void (*JobFn)(void *arg, int begin, int end);
+
+typedef struct JobCounter JobCounter;
+
+typedef struct Job {
+    JobFn       fn;
+    void       *arg;
+    int         begin, end;
+    JobCounter *done;             /* counted down when fn returns, or NULL */
+} Job;
+
+/* A dependency counter: the number of jobs still to finish.  When it
+ * reaches zero, the jobs registered with job_then() are queued, which
+ * chains frame stages without anyone blocking between them. */
+struct JobCounter {
+    atomic_int pending;
+    Job        then[JOB_MAX_THEN];
+    int        then_count;
+};
+
+/* Every pool thread owns a deque: it pushes and pops its own work at
+ * the bottom, and idle threads steal the oldest work from the top of
+ * someone else's.  Threads outside the pool (render, simulation) share
+ * one extra deque.  Each deque has its own lock, so the owner and a
+ * thief only meet when they pick the same deque. */
+typedef struct JobDeque {
+    mtx_t    lock;
+    unsigned top, bottom;         /* steal at top, push/pop at bottom    */
+    Job      ring[JOB_DEQUE_SIZE];
+} JobDeque;
+
+typedef struct JobPool {
+    int          workers;
+    thrd_t       threads[JOB_MAX_WORKERS];
+    JobDeque     deques[JOB_MAX_WORKERS + 1]; /* last: outside callers   */
+    atomic_int   queued;          /* jobs sitting in any deque           */
+    atomic_int   sleeping;        /* workers waiting on `wake`           */
+    atomic_bool  quit;
+    mtx_t        lock;            /* only for sleeping, never for deques */
+    cnd_t        wake;
+    atomic_uint  executed;        /* jobs run, for tests and benchmarks  */
+    atomic_uint  stolen;          /* of those, taken from another deque  */
+} JobPool;
+
+/**  Start `workers` pool threads (clamped to JOB_MAX_WORKERS).  With 0,
+ *   jobs run on whichever caller waits for them.  Returns false if a
+ *   thread cannot be started. */
+bool job_pool_start(JobPool *pool, int workers);
+
+/**  Stop the pool threads.  Every submitted job must have finished. */
+void job_pool_stop(JobPool *pool);
+
+/**  Reset a counter to no pending jobs and no continuations. */
+void job_counter_init(JobCounter *c);
+
+/**  Queue `job` once every job counted on `c` is done.  Register before
+ *   submitting anything counted on `c`; job->done counts it from now,
+ *   so waiting on it before it is released is safe, and `c` must live
+ *   until then.  Returns false if `c` already has JOB_MAX_THEN. */
+bool job_then(JobCounter *c, const Job *job);
+
+/**  Queue n jobs (from any thread).  All their counters are raised
+ *   before the first job is queued, so a stage submitted in one call
+ *   cannot finish early.  A full deque runs the job on the caller. */
+void job_submit(JobPool *pool, const Job *jobs, int n);
+
+/**  Run queued jobs on the calling thread until c has no pending jobs. */
+void job_wait(JobPool *pool, JobCounter *c);
+
+/**  fn over [begin, end) in pieces of at least `grain`, spread over the
+ *   pool and the caller; returns when all are done.  A NULL pool or a
+ *   range no larger than grain runs fn(arg, begin, end) directly. */
+void job_parallel_for(JobPool *pool, int begin, int end, int grain,
+                      JobFn fn, void *arg);
+
+#endif /* JOBS_H */
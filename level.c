@@ -0,0 +1,234 @@
+/*  level.c  –  level list and background preloading of the next map
+ *  ─────────────────────────────────────────────────────────────────
+ *  While one level plays, a preload thread loads the following level's
+ *  map and builds its derived data into the spare slot.  Reaching the
+ *  endgame trigger then swaps the two slot pointers instead of blocking
+ *  on file I/O.  The game loop only ever touches *active; the preload
+ *  thread only ever touches *next.
+ */
+#include "level.h"
+#include "map_cache.h"
+#include "map_manager.h"
+#include "memstat.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static void build_occupancy(void *data, const Map *map)
+{
+    map_occupancy_build(data, map);
+}
+
+static void build_triggers(void *data, const Map *map)
+{
+    trig_build(data, map);
+}
+
+static void build_jumps(void *data, const Map *map)
+{
+    path_build(data, map);
+}
+
+/** Load one level and everything derived from its map, reusing cached
+ *  derived data when the map is unchanged since it was built. */
+static bool load_level(const LevelManager *lm, int index, Level *lv)
+{
+    memset(lv, 0, sizeof(*lv));
+    const char *sprites = lm->sprites[index][0] ? lm->sprites[index] : NULL;
+    if (!map_load(&lv->map, &lv->spawn, lm->tiles[index], sprites,
+                  lm->info[index]))
+        return false;
+
+    MapCache mc;
+    map_cache_open(&mc, lm->cache_dir[0] ? lm->cache_dir : NULL, &lv->map);
+    map_cache_fetch(&mc, "occupancy", MAP_OCCUPANCY_VERSION, &lv->occupancy,
+                    sizeof(lv->occupancy), build_occupancy, &lv->map);
+    map_cache_fetch(&mc, "triggers", TRIGGER_SET_VERSION, &lv->triggers,
+                    sizeof(lv->triggers), build_triggers, &lv->map);
+    map_cache_fetch(&mc, "jumps", PATH_JUMP_VERSION, &lv->jumps,
+                    sizeof(lv->jumps), build_jumps, &lv->map);
+
+    /* Cached entries match the planes, not necessarily the revision */
+    lv->occupancy.revision = lv->map.revision;
+    lv->triggers.revision  = lv->map.revision;
+    lv->jumps.revision     = lv->map.revision;
+    lv->cache_hits = mc.hits;
+    return true;
+}
+
+static int preload_thread(void *arg)
+{
+    LevelManager *lm = arg;
+
+    mtx_lock(&lm->lock);
+    for (;;) {
+        while (!lm->quit && lm->request < 0)
+            cnd_wait(&lm->wake, &lm->lock);
+        if (lm->quit) break;
+
+        int index = lm->request;
+        Level *dst = lm->next;
+        mtx_unlock(&lm->lock);
+
+        bool ok = load_level(lm, index, dst);
+
+        mtx_lock(&lm->lock);
+        lm->request = -1;
+        lm->loaded  = index;
+        lm->load_ok = ok;
+        cnd_broadcast(&lm->wake);
+    }
+    mtx_unlock(&lm->lock);
+    return 0;
+}
+
+/** Queue a preload of the level after the current one (lock held). */
+static void request_next(LevelManager *lm)
+{
+    lm->loaded = -1;
+    if (lm->current + 1 < lm->count) {
+        lm->request = lm->current + 1;
+        cnd_broadcast(&lm->wake);
+    }
+}
+
+static bool parse_list(LevelManager *lm, const char *list_path)
+{
+    FILE *fp = fopen(list_path, "r");
+    if (!fp) {
+        fprintf(stderr, "level_open: cannot open '%s'\n", list_path);
+        return false;
+    }
+
+    char line[3 * LEVEL_PATH_MAX + 8];
+    int  line_no = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        char tiles[LEVEL_PATH_MAX], sprites[LEVEL_PATH_MAX], info[LEVEL_PATH_MAX];
+        char first;
+        if (sscanf(line, " %c", &first) != 1 || first == '#') continue;
+
+        if (sscanf(line, "%127s %127s %127s", tiles, sprites, info) != 3) {
+            fprintf(stderr, "level_open: bad entry at '%s' line %d\n",
+                    list_path, line_no);
+            fclose(fp);
+            return false;
+        }
+        if (lm->count >= MAX_LEVELS) {
+            fprintf(stderr, "level_open: more than %d levels in '%s'\n",
+                    MAX_LEVELS, list_path);
+            fclose(fp);
+            return false;
+        }
+
+        strcpy(lm->tiles[lm->count], tiles);
+        strcpy(lm->sprites[lm->count], strcmp(sprites, "-") == 0 ? "" : sprites);
+        strcpy(lm->info[lm->count], info);
+        lm->count++;
+    }
+    fclose(fp);
+
+    if (lm->count == 0) {
+        fprintf(stderr, "level_open: no levels in '%s'\n", list_path);
+        return false;
+    }
+    return true;
+}
+
+/** Report both slots: maps and lists as map data, the rest derived. */
+static void account(const LevelManager *lm, bool hold)
+{
+    const Level *l = &lm->slots[0];
+    size_t derived = (sizeof(l->occupancy) + sizeof(l->triggers)
+                      + sizeof(l->jumps)) * 2;
+    void (*op)(MemTag, size_t) = hold ? mem_account : mem_release;
+    op(MEM_DERIVED, derived);
+    op(MEM_MAP, sizeof(*lm) - derived);
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+bool level_open(LevelManager *lm, const char *list_path,
+                const char *cache_dir)
+{
+    memset(lm, 0, sizeof(*lm));
+    lm->request = -1;
+    lm->loaded  = -1;
+    lm->active  = &lm->slots[0];
+    lm->next    = &lm->slots[1];
+
+    if (!parse_list(lm, list_path)) return false;
+    if (cache_dir)
+        snprintf(lm->cache_dir, sizeof(lm->cache_dir), "%s", cache_dir);
+
+    if (!load_level(lm, 0, lm->active)) {
+        fprintf(stderr, "level_open: failed to load level 1 of '%s'\n",
+                list_path);
+        return false;
+    }
+
+    /* Undo exactly what was set up before a failure */
+    bool locked = mtx_init(&lm->lock, mtx_plain) == thrd_success;
+    bool waits  = locked && cnd_init(&lm->wake) == thrd_success;
+    if (!waits || thrd_create(&lm->thread, preload_thread, lm) != thrd_success) {
+        fprintf(stderr, "level_open: cannot start preload thread\n");
+        if (waits)  cnd_destroy(&lm->wake);
+        if (locked) mtx_destroy(&lm->lock);
+        return false;
+    }
+
+    mtx_lock(&lm->lock);
+    request_next(lm);
+    mtx_unlock(&lm->lock);
+    account(lm, true);
+    return true;
+}
+
+bool level_advance(LevelManager *lm)
+{
+    if (lm->current + 1 >= lm->count) return false;
+
+    mtx_lock(&lm->lock);
+    while (lm->loaded != lm->current + 1)
+        cnd_wait(&lm->wake, &lm->lock);
+
+    if (!lm->load_ok) {
+        mtx_unlock(&lm->lock);
+        fprintf(stderr, "level_advance: failed to load level %d\n",
+                lm->current + 2);
+        return false;
+    }
+
+    /* The transition itself: swap the slots */
+    Level *tmp = lm->active;
+    lm->active = lm->next;
+    lm->next   = tmp;
+    lm->current++;
+
+    request_next(lm);
+    mtx_unlock(&lm->lock);
+    return true;
+}
+
+bool level_next_ready(LevelManager *lm)
+{
+    mtx_lock(&lm->lock);
+    bool ready = lm->loaded == lm->current + 1 && lm->load_ok;
+    mtx_unlock(&lm->lock);
+    return ready;
+}
+
+void level_close(LevelManager *lm)
+{
+    mtx_lock(&lm->lock);
+    lm->quit = true;
+    cnd_broadcast(&lm->wake);
+    mtx_unlock(&lm->lock);
+
+    thrd_join(lm->thread, NULL);
+    cnd_destroy(&lm->wake);
+    mtx_destroy(&lm->lock);
+    account(lm, false);
+}
@@ -0,0 +1,68 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include "game_globals.h"
+#include "map_edit.h"
+#include "path.h"
+#include "trigger.h"
+
+#include <threads.h>
+
+/* ── Level list limits ────────────────────────────────────────────── */
+#define MAX_LEVELS      16       /* entries in a level list file        */
+#define LEVEL_PATH_MAX  128      /* max length of one map file path     */
+
+/* ── One level: map planes plus everything derived from them ──────── */
+typedef struct Level {
+    Map          map;
+    Player       spawn;          /* player pose from the info plane     */
+    MapOccupancy occupancy;      /* built off-thread with the map       */
+    TriggerSet   triggers;       /* per-cell trigger index              */
+    JumpTable    jumps;          /* pathfinding jump distances          */
+    int          cache_hits;     /* derived structures read from cache  */
+} Level;
+
+/* ── Level sequence with a background preloader ───────────────────── */
+typedef struct LevelManager {
+    char   tiles[MAX_LEVELS][LEVEL_PATH_MAX];
+    char   sprites[MAX_LEVELS][LEVEL_PATH_MAX];  /* "" = no sprites   */
+    char   info[MAX_LEVELS][LEVEL_PATH_MAX];
+    int    count;
+    int    current;              /* index of the active level           */
+    char   cache_dir[LEVEL_PATH_MAX]; /* derived-data cache, "" = none  */
+
+    Level  slots[2];             /* double buffer: active + preloading  */
+    Level *active;               /* read by the game loop               */
+    Level *next;                 /* written only by the preload thread  */
+
+    /* Shared with the preload thread – guarded by lock */
+    mtx_t  lock;
+    cnd_t  wake;
+    thrd_t thread;
+    int    request;              /* level index to preload, -1 = none   */
+    int    loaded;               /* level index in *next, -1 = none     */
+    bool   load_ok;
+    bool   quit;
+} LevelManager;
+
+/**  Read a level list (one "tiles sprites info" triplet per line, '-'
+ *   for no sprites, '#' comments), load the first level synchronously
+ *   and start preloading the second in the background.  Derived data
+ *   is looked up in cache_dir first (NULL = always build).
+ *   Returns false on failure. */
+bool level_open(LevelManager *lm, const char *list_path,
+                const char *cache_dir);
+
+/**  Switch to the next level.  Normally a pointer swap of the preloaded
+ *   slot; blocks only if the preload has not finished yet.  Starts
+ *   preloading the level after it.  Returns false when there is no next
+ *   level or it failed to load. */
+bool level_advance(LevelManager *lm);
+
+/**  True once the next level is fully loaded and preprocessed. */
+bool level_next_ready(LevelManager *lm);
+
+/**  Stop the preload thread. */
+void level_close(LevelManager *lm);
+
+#endif /* LEVEL_H */
@@ -1,78 +1,448 @@
-/*  main.c  –  entry point & fixed-step game loop
+/*  main.c  –  entry point & render loop
  *  ───────────────────────────────────────────────
+ *  Loads the world, hands it to the simulation thread (sim.c) and then
+ *  renders the newest published snapshot at display rate.
  */
 #include "raycaster.h"
-#include "map_manager.h"
+#include "arena.h"
+#include "map_stream.h"
+#include "map_gen.h"
+#include "level.h"
+#include "trigger.h"
+#include "entity.h"
+#include "path.h"
+#include "sim.h"
+#include "pace.h"
+#include "replay.h"
+#include "map_cache.h"
+#include "memstat.h"
+#include "frame_ring.h"
+#include "jobs.h"
+#include "capture.h"
+#include "server.h"
 #include "frontend.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-#define TICK_RATE  60            /* logic updates per second          */
-#define DT         (1.0f / TICK_RATE)
-#define MAX_FRAME  0.25f         /* max frame time before clamping (s)*/
+#define STREAM_RADIUS  1         /* chunks kept resident around player */
+#define STREAM_BUDGET  (16 * MAP_CHUNK_BYTES) /* resident chunk budget  */
+#define IDLE_WAIT_MS   50        /* longest sleep while nothing changes */
 
-int main()
+/** Server hook: remote input changed, so stop idling and draw. */
+static void wake_frontend(void *arg)
 {
-    const char *map_tiles_path       = "assets/map_tiles.txt";
-    const char *map_sprites_path     = "assets/map_sprites.txt";
-    const char *map_info_path        = "assets/map_info.txt";
+    (void)arg;
+    frontend_wake();
+}
+
+/** Replay a recorded session headlessly at full speed and check that it
+ *  ends in the recorded state.  Returns the process exit code. */
+static int run_replay(SimWorld *w, FlowCache *flows, const char *path)
+{
+    Replay rp;
+    if (!replay_open_read(&rp, path)) return 1;
+
+    if (rp.header.map_hash != map_hash(w->map)) {
+        fprintf(stderr, "main: replay '%s' was recorded on a different map\n",
+                path);
+        replay_close(&rp);
+        return 1;
+    }
+    w->state.player = rp.header.spawn;
+    w->flows        = (rp.header.flags & REPLAY_CHASE) ? flows : NULL;
+    ent_populate(&w->npcs, w->occupancy, rp.header.npc_count, 1);
+
+    Input  in;
+    double start = sim_clock();
+    while (replay_next(&rp, &in))
+        sim_world_tick(w, &in, rp.header.dt);
+    double secs = sim_clock() - start;
+    replay_close(&rp);
+
+    bool same = rp.ticks == rp.end_ticks && sim_world_hash(w) == rp.end_hash;
+    printf("replay: %llu ticks in %.3f s (%.0f ticks/s), final state %s\n",
+           (unsigned long long)rp.ticks, secs,
+           secs > 0.0 ? (double)rp.ticks / secs : 0.0,
+           same ? "matches" : "DIFFERS");
+    return same ? 0 : 2;
+}
+
+int main(int argc, char **argv)
+{
+    const char *levels_path          = "assets/levels.txt";
     const char *texture_tiles_path   = "assets/texture_tiles.bmp";
     const char *texture_sprites_path = "assets/texture_sprites.bmp";
+    const char *stream_path          = NULL;  /* --stream: chunked map  */
+    const char *pack_path            = NULL;  /* --pack: write chunked  */
+    const char *gen_spec             = NULL;  /* --gen kind:seed        */
+    const char *cache_dir            = "cache"; /* --cache dir         */
+    int         npc_count            = 0;     /* --npcs N wanderers     */
+    bool        chase                = false; /* --chase: NPCs pursue   */
+    int         tick_rate            = SIM_TICK_RATE; /* --tick-rate Hz */
+    int         fps_cap              = 0;     /* --fps N, 0 = uncapped  */
+    const char *record_path          = NULL;  /* --record: input log    */
+    const char *replay_path          = NULL;  /* --replay: headless run */
+    const char *export_name          = NULL;  /* --export /shm-name     */
+    const char *capture_path         = NULL;  /* --capture: Y4M video   */
+    const char *serve_addr           = NULL;  /* --serve unix:P|tcp:N   */
+    int         job_threads          = JOB_DEFAULT_WORKERS; /* --jobs N */
 
-    /* Initialise */
-    Map map;
-    memset(&map, 0, sizeof(map));
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            levels_path = argv[++i];
+        } else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            stream_path = argv[++i];
+        } else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+            pack_path = argv[++i];
+        } else if (strcmp(argv[i], "--gen") == 0 && i + 1 < argc) {
+            gen_spec = argv[++i];
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            cache_dir = NULL;
+        } else if (strcmp(argv[i], "--npcs") == 0 && i + 1 < argc) {
+            npc_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--chase") == 0) {
+            chase = true;
+        } else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            tick_rate = atoi(argv[++i]);
+            if (tick_rate < 1) tick_rate = 1;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps_cap = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+            export_name = argv[++i];
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capture_path = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            job_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            serve_addr = argv[++i];
+        } else {
+            fprintf(stderr, "main: unknown option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
 
-    GameState gs;
-    memset(&gs, 0, sizeof(gs));
+    /* Streamed chunks arrive at wall-clock times, so a streamed session
+     * cannot be reproduced tick for tick */
+    if ((record_path || replay_path) && stream_path) {
+        fprintf(stderr, "main: --record/--replay need a non-streamed map\n");
+        return 1;
+    }
 
-    if (!map_load(&map, &gs.player, map_tiles_path, map_sprites_path, map_info_path)) {
-        fprintf(stderr, "main: failed to load map\n");
+    /* A streamed map is already chunked; there is nothing to pack */
+    if (pack_path && stream_path) {
+        fprintf(stderr, "main: --pack needs a non-streamed map\n");
         return 1;
     }
 
+    /* Initialise.  A generated or streamed map is a single level;
+     * otherwise levels come from the list and map points at the
+     * active (preloaded) slot.  Everything the simulation touches
+     * lives in sim.world. */
+    static Map single;
+    memset(&single, 0, sizeof(single));
+
+    static Sim          sim;
+    static MapStream    stream;
+    static LevelManager levels;
+    static TriggerSet   single_triggers;
+    static MapOccupancy single_occupancy;
+    static JumpTable    single_jumps;
+    static FlowCache    flows;
+    SimWorld *w = &sim.world;
+    w->map       = &single;
+    w->npc_count = npc_count;
+    bool level_mode = !gen_spec && !stream_path;
+
+    if (gen_spec) {
+        /* "kind:seed", e.g. "maze:42" – a full-size generated map */
+        char kind_name[16];
+        const char *colon = strchr(gen_spec, ':');
+        size_t len = colon ? (size_t)(colon - gen_spec) : strlen(gen_spec);
+        MapGenKind kind;
+        if (len >= sizeof(kind_name)) len = sizeof(kind_name) - 1;
+        memcpy(kind_name, gen_spec, len);
+        kind_name[len] = '\0';
+        uint32_t seed = colon ? (uint32_t)strtoul(colon + 1, NULL, 10) : 0u;
+
+        if (!map_gen_kind_from_name(kind_name, &kind)
+            || !map_gen(w->map, &w->state.player, kind, MAP_MAX_W, MAP_MAX_H,
+                        seed)) {
+            fprintf(stderr, "main: bad --gen '%s'\n", gen_spec);
+            return 1;
+        }
+    } else if (stream_path) {
+        if (!map_stream_open(&stream, w->map, &w->state.player, stream_path,
+                             STREAM_RADIUS, STREAM_BUDGET)) {
+            fprintf(stderr, "main: failed to open streamed map\n");
+            return 1;
+        }
+        w->stream          = &stream;
+        w->stream_triggers = &single_triggers;
+    } else {
+        if (!level_open(&levels, levels_path, cache_dir)) {
+            fprintf(stderr, "main: failed to load map\n");
+            return 1;
+        }
+        w->map          = &levels.active->map;
+        w->state.player = levels.active->spawn;
+        w->levels       = &levels;
+    }
+
+    /* Trigger index, occupancy bits and jump table for the (first) map */
+    if (level_mode) {
+        w->state.triggers = &levels.active->triggers;
+        w->occupancy      = &levels.active->occupancy;
+        w->jumps          = &levels.active->jumps;
+    } else {
+        trig_build(&single_triggers, w->map);
+        map_occupancy_build(&single_occupancy, w->map);
+        path_build(&single_jumps, w->map);
+        w->state.triggers = &single_triggers;
+        w->occupancy      = &single_occupancy;
+        w->jumps          = &single_jumps;
+    }
+    if (chase) w->flows = &flows;
+    ent_populate(&w->npcs, w->occupancy, npc_count, 1);
+
+    /* Level lists and streams report their own maps; the rest is here */
+    if (!level_mode) {
+        mem_account(MEM_MAP, sizeof(single));
+        mem_account(MEM_DERIVED, sizeof(single_triggers)
+                                 + sizeof(single_occupancy) + sizeof(single_jumps));
+    }
+    if (chase) mem_account(MEM_DERIVED, sizeof(flows));
+
+    /* Convert the (first) map to the chunked format and exit */
+    if (pack_path) {
+        bool ok = map_stream_write(w->map, &w->state.player, pack_path);
+        if (level_mode) level_close(&levels);
+        return ok ? 0 : 1;
+    }
+
+    /* One worker pool for casting, drawing and ticking (--jobs 0 = none) */
+    static JobPool jobs;
+    bool pooled = job_threads > 0 && job_pool_start(&jobs, job_threads);
+    JobPool *pool = pooled ? &jobs : NULL;
+    w->jobs = pool;
+
+    /* Headless replay: no window, no simulation thread */
+    if (replay_path) {
+        int rc = run_replay(w, &flows, replay_path);
+        if (pooled)     job_pool_stop(&jobs);
+        if (level_mode) level_close(&levels);
+        return rc;
+    }
+
     /* Initialize frontend and textures */
     if (!frontend_init(texture_tiles_path, texture_sprites_path)) {
+        if (pooled)      job_pool_stop(&jobs);
+        if (stream_path) map_stream_close(&stream);
+        if (level_mode)  level_close(&levels);
+        return 1;
+    }
+    frontend_set_jobs(pool);
+
+    /* From here on only the simulation thread touches the world */
+    sim.dt = 1.0f / (float)tick_rate;
+
+    static Replay record;
+    if (record_path) {
+        ReplayHeader h = {
+            .map_hash  = map_hash(w->map),
+            .dt        = sim.dt,
+            .spawn     = w->state.player,
+            .npc_count = npc_count,
+            .flags     = chase ? REPLAY_CHASE : 0u,
+        };
+        if (replay_open_write(&record, record_path, &h)) sim.record = &record;
+    }
+
+    if (!sim_start(&sim)) {
+        frontend_shutdown();
+        if (pooled)      job_pool_stop(&jobs);
+        if (stream_path) map_stream_close(&stream);
+        if (level_mode)  level_close(&levels);
         return 1;
     }
 
-    /* Main loop (fixed timestep with accumulator) */
-    Input  input;
+    /* Render loop: draw the newest snapshot at display rate */
+    Input input;
     memset(&input, 0, sizeof(input));
 
-    double prev  = frontend_get_time();
-    float  accum = 0.0f;
+    static GameState  gs;        /* render-side buffers (hits, sprites) */
+    static EntityPool npcs;      /* entities blended between ticks      */
+    mem_account(MEM_VIEW, sizeof(gs));
+    mem_account(MEM_ENTITIES, sizeof(npcs));
+    bool game_over = false;
+    bool running   = true;
 
-    bool running = true;
-    while (running) {
-        double now   = frontend_get_time();
-        float  frame = (float)(now - prev);
-        prev = now;
+    /* What is on screen, for idle detection: a frame drawn from a still
+     * snapshot stays correct until input, pose or map change */
+    bool     shown_still = false;
+    unsigned shown_input = 0;
+    Player   shown_pose;
+    uint32_t shown_epoch = 0, shown_revision = 0;
+    memset(&shown_pose, 0, sizeof(shown_pose));
+
+    /* --export: frames go to a shared-memory ring for other processes */
+    static FrameRing ring;
+    bool exporting = export_name && fring_create(&ring, export_name);
+    if (exporting) printf("export: frames in shm '%s'\n", export_name);
+
+    /* --capture: Y4M to a file or a named pipe, written off this thread */
+    static Capture  capture;
+    static uint32_t capture_fb[SCREEN_H * SCREEN_W];
+    FILE *capture_out = capture_path ? fopen(capture_path, "wb") : NULL;
+    if (capture_path && !capture_out)
+        fprintf(stderr, "main: cannot open capture '%s'\n", capture_path);
+    if (capture_out && !cap_open(&capture, capture_out, fps_cap)) {
+        fclose(capture_out);
+        capture_out = NULL;
+    }
+    if (capture_out) mem_account(MEM_FRAMES, sizeof(capture_fb));
 
-        /* Clamp large spikes (e.g. window drag) */
-        if (frame > MAX_FRAME) frame = MAX_FRAME;
-        accum += frame;
+    /* --serve: remote input in, state deltas and frames out.  Client
+     * input wakes an idle loop, which would otherwise wait on SDL */
+    static Server server;
+    server.on_input = wake_frontend;
+    bool serving = serve_addr && srv_start(&server, serve_addr);
+    if (serving && server.port) printf("serve: 127.0.0.1:%d\n", server.port);
+    else if (serving)           printf("serve: %s\n", server.path);
+    bool shown_served = false;   /* the frame on screen went to clients */
+
+    Pacer  pacer;
+    double next_report = pace_clock() + PACE_REPORT_S;
+    pace_init(&pacer, fps_cap);
+
+    /* kill -USR1 prints what each subsystem holds */
+    mem_watch_signal();
+
+    while (running) {
+        if (mem_report_requested()) mem_report(stdout);
 
         /* Poll events once per frame */
         running = frontend_poll_input(&input);
+        if (serving)                 /* remote keys press alongside local */
+            sim_unpack_input(sim_pack_input(&input) | srv_input(&server), &input);
+        sim_set_input(&sim, &input);
 
-        /* Fixed-step logic updates */
-        while (accum >= DT) {
-            rc_update(&gs, &map, &input, DT);
-            accum -= DT;
+        /* Idle: nothing moved since the last frame, so skip the cast
+         * and the present and sleep until an event (or a short timeout,
+         * for map changes the sim makes on its own) */
+        const SimSnapshot *snap = sim_latest(&sim);
+        if (shown_still && running && !snap->game_over
+            && sim_pack_input(&input) == shown_input
+            && snap->map_epoch == shown_epoch
+            && snap->map.revision == shown_revision
+            && memcmp(&snap->player, &shown_pose, sizeof(Player)) == 0
+            && sim_snapshot_still(snap)
+            && !(serving && srv_wants_frames(&server) && !shown_served)) {
+            if (frontend_wait_events(IDLE_WAIT_MS))
+                shown_still = false;     /* e.g. exposed: draw once more */
+            pace_restart(&pacer);        /* idling is not a late frame */
+            if (capture_out)             /* keep the still on the tape */
+                cap_repeat(&capture, cap_frames_due(&capture, pace_clock()));
+            continue;
         }
 
-        /* Render at display rate */
-        rc_cast(&gs, &map);
-        frontend_render(&gs);
+        /* Drop the last frame's scratch in one step */
+        arena_reset(arena_thread());
+
+        /* Draw the world between its last two ticks, so motion stays
+         * smooth at display rates above the tick rate */
+        float alpha = sim_alpha(snap, sim_clock());
+        rc_lerp_player(&gs.player, &snap->prev_player, &snap->player, alpha);
+        sim_lerp_npcs(snap, alpha, &npcs);
+        rc_cast_jobs(&gs, &snap->map, pool);
+        ent_collect_sprites(&npcs, &gs);
+        uint32_t *served = serving && srv_wants_frames(&server)
+                         ? srv_frame_begin(&server) : NULL;
+        uint32_t *fb = exporting   ? fring_acquire(&ring)
+                     : served      ? served
+                     : capture_out ? capture_fb : NULL;
+        if (fb) {
+            /* Draw where the frame is consumed (the shared ring, the
+             * server or the capture buffer) and show that same frame */
+            frontend_render_to(&gs, fb);
+            if (capture_out) {
+                /* One stream frame per capture tick, at any draw rate */
+                int due = cap_frames_due(&capture, pace_clock());
+                if (due > 0) {
+                    cap_submit(&capture, fb, SCREEN_W);
+                    cap_repeat(&capture, due - 1);
+                }
+            }
+            if (served && served != fb)
+                memcpy(served, fb, sizeof(uint32_t) * SCREEN_W * SCREEN_H);
+            if (served)      srv_frame_publish(&server);
+            if (exporting)   fring_publish(&ring);
+        } else {
+            frontend_render(&gs);
+        }
+        if (serving) {
+            SrvState st = {
+                .tick = snap->tick, .player = snap->player,
+                .game_over = snap->game_over, .damage_taken = snap->damage_taken,
+                .map_epoch = snap->map_epoch, .map_revision = snap->map.revision,
+            };
+            srv_publish_state(&server, &st);
+        }
+        shown_served   = served != NULL;
 
-        /* Player reached the endgame trigger */
-        if (gs.game_over) running = false;
+        shown_still    = sim_snapshot_still(snap);
+        shown_input    = sim_pack_input(&input);
+        shown_pose     = snap->player;
+        shown_epoch    = snap->map_epoch;
+        shown_revision = snap->map.revision;
+
+        /* Hold the frame rate to --fps and report how evenly it holds */
+        pace_wait(&pacer);
+        if (fps_cap > 0 && pace_clock() >= next_report) {
+            double mean, max;
+            int n = pace_take_stats(&pacer, &mean, &max);
+            printf("pacing: %d frames at %d fps cap, error mean %.3f ms, "
+                   "max %.3f ms\n", n, fps_cap, mean * 1e3, max * 1e3);
+            next_report = pace_clock() + PACE_REPORT_S;
+        }
+
+        if (snap->game_over) {
+            game_over = true;
+            running   = false;
+        }
+    }
+    mem_report(stdout);          /* before teardown gives memory back */
+    sim_stop(&sim);
+    if (exporting) fring_close(&ring);
+    if (serving) {
+        srv_stop(&server);
+        printf("serve: %llu frames skipped for slow clients\n",
+               (unsigned long long)server.frames_skipped);
+    }
+    if (capture_out) {
+        uint64_t n = cap_close(&capture);
+        printf("capture: %llu frames written, %llu dropped%s\n",
+               (unsigned long long)n, (unsigned long long)capture.dropped,
+               atomic_load(&capture.io_error) ? " (write error)" : "");
+        fclose(capture_out);
     }
+    unsigned short_allocs;
+    size_t arena_peak = arena_thread_peak(&short_allocs);
+    printf("arena: peak %zu of %d bytes per thread", arena_peak,
+           ARENA_THREAD_SIZE);
+    if (short_allocs) printf(", %u allocations did not fit", short_allocs);
+    printf("\n");
+    if (sim.record) replay_close_write(sim.record, sim_world_hash(&sim.world));
 
     /* End-game screen */
-    if (gs.game_over) {
+    if (game_over) {
         frontend_render_end_screen();
         bool waiting = true;
         while (waiting) {
@@ -81,5 +451,8 @@ int main()
     }
 
     frontend_shutdown();
+    if (pooled)      job_pool_stop(&jobs);
+    if (stream_path) map_stream_close(&stream);
+    if (level_mode)  level_close(&levels);
     return 0;
 }
@@ -0,0 +1,149 @@
+/*  map_cache.c  –  on-disk cache of derived map data
+ *  ─────────────────────────────────────────────────────────────────
+ *  Entry layout (header little-endian, payload native):
+ *    0  "RCDC"                magic
+ *    4  u32 version           caller's structure version
+ *    8  u32 size              payload bytes
+ *   12  u64 hash              map_hash() of the source map
+ *   20  payload
+ *  Entries are written to a temporary file and renamed into place, so
+ *  a crash mid-write never leaves a truncated entry behind.
+ */
+#define _POSIX_C_SOURCE 200809L  /* mkdir() */
+
+#include "map_cache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define HEADER_BYTES  20
+#define FNV_OFFSET    0xcbf29ce484222325ull
+#define FNV_PRIME     0x100000001b3ull
+
+/* ── Hash ──────────────────────────────────────────────────────────── */
+
+static uint64_t fnv_u16(uint64_t h, uint16_t v)
+{
+    h = (h ^ (v & 0xFF)) * FNV_PRIME;
+    h = (h ^ (v >> 8))   * FNV_PRIME;
+    return h;
+}
+
+uint64_t map_hash(const Map *map)
+{
+    uint64_t h = FNV_OFFSET;
+    h = fnv_u16(h, (uint16_t)map->w);
+    h = fnv_u16(h, (uint16_t)map->h);
+    for (int y = 0; y < map->h; y++) {
+        for (int x = 0; x < map->w; x++) {
+            h = fnv_u16(h, map->tiles[y][x]);
+            h = fnv_u16(h, map->info[y][x]);
+            h = fnv_u16(h, map->sprites[y][x]);
+        }
+    }
+    return h;
+}
+
+/* ── Header helpers ────────────────────────────────────────────────── */
+
+static void put_u32(uint8_t *b, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) b[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t *b, uint64_t v)
+{
+    put_u32(b,     (uint32_t)v);
+    put_u32(b + 4, (uint32_t)(v >> 32));
+}
+
+static void make_header(uint8_t hdr[HEADER_BYTES], uint32_t version,
+                        size_t size, uint64_t hash)
+{
+    memcpy(hdr, "RCDC", 4);
+    put_u32(hdr + 4, version);
+    put_u32(hdr + 8, (uint32_t)size);
+    put_u64(hdr + 12, hash);
+}
+
+/* ── Entries ───────────────────────────────────────────────────────── */
+
+static bool read_entry(const char *path, uint32_t version, uint64_t hash,
+                       void *data, size_t size)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+
+    uint8_t want[HEADER_BYTES], got[HEADER_BYTES];
+    make_header(want, version, size, hash);
+    bool ok = fread(got, 1, sizeof(got), fp) == sizeof(got)
+           && memcmp(got, want, sizeof(got)) == 0
+           && fread(data, 1, size, fp) == size
+           && fgetc(fp) == EOF;       /* no trailing bytes */
+    fclose(fp);
+    return ok;
+}
+
+static void write_entry(const char *path, uint32_t version, uint64_t hash,
+                        const void *data, size_t size)
+{
+    char tmp[MAP_CACHE_PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) {
+        fprintf(stderr, "map_cache_fetch: cannot write '%s'\n", tmp);
+        return;
+    }
+    uint8_t hdr[HEADER_BYTES];
+    make_header(hdr, version, size, hash);
+    bool ok = fwrite(hdr, 1, sizeof(hdr), fp) == sizeof(hdr)
+           && fwrite(data, 1, size, fp) == size;
+    ok = fclose(fp) == 0 && ok;
+
+    if (!ok || rename(tmp, path) != 0) {
+        fprintf(stderr, "map_cache_fetch: cannot store '%s'\n", path);
+        remove(tmp);
+    }
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+void map_cache_open(MapCache *mc, const char *dir, const Map *map)
+{
+    memset(mc, 0, sizeof(*mc));
+    mc->hash = map_hash(map);
+    if (!dir) return;
+
+    if (strlen(dir) + 40 >= sizeof(mc->dir)) {
+        fprintf(stderr, "map_cache_open: path too long '%s'\n", dir);
+        return;
+    }
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "map_cache_open: cannot create '%s'\n", dir);
+        return;
+    }
+    strcpy(mc->dir, dir);
+}
+
+bool map_cache_fetch(MapCache *mc, const char *name, uint32_t version,
+                     void *data, size_t size, MapCacheBuildFn build,
+                     const Map *map)
+{
+    char path[MAP_CACHE_PATH_MAX + 64];
+    if (mc->dir[0]) {
+        snprintf(path, sizeof(path), "%s/%016llx-%s.bin", mc->dir,
+                 (unsigned long long)mc->hash, name);
+        if (read_entry(path, version, mc->hash, data, size)) {
+            mc->hits++;
+            return true;
+        }
+    }
+
+    build(data, map);
+    mc->misses++;
+    if (mc->dir[0]) write_entry(path, version, mc->hash, data, size);
+    return false;
+}
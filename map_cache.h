@@ -0,0 +1,40 @@
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H
+
+#include "game_globals.h"
+
+#include <stddef.h>
+
+/* ── Derived-data cache ───────────────────────────────────────────── */
+/* Derived structures (occupancy bits, trigger index, …) are stored in a
+ * cache directory under "<hash>-<name>.bin", keyed by a hash of the map
+ * planes.  An entry is used only if its magic, version, size and hash
+ * all match; anything else is treated as a miss and rebuilt.  Entries
+ * are raw structs in native byte order, so a cache is machine-local. */
+#define MAP_CACHE_PATH_MAX  256  /* max length of a cache file path     */
+
+typedef struct MapCache {
+    char     dir[MAP_CACHE_PATH_MAX]; /* "" = caching disabled          */
+    uint64_t hash;               /* map_hash() of the served map        */
+    int      hits, misses;
+} MapCache;
+
+/**  Builds one derived structure from a map (e.g. map_occupancy_build). */
+typedef void (*MapCacheBuildFn)(void *data, const Map *map);
+
+/**  64-bit FNV-1a hash of the map size and all three planes. */
+uint64_t map_hash(const Map *map);
+
+/**  Hash the map and prepare the cache directory (created if missing).
+ *   dir may be NULL to disable caching; fetches then always build. */
+void map_cache_open(MapCache *mc, const char *dir, const Map *map);
+
+/**  Fill data (size bytes) with the derived structure called name:
+ *   read it from the cache if a valid entry exists, otherwise build it
+ *   and store it.  Bump version whenever the structure or its builder
+ *   changes.  Returns true on a cache hit. */
+bool map_cache_fetch(MapCache *mc, const char *name, uint32_t version,
+                     void *data, size_t size, MapCacheBuildFn build,
+                     const Map *map);
+
+#endif /* MAP_CACHE_H */
@@ -0,0 +1,158 @@
+/*  map_edit.c  –  runtime map mutation and incremental derived data
+ *  ─────────────────────────────────────────────────────────────────
+ *  Doors, destructible walls and pushwalls edit the Map through these
+ *  setters so that the revision counter and change log stay accurate.
+ *  No SDL headers.  Pure C.
+ */
+#include "map_edit.h"
+#include "raycaster.h"
+
+#include <string.h>
+
+_Static_assert(MAP_MAX_W <= 64, "occupancy rows must fit in 64 bits");
+
+/* ── Change log ────────────────────────────────────────────────────── */
+
+static bool in_bounds(const Map *map, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < map->w && y < map->h;
+}
+
+static void record_change(Map *map, int x, int y)
+{
+    map->revision++;
+    MapChange *c = &map->changes[(map->revision - 1) % MAP_CHANGE_LOG];
+    c->x = (uint16_t)x;
+    c->y = (uint16_t)y;
+}
+
+static bool set_cell(Map *map, uint16_t plane[MAP_MAX_H][MAP_MAX_W],
+                     int x, int y, uint16_t value)
+{
+    if (!in_bounds(map, x, y) || plane[y][x] == value) return false;
+    plane[y][x] = value;
+    record_change(map, x, y);
+    return true;
+}
+
+bool map_set_tile(Map *map, int x, int y, uint16_t value)
+{
+    return set_cell(map, map->tiles, x, y, value);
+}
+
+bool map_set_info(Map *map, int x, int y, uint16_t value)
+{
+    return set_cell(map, map->info, x, y, value);
+}
+
+bool map_set_sprite(Map *map, int x, int y, uint16_t value)
+{
+    return set_cell(map, map->sprites, x, y, value);
+}
+
+void map_invalidate(Map *map)
+{
+    map->revision++;
+    map->rebuild_revision = map->revision;
+}
+
+bool map_changes_available(const Map *map, uint32_t since)
+{
+    return since >= map->rebuild_revision
+        && since <= map->revision
+        && map->revision - since <= MAP_CHANGE_LOG;
+}
+
+MapChange map_change_at(const Map *map, uint32_t rev)
+{
+    return map->changes[(rev - 1) % MAP_CHANGE_LOG];
+}
+
+/* ── Shared maps ───────────────────────────────────────────────────── */
+
+void map_share_init(SharedMap *sm, const Map *src)
+{
+    sm->map = *src;
+    atomic_init(&sm->refs, 1);
+}
+
+void map_share_retain(SharedMap *sm)
+{
+    atomic_fetch_add_explicit(&sm->refs, 1, memory_order_relaxed);
+}
+
+bool map_share_release(SharedMap *sm)
+{
+    return atomic_fetch_sub_explicit(&sm->refs, 1, memory_order_acq_rel) == 1;
+}
+
+void map_cow_init(MapCow *cow, SharedMap *sm, Map *own)
+{
+    map_share_retain(sm);
+    cow->shared = sm;
+    cow->own    = own;
+    cow->map    = &sm->map;
+}
+
+Map *map_cow_write(MapCow *cow)
+{
+    if (cow->shared) {
+        *cow->own = cow->shared->map;
+        map_share_release(cow->shared);
+        cow->shared = NULL;
+        cow->map    = cow->own;
+    }
+    return cow->map;
+}
+
+void map_cow_release(MapCow *cow)
+{
+    if (cow->shared) map_share_release(cow->shared);
+    cow->shared = NULL;
+    cow->map    = cow->own;
+}
+
+/* ── Occupancy bits ────────────────────────────────────────────────── */
+
+static void occupancy_set_cell(MapOccupancy *occ, const Map *map, int x, int y)
+{
+    uint64_t bit = (uint64_t)1 << x;
+    if (map->tiles[y][x] > TILE_FLOOR)
+        occ->rows[y] |= bit;
+    else
+        occ->rows[y] &= ~bit;
+}
+
+void map_occupancy_build(MapOccupancy *occ, const Map *map)
+{
+    memset(occ, 0, sizeof(*occ));
+    occ->w = map->w;
+    occ->h = map->h;
+    for (int y = 0; y < map->h; y++)
+        for (int x = 0; x < map->w; x++)
+            occupancy_set_cell(occ, map, x, y);
+    occ->revision = map->revision;
+}
+
+void map_occupancy_sync(MapOccupancy *occ, const Map *map)
+{
+    if (occ->revision == map->revision) return;
+
+    if (!map_changes_available(map, occ->revision)
+        || occ->w != map->w || occ->h != map->h) {
+        map_occupancy_build(occ, map);
+        return;
+    }
+
+    for (uint32_t r = occ->revision + 1; r <= map->revision; r++) {
+        MapChange c = map_change_at(map, r);
+        occupancy_set_cell(occ, map, c.x, c.y);
+    }
+    occ->revision = map->revision;
+}
+
+bool map_occupancy_solid(const MapOccupancy *occ, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= occ->w || y >= occ->h) return true;
+    return (occ->rows[y] >> x) & 1;
+}
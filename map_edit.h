@@ -0,0 +1,92 @@
+#ifndef MAP_EDIT_H
+#define MAP_EDIT_H
+
+#include "game_globals.h"
+
+#include <stdatomic.h>
+
+/* ── Runtime map mutation ─────────────────────────────────────────── */
+/* Every edit bumps map->revision and records the cell in the change log.
+ * Derived structures remember the revision they were built at and replay
+ * only the cells edited since, falling back to a full rebuild when the
+ * log has wrapped or a bulk change (map_invalidate) happened. */
+
+/**  Set a cell in the tiles / info / sprites plane.  Out-of-bounds cells
+ *   and writes of the current value are ignored.  Returns true if the
+ *   cell changed (and the revision was bumped). */
+bool map_set_tile(Map *map, int x, int y, uint16_t value);
+bool map_set_info(Map *map, int x, int y, uint16_t value);
+bool map_set_sprite(Map *map, int x, int y, uint16_t value);
+
+/**  Record a bulk change (load, streamed chunk, ...): every derived
+ *   structure must rebuild from scratch on its next sync. */
+void map_invalidate(Map *map);
+
+/**  True if every edit after revision `since` is still in the log, so a
+ *   derived structure at that revision can update incrementally. */
+bool map_changes_available(const Map *map, uint32_t since);
+
+/**  The cell edited at revision rev (since < rev <= map->revision). */
+MapChange map_change_at(const Map *map, uint32_t rev);
+
+/* ── Shared maps (copy-on-write) ──────────────────────────────────── */
+/* Many games on the same level read one SharedMap.  A game reaches its
+ * map through a MapCow, which copies the planes into caller-provided
+ * storage the first time the game edits them and drops its reference
+ * to the shared copy.  Until then the private storage is never touched,
+ * so its pages cost nothing. */
+
+typedef struct SharedMap {
+    Map        map;              /* read-only while refs > 0           */
+    atomic_int refs;
+} SharedMap;
+
+typedef struct MapCow {
+    SharedMap *shared;           /* NULL once privatised                */
+    Map       *own;              /* storage for the private copy        */
+    Map       *map;              /* what the game reads: shared or own  */
+} MapCow;
+
+/**  Copy src into sm with one reference (the caller's). */
+void map_share_init(SharedMap *sm, const Map *src);
+
+/**  Take another reference to sm.  Thread-safe. */
+void map_share_retain(SharedMap *sm);
+
+/**  Drop a reference.  Returns true when it was the last one and sm
+ *   may be reused or freed.  Thread-safe. */
+bool map_share_release(SharedMap *sm);
+
+/**  Point cow at sm (taking a reference); `own` stays untouched until
+ *   the first map_cow_write(). */
+void map_cow_init(MapCow *cow, SharedMap *sm, Map *own);
+
+/**  The map to edit: on first use copies the shared planes into own
+ *   and releases the shared reference.  Revisions carry over, so
+ *   derived data built from the shared map stays in sync. */
+Map *map_cow_write(MapCow *cow);
+
+/**  Release the shared reference, if still held. */
+void map_cow_release(MapCow *cow);
+
+/* ── Occupancy bits (derived) ─────────────────────────────────────── */
+/* One bit per cell, set when the tile is solid.  MAP_MAX_W is 64, so
+ * each map row packs into a single 64-bit word. */
+#define MAP_OCCUPANCY_VERSION 1  /* bump when the layout changes (cache) */
+
+typedef struct MapOccupancy {
+    uint64_t rows[MAP_MAX_H];    /* bit x of rows[y] = tiles[y][x] > 0  */
+    int      w, h;
+    uint32_t revision;           /* map revision these bits reflect     */
+} MapOccupancy;
+
+/**  Rebuild all occupancy bits from the tiles plane. */
+void map_occupancy_build(MapOccupancy *occ, const Map *map);
+
+/**  Bring occupancy up to date, touching only edited cells when possible. */
+void map_occupancy_sync(MapOccupancy *occ, const Map *map);
+
+/**  True for solid cells and out-of-bounds positions (like is_wall). */
+bool map_occupancy_solid(const MapOccupancy *occ, int x, int y);
+
+#endif /* MAP_EDIT_H */
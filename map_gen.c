@@ -0,0 +1,404 @@
+/*  map_gen.c  –  seeded procedural map generator
+ *  ─────────────────────────────────────────────
+ *  Produces deterministic corridor mazes, open caverns and sprite-dense
+ *  arenas up to MAP_MAX_W × MAP_MAX_H, either directly into a Map or as
+ *  the ASCII triplet consumed by map_load().  Intended for benchmarks and
+ *  differential tests that need large, realistic inputs on demand.
+ *  No SDL headers.  Pure C + math.
+ */
+#include "map_gen.h"
+#include "raycaster.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PI 3.14159265358979323846f
+
+#define GEN_WALL_TYPES    10     /* tile values 1..10 ('X'/digits)       */
+#define GEN_SPRITE_TYPES  4      /* sprite values 1..4                   */
+#define CAVE_FILL_PCT     45     /* initial wall density (percent)       */
+#define CAVE_SMOOTH_STEPS 4      /* cellular automaton iterations        */
+#define CAVE_SPRITE_PCT   3      /* floor cells carrying a sprite        */
+#define ARENA_SPRITE_PCT  25     /* floor cells carrying a sprite        */
+#define ARENA_PILLAR_STEP 4      /* pillar grid spacing (cells)          */
+
+/* ── Deterministic PRNG (xorshift32) ──────────────────────────────── */
+
+static uint32_t rng_next(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+static int rng_range(uint32_t *s, int n)
+{
+    return (int)(rng_next(s) % (uint32_t)n);
+}
+
+static uint16_t random_wall(uint32_t *s)
+{
+    return (uint16_t)(1 + rng_range(s, GEN_WALL_TYPES));
+}
+
+static uint16_t random_sprite(uint32_t *s)
+{
+    return (uint16_t)(1 + rng_range(s, GEN_SPRITE_TYPES));
+}
+
+/* ── Scratch ──────────────────────────────────────────────────────── */
+
+/** Working arrays for one map_gen() call.  It lives on the caller's
+ *  stack (about 36 KB), so concurrent calls do not share state. */
+typedef struct GenScratch {
+    int      cells[MAP_MAX_W * MAP_MAX_H];   /* BFS queue / maze stack  */
+    uint16_t next[MAP_MAX_H][MAP_MAX_W];     /* cavern smoothing step   */
+    int16_t  dist[MAP_MAX_H][MAP_MAX_W];     /* BFS distances           */
+    int8_t   keep[MAP_MAX_H][MAP_MAX_W];     /* cells already flooded   */
+} GenScratch;
+
+/* ── Helper: flood-fill distances over floor cells ────────────────── */
+
+/** BFS from (sx, sy) over floor cells into sc->dist, which gets -1 for
+ *  unreached cells.  Returns the number of cells reached and the
+ *  farthest one. */
+static int bfs_floor(const Map *map, int sx, int sy, GenScratch *sc,
+                     int *fx, int *fy)
+{
+    int     *queue = sc->cells;
+    int16_t (*dist)[MAP_MAX_W] = sc->dist;
+    static const int dx[4] = { 1, -1, 0, 0 };
+    static const int dy[4] = { 0, 0, 1, -1 };
+
+    for (int y = 0; y < MAP_MAX_H; y++)
+        for (int x = 0; x < MAP_MAX_W; x++)
+            dist[y][x] = -1;
+
+    int head = 0, tail = 0;
+    dist[sy][sx] = 0;
+    queue[tail++] = sy * MAP_MAX_W + sx;
+    *fx = sx;
+    *fy = sy;
+
+    while (head < tail) {
+        int cx = queue[head] % MAP_MAX_W;
+        int cy = queue[head] / MAP_MAX_W;
+        head++;
+        if (dist[cy][cx] > dist[*fy][*fx]) {
+            *fx = cx;
+            *fy = cy;
+        }
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + dx[d], ny = cy + dy[d];
+            if (nx < 0 || ny < 0 || nx >= map->w || ny >= map->h) continue;
+            if (map->tiles[ny][nx] != TILE_FLOOR || dist[ny][nx] >= 0) continue;
+            dist[ny][nx] = (int16_t)(dist[cy][cx] + 1);
+            queue[tail++] = ny * MAP_MAX_W + nx;
+        }
+    }
+    return tail;
+}
+
+/* ── Corridor maze (iterative recursive backtracker) ──────────────── */
+
+static void gen_maze(Map *map, uint32_t *rng, GenScratch *sc)
+{
+    int *stack = sc->cells;
+    static const int dx[4] = { 2, -2, 0, 0 };
+    static const int dy[4] = { 0, 0, 2, -2 };
+
+    for (int y = 0; y < map->h; y++)
+        for (int x = 0; x < map->w; x++)
+            map->tiles[y][x] = random_wall(rng);
+
+    int top = 0;
+    map->tiles[1][1] = TILE_FLOOR;
+    stack[top++] = 1 * MAP_MAX_W + 1;
+
+    while (top > 0) {
+        int cx = stack[top - 1] % MAP_MAX_W;
+        int cy = stack[top - 1] / MAP_MAX_W;
+
+        /* Collect unvisited cells two steps away */
+        int options[4], n = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + dx[d], ny = cy + dy[d];
+            if (nx < 1 || ny < 1 || nx > map->w - 2 || ny > map->h - 2) continue;
+            if (map->tiles[ny][nx] == TILE_FLOOR) continue;
+            options[n++] = d;
+        }
+        if (n == 0) {
+            top--;
+            continue;
+        }
+
+        int d = options[rng_range(rng, n)];
+        map->tiles[cy + dy[d] / 2][cx + dx[d] / 2] = TILE_FLOOR;
+        map->tiles[cy + dy[d]][cx + dx[d]]         = TILE_FLOOR;
+        stack[top++] = (cy + dy[d]) * MAP_MAX_W + (cx + dx[d]);
+    }
+
+    /* Sprites in dead ends */
+    for (int y = 1; y < map->h - 1; y++) {
+        for (int x = 1; x < map->w - 1; x++) {
+            if (map->tiles[y][x] != TILE_FLOOR) continue;
+            int open = (map->tiles[y][x + 1] == TILE_FLOOR)
+                     + (map->tiles[y][x - 1] == TILE_FLOOR)
+                     + (map->tiles[y + 1][x] == TILE_FLOOR)
+                     + (map->tiles[y - 1][x] == TILE_FLOOR);
+            if (open == 1 && rng_range(rng, 2) == 0)
+                map->sprites[y][x] = random_sprite(rng);
+        }
+    }
+}
+
+/* ── Open caverns (cellular automaton) ────────────────────────────── */
+
+static void gen_cavern(Map *map, uint32_t *rng, GenScratch *sc)
+{
+    uint16_t (*next)[MAP_MAX_W] = sc->next;
+    int16_t  (*dist)[MAP_MAX_W] = sc->dist;
+    int8_t   (*keep)[MAP_MAX_W] = sc->keep;
+
+    for (int y = 0; y < map->h; y++) {
+        for (int x = 0; x < map->w; x++) {
+            bool border = x == 0 || y == 0 || x == map->w - 1 || y == map->h - 1;
+            map->tiles[y][x] = (border || rng_range(rng, 100) < CAVE_FILL_PCT)
+                             ? 1 : TILE_FLOOR;
+        }
+    }
+
+    /* Smooth: a cell becomes wall when most of its 3×3 block is wall */
+    for (int step = 0; step < CAVE_SMOOTH_STEPS; step++) {
+        for (int y = 0; y < map->h; y++) {
+            for (int x = 0; x < map->w; x++) {
+                int walls = 0;
+                for (int oy = -1; oy <= 1; oy++) {
+                    for (int ox = -1; ox <= 1; ox++) {
+                        int nx = x + ox, ny = y + oy;
+                        if (nx < 0 || ny < 0 || nx >= map->w || ny >= map->h
+                            || map->tiles[ny][nx] != TILE_FLOOR)
+                            walls++;
+                    }
+                }
+                bool border = x == 0 || y == 0 || x == map->w - 1 || y == map->h - 1;
+                next[y][x] = (border || walls >= 5) ? 1 : TILE_FLOOR;
+            }
+        }
+        for (int y = 0; y < map->h; y++)
+            memcpy(map->tiles[y], next[y], (size_t)map->w * sizeof(uint16_t));
+    }
+
+    /* Keep only the largest connected cave */
+    memset(sc->keep, 0, sizeof(sc->keep));
+    int best = 0, best_x = -1, best_y = -1;
+    for (int y = 0; y < map->h; y++) {
+        for (int x = 0; x < map->w; x++) {
+            if (map->tiles[y][x] != TILE_FLOOR || keep[y][x]) continue;
+            int fx, fy;
+            int size = bfs_floor(map, x, y, sc, &fx, &fy);
+            for (int ry = 0; ry < map->h; ry++)
+                for (int rx = 0; rx < map->w; rx++)
+                    if (dist[ry][rx] >= 0) keep[ry][rx] = 1;
+            if (size > best) {
+                best = size;
+                best_x = x;
+                best_y = y;
+            }
+        }
+    }
+
+    /* Tiny maps may smooth away almost everything: carve a corridor */
+    if (best < 2) {
+        for (int x = 1; x < map->w - 1; x++)
+            map->tiles[map->h / 2][x] = TILE_FLOOR;
+        best_x = 1;
+        best_y = map->h / 2;
+    }
+
+    int fx, fy;
+    bfs_floor(map, best_x, best_y, sc, &fx, &fy);
+    for (int y = 0; y < map->h; y++) {
+        for (int x = 0; x < map->w; x++) {
+            if (map->tiles[y][x] != TILE_FLOOR) {
+                map->tiles[y][x] = random_wall(rng);
+            } else if (dist[y][x] < 0) {
+                map->tiles[y][x] = random_wall(rng);   /* isolated pocket */
+            } else if (rng_range(rng, 100) < CAVE_SPRITE_PCT) {
+                map->sprites[y][x] = random_sprite(rng);
+            }
+        }
+    }
+}
+
+/* ── Sprite-dense arena ───────────────────────────────────────────── */
+
+static void gen_arena(Map *map, uint32_t *rng)
+{
+    for (int y = 0; y < map->h; y++) {
+        for (int x = 0; x < map->w; x++) {
+            bool border = x == 0 || y == 0 || x == map->w - 1 || y == map->h - 1;
+            bool pillar = x % ARENA_PILLAR_STEP == 2 && y % ARENA_PILLAR_STEP == 2
+                          && x < map->w - 2 && y < map->h - 2;
+            if (border) {
+                map->tiles[y][x] = 1;
+            } else if (pillar && rng_range(rng, 4) != 0) {
+                map->tiles[y][x] = random_wall(rng);
+            } else {
+                map->tiles[y][x] = TILE_FLOOR;
+                if (rng_range(rng, 100) < ARENA_SPRITE_PCT)
+                    map->sprites[y][x] = random_sprite(rng);
+            }
+        }
+    }
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+bool map_gen(Map *map, Player *player, MapGenKind kind, int w, int h,
+             uint32_t seed)
+{
+    GenScratch sc;
+
+    if (w < MAP_GEN_MIN_SIZE || h < MAP_GEN_MIN_SIZE
+        || w > MAP_MAX_W || h > MAP_MAX_H) {
+        fprintf(stderr, "map_gen: unsupported size %dx%d\n", w, h);
+        return false;
+    }
+
+    memset(map, 0, sizeof(*map));
+    map->w = w;
+    map->h = h;
+
+    /* Mix the seed so that small seeds still diverge; never zero */
+    uint32_t rng = seed * 2654435761u ^ 0x9E3779B9u;
+    if (rng == 0) rng = 1;
+
+    switch (kind) {
+    case MAP_GEN_MAZE:   gen_maze(map, &rng, &sc);   break;
+    case MAP_GEN_CAVERN: gen_cavern(map, &rng, &sc); break;
+    case MAP_GEN_ARENA:  gen_arena(map, &rng);       break;
+    default:
+        fprintf(stderr, "map_gen: unknown kind %d\n", (int)kind);
+        return false;
+    }
+
+    /* Spawn: arena centre when open, otherwise the first floor cell */
+    int sx = -1, sy = -1;
+    if (kind == MAP_GEN_ARENA && map->tiles[h / 2][w / 2] == TILE_FLOOR) {
+        sx = w / 2;
+        sy = h / 2;
+    }
+    for (int y = 0; y < h && sx < 0; y++) {
+        for (int x = 0; x < w; x++) {
+            if (map->tiles[y][x] == TILE_FLOOR) {
+                sx = x;
+                sy = y;
+                break;
+            }
+        }
+    }
+
+    /* Endgame trigger on the floor cell farthest from the spawn */
+    int ex, ey;
+    bfs_floor(map, sx, sy, &sc, &ex, &ey);
+    map->info[sy][sx] = INFO_SPAWN_PLAYER_E;
+    map->info[ey][ex] = INFO_TRIGGER_ENDGAME;
+    map->sprites[sy][sx] = SPRITE_EMPTY;
+    map->sprites[ey][ex] = SPRITE_EMPTY;
+
+    /* Facing east, with FOV-derived camera plane (as map_load) */
+    float half_fov = (FOV_DEG * 0.5f) * (PI / 180.0f);
+    player->x       = sx + 0.5f;
+    player->y       = sy + 0.5f;
+    player->dir_x   = 1.0f;
+    player->dir_y   = 0.0f;
+    player->plane_x = 0.0f;
+    player->plane_y = tanf(half_fov);
+
+    return true;
+}
+
+bool map_gen_kind_from_name(const char *name, MapGenKind *kind)
+{
+    static const char *names[MAP_GEN_KIND_COUNT] = { "maze", "cavern", "arena" };
+    for (int k = 0; k < MAP_GEN_KIND_COUNT; k++) {
+        if (strcmp(name, names[k]) == 0) {
+            *kind = (MapGenKind)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ── ASCII output ──────────────────────────────────────────────────── */
+
+static char tile_char(uint16_t tile)
+{
+    if (tile == TILE_FLOOR) return ' ';
+    if (tile == 1)          return 'X';
+    return (char)('0' + (tile - 1) % 10);   /* tile N+1 = digit N */
+}
+
+static char info_char(const Map *map, int x, int y)
+{
+    switch (map->info[y][x]) {
+    case INFO_SPAWN_PLAYER_N:  return '^';
+    case INFO_SPAWN_PLAYER_E:  return '>';
+    case INFO_SPAWN_PLAYER_S:  return 'V';
+    case INFO_SPAWN_PLAYER_W:  return '<';
+    case INFO_TRIGGER_ENDGAME: return 'F';
+    case INFO_TRIGGER_TELEPORT: return 'T';
+    case INFO_TRIGGER_DAMAGE:  return 'H';
+    case INFO_TRIGGER_SWITCH:  return 'S';
+    case INFO_DOOR:            return 'D';
+    default: break;
+    }
+    /* Decorative X border, mirroring the tiles file */
+    bool border = x == 0 || y == 0 || x == map->w - 1 || y == map->h - 1;
+    return border ? 'X' : ' ';
+}
+
+static char sprite_char(uint16_t sprite)
+{
+    return (sprite >= 1 && sprite <= 9) ? (char)('0' + sprite) : ' ';
+}
+
+static bool write_plane(const Map *map, const char *path, int plane)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        fprintf(stderr, "map_gen_write_ascii: cannot open '%s'\n", path);
+        return false;
+    }
+
+    char line[MAP_MAX_W + 2];
+    bool ok = true;
+    for (int y = 0; y < map->h && ok; y++) {
+        for (int x = 0; x < map->w; x++) {
+            if (plane == 0)      line[x] = tile_char(map->tiles[y][x]);
+            else if (plane == 1) line[x] = info_char(map, x, y);
+            else                 line[x] = sprite_char(map->sprites[y][x]);
+        }
+        line[map->w]     = '\n';
+        line[map->w + 1] = '\0';
+        ok = fputs(line, fp) >= 0;
+    }
+
+    if (fclose(fp) != 0) ok = false;
+    if (!ok)
+        fprintf(stderr, "map_gen_write_ascii: write to '%s' failed\n", path);
+    return ok;
+}
+
+bool map_gen_write_ascii(const Map *map, const char *tiles_path,
+                         const char *sprites_path, const char *info_path)
+{
+    return write_plane(map, tiles_path, 0)
+        && write_plane(map, info_path, 1)
+        && write_plane(map, sprites_path, 2);
+}
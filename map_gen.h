@@ -0,0 +1,35 @@
+#ifndef MAP_GEN_H
+#define MAP_GEN_H
+
+#include "game_globals.h"
+
+#define MAP_GEN_MIN_SIZE 5       /* smallest map with spawn + trigger    */
+
+/* ── Generator kinds ──────────────────────────────────────────────── */
+typedef enum MapGenKind {
+    MAP_GEN_MAZE = 0,            /* one-cell corridors, perfect maze     */
+    MAP_GEN_CAVERN,              /* cellular-automaton open caves        */
+    MAP_GEN_ARENA,               /* open hall, pillars, dense sprites    */
+    MAP_GEN_KIND_COUNT
+} MapGenKind;
+
+/**  Generate a map of w × h cells (MAP_GEN_MIN_SIZE .. MAP_MAX_W/H)
+ *   from a seed.  Fills all three planes, places a player spawn and an
+ *   endgame trigger that is reachable from it, and sets the player pose
+ *   like map_load().
+ *   The same kind, size and seed always produce the same map.
+ *   Reentrant: all scratch lives on the caller's stack.
+ *   Returns false for an unsupported size or kind. */
+bool map_gen(Map *map, Player *player, MapGenKind kind, int w, int h,
+             uint32_t seed);
+
+/**  Look up a generator kind by name ("maze", "cavern", "arena").
+ *   Returns false if the name is unknown. */
+bool map_gen_kind_from_name(const char *name, MapGenKind *kind);
+
+/**  Write a map as the ASCII triplet read by map_load().
+ *   Returns false on I/O failure. */
+bool map_gen_write_ascii(const Map *map, const char *tiles_path,
+                         const char *sprites_path, const char *info_path);
+
+#endif /* MAP_GEN_H */
@@ -116,6 +116,14 @@ bool map_load(Map *map, Player *player, const char *tiles_path,
                 val = INFO_SPAWN_PLAYER_W;
             } else if (c == 'F' || c == 'f') {
                 val = INFO_TRIGGER_ENDGAME;
+            } else if (c == 'T') {
+                val = INFO_TRIGGER_TELEPORT;
+            } else if (c == 'H') {
+                val = INFO_TRIGGER_DAMAGE;
+            } else if (c == 'S') {
+                val = INFO_TRIGGER_SWITCH;
+            } else if (c == 'D') {
+                val = INFO_DOOR;
             }
 
             map->info[row][col] = val;
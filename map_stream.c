@@ -0,0 +1,399 @@
+/*  map_stream.c  –  chunked, background-streamed map backend
+ *  ─────────────────────────────────────────────────────────
+ *  Keeps only the chunks around the player resident in the Map planes.
+ *  A background I/O thread reads chunks from a chunked on-disk file into
+ *  staging slots; map_stream_update() commits them on the owning thread,
+ *  so the Map itself is never touched concurrently.  Non-resident chunks
+ *  hold TILE_UNLOADED, which rc_cast() and rc_update() treat as solid.
+ *
+ *  File layout (all integers little-endian):
+ *    0  "RCMC"                magic
+ *    4  u16 version           MAP_STREAM_VERSION
+ *    6  u16 chunk size        MAP_CHUNK_SIZE
+ *    8  u16 w, u16 h          map size in cells
+ *   12  6 × f32               spawn x, y, dir_x, dir_y, plane_x, plane_y
+ *   36  chunks, row-major; each is tiles, info, sprites planes of
+ *       MAP_CHUNK_SIZE² u16 cells (cells beyond w/h are zero)
+ */
+#include "map_stream.h"
+#include "map_edit.h"
+#include "memstat.h"
+#include "raycaster.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MAP_STREAM_VERSION  1
+#define HEADER_BYTES        36
+#define PREFETCH_RING       1    /* chunks beyond radius read ahead     */
+
+/* ── Little-endian helpers ─────────────────────────────────────────── */
+
+static void put_u16(uint8_t *b, uint16_t v)
+{
+    b[0] = (uint8_t)(v & 0xFF);
+    b[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get_u16(const uint8_t *b)
+{
+    return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+static void put_f32(uint8_t *b, float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    put_u16(b,     (uint16_t)(v & 0xFFFF));
+    put_u16(b + 2, (uint16_t)(v >> 16));
+}
+
+static float get_f32(const uint8_t *b)
+{
+    uint32_t v = (uint32_t)get_u16(b) | ((uint32_t)get_u16(b + 2) << 16);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+static int chebyshev(int ax, int ay, int bx, int by)
+{
+    int dx = ax > bx ? ax - bx : bx - ax;
+    int dy = ay > by ? ay - by : by - ay;
+    return dx > dy ? dx : dy;
+}
+
+/* ── Chunk I/O ─────────────────────────────────────────────────────── */
+
+static bool read_chunk(FILE *fp, int chunk, uint16_t out[3][MAP_CHUNK_CELLS])
+{
+    uint8_t buf[MAP_CHUNK_BYTES];
+    long off = HEADER_BYTES + (long)chunk * MAP_CHUNK_BYTES;
+    if (fseek(fp, off, SEEK_SET) != 0) return false;
+    if (fread(buf, 1, sizeof(buf), fp) != sizeof(buf)) return false;
+
+    for (int p = 0; p < 3; p++)
+        for (int i = 0; i < MAP_CHUNK_CELLS; i++)
+            out[p][i] = get_u16(&buf[(p * MAP_CHUNK_CELLS + i) * 2]);
+    return true;
+}
+
+/** Copy a chunk's planes into the Map (cells beyond w/h are skipped). */
+static void commit_chunk(const MapStream *ms, Map *map, int chunk,
+                         uint16_t data[3][MAP_CHUNK_CELLS])
+{
+    int x0 = (chunk % ms->chunks_x) * MAP_CHUNK_SIZE;
+    int y0 = (chunk / ms->chunks_x) * MAP_CHUNK_SIZE;
+
+    for (int r = 0; r < MAP_CHUNK_SIZE && y0 + r < map->h; r++) {
+        for (int c = 0; c < MAP_CHUNK_SIZE && x0 + c < map->w; c++) {
+            int i = r * MAP_CHUNK_SIZE + c;
+            map->tiles[y0 + r][x0 + c]   = data[0][i];
+            map->info[y0 + r][x0 + c]    = data[1][i];
+            map->sprites[y0 + r][x0 + c] = data[2][i];
+        }
+    }
+}
+
+/** Replace a chunk's cells with the solid TILE_UNLOADED filler. */
+static void blank_chunk(const MapStream *ms, Map *map, int chunk)
+{
+    int x0 = (chunk % ms->chunks_x) * MAP_CHUNK_SIZE;
+    int y0 = (chunk / ms->chunks_x) * MAP_CHUNK_SIZE;
+
+    for (int r = 0; r < MAP_CHUNK_SIZE && y0 + r < map->h; r++) {
+        for (int c = 0; c < MAP_CHUNK_SIZE && x0 + c < map->w; c++) {
+            map->tiles[y0 + r][x0 + c]   = TILE_UNLOADED;
+            map->info[y0 + r][x0 + c]    = INFO_EMPTY;
+            map->sprites[y0 + r][x0 + c] = SPRITE_EMPTY;
+        }
+    }
+}
+
+/* ── Background I/O thread ─────────────────────────────────────────── */
+
+static int io_thread(void *arg)
+{
+    MapStream *ms = arg;
+
+    mtx_lock(&ms->lock);
+    for (;;) {
+        while (!ms->quit && ms->queue_len == 0)
+            cnd_wait(&ms->wake, &ms->lock);
+        if (ms->quit) break;
+
+        int slot = ms->queue[ms->queue_head];
+        ms->queue_head = (ms->queue_head + 1) % MAP_STREAM_SLOTS;
+        ms->queue_len--;
+        int chunk = ms->slots[slot].chunk;
+        mtx_unlock(&ms->lock);
+
+        /* The slot's data is private to this thread until ready is set */
+        bool ok = read_chunk(ms->fp, chunk, ms->slots[slot].data);
+
+        mtx_lock(&ms->lock);
+        ms->slots[slot].ready  = true;
+        ms->slots[slot].failed = !ok;
+    }
+    mtx_unlock(&ms->lock);
+    return 0;
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+bool map_stream_write(const Map *map, const Player *spawn, const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "map_stream_write: cannot open '%s'\n", path);
+        return false;
+    }
+
+    uint8_t hdr[HEADER_BYTES];
+    memcpy(hdr, "RCMC", 4);
+    put_u16(hdr + 4,  MAP_STREAM_VERSION);
+    put_u16(hdr + 6,  MAP_CHUNK_SIZE);
+    put_u16(hdr + 8,  (uint16_t)map->w);
+    put_u16(hdr + 10, (uint16_t)map->h);
+    put_f32(hdr + 12, spawn->x);
+    put_f32(hdr + 16, spawn->y);
+    put_f32(hdr + 20, spawn->dir_x);
+    put_f32(hdr + 24, spawn->dir_y);
+    put_f32(hdr + 28, spawn->plane_x);
+    put_f32(hdr + 32, spawn->plane_y);
+    bool ok = fwrite(hdr, 1, sizeof(hdr), fp) == sizeof(hdr);
+
+    int cxn = (map->w + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE;
+    int cyn = (map->h + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE;
+
+    for (int cy = 0; cy < cyn && ok; cy++) {
+        for (int cx = 0; cx < cxn && ok; cx++) {
+            uint8_t buf[MAP_CHUNK_BYTES];
+            memset(buf, 0, sizeof(buf));
+
+            for (int r = 0; r < MAP_CHUNK_SIZE; r++) {
+                for (int c = 0; c < MAP_CHUNK_SIZE; c++) {
+                    int y = cy * MAP_CHUNK_SIZE + r;
+                    int x = cx * MAP_CHUNK_SIZE + c;
+                    if (x >= map->w || y >= map->h) continue;
+                    int i = r * MAP_CHUNK_SIZE + c;
+                    put_u16(&buf[i * 2], map->tiles[y][x]);
+                    put_u16(&buf[(MAP_CHUNK_CELLS + i) * 2], map->info[y][x]);
+                    put_u16(&buf[(2 * MAP_CHUNK_CELLS + i) * 2],
+                            map->sprites[y][x]);
+                }
+            }
+            ok = fwrite(buf, 1, sizeof(buf), fp) == sizeof(buf);
+        }
+    }
+
+    if (fclose(fp) != 0) ok = false;
+    if (!ok)
+        fprintf(stderr, "map_stream_write: write to '%s' failed\n", path);
+    return ok;
+}
+
+bool map_stream_open(MapStream *ms, Map *map, Player *player,
+                     const char *path, int radius, int budget_bytes)
+{
+    memset(ms, 0, sizeof(*ms));
+    memset(map, 0, sizeof(*map));
+
+    ms->fp = fopen(path, "rb");
+    if (!ms->fp) {
+        fprintf(stderr, "map_stream_open: cannot open '%s'\n", path);
+        return false;
+    }
+
+    uint8_t hdr[HEADER_BYTES];
+    if (fread(hdr, 1, sizeof(hdr), ms->fp) != sizeof(hdr)
+        || memcmp(hdr, "RCMC", 4) != 0
+        || get_u16(hdr + 4) != MAP_STREAM_VERSION
+        || get_u16(hdr + 6) != MAP_CHUNK_SIZE) {
+        fprintf(stderr, "map_stream_open: '%s' is not a chunked map\n", path);
+        fclose(ms->fp);
+        return false;
+    }
+
+    map->w = get_u16(hdr + 8);
+    map->h = get_u16(hdr + 10);
+    if (map->w <= 0 || map->h <= 0 || map->w > MAP_MAX_W || map->h > MAP_MAX_H) {
+        fprintf(stderr, "map_stream_open: bad map size %dx%d in '%s'\n",
+                map->w, map->h, path);
+        fclose(ms->fp);
+        return false;
+    }
+
+    player->x       = get_f32(hdr + 12);
+    player->y       = get_f32(hdr + 16);
+    player->dir_x   = get_f32(hdr + 20);
+    player->dir_y   = get_f32(hdr + 24);
+    player->plane_x = get_f32(hdr + 28);
+    player->plane_y = get_f32(hdr + 32);
+
+    ms->chunks_x = (map->w + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE;
+    ms->chunks_y = (map->h + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE;
+    ms->radius   = radius < 0 ? 0 : radius;
+
+    /* The keep-resident square must always fit in the budget */
+    int keep = (2 * ms->radius + 1) * (2 * ms->radius + 1);
+    ms->max_resident = budget_bytes / MAP_CHUNK_BYTES;
+    if (ms->max_resident < keep) ms->max_resident = keep;
+
+    for (int i = 0; i < MAP_STREAM_SLOTS; i++)
+        ms->slots[i].chunk = -1;
+    for (int i = 0; i < ms->chunks_x * ms->chunks_y; i++)
+        blank_chunk(ms, map, i);
+
+    /* Synchronously load the chunks around the spawn so the first frame
+     * never shows filler where the player is standing. */
+    int pcx = (int)player->x / MAP_CHUNK_SIZE;
+    int pcy = (int)player->y / MAP_CHUNK_SIZE;
+    for (int cy = 0; cy < ms->chunks_y; cy++) {
+        for (int cx = 0; cx < ms->chunks_x; cx++) {
+            if (chebyshev(cx, cy, pcx, pcy) > ms->radius) continue;
+            int chunk = cy * ms->chunks_x + cx;
+            if (!read_chunk(ms->fp, chunk, ms->slots[0].data)) {
+                fprintf(stderr, "map_stream_open: truncated chunk %d in '%s'\n",
+                        chunk, path);
+                fclose(ms->fp);
+                return false;
+            }
+            commit_chunk(ms, map, chunk, ms->slots[0].data);
+            ms->state[chunk] = CHUNK_RESIDENT;
+            ms->resident_count++;
+        }
+    }
+
+    /* Undo exactly what was set up before a failure */
+    bool locked = mtx_init(&ms->lock, mtx_plain) == thrd_success;
+    bool waits  = locked && cnd_init(&ms->wake) == thrd_success;
+    if (!waits || thrd_create(&ms->thread, io_thread, ms) != thrd_success) {
+        fprintf(stderr, "map_stream_open: cannot start I/O thread\n");
+        if (waits)  cnd_destroy(&ms->wake);
+        if (locked) mtx_destroy(&ms->lock);
+        fclose(ms->fp);
+        return false;
+    }
+    mem_account(MEM_MAP, sizeof(*ms));
+    return true;
+}
+
+void map_stream_update(MapStream *ms, Map *map, const Player *player)
+{
+    int n   = ms->chunks_x * ms->chunks_y;
+    int pcx = (int)player->x / MAP_CHUNK_SIZE;
+    int pcy = (int)player->y / MAP_CHUNK_SIZE;
+    ms->tick++;
+
+    mtx_lock(&ms->lock);
+
+    /* ── Commit finished reads ────────────────────────────────────── */
+    bool changed = false;
+    int  pending = 0;
+    for (int s = 0; s < MAP_STREAM_SLOTS; s++) {
+        ChunkSlot *slot = &ms->slots[s];
+        if (slot->chunk < 0) continue;
+        if (!slot->ready) {
+            pending++;
+            continue;
+        }
+        if (slot->failed) {
+            fprintf(stderr, "map_stream_update: cannot read chunk %d\n",
+                    slot->chunk);
+            ms->state[slot->chunk] = CHUNK_ABSENT;
+        } else {
+            commit_chunk(ms, map, slot->chunk, slot->data);
+            ms->state[slot->chunk] = CHUNK_RESIDENT;
+            ms->last_used[slot->chunk] = ms->tick;
+            ms->resident_count++;
+            changed = true;
+        }
+        slot->chunk = -1;
+        slot->ready = false;
+    }
+
+    /* ── Touch and request chunks, nearest ring first ─────────────── */
+    for (int d = 0; d <= ms->radius + PREFETCH_RING; d++) {
+        for (int cy = pcy - d; cy <= pcy + d; cy++) {
+            for (int cx = pcx - d; cx <= pcx + d; cx++) {
+                if (cx < 0 || cy < 0 || cx >= ms->chunks_x || cy >= ms->chunks_y)
+                    continue;
+                if (chebyshev(cx, cy, pcx, pcy) != d) continue;
+
+                int chunk = cy * ms->chunks_x + cx;
+                if (ms->state[chunk] == CHUNK_RESIDENT) {
+                    ms->last_used[chunk] = ms->tick;
+                    continue;
+                }
+                if (ms->state[chunk] != CHUNK_ABSENT) continue;
+
+                /* Prefetch ring only reads ahead while under budget */
+                if (d > ms->radius
+                    && ms->resident_count + pending >= ms->max_resident)
+                    continue;
+
+                int free_slot = -1;
+                for (int s = 0; s < MAP_STREAM_SLOTS; s++) {
+                    if (ms->slots[s].chunk < 0) { free_slot = s; break; }
+                }
+                if (free_slot < 0) continue;
+
+                ms->slots[free_slot].chunk  = chunk;
+                ms->slots[free_slot].ready  = false;
+                ms->slots[free_slot].failed = false;
+                int tail = (ms->queue_head + ms->queue_len) % MAP_STREAM_SLOTS;
+                ms->queue[tail] = free_slot;
+                ms->queue_len++;
+                ms->state[chunk] = CHUNK_PENDING;
+                pending++;
+            }
+        }
+    }
+
+    cnd_signal(&ms->wake);
+    mtx_unlock(&ms->lock);
+
+    /* ── Evict least-recently-used chunks outside the keep radius ─── */
+    while (ms->resident_count > ms->max_resident) {
+        int victim = -1;
+        for (int i = 0; i < n; i++) {
+            if (ms->state[i] != CHUNK_RESIDENT) continue;
+            if (chebyshev(i % ms->chunks_x, i / ms->chunks_x, pcx, pcy)
+                <= ms->radius) continue;
+            if (victim < 0 || ms->last_used[i] < ms->last_used[victim])
+                victim = i;
+        }
+        if (victim < 0) break;
+
+        blank_chunk(ms, map, victim);
+        ms->state[victim] = CHUNK_ABSENT;
+        ms->resident_count--;
+        changed = true;
+    }
+
+    /* Whole chunks changed: derived structures rebuild on next sync */
+    if (changed) map_invalidate(map);
+}
+
+bool map_stream_is_resident(const MapStream *ms, int x, int y)
+{
+    int cx = x / MAP_CHUNK_SIZE;
+    int cy = y / MAP_CHUNK_SIZE;
+    if (x < 0 || y < 0 || cx >= ms->chunks_x || cy >= ms->chunks_y) return false;
+    return ms->state[cy * ms->chunks_x + cx] == CHUNK_RESIDENT;
+}
+
+void map_stream_close(MapStream *ms)
+{
+    mtx_lock(&ms->lock);
+    ms->quit = true;
+    cnd_signal(&ms->wake);
+    mtx_unlock(&ms->lock);
+
+    thrd_join(ms->thread, NULL);
+    cnd_destroy(&ms->wake);
+    mtx_destroy(&ms->lock);
+    fclose(ms->fp);
+    mem_release(MEM_MAP, sizeof(*ms));
+}
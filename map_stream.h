@@ -0,0 +1,77 @@
+#ifndef MAP_STREAM_H
+#define MAP_STREAM_H
+
+#include "game_globals.h"
+
+#include <stdio.h>
+#include <threads.h>
+
+/* ── Chunked map constants ────────────────────────────────────────── */
+#define MAP_CHUNK_SIZE   16      /* width & height of one chunk (cells)  */
+#define MAP_CHUNKS_X     (MAP_MAX_W / MAP_CHUNK_SIZE)
+#define MAP_CHUNKS_Y     (MAP_MAX_H / MAP_CHUNK_SIZE)
+#define MAP_CHUNK_CELLS  (MAP_CHUNK_SIZE * MAP_CHUNK_SIZE)
+#define MAP_CHUNK_BYTES  (3 * MAP_CHUNK_CELLS * (int)sizeof(uint16_t))
+#define MAP_STREAM_SLOTS 8       /* in-flight chunk loads (staging)      */
+
+/* ── Per-chunk residency state ────────────────────────────────────── */
+typedef enum ChunkState {
+    CHUNK_ABSENT = 0,            /* planes hold the TILE_UNLOADED filler */
+    CHUNK_PENDING,               /* queued on / being read by I/O thread */
+    CHUNK_RESIDENT               /* real planes copied into the Map      */
+} ChunkState;
+
+/* ── Staging slot filled by the I/O thread ────────────────────────── */
+typedef struct ChunkSlot {
+    int      chunk;              /* chunk index, -1 when slot is free    */
+    bool     ready;              /* data[] holds the chunk's planes      */
+    bool     failed;             /* read error – chunk stays absent      */
+    uint16_t data[3][MAP_CHUNK_CELLS]; /* tiles, info, sprites         */
+} ChunkSlot;
+
+/* ── Streaming map backend ────────────────────────────────────────── */
+typedef struct MapStream {
+    FILE      *fp;               /* owned by the I/O thread once started */
+    int        chunks_x, chunks_y;
+    int        radius;           /* keep-resident radius (chunks)        */
+    int        max_resident;     /* LRU budget (chunks)                  */
+    int        resident_count;
+    uint32_t   tick;             /* LRU clock, bumped per update         */
+    ChunkState state[MAP_CHUNKS_Y * MAP_CHUNKS_X];
+    uint32_t   last_used[MAP_CHUNKS_Y * MAP_CHUNKS_X];
+
+    /* Shared with the I/O thread – guarded by lock */
+    mtx_t      lock;
+    cnd_t      wake;
+    thrd_t     thread;
+    bool       quit;
+    int        queue[MAP_STREAM_SLOTS];  /* slot indices awaiting read  */
+    int        queue_head, queue_len;
+    ChunkSlot  slots[MAP_STREAM_SLOTS];
+} MapStream;
+
+/**  Write a loaded map to the chunked on-disk format, together with the
+ *   player spawn pose.  Returns false on I/O failure. */
+bool map_stream_write(const Map *map, const Player *spawn, const char *path);
+
+/**  Open a chunked map.  Sets map->w/h, fills every cell with the
+ *   TILE_UNLOADED filler, loads the chunks within radius of the spawn
+ *   synchronously, then starts the background I/O thread.
+ *   budget_bytes caps resident chunk data (LRU eviction beyond it).
+ *   Returns false on failure. */
+bool map_stream_open(MapStream *ms, Map *map, Player *player,
+                     const char *path, int radius, int budget_bytes);
+
+/**  Per-frame pump: commits chunks the I/O thread has finished reading,
+ *   prefetches chunks around the player and evicts least-recently-used
+ *   chunks beyond the budget.  Must be called from the thread that owns
+ *   the Map (the same one that calls rc_update / rc_cast). */
+void map_stream_update(MapStream *ms, Map *map, const Player *player);
+
+/**  True if the chunk containing map cell (x, y) is resident. */
+bool map_stream_is_resident(const MapStream *ms, int x, int y);
+
+/**  Stop the I/O thread and close the file. */
+void map_stream_close(MapStream *ms);
+
+#endif /* MAP_STREAM_H */
@@ -0,0 +1,101 @@
+/*  memstat.c  –  per-subsystem memory accounting
+ *  ─────────────────────────────────────────────────────────────────
+ *  Nearly all storage here is static or caller-owned, so the linker
+ *  map says what is reserved but not what a given run uses.  Subsystems
+ *  report what they hold as they start and stop, and the totals can be
+ *  printed at exit or on SIGUSR1 from outside the process.
+ *  No SDL headers.  C11 atomics, POSIX sigaction().
+ */
+#define _POSIX_C_SOURCE 200809L  /* sigaction() */
+
+#include "memstat.h"
+
+#include <signal.h>
+#include <stdatomic.h>
+#include <string.h>
+
+static atomic_size_t held[MEM_TAG_COUNT];
+static atomic_size_t peak[MEM_TAG_COUNT];
+static atomic_size_t total;
+static atomic_size_t total_peak;
+
+static volatile sig_atomic_t report_flag;
+
+static const char *const names[MEM_TAG_COUNT] = {
+    [MEM_MAP]      = "map",
+    [MEM_DERIVED]  = "derived",
+    [MEM_ENTITIES] = "entities",
+    [MEM_SIM]      = "sim",
+    [MEM_VIEW]     = "view",
+    [MEM_ATLAS]    = "atlas",
+    [MEM_TEXTURE]  = "texture",
+    [MEM_FRAMES]   = "frames",
+    [MEM_SCRATCH]  = "scratch",
+};
+
+static void raise_peak(atomic_size_t *p, size_t now)
+{
+    size_t seen = atomic_load_explicit(p, memory_order_relaxed);
+    while (now > seen && !atomic_compare_exchange_weak(p, &seen, now)) { }
+}
+
+void mem_account(MemTag tag, size_t bytes)
+{
+    raise_peak(&peak[tag], atomic_fetch_add(&held[tag], bytes) + bytes);
+    raise_peak(&total_peak, atomic_fetch_add(&total, bytes) + bytes);
+}
+
+void mem_release(MemTag tag, size_t bytes)
+{
+    atomic_fetch_sub(&held[tag], bytes);
+    atomic_fetch_sub(&total, bytes);
+}
+
+size_t mem_bytes(MemTag tag)      { return atomic_load(&held[tag]); }
+size_t mem_peak(MemTag tag)       { return atomic_load(&peak[tag]); }
+size_t mem_total(void)            { return atomic_load(&total); }
+size_t mem_total_peak(void)       { return atomic_load(&total_peak); }
+const char *mem_tag_name(MemTag tag) { return names[tag]; }
+
+void mem_report(FILE *out)
+{
+    fprintf(out, "memory: %zu KB held, peak %zu KB\n",
+            (mem_total() + 1023) / 1024, (mem_total_peak() + 1023) / 1024);
+    for (int t = 0; t < MEM_TAG_COUNT; t++) {
+        if (mem_peak((MemTag)t) == 0) continue;
+        fprintf(out, "  %-9s %8zu KB  (peak %zu KB)\n", names[t],
+                (mem_bytes((MemTag)t) + 1023) / 1024,
+                (mem_peak((MemTag)t) + 1023) / 1024);
+    }
+}
+
+/* ── Report on request ─────────────────────────────────────────────── */
+
+#ifdef SIGUSR1
+static void on_signal(int sig)
+{
+    (void)sig;
+    report_flag = 1;
+}
+#endif
+
+void mem_watch_signal(void)
+{
+#ifdef SIGUSR1
+    /* sigaction(), not signal(): under -std=c11 glibc's signal() resets
+     * the handler after one delivery, so a second SIGUSR1 would kill us */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sa.sa_flags   = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+#endif
+}
+
+bool mem_report_requested(void)
+{
+    if (!report_flag) return false;
+    report_flag = 0;
+    return true;
+}
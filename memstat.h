@@ -0,0 +1,52 @@
+#ifndef MEMSTAT_H
+#define MEMSTAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* ── Memory accounting ────────────────────────────────────────────── */
+/* Each subsystem reports the storage it holds while it is running:
+ * static and caller-owned structs when they are put to use, and any
+ * future heap blocks when they are allocated.  Totals are kept per tag
+ * with a peak, so a budget for one more instance can be read off. */
+typedef enum MemTag {
+    MEM_MAP,                     /* map planes, snapshots, stream slots */
+    MEM_DERIVED,                 /* occupancy, triggers, paths, flows   */
+    MEM_ENTITIES,                /* entity pools and their history      */
+    MEM_SIM,                     /* worlds, snapshots (minus the above) */
+    MEM_VIEW,                    /* GameState, ray hits, sensor rays    */
+    MEM_ATLAS,                   /* CPU-side texture atlas              */
+    MEM_TEXTURE,                 /* SDL streaming texture (estimate)    */
+    MEM_FRAMES,                  /* export ring, capture, server, env   */
+    MEM_SCRATCH,                 /* frame arenas, job deques            */
+    MEM_TAG_COUNT
+} MemTag;
+
+/**  Record `bytes` more held under `tag`.  Thread-safe. */
+void mem_account(MemTag tag, size_t bytes);
+
+/**  Record `bytes` under `tag` given back.  Thread-safe. */
+void mem_release(MemTag tag, size_t bytes);
+
+/**  Bytes held under `tag` now, and the most it ever held. */
+size_t mem_bytes(MemTag tag);
+size_t mem_peak(MemTag tag);
+
+/**  Bytes held under all tags now, and the most held at once. */
+size_t mem_total(void);
+size_t mem_total_peak(void);
+
+/**  Short lower-case name of `tag`, as printed by mem_report(). */
+const char *mem_tag_name(MemTag tag);
+
+/**  One line per non-empty tag and a total, in KB. */
+void mem_report(FILE *out);
+
+/**  Ask for a report on SIGUSR1 (where the platform has it). */
+void mem_watch_signal(void);
+
+/**  True once after each SIGUSR1; the main loop then calls mem_report(). */
+bool mem_report_requested(void);
+
+#endif /* MEMSTAT_H */
@@ -0,0 +1,98 @@
+/*  pace.c  –  frame-rate cap with low-jitter waits
+ *  ─────────────────────────────────────────────────────────────────
+ *  Without vsync the render loop would draw as fast as it can.  A pacer
+ *  holds it to a fixed frame period: a coarse OS sleep covers most of
+ *  the wait and a short spin covers the end, where the OS timer is too
+ *  coarse to hit the deadline on its own.  Every wake is measured so
+ *  the pacing error can be reported.
+ *  No SDL headers.  C11 threads for sleeping, the POSIX monotonic
+ *  clock for deadlines.
+ */
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime(CLOCK_MONOTONIC) */
+
+#include "pace.h"
+
+#include <threads.h>
+#include <time.h>
+
+double pace_clock(void)
+{
+    /* Monotonic: a wall-clock step must not stretch or skip a wait */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void sleep_for(double secs)
+{
+    struct timespec ts = {
+        .tv_sec  = (time_t)secs,
+        .tv_nsec = (long)((secs - (double)(time_t)secs) * 1e9),
+    };
+    thrd_sleep(&ts, NULL);
+}
+
+void pace_init(Pacer *p, int fps)
+{
+    p->period    = fps > 0 ? 1.0 / fps : 0.0;
+    p->deadline  = pace_clock();
+    p->spin_tail = PACE_SPIN_MAX;
+    p->frames    = 0;
+    p->err_sum   = 0.0;
+    p->err_max   = 0.0;
+}
+
+double pace_wait(Pacer *p)
+{
+    if (p->period <= 0.0) return 0.0;
+
+    p->deadline += p->period;
+    double now = pace_clock();
+    if (now > p->deadline + p->period) {
+        /* Stalled: count the late frame, then restart the grid */
+        double err = now - p->deadline;
+        p->err_sum += err;
+        if (err > p->err_max) p->err_max = err;
+        p->frames++;
+        p->deadline = now;
+        return err;
+    }
+
+    /* Coarse sleep, then learn how far the OS overshot */
+    double sleep_until = p->deadline - p->spin_tail;
+    if (now < sleep_until) {
+        sleep_for(sleep_until - now);
+        double over = pace_clock() - sleep_until;
+        if (over > p->spin_tail)
+            p->spin_tail = over * 1.25 < PACE_SPIN_MAX ? over * 1.25 : PACE_SPIN_MAX;
+        else if (p->spin_tail * 0.99 > PACE_SPIN_MIN)
+            p->spin_tail *= 0.99;
+    }
+
+    /* Spin tail */
+    while ((now = pace_clock()) < p->deadline)
+        ;
+
+    double err  = now - p->deadline;
+    double mag  = err < 0.0 ? -err : err;
+    p->err_sum += mag;
+    if (mag > p->err_max) p->err_max = mag;
+    p->frames++;
+    return err;
+}
+
+void pace_restart(Pacer *p)
+{
+    p->deadline = pace_clock();   /* the next frame gets a full period */
+}
+
+int pace_take_stats(Pacer *p, double *mean_err, double *max_err)
+{
+    int n = p->frames;
+    *mean_err  = n > 0 ? p->err_sum / n : 0.0;
+    *max_err   = p->err_max;
+    p->frames  = 0;
+    p->err_sum = 0.0;
+    p->err_max = 0.0;
+    return n;
+}
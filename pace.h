@@ -0,0 +1,45 @@
+#ifndef PACE_H
+#define PACE_H
+
+#include "game_globals.h"
+
+/* ── Frame pacing ─────────────────────────────────────────────────── */
+#define PACE_SPIN_MIN    0.0005  /* shortest spin tail before a deadline*/
+#define PACE_SPIN_MAX    0.004   /* longest spin tail (seconds)         */
+#define PACE_REPORT_S    5.0     /* seconds between pacing reports      */
+
+/* Frames start on a fixed grid of deadlines.  Each wait sleeps on the OS
+ * timer until shortly before the deadline and busy-waits the rest (the
+ * spin tail).  The tail grows to cover the worst oversleep seen and
+ * slowly shrinks again, so the CPU spins only as long as the OS needs. */
+typedef struct Pacer {
+    double period;               /* seconds per frame, 0 = uncapped     */
+    double deadline;             /* start time of the next frame        */
+    double spin_tail;            /* current busy-wait stretch (seconds) */
+    int    frames;               /* paced frames since the last report  */
+    double err_sum;              /* summed |wake - deadline| (seconds)  */
+    double err_max;              /* worst |wake - deadline| (seconds)   */
+} Pacer;
+
+/**  Cap at fps frames per second; fps <= 0 leaves frames uncapped. */
+void pace_init(Pacer *p, int fps);
+
+/**  Wait until the next frame may start and return the pacing error of
+ *   this wake in seconds (positive = late).  Uncapped pacers return 0
+ *   at once.  After a stall longer than a frame the late frame is
+ *   counted and the grid restarts from now instead of rushing frames
+ *   to catch up. */
+double pace_wait(Pacer *p);
+
+/**  Restart the grid from now, so the frame drawn after a deliberate
+ *   pause (an idle wait) gets a full period and is not counted late. */
+void pace_restart(Pacer *p);
+
+/**  Mean and worst pacing error in seconds since the last call, and
+ *   the number of frames they cover; then start a new interval. */
+int pace_take_stats(Pacer *p, double *mean_err, double *max_err);
+
+/**  Monotonic clock used for deadlines (seconds, arbitrary origin). */
+double pace_clock(void);
+
+#endif /* PACE_H */
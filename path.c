@@ -0,0 +1,396 @@
+/*  path.c  –  jump point search over precomputed jump tables (JPS+)
+ *  ─────────────────────────────────────────────────────────────────
+ *  path_build() records, for every open cell and each of the eight
+ *  directions, how far a straight or diagonal run goes before it meets
+ *  a jump point or a wall.  A search then expands only jump points and
+ *  crosses any open stretch in one table read, instead of pushing every
+ *  cell of the run through the open list as plain A* does.
+ *  Tile edits made through map_set_tile() are replayed by path_sync(),
+ *  which recomputes only the lines of the table they can affect.
+ *  No SDL headers.  Batch queries run on the job pool.
+ */
+#include "path.h"
+#include "jobs.h"
+#include "map_edit.h"
+#include "raycaster.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(MAP_MAX_W <= 64, "open rows must fit in 64 bits");
+
+/* Direction d steps by (DX[d], DY[d]); odd directions are diagonal */
+static const int DX[PATH_DIRS] = {  0,  1, 1, 1, 0, -1, -1, -1 };
+static const int DY[PATH_DIRS] = { -1, -1, 0, 1, 1,  1,  0, -1 };
+
+enum { DIR_N, DIR_NE, DIR_E, DIR_SE, DIR_S, DIR_SW, DIR_W, DIR_NW };
+
+#define CELLS  (MAP_MAX_W * MAP_MAX_H)
+#define LINES  (MAP_MAX_W + MAP_MAX_H + 2) /* one spare either side */
+
+/* ── Table helpers ─────────────────────────────────────────────────── */
+
+static bool in_table(const JumpTable *jt, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < jt->w && y < jt->h;
+}
+
+bool path_open(const JumpTable *jt, int x, int y)
+{
+    return in_table(jt, x, y) && (jt->open[y] >> x & 1u);
+}
+
+static void set_open(JumpTable *jt, const Map *map, int x, int y)
+{
+    uint64_t bit = (uint64_t)1 << x;
+    if (map->tiles[y][x] > TILE_FLOOR)
+        jt->open[y] &= ~bit;
+    else
+        jt->open[y] |= bit;
+}
+
+/** A straight run along d stops at (x, y) when a cell beside it opens
+ *  up that was walled off beside the previous cell. */
+static bool forced(const JumpTable *jt, int x, int y, int d)
+{
+    int dx = DX[d], dy = DY[d];
+    return (path_open(jt, x - dy, y + dx) && !path_open(jt, x - dx - dy, y - dy + dx))
+        || (path_open(jt, x + dy, y - dx) && !path_open(jt, x - dx + dy, y - dy - dx));
+}
+
+/** One step along d, with no squeezing between two diagonal walls. */
+static bool can_step(const JumpTable *jt, int x, int y, int d)
+{
+    int nx = x + DX[d], ny = y + DY[d];
+    if (!path_open(jt, nx, ny)) return false;
+    if (d & 1) return path_open(jt, nx, y) && path_open(jt, x, ny);
+    return true;
+}
+
+/** Jump distance of one cell, from the cell ahead of it along d.  A
+ *  diagonal run stops where either of its straight components would
+ *  reach a jump point. */
+static int16_t cell_dist(const JumpTable *jt, int x, int y, int d)
+{
+    if (!path_open(jt, x, y) || !can_step(jt, x, y, d)) return 0;
+
+    int nx = x + DX[d], ny = y + DY[d];
+    const int16_t *ahead = jt->dist[ny][nx];
+    bool stop = (d & 1) ? ahead[(d + 7) % PATH_DIRS] > 0
+                          || ahead[(d + 1) % PATH_DIRS] > 0
+                        : forced(jt, nx, ny, d);
+    if (stop) return 1;
+    return (int16_t)(ahead[d] > 0 ? ahead[d] + 1 : ahead[d] - 1);
+}
+
+/* ── Incremental bookkeeping ───────────────────────────────────────── */
+
+typedef struct Dirty {
+    bool row[MAP_MAX_H];         /* E/W runs to recompute               */
+    bool col[MAP_MAX_W];         /* N/S runs                            */
+    bool anti[LINES];            /* NE/SW runs, indexed by x + y        */
+    bool diag[LINES];            /* SE/NW runs, by x - y + MAP_MAX_H    */
+} Dirty;
+
+static void mark_lines(Dirty *dt, int x, int y)
+{
+    dt->anti[x + y + 1] = true;  /* +1: neighbours may sit at x = -1    */
+    dt->diag[x - y + MAP_MAX_H] = true;
+}
+
+/** Recompute direction d along the whole line through (x, y), from the
+ *  far end back, so each cell reads an up-to-date cell ahead.  Changed
+ *  straight values dirty the diagonals that read them. */
+static void fill_line(JumpTable *jt, int x, int y, int d, Dirty *dt)
+{
+    int dx = DX[d], dy = DY[d];
+    while (in_table(jt, x + dx, y + dy)) {
+        x += dx;
+        y += dy;
+    }
+    for (; in_table(jt, x, y); x -= dx, y -= dy) {
+        int16_t v = cell_dist(jt, x, y, d);
+        if (dt && v != jt->dist[y][x][d]) mark_lines(dt, x, y);
+        jt->dist[y][x][d] = v;
+    }
+}
+
+static void fill_diagonals(JumpTable *jt, const Dirty *dt)
+{
+    for (int k = 0; k < jt->w + jt->h - 1; k++) {
+        if (!dt || dt->anti[k + 1]) {
+            int x = k < jt->w ? k : jt->w - 1;
+            fill_line(jt, x, k - x, DIR_NE, NULL);
+            fill_line(jt, x, k - x, DIR_SW, NULL);
+        }
+        if (!dt || dt->diag[k + MAP_MAX_H - (jt->h - 1)]) {
+            int x = k > jt->h - 1 ? k - (jt->h - 1) : 0;
+            int y = x - (k - (jt->h - 1));
+            fill_line(jt, x, y, DIR_SE, NULL);
+            fill_line(jt, x, y, DIR_NW, NULL);
+        }
+    }
+}
+
+/* ── Build and sync ────────────────────────────────────────────────── */
+
+void path_build(JumpTable *jt, const Map *map)
+{
+    memset(jt, 0, sizeof(*jt));
+    jt->w = map->w;
+    jt->h = map->h;
+    for (int y = 0; y < map->h; y++)
+        for (int x = 0; x < map->w; x++)
+            set_open(jt, map, x, y);
+
+    /* Straight runs first: the diagonals read them */
+    for (int y = 0; y < jt->h; y++) {
+        fill_line(jt, 0, y, DIR_E, NULL);
+        fill_line(jt, 0, y, DIR_W, NULL);
+    }
+    for (int x = 0; x < jt->w; x++) {
+        fill_line(jt, x, 0, DIR_N, NULL);
+        fill_line(jt, x, 0, DIR_S, NULL);
+    }
+    fill_diagonals(jt, NULL);
+    jt->revision = map->revision;
+}
+
+void path_sync(JumpTable *jt, const Map *map)
+{
+    if (jt->revision == map->revision) return;
+
+    if (!map_changes_available(map, jt->revision)
+        || jt->w != map->w || jt->h != map->h) {
+        path_build(jt, map);
+        return;
+    }
+
+    /* A cell that opens or closes can change the forced neighbours of
+     * the rows and columns beside it, and the diagonal steps of the
+     * cells around it */
+    Dirty dt;
+    memset(&dt, 0, sizeof(dt));
+    bool any = false;
+    for (uint32_t r = jt->revision + 1; r <= map->revision; r++) {
+        MapChange c = map_change_at(map, r);
+        bool was_open = path_open(jt, c.x, c.y);
+        set_open(jt, map, c.x, c.y);
+        if (path_open(jt, c.x, c.y) == was_open) continue;
+
+        any = true;
+        for (int i = -1; i <= 1; i++) {
+            if (c.y + i >= 0 && c.y + i < jt->h) dt.row[c.y + i] = true;
+            if (c.x + i >= 0 && c.x + i < jt->w) dt.col[c.x + i] = true;
+        }
+        mark_lines(&dt, c.x, c.y);
+        mark_lines(&dt, c.x - 1, c.y);
+        mark_lines(&dt, c.x + 1, c.y);
+        mark_lines(&dt, c.x, c.y - 1);
+        mark_lines(&dt, c.x, c.y + 1);
+    }
+
+    if (any) {
+        for (int y = 0; y < jt->h; y++)
+            if (dt.row[y]) {
+                fill_line(jt, 0, y, DIR_E, &dt);
+                fill_line(jt, 0, y, DIR_W, &dt);
+            }
+        for (int x = 0; x < jt->w; x++)
+            if (dt.col[x]) {
+                fill_line(jt, x, 0, DIR_N, &dt);
+                fill_line(jt, x, 0, DIR_S, &dt);
+            }
+        fill_diagonals(jt, &dt);
+    }
+    jt->revision = map->revision;
+}
+
+/* ── Search ────────────────────────────────────────────────────────── */
+
+typedef struct Search {
+    uint32_t g[CELLS];           /* best cost so far, UINT32_MAX = none */
+    uint32_t f[CELLS];           /* g + heuristic                       */
+    uint16_t parent[CELLS];
+    uint8_t  arrived[CELLS];     /* direction of arrival, PATH_DIRS for */
+                                 /* the start                           */
+    uint8_t  closed[CELLS];
+    int16_t  pos[CELLS];         /* index in heap, -1 = not queued      */
+    uint16_t heap[CELLS];        /* binary min-heap on f                */
+    int      heap_n;
+} Search;
+
+static uint32_t octile(int dx, int dy)
+{
+    dx = abs(dx);
+    dy = abs(dy);
+    int lo = dx < dy ? dx : dy;
+    int hi = dx < dy ? dy : dx;
+    return (uint32_t)(lo * PATH_COST_DIAGONAL + (hi - lo) * PATH_COST_STRAIGHT);
+}
+
+static void heap_swap(Search *s, int a, int b)
+{
+    uint16_t t = s->heap[a];
+    s->heap[a] = s->heap[b];
+    s->heap[b] = t;
+    s->pos[s->heap[a]] = (int16_t)a;
+    s->pos[s->heap[b]] = (int16_t)b;
+}
+
+static void heap_up(Search *s, int i)
+{
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (s->f[s->heap[p]] <= s->f[s->heap[i]]) break;
+        heap_swap(s, i, p);
+        i = p;
+    }
+}
+
+static uint16_t heap_pop(Search *s)
+{
+    uint16_t top = s->heap[0];
+    s->pos[top] = -1;
+    if (--s->heap_n > 0) {
+        s->heap[0] = s->heap[s->heap_n];
+        s->pos[s->heap[0]] = 0;
+        int i = 0;
+        for (;;) {
+            int l = 2 * i + 1, r = l + 1, m = i;
+            if (l < s->heap_n && s->f[s->heap[l]] < s->f[s->heap[m]]) m = l;
+            if (r < s->heap_n && s->f[s->heap[r]] < s->f[s->heap[m]]) m = r;
+            if (m == i) break;
+            heap_swap(s, i, m);
+            i = m;
+        }
+    }
+    return top;
+}
+
+static void relax(Search *s, int cell, uint32_t g, uint32_t h, int from,
+                  int dir)
+{
+    if (s->closed[cell] || g >= s->g[cell]) return;
+    s->g[cell]       = g;
+    s->f[cell]       = g + h;
+    s->parent[cell]  = (uint16_t)from;
+    s->arrived[cell] = (uint8_t)dir;
+    if (s->pos[cell] < 0) {
+        s->pos[cell] = (int16_t)s->heap_n;
+        s->heap[s->heap_n++] = (uint16_t)cell;
+    }
+    heap_up(s, s->pos[cell]);
+}
+
+/** Directions worth trying from a jump point reached along `arrived`:
+ *  onward, the two neighbouring diagonals or components and, after a
+ *  straight run, both sides (where a forced neighbour can open up). */
+static unsigned successor_dirs(int arrived)
+{
+    if (arrived == PATH_DIRS) return 0xFFu;
+    unsigned m = 1u << arrived
+               | 1u << (arrived + 1) % PATH_DIRS
+               | 1u << (arrived + 7) % PATH_DIRS;
+    if (!(arrived & 1))
+        m |= 1u << (arrived + 2) % PATH_DIRS | 1u << (arrived + 6) % PATH_DIRS;
+    return m;
+}
+
+static bool trace(const Search *s, int start, int goal, Path *out)
+{
+    int n = 1;
+    for (int c = goal; c != start; c = s->parent[c]) n++;
+    if (n > PATH_MAX_POINTS) return false;
+
+    out->count = n;
+    out->cost  = (int)s->g[goal];
+    for (int c = goal, i = n - 1; i >= 0; c = s->parent[c], i--) {
+        out->points[i].x = (int16_t)(c % MAP_MAX_W);
+        out->points[i].y = (int16_t)(c / MAP_MAX_W);
+    }
+    return true;
+}
+
+bool path_find(const JumpTable *jt, int sx, int sy, int gx, int gy,
+               Path *out)
+{
+    out->count = 0;
+    out->cost  = 0;
+    if (!path_open(jt, sx, sy) || !path_open(jt, gx, gy)) return false;
+
+    Search s;
+    memset(s.g, 0xFF, sizeof(s.g));
+    memset(s.closed, 0, sizeof(s.closed));
+    memset(s.pos, 0xFF, sizeof(s.pos));
+    s.heap_n = 0;
+
+    int start = sy * MAP_MAX_W + sx;
+    int goal  = gy * MAP_MAX_W + gx;
+    relax(&s, start, 0, octile(gx - sx, gy - sy), start, PATH_DIRS);
+
+    while (s.heap_n > 0) {
+        int cur = heap_pop(&s);
+        if (cur == goal) return trace(&s, start, goal, out);
+        s.closed[cur] = 1;
+
+        int cx = cur % MAP_MAX_W, cy = cur / MAP_MAX_W;
+        int gdx = gx - cx, gdy = gy - cy;
+        unsigned dirs = successor_dirs(s.arrived[cur]);
+
+        for (int d = 0; d < PATH_DIRS; d++) {
+            if (!(dirs >> d & 1u)) continue;
+            int dist  = jt->dist[cy][cx][d];
+            int reach = dist > 0 ? dist : -dist;
+            int steps;
+
+            /* Stop early where the goal lies on the run (straight), or
+             * level with it (diagonal, a "target jump point") */
+            if (d & 1) {
+                int m = abs(gdx) < abs(gdy) ? abs(gdx) : abs(gdy);
+                bool ahead = gdx * DX[d] > 0 && gdy * DY[d] > 0;
+                if (ahead && m <= reach) steps = m;
+                else if (dist > 0)       steps = dist;
+                else                     continue;
+            } else {
+                int along = DX[d] ? gdx * DX[d] : gdy * DY[d];
+                bool on_run = (DX[d] ? gdy : gdx) == 0 && along > 0;
+                if (on_run && along <= reach) steps = along;
+                else if (dist > 0)            steps = dist;
+                else                          continue;
+            }
+
+            int nx = cx + steps * DX[d], ny = cy + steps * DY[d];
+            uint32_t step_cost = (d & 1) ? PATH_COST_DIAGONAL
+                                         : PATH_COST_STRAIGHT;
+            relax(&s, ny * MAP_MAX_W + nx, s.g[cur] + (uint32_t)steps * step_cost,
+                  octile(gx - nx, gy - ny), cur, d);
+        }
+    }
+    return false;
+}
+
+/* ── Batch queries ─────────────────────────────────────────────────── */
+
+typedef struct Batch {
+    const JumpTable *jt;
+    PathQuery       *q;
+} Batch;
+
+static void batch_range(void *arg, int begin, int end)
+{
+    Batch *b = arg;
+    for (int i = begin; i < end; i++) {
+        PathQuery *q = &b->q[i];
+        path_find(b->jt, q->sx, q->sy, q->gx, q->gy, &q->path);
+    }
+}
+
+void path_find_batch(const JumpTable *jt, PathQuery *q, int n,
+                     struct JobPool *pool)
+{
+    /* Single-query grain: the pieces are small enough that idle threads
+     * steal around uneven path lengths */
+    Batch b = { .jt = jt, .q = q };
+    job_parallel_for(pool, 0, n, 1, batch_range, &b);
+}
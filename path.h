@@ -0,0 +1,69 @@
+#ifndef PATH_H
+#define PATH_H
+
+#include "game_globals.h"
+
+/* ── Pathfinding limits and costs ─────────────────────────────────── */
+#define PATH_DIRS          8     /* N, NE, E, SE, S, SW, W, NW          */
+#define PATH_MAX_POINTS    512   /* waypoints per path (jump points)    */
+#define PATH_COST_STRAIGHT 1000  /* cost of one orthogonal step         */
+#define PATH_COST_DIAGONAL 1414  /* cost of one diagonal step           */
+#define PATH_JUMP_VERSION  1     /* bump when JumpTable changes (cache) */
+
+/* ── Jump table (JPS+, derived from the tiles plane) ──────────────── */
+/* For every open cell and direction: a positive value is the number of
+ * steps to the next jump point, zero or negative is minus the number of
+ * open steps before a wall.  Movement is 8-way; a diagonal step needs
+ * both orthogonal neighbours open, so paths never cut wall corners. */
+typedef struct JumpTable {
+    int16_t  dist[MAP_MAX_H][MAP_MAX_W][PATH_DIRS];
+    uint64_t open[MAP_MAX_H];    /* bit x of open[y] = walkable cell    */
+    int      w, h;
+    uint32_t revision;           /* map revision this table reflects    */
+} JumpTable;
+
+/* ── Paths and batch queries ──────────────────────────────────────── */
+typedef struct PathPoint {
+    int16_t x, y;
+} PathPoint;
+
+typedef struct Path {
+    PathPoint points[PATH_MAX_POINTS]; /* start, jump points, goal      */
+    int       count;             /* 0 = no path                         */
+    int       cost;              /* in PATH_COST_* units                */
+} Path;
+
+typedef struct PathQuery {
+    int  sx, sy;                 /* start cell                          */
+    int  gx, gy;                 /* goal cell                           */
+    Path path;                   /* result                              */
+} PathQuery;
+
+/**  Build every jump distance from the tiles plane. */
+void path_build(JumpTable *jt, const Map *map);
+
+/**  Bring the table up to date with the map.  Each edited tile only
+ *   recomputes the rows and columns around it and the diagonals that
+ *   cross changed cells; a wrapped change log or a bulk change rebuilds. */
+void path_sync(JumpTable *jt, const Map *map);
+
+/**  True for open cells inside the map. */
+bool path_open(const JumpTable *jt, int x, int y);
+
+/**  Shortest 8-way path from (sx, sy) to (gx, gy) with jump point
+ *   search over the precomputed table.  Straight runs between jump
+ *   points are implied, so out->points holds only the turns.  Returns
+ *   false (count 0) if either end is solid, the goal is unreachable or
+ *   the path needs more than PATH_MAX_POINTS waypoints.  Read-only on
+ *   jt, so any number of threads may search one table at once. */
+bool path_find(const JumpTable *jt, int sx, int sy, int gx, int gy,
+               Path *out);
+
+struct JobPool;
+
+/**  Resolve n queries spread over pool and the caller (NULL = all on
+ *   the caller).  Blocks until all are done. */
+void path_find_batch(const JumpTable *jt, PathQuery *q, int n,
+                     struct JobPool *pool);
+
+#endif /* PATH_H */
@@ -3,6 +3,9 @@
  *  No SDL headers.  Pure C + math.
  */
 #include "raycaster.h"
+#include "arena.h"
+#include "jobs.h"
+#include "trigger.h"
 
 #include <math.h>
 #include <stdio.h>
@@ -25,9 +28,10 @@ static bool is_wall(const Map *m, float x, float y)
     return m->tiles[my][mx] > TILE_FLOOR;
 }
 
-void rc_update(GameState *gs, const Map *map, const Input *in, float dt)
+void rc_update(SimState *st, Map *map, const Input *in, float dt)
 {
-    Player *p = &gs->player;
+    Player *p = &st->player;
+    float old_x = p->x, old_y = p->y;
 
     /* ── Rotation ─────────────────────────────────────────────────── */
     /* Apply 2D rotation matrix to both direction and camera plane vectors.
@@ -69,21 +73,124 @@ void rc_update(GameState *gs, const Map *map, const Input *in, float dt)
     if (!is_wall(map, p->x, p->y + dy + (dy > 0 ? COL_MARGIN : -COL_MARGIN)))
         p->y += dy;
 
-    /* ── Endgame detection (player must reach centre of trigger) ─── */
-    int cx = (int)p->x;
-    int cy = (int)p->y;
-    if (cx >= 0 && cy >= 0 && cx < map->w && cy < map->h
-        && map->info[cy][cx] == INFO_TRIGGER_ENDGAME) {
-
-        float centre_x = cx + 0.5f;
-        float centre_y = cy + 0.5f;
-        float ex = p->x - centre_x;
-        float ey = p->y - centre_y;
-        if (ex * ex + ey * ey <= COL_MARGIN * COL_MARGIN)
-            gs->game_over = true;
+    /* ── Triggers: queue this tick's events, then apply them ──────── */
+    trig_touch(st->triggers, map, &st->events, TRIG_ENTITY_PLAYER,
+               old_x, old_y, p->x, p->y);
+    trig_dispatch(st->triggers, &st->events, st, map, NULL);
+}
+
+/* ── Sparse ray sensor ─────────────────────────────────────────────── */
+/* The same DDA as rc_cast(), but on unit-length rays, so the distance
+ * to the crossed boundary is the Euclidean range rather than the
+ * perpendicular one, and without the sprite bookkeeping. */
+
+static SenseHit sense_ray(const Map *map, float px, float py,
+                          float ray_dx, float ray_dy, float max_range)
+{
+    int map_x = (int)px;
+    int map_y = (int)py;
+    float delta_dx = (ray_dx == 0.0f) ? 1e30f : fabsf(1.0f / ray_dx);
+    float delta_dy = (ray_dy == 0.0f) ? 1e30f : fabsf(1.0f / ray_dy);
+    int   step_x   = ray_dx < 0 ? -1 : 1;
+    int   step_y   = ray_dy < 0 ? -1 : 1;
+    float side_dx  = (ray_dx < 0 ? px - map_x : map_x + 1.0f - px) * delta_dx;
+    float side_dy  = (ray_dy < 0 ? py - map_y : map_y + 1.0f - py) * delta_dy;
+
+    SenseHit h = { .cell = ID_NO_CELL };
+    for (;;) {
+        if (side_dx < side_dy) {
+            h.dist   = side_dx;
+            side_dx += delta_dx;
+            map_x   += step_x;
+            h.side   = 0;
+        } else {
+            h.dist   = side_dy;
+            side_dy += delta_dy;
+            map_y   += step_y;
+            h.side   = 1;
+        }
+        if (max_range > 0.0f && h.dist > max_range) {
+            h.dist = max_range;
+            return h;
+        }
+        if (map_x < 0 || map_y < 0 || map_x >= map->w || map_y >= map->h)
+            return h;                          /* left the map: no cell */
+        int tile = map->tiles[map_y][map_x];
+        if (tile > TILE_FLOOR) {
+            h.tile_type = (uint16_t)(tile - 1);
+            h.cell      = (uint16_t)(map_y * MAP_MAX_W + map_x);
+            return h;
+        }
+    }
+}
+
+void rc_sense(const Map *map, const Player *p, const float *angles,
+              int count, float max_range, SenseHit *out)
+{
+    /* Unit facing and camera-plane directions span the sensor frame */
+    float dl = sqrtf(p->dir_x * p->dir_x + p->dir_y * p->dir_y);
+    float pl = sqrtf(p->plane_x * p->plane_x + p->plane_y * p->plane_y);
+    float fx = p->dir_x / dl,   fy = p->dir_y / dl;
+    float rx = p->plane_x / pl, ry = p->plane_y / pl;
+
+    for (int i = 0; i < count; i++) {
+        float c = cosf(angles[i]), s = sinf(angles[i]);
+        out[i] = sense_ray(map, p->x, p->y,
+                           fx * c + rx * s, fy * c + ry * s, max_range);
     }
 }
 
+void rc_sense_spread(float *angles, int count, float fov, float focus)
+{
+    const float two_pi = 6.28318530718f;
+    bool sweep = fov >= two_pi;
+    for (int i = 0; i < count; i++) {
+        /* u runs -1 .. 1 (a sweep stops one step short of +1) */
+        float u = count == 1 ? 0.0f
+                : sweep      ? -1.0f + 2.0f * i / count
+                             : -1.0f + 2.0f * i / (count - 1);
+        float a = powf(fabsf(u), 1.0f + focus);
+        angles[i] = (sweep ? 0.5f * two_pi : 0.5f * fov) * (u < 0.0f ? -a : a);
+    }
+}
+
+/* ── Render interpolation ──────────────────────────────────────────── */
+
+/** Rescale (x, y) to length len; leaves a zero vector alone. */
+static void set_length(float *x, float *y, float len)
+{
+    float cur = sqrtf(*x * *x + *y * *y);
+    if (cur > 0.0f) {
+        *x *= len / cur;
+        *y *= len / cur;
+    }
+}
+
+void rc_lerp_player(Player *out, const Player *a, const Player *b,
+                    float alpha)
+{
+    float dx = b->x - a->x;
+    float dy = b->y - a->y;
+    if (dx * dx + dy * dy > LERP_SNAP_DIST * LERP_SNAP_DIST) {
+        *out = *b;
+        return;
+    }
+
+    out->x = a->x + dx * alpha;
+    out->y = a->y + dy * alpha;
+
+    /* Blending two unit vectors shortens the result: restore b's lengths
+     * so the field of view does not pulse while turning */
+    out->dir_x   = a->dir_x   + (b->dir_x   - a->dir_x)   * alpha;
+    out->dir_y   = a->dir_y   + (b->dir_y   - a->dir_y)   * alpha;
+    out->plane_x = a->plane_x + (b->plane_x - a->plane_x) * alpha;
+    out->plane_y = a->plane_y + (b->plane_y - a->plane_y) * alpha;
+    set_length(&out->dir_x, &out->dir_y,
+               sqrtf(b->dir_x * b->dir_x + b->dir_y * b->dir_y));
+    set_length(&out->plane_x, &out->plane_y,
+               sqrtf(b->plane_x * b->plane_x + b->plane_y * b->plane_y));
+}
+
 /* ── Sprite sorting ────────────────────────────────────────────────── */
 
 /** qsort comparator: sort sprites by perp_dist descending (farthest first)
@@ -98,7 +205,7 @@ static int sprite_cmp_desc(const void *a, const void *b)
 }
 
 /** Sort visible sprites back-to-front using qsort for O(N log N). */
-static void sort_visible_sprites(GameState *gs)
+void rc_sort_sprites(GameState *gs)
 {
     if (gs->visible_sprite_count > 1)
         qsort(gs->visible_sprites, (size_t)gs->visible_sprite_count,
@@ -111,41 +218,36 @@ static void sort_visible_sprites(GameState *gs)
  * scene. Step through the map grid cell-by-cell until hitting a wall.
  * The distance to the wall determines the height of the vertical strip drawn. */
 
-void rc_cast(GameState *gs, const Map *map)
+/** Collect the sprite in cell (cx, cy) if it is in front of the camera.
+ *  inv_det is the inverse camera matrix determinant, so that
+ *  perp_dist = inv_det * (-plane_y * sx + plane_x * sy)
+ *  where (sx, sy) is the sprite position relative to the player. */
+static void collect_sprite(const Map *map, const Player *p, float inv_det,
+                           int cx, int cy, Sprite *list, int *count)
 {
-    const Player *p = &gs->player;
-
-    /* Reset visible sprite list and visited bitmap for deduplication */
-    gs->visible_sprite_count = 0;
-    bool seen[MAP_MAX_H][MAP_MAX_W];
-    memset(seen, 0, sizeof(seen));
+    float sx = cx + 0.5f - p->x;
+    float sy = cy + 0.5f - p->y;
+    float pd = inv_det * (-p->plane_y * sx + p->plane_x * sy);
+    if (pd > 0.0f && *count < MAX_VISIBLE_SPRITES) {
+        Sprite *sp = &list[(*count)++];
+        sp->x = cx + 0.5f;
+        sp->y = cy + 0.5f;
+        sp->perp_dist   = pd;
+        sp->texture_id  = map->sprites[cy][cx] - 1;
+        sp->id = MAKE_ID(ID_SPRITE, sp->texture_id, cy * MAP_MAX_W + cx);
+    }
+}
 
-    /* Inverse camera matrix determinant for sprite perpendicular distance.
-     * perp_dist = inv_det * (-plane_y * sx + plane_x * sy)
-     * where (sx, sy) is the sprite position relative to the player. */
+/** Columns [x0, x1): fill gs->hits and gs->z_buffer, and append the
+ *  sprites the rays pass, first sighting only, to list.  seen holds one
+ *  byte per map cell (y * map->w + x); NULL collects no sprites. */
+static void cast_columns(GameState *gs, const Map *map, int x0, int x1,
+                         uint8_t *seen, Sprite *list, int *count)
+{
+    const Player *p = &gs->player;
     float inv_det = 1.0f / (p->plane_x * p->dir_y - p->dir_x * p->plane_y);
 
-    /* Check the player's starting cell for sprites (not visited by DDA) */
-    {
-        int cx = (int)p->x;
-        int cy = (int)p->y;
-        if (cx >= 0 && cy >= 0 && cx < map->w && cy < map->h
-            && map->sprites[cy][cx] != SPRITE_EMPTY) {
-            seen[cy][cx] = true;
-            float sx = cx + 0.5f - p->x;
-            float sy = cy + 0.5f - p->y;
-            float pd = inv_det * (-p->plane_y * sx + p->plane_x * sy);
-            if (pd > 0.0f && gs->visible_sprite_count < MAX_VISIBLE_SPRITES) {
-                Sprite *sp = &gs->visible_sprites[gs->visible_sprite_count++];
-                sp->x = cx + 0.5f;
-                sp->y = cy + 0.5f;
-                sp->perp_dist   = pd;
-                sp->texture_id  = map->sprites[cy][cx] - 1;
-            }
-        }
-    }
-
-    for (int x = 0; x < SCREEN_W; x++) {
+    for (int x = x0; x < x1; x++) {
         /* Camera-space x: -1 (left edge) to +1 (right edge).
          * This maps screen column to a position across the camera plane. */
         float cam_x = 2.0f * x / (float)SCREEN_W - 1.0f;
@@ -211,20 +313,11 @@ void rc_cast(GameState *gs, const Map *map)
                 hit = true;                    /* out of bounds = wall */
             } else if (map->tiles[map_y][map_x] > TILE_FLOOR) {
                 hit = true;
-            } else if (!seen[map_y][map_x]
+            } else if (seen && !seen[map_y * map->w + map_x]
                        && map->sprites[map_y][map_x] != SPRITE_EMPTY) {
                 /* Floor cell with an unseen sprite — collect it */
-                seen[map_y][map_x] = true;
-                float sx = map_x + 0.5f - p->x;
-                float sy = map_y + 0.5f - p->y;
-                float pd = inv_det * (-p->plane_y * sx + p->plane_x * sy);
-                if (pd > 0.0f && gs->visible_sprite_count < MAX_VISIBLE_SPRITES) {
-                    Sprite *sp = &gs->visible_sprites[gs->visible_sprite_count++];
-                    sp->x = map_x + 0.5f;
-                    sp->y = map_y + 0.5f;
-                    sp->perp_dist   = pd;
-                    sp->texture_id  = map->sprites[map_y][map_x] - 1;
-                }
+                seen[map_y * map->w + map_x] = 1;
+                collect_sprite(map, p, inv_det, map_x, map_y, list, count);
             }
         }
 
@@ -256,20 +349,130 @@ void rc_cast(GameState *gs, const Map *map)
         /* Extract tile_type (texture index) from tile value.
          * Tile encoding: 0 = floor, 1 = tile type 0, 2 = tile type 1, etc.
          * So tile_type = tile - 1. Out-of-bounds tiles default to type 0. */
-        int tile = 0;
-        if (map_x >= 0 && map_y >= 0 && map_x < map->w && map_y < map->h)
+        int      tile = 0;
+        uint16_t cell = ID_NO_CELL;
+        if (map_x >= 0 && map_y >= 0 && map_x < map->w && map_y < map->h) {
             tile = map->tiles[map_y][map_x];
+            cell = (uint16_t)(map_y * MAP_MAX_W + map_x);
+        }
 
         /* Store results in the hit buffer for this column – the renderer reads this */
         gs->hits[x].wall_dist = perp;
         gs->hits[x].wall_x    = wall_x;
         gs->hits[x].side      = side;
         gs->hits[x].tile_type = (tile > 0) ? tile - 1 : 0;
+        gs->hits[x].cell      = cell;
 
         /* Store perpendicular distance in z-buffer for sprite clipping */
         gs->z_buffer[x] = perp;
     }
+}
+
+/** A cleared visited bitmap for map from the thread's arena, or NULL
+ *  when the arena is full (the cast then collects no sprites). */
+static uint8_t *alloc_seen(Arena *a, const Map *map)
+{
+    size_t cells = (size_t)map->w * (size_t)map->h;
+    uint8_t *seen = arena_alloc(a, cells);
+    if (seen) memset(seen, 0, cells);
+    return seen;
+}
+
+/** Reset the sprite list and check the player's own cell, which the
+ *  DDA never visits.  Returns with that cell marked in seen. */
+static void begin_cast(GameState *gs, const Map *map, uint8_t *seen)
+{
+    const Player *p = &gs->player;
+    gs->visible_sprite_count = 0;
+
+    int cx = (int)p->x;
+    int cy = (int)p->y;
+    if (seen && cx >= 0 && cy >= 0 && cx < map->w && cy < map->h
+        && map->sprites[cy][cx] != SPRITE_EMPTY) {
+        seen[cy * map->w + cx] = 1;
+        float inv_det = 1.0f / (p->plane_x * p->dir_y - p->dir_x * p->plane_y);
+        collect_sprite(map, p, inv_det, cx, cy,
+                       gs->visible_sprites, &gs->visible_sprite_count);
+    }
+}
+
+void rc_cast(GameState *gs, const Map *map)
+{
+    /* Visited bitmap, so each sprite is collected once */
+    Arena *a = arena_thread();
+    size_t mark = arena_mark(a);
+    uint8_t *seen = alloc_seen(a, map);
+    begin_cast(gs, map, seen);
+    cast_columns(gs, map, 0, SCREEN_W, seen,
+                 gs->visible_sprites, &gs->visible_sprite_count);
+    arena_release(a, mark);
 
     /* Sort visible sprites back-to-front for correct painter's order */
-    sort_visible_sprites(gs);
+    rc_sort_sprites(gs);
+}
+
+/* ── Parallel cast ─────────────────────────────────────────────────── */
+/* Columns are independent apart from the sprite list, so each band
+ * collects its own; merging them in band order and keeping the first
+ * sighting of each cell yields exactly the serial list.  The band lists
+ * live in the caller's arena and each band's bitmap in the arena of the
+ * thread that casts it. */
+
+_Static_assert(sizeof(Sprite) * RC_CAST_BANDS * MAX_VISIBLE_SPRITES
+               + 2 * (MAP_MAX_W * MAP_MAX_H + ARENA_ALIGN) <= ARENA_THREAD_SIZE,
+               "a thread arena must hold one parallel cast");
+
+typedef struct CastBands {
+    GameState  *gs;
+    const Map  *map;
+    Sprite     *sprites;          /* RC_CAST_BANDS lists, band-major     */
+    int         counts[RC_CAST_BANDS];
+} CastBands;
+
+static void cast_bands(void *arg, int begin, int end)
+{
+    CastBands *cb = arg;
+    Arena *a = arena_thread();
+    for (int b = begin; b < end; b++) {
+        size_t mark = arena_mark(a);
+        uint8_t *seen = alloc_seen(a, cb->map);
+        cb->counts[b] = 0;
+        cast_columns(cb->gs, cb->map, b * SCREEN_W / RC_CAST_BANDS,
+                     (b + 1) * SCREEN_W / RC_CAST_BANDS, seen,
+                     cb->sprites + (size_t)b * MAX_VISIBLE_SPRITES,
+                     &cb->counts[b]);
+        arena_release(a, mark);
+    }
+}
+
+void rc_cast_jobs(GameState *gs, const Map *map, struct JobPool *pool)
+{
+    Arena *a = arena_thread();
+    size_t mark = arena_mark(a);
+    uint8_t *seen = pool ? alloc_seen(a, map) : NULL;
+    Sprite *lists = seen ? arena_alloc(a, sizeof(Sprite) * RC_CAST_BANDS
+                                          * MAX_VISIBLE_SPRITES) : NULL;
+    if (!lists) {
+        /* No pool, or no room for the band lists: cast serially */
+        arena_release(a, mark);
+        rc_cast(gs, map);
+        return;
+    }
+    begin_cast(gs, map, seen);
+
+    CastBands cb = { .gs = gs, .map = map, .sprites = lists };
+    job_parallel_for(pool, 0, RC_CAST_BANDS, 1, cast_bands, &cb);
+
+    for (int b = 0; b < RC_CAST_BANDS; b++)
+        for (int i = 0; i < cb.counts[b]; i++) {
+            const Sprite *sp = &lists[(size_t)b * MAX_VISIBLE_SPRITES + i];
+            int cx = (int)sp->x, cy = (int)sp->y;
+            if (seen[cy * map->w + cx]
+                || gs->visible_sprite_count >= MAX_VISIBLE_SPRITES)
+                continue;
+            seen[cy * map->w + cx] = 1;
+            gs->visible_sprites[gs->visible_sprite_count++] = *sp;
+        }
+    arena_release(a, mark);
+    rc_sort_sprites(gs);
 }
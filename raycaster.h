@@ -5,9 +5,15 @@
 
 /* ── Raycasting constants ──────────────────────────────────────────── */
 #define FOV_DEG   60.0f          /* field of view in degrees           */
+#define RC_CAST_BANDS 8          /* column bands for rc_cast_jobs()    */
+
+/* ── Render interpolation ─────────────────────────────────────────── */
+#define LERP_SNAP_DIST 0.5f      /* jumps longer than this are not      */
+                                 /* interpolated (teleports, map loads) */
 
 /* ── Tiles plane values ───────────────────────────────────────────── */
 #define TILE_FLOOR  0            /* empty floor (walkable)             */
+#define TILE_UNLOADED 1          /* solid filler for non-resident chunks */
 
 /* ── Info plane values ────────────────────────────────────────────── */
 #define INFO_EMPTY              0 /* no metadata at this cell          */
@@ -16,13 +22,62 @@
 #define INFO_SPAWN_PLAYER_S     3 /* player spawn, facing south        */
 #define INFO_SPAWN_PLAYER_W     4 /* player spawn, facing west         */
 #define INFO_TRIGGER_ENDGAME    5 /* endgame trigger                   */
+#define INFO_TRIGGER_TELEPORT   6 /* teleport to the paired pad        */
+#define INFO_TRIGGER_DAMAGE     7 /* damage zone (every tick inside)   */
+#define INFO_TRIGGER_SWITCH     8 /* toggles every door on the map     */
+#define INFO_DOOR               9 /* wall cell opened by a switch      */
 
 /* ── Public API ────────────────────────────────────────────────────── */
 
-/**  Update player position/rotation from input.  dt in seconds. */
-void rc_update(GameState *gs, const Map *map, const Input *in, float dt);
+/**  Update player position/rotation from input, then queue and dispatch
+ *   the trigger events for this tick (switches may edit the map).
+ *   dt in seconds. */
+void rc_update(SimState *st, Map *map, const Input *in, float dt);
 
 /**  Cast all rays and fill gs->hits[]. */
 void rc_cast(GameState *gs, const Map *map);
 
+struct JobPool;
+
+/**  rc_cast() with the columns split into RC_CAST_BANDS jobs on pool
+ *   (NULL = rc_cast()).  The result is identical to rc_cast(). */
+void rc_cast_jobs(GameState *gs, const Map *map, struct JobPool *pool);
+
+/**  Pose between two consecutive ticks: a at alpha 0, b at alpha 1.
+ *   Position, direction and camera plane are blended, with the direction
+ *   and plane kept at b's lengths.  If the player moved further than
+ *   LERP_SNAP_DIST, out is simply b. */
+void rc_lerp_player(Player *out, const Player *a, const Player *b,
+                    float alpha);
+
+/* ── Sparse ray sensor ────────────────────────────────────────────── */
+/* Lidar-style readings for agents that need ranges, not pixels: any
+ * number of rays at any angles, straight from the DDA, with no sprite
+ * collection and no framebuffer.  Angles are radians from the facing
+ * direction, positive toward the camera plane (screen right). */
+#define SENSE_MAX_RAYS 1024      /* rays per rc_sense() call            */
+
+typedef struct SenseHit {
+    float    dist;               /* Euclidean range to the hit          */
+    uint16_t tile_type;          /* as RayHit.tile_type                 */
+    uint16_t cell;               /* y * MAP_MAX_W + x, or ID_NO_CELL    */
+    uint8_t  side;               /* 0 = x-side, 1 = y-side              */
+} SenseHit;
+
+/**  Cast count rays from p's position at angles[i] and write out[i].
+ *   A ray that runs max_range (> 0) without a hit, or leaves the map,
+ *   reports ID_NO_CELL; max_range <= 0 means unlimited. */
+void rc_sense(const Map *map, const Player *p, const float *angles,
+              int count, float max_range, SenseHit *out);
+
+/**  Fill angles[0..count) across fov radians centred on the facing
+ *   direction, left to right.  focus 0 spaces rays evenly; larger
+ *   values pack them toward the centre.  An fov of 2π or more is a full
+ *   sweep without a duplicate ray at the seam. */
+void rc_sense_spread(float *angles, int count, float fov, float focus);
+
+/**  Sort gs->visible_sprites back-to-front.  rc_cast() already does this;
+ *   call it again after appending sprites (e.g. entities). */
+void rc_sort_sprites(GameState *gs);
+
 #endif /* RAYCASTER_H */
@@ -0,0 +1,334 @@
+/*  render.c  –  software renderer over a caller-owned framebuffer
+ *  ─────────────────────────────────────────────────────────────────
+ *  Turns the RayHit buffer into textured vertical strips and draws
+ *  billboarded sprites after the walls against the 1D z-buffer, with
+ *  optional per-pixel depth and object IDs filled in the same pass.  All
+ *  state comes in through the arguments, so the SDL frontend and any
+ *  number of headless instances share the same drawing code.
+ *  No SDL headers.  Atlas BMPs are decoded with stdio.
+ */
+#include "render.h"
+#include "jobs.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ── Atlas ─────────────────────────────────────────────────────────── */
+
+void render_atlas_solid(TextureAtlas *atlas)
+{
+    for (int i = 0; i < TEX_COUNT * TEX_SIZE * TEX_SIZE; i++)
+        atlas->tiles[i] = COL_WALL;
+    for (int i = 0; i < SPRITE_TEX_COUNT * TEX_SIZE * TEX_SIZE; i++)
+        atlas->sprites[i] = COL_SPRITE;
+}
+
+static uint32_t get_le(const uint8_t *b, int n)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < n; i++) v |= (uint32_t)b[i] << (8 * i);
+    return v;
+}
+
+/** Read a horizontal strip of tex_count textures into buf (RGBA8888,
+ *  as SDL_ConvertSurface would produce).  Returns false on any error. */
+static bool load_strip(const char *path, uint32_t *buf, int tex_count,
+                       const char *label)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "render_atlas_load: cannot open %s '%s' – using solid colour\n",
+                label, path);
+        return false;
+    }
+
+    uint8_t hdr[54];
+    bool ok = fread(hdr, 1, sizeof(hdr), fp) == sizeof(hdr)
+           && hdr[0] == 'B' && hdr[1] == 'M';
+    uint32_t data   = get_le(hdr + 10, 4);
+    int32_t  w      = (int32_t)get_le(hdr + 18, 4);
+    int32_t  h      = (int32_t)get_le(hdr + 22, 4);
+    int      bpp    = (int)get_le(hdr + 28, 2);
+    uint32_t comp   = get_le(hdr + 30, 4);
+    int      need_w = tex_count * TEX_SIZE;
+    int      rows   = h < 0 ? -h : h;
+    ok = ok && (bpp == 24 || bpp == 32) && (comp == 0 || comp == 3)
+            && w >= need_w && rows >= TEX_SIZE;
+    if (!ok) {
+        fprintf(stderr, "render_atlas_load: %s '%s' is not an uncompressed "
+                "24/32-bit BMP of at least %dx%d\n", label, path, need_w, TEX_SIZE);
+        fclose(fp);
+        return false;
+    }
+
+    /* Rows are stored bottom-up unless the height is negative */
+    long    pitch = ((long)w * bpp + 31) / 32 * 4;
+    int     bytes = bpp / 8;
+    uint8_t line[TEX_COUNT * TEX_SIZE * 4];
+    for (int y = 0; y < TEX_SIZE && ok; y++) {
+        long row = h < 0 ? y : rows - 1 - y;
+        ok = fseek(fp, (long)data + row * pitch, SEEK_SET) == 0
+          && fread(line, 1, (size_t)(need_w * bytes), fp) == (size_t)(need_w * bytes);
+        for (int x = 0; ok && x < need_w; x++) {
+            const uint8_t *px = line + x * bytes;       /* B, G, R(, X) */
+            int t = x / TEX_SIZE;
+            buf[t * TEX_SIZE * TEX_SIZE + y * TEX_SIZE + x % TEX_SIZE] =
+                (uint32_t)px[2] << 24 | (uint32_t)px[1] << 16
+                | (uint32_t)px[0] << 8 | 0xFFu;
+        }
+    }
+    fclose(fp);
+    if (!ok)
+        fprintf(stderr, "render_atlas_load: %s '%s' is truncated\n", label, path);
+    return ok;
+}
+
+bool render_atlas_load(TextureAtlas *atlas, const char *tiles_path,
+                       const char *sprites_path)
+{
+    bool tiles_ok = load_strip(tiles_path, atlas->tiles, TEX_COUNT, "tiles");
+    if (!tiles_ok)
+        for (int i = 0; i < TEX_COUNT * TEX_SIZE * TEX_SIZE; i++)
+            atlas->tiles[i] = COL_WALL;
+    bool sprites_ok = load_strip(sprites_path, atlas->sprites,
+                                 SPRITE_TEX_COUNT, "sprite");
+    if (!sprites_ok)
+        for (int i = 0; i < SPRITE_TEX_COUNT * TEX_SIZE * TEX_SIZE; i++)
+            atlas->sprites[i] = COL_SPRITE;
+    return tiles_ok && sprites_ok;
+}
+
+void render_atlas_share(SharedAtlas *sa)
+{
+    atomic_init(&sa->refs, 1);
+}
+
+void render_atlas_retain(SharedAtlas *sa)
+{
+    atomic_fetch_add_explicit(&sa->refs, 1, memory_order_relaxed);
+}
+
+bool render_atlas_release(SharedAtlas *sa)
+{
+    return atomic_fetch_sub_explicit(&sa->refs, 1, memory_order_acq_rel) == 1;
+}
+
+/* ── Sampling (clamped, like tm_get_*_pixel) ───────────────────────── */
+
+static uint32_t tile_pixel(const TextureAtlas *atlas, uint16_t tile_type,
+                           int tex_x, int tex_y)
+{
+    if (tile_type >= TEX_COUNT) tile_type = TEX_COUNT - 1;
+    return atlas->tiles[tile_type * TEX_SIZE * TEX_SIZE + tex_y * TEX_SIZE + tex_x];
+}
+
+static uint32_t sprite_pixel(const TextureAtlas *atlas, uint16_t tex_id,
+                             int tex_x, int tex_y)
+{
+    if (tex_id >= SPRITE_TEX_COUNT) tex_id = SPRITE_TEX_COUNT - 1;
+    return atlas->sprites[tex_id * TEX_SIZE * TEX_SIZE + tex_y * TEX_SIZE + tex_x];
+}
+
+/* ── Helpers: darken a colour for y-side shading ─────────────────── */
+
+static uint32_t darken(uint32_t c)
+{
+    int r = (c >> 24) & 0xFF;
+    int g = (c >> 16) & 0xFF;
+    int b = (c >>  8) & 0xFF;
+    int a =  c        & 0xFF;
+    return (uint32_t)((r >> 1) << 24 | (g >> 1) << 16 | (b >> 1) << 8 | a);
+}
+
+/* ── Sprite rendering (billboarded, z-buffered) ──────────────────── */
+
+static void render_sprites(uint32_t *fb, int fb_stride, const GameState *gs,
+                           const TextureAtlas *atlas, float *zb, uint32_t *ids,
+                           int x0, int x1)
+{
+    const Player *p = &gs->player;
+    int n = gs->visible_sprite_count;
+    if (n <= 0) return;
+
+    /* Inverse camera matrix determinant (for transform_x computation):
+     * | plane_x  dir_x |   inv_det = 1 / (plane_x*dir_y - dir_x*plane_y)
+     * | plane_y  dir_y |
+     */
+    float inv_det = 1.0f / (p->plane_x * p->dir_y - p->dir_x * p->plane_y);
+
+    for (int i = 0; i < n; i++) {
+        const Sprite *sp = &gs->visible_sprites[i];
+        float depth = sp->perp_dist;
+
+        /* Translate sprite position relative to player */
+        float sx = sp->x - p->x;
+        float sy = sp->y - p->y;
+
+        /* Camera-space X (horizontal offset on screen) */
+        float transform_x = inv_det * (p->dir_y * sx - p->dir_x * sy);
+
+        /* Project: screen X position and sprite dimensions */
+        int sprite_screen_x = (int)((SCREEN_W / 2) *
+                              (1.0f + transform_x / depth));
+
+        int sprite_h = abs((int)(SCREEN_H / depth));
+        int sprite_w = sprite_h;  /* square sprites */
+
+        /* Vertical draw bounds */
+        int draw_start_y = -sprite_h / 2 + SCREEN_H / 2;
+        int draw_end_y   =  sprite_h / 2 + SCREEN_H / 2;
+
+        int y_start = draw_start_y < 0 ? 0 : draw_start_y;
+        int y_end   = draw_end_y >= SCREEN_H ? SCREEN_H - 1 : draw_end_y;
+
+        /* Horizontal draw bounds */
+        int draw_start_x = -sprite_w / 2 + sprite_screen_x;
+        int draw_end_x   =  sprite_w / 2 + sprite_screen_x;
+
+        /* Skip entirely if outside screen (FOV culling) */
+        if (draw_end_x < 0 || draw_start_x >= SCREEN_W) continue;
+
+        int x_start = draw_start_x < x0 ? x0 : draw_start_x;
+        int x_end   = draw_end_x >= x1 ? x1 - 1 : draw_end_x;
+
+        /* Draw sprite columns */
+        for (int x = x_start; x <= x_end; x++) {
+            /* Z-buffer test: skip if wall is closer */
+            if (depth >= gs->z_buffer[x]) continue;
+
+            /* Texture X coordinate */
+            int tex_x = (int)((x - draw_start_x) * TEX_SIZE / sprite_w);
+            if (tex_x < 0)          tex_x = 0;
+            if (tex_x >= TEX_SIZE)  tex_x = TEX_SIZE - 1;
+
+            /* Draw vertical stripe */
+            for (int y = y_start; y <= y_end; y++) {
+                /* Texture Y coordinate */
+                int d = y * 2 - SCREEN_H + sprite_h;
+                int tex_y = (d * TEX_SIZE) / (sprite_h * 2);
+                if (tex_y < 0)          tex_y = 0;
+                if (tex_y >= TEX_SIZE)  tex_y = TEX_SIZE - 1;
+
+                uint32_t col = sprite_pixel(atlas, sp->texture_id, tex_x, tex_y);
+
+                /* Transparency: skip magenta alpha-key pixels */
+                if (col == SPRITE_ALPHA_KEY) continue;
+
+                fb[y * fb_stride + x] = col;
+                if (zb)  zb[y * fb_stride + x]  = depth;
+                if (ids) ids[y * fb_stride + x] = sp->id;
+            }
+        }
+    }
+}
+
+/* ── Main rendering ───────────────────────────────────────────────── */
+
+/** Distance at which the floor (or ceiling) is seen through row y's
+ *  pixel centre: the inverse of the wall strip height SCREEN_H / dist. */
+static float row_dist(int y)
+{
+    return (float)SCREEN_H / fabsf((float)(2 * y + 1 - SCREEN_H));
+}
+
+void render_frame(const GameState *gs, const TextureAtlas *atlas,
+                  uint32_t *fb, int fb_stride)
+{
+    render_frame_aux(gs, atlas, fb, fb_stride, NULL);
+}
+
+/** Everything in columns [x0, x1); no other column is touched, so
+ *  column bands can be drawn concurrently. */
+static void render_columns(const GameState *gs, const TextureAtlas *atlas,
+                           uint32_t *fb, int fb_stride, float *zb,
+                           uint32_t *ids, int x0, int x1)
+{
+    /* Fill the band with ceiling and floor colours */
+    for (int y = 0; y < SCREEN_H; y++) {
+        uint32_t col = y < SCREEN_H / 2 ? COL_CEIL : COL_FLOOR;
+        uint32_t id  = MAKE_ID(y < SCREEN_H / 2 ? ID_CEIL : ID_FLOOR, 0, 0);
+        float    d   = row_dist(y);
+        for (int x = x0; x < x1; x++) {
+            fb[y * fb_stride + x] = col;
+            if (zb)  zb[y * fb_stride + x]  = d;
+            if (ids) ids[y * fb_stride + x] = id;
+        }
+    }
+
+    /* Draw textured wall strips from the hit buffer */
+    for (int x = x0; x < x1; x++) {
+        float dist = gs->hits[x].wall_dist;
+        int line_h = (int)(SCREEN_H / dist);
+
+        int draw_start = -line_h / 2 + SCREEN_H / 2;
+        int draw_end   =  line_h / 2 + SCREEN_H / 2;
+
+        /* Texture X coordinate from fractional wall hit position */
+        int tex_x = (int)(gs->hits[x].wall_x * TEX_SIZE);
+        if (tex_x < 0)         tex_x = 0;
+        if (tex_x >= TEX_SIZE) tex_x = TEX_SIZE - 1;
+
+        uint16_t wt = gs->hits[x].tile_type;
+        int side = gs->hits[x].side;
+        uint32_t id = MAKE_ID(ID_WALL, wt, gs->hits[x].cell);   /* whole strip */
+
+        /* Clamp visible range to screen */
+        int y_start = draw_start < 0 ? 0 : draw_start;
+        int y_end   = draw_end >= SCREEN_H ? SCREEN_H - 1 : draw_end;
+
+        for (int y = y_start; y <= y_end; y++) {
+            /* Map screen Y to texture Y (0 .. TEX_SIZE-1) */
+            int d = y * 2 - SCREEN_H + line_h;  /* offset from strip top */
+            int tex_y = (d * TEX_SIZE) / (line_h * 2);
+            if (tex_y < 0)            tex_y = 0;
+            if (tex_y >= TEX_SIZE)    tex_y = TEX_SIZE - 1;
+
+            uint32_t col = tile_pixel(atlas, wt, tex_x, tex_y);
+
+            /* Darken y-side hits for depth cue */
+            if (side == 1) col = darken(col);
+
+            fb[y * fb_stride + x] = col;
+            if (zb)  zb[y * fb_stride + x]  = dist;
+            if (ids) ids[y * fb_stride + x] = id;
+        }
+    }
+
+    /* Sprite rendering pass (after walls) */
+    render_sprites(fb, fb_stride, gs, atlas, zb, ids, x0, x1);
+}
+
+void render_frame_aux(const GameState *gs, const TextureAtlas *atlas,
+                      uint32_t *fb, int fb_stride, const RenderAux *aux)
+{
+    render_frame_jobs(gs, atlas, fb, fb_stride, aux, NULL);
+}
+
+typedef struct RenderBands {
+    const GameState    *gs;
+    const TextureAtlas *atlas;
+    uint32_t           *fb;
+    int                 stride;
+    float              *zb;
+    uint32_t           *ids;
+} RenderBands;
+
+static void render_bands(void *arg, int begin, int end)
+{
+    const RenderBands *rb = arg;
+    render_columns(rb->gs, rb->atlas, rb->fb, rb->stride, rb->zb, rb->ids,
+                   begin, end);
+}
+
+void render_frame_jobs(const GameState *gs, const TextureAtlas *atlas,
+                       uint32_t *fb, int fb_stride, const RenderAux *aux,
+                       struct JobPool *pool)
+{
+    RenderBands rb = {
+        .gs = gs, .atlas = atlas, .fb = fb, .stride = fb_stride,
+        .zb = aux ? aux->depth : NULL, .ids = aux ? aux->ids : NULL,
+    };
+    job_parallel_for(pool, 0, SCREEN_W, RENDER_BAND_W, render_bands, &rb);
+}
@@ -0,0 +1,88 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "game_globals.h"
+
+#include <stdatomic.h>
+
+/* ── Texture atlas constants ──────────────────────────────────────── */
+#define TEX_SIZE  64             /* width & height of one texture tile */
+#define TEX_COUNT 10             /* number of textures in the atlas    */
+#define SPRITE_TEX_COUNT  4      /* number of sprite textures in atlas */
+#define SPRITE_ALPHA_KEY  0x980088FF /* #980088 magenta = transparent */
+
+/* ── Rendering colours (RGBA8888) ──────────────────────────────────── */
+#define COL_CEIL       0xAAAAAAFF   /* ceiling (light grey)              */
+#define COL_FLOOR      0x66666666   /* floor (dark grey)                 */
+#define COL_WALL_SHADE 0x000068FF   /* shading reference (darker blue)   */
+#define COL_WALL       0x00008BFF   /* dark blue used when BMP fails to load */
+#define COL_SPRITE     0xFF00FFFF   /* bright magenta sprite fallback    */
+
+/* ── Decoded textures (RGBA8888, one TEX_SIZE² block per texture) ─── */
+/* Plain pixel arrays with no owner state, so one atlas can be read by
+ * any number of renderers at once. */
+typedef struct TextureAtlas {
+    uint32_t tiles[TEX_COUNT * TEX_SIZE * TEX_SIZE];
+    uint32_t sprites[SPRITE_TEX_COUNT * TEX_SIZE * TEX_SIZE];
+} TextureAtlas;
+
+/* ── Shared atlas ─────────────────────────────────────────────────── */
+/* An atlas is never written after loading, so games that draw the same
+ * textures hold references to one copy instead of 224 KB each. */
+typedef struct SharedAtlas {
+    TextureAtlas atlas;
+    atomic_int   refs;
+} SharedAtlas;
+
+/**  Start sa's count at one reference (the loader's); fill sa->atlas
+ *   with render_atlas_load() or render_atlas_solid() first. */
+void render_atlas_share(SharedAtlas *sa);
+
+/**  Take another reference to sa.  Thread-safe. */
+void render_atlas_retain(SharedAtlas *sa);
+
+/**  Drop a reference.  Returns true when it was the last one. */
+bool render_atlas_release(SharedAtlas *sa);
+
+/**  Fill every texture with its fallback colour (COL_WALL, COL_SPRITE). */
+void render_atlas_solid(TextureAtlas *atlas);
+
+/**  Load both atlas strips from uncompressed 24- or 32-bit BMP files,
+ *   without SDL.  A strip that cannot be read falls back to its solid
+ *   colour.  Returns false if either file was unusable. */
+bool render_atlas_load(TextureAtlas *atlas, const char *tiles_path,
+                       const char *sprites_path);
+
+/**  Draw one frame in software: ceiling and floor, textured wall strips
+ *   from gs->hits (y-side hits darkened), then gs->visible_sprites
+ *   against gs->z_buffer.  fb holds SCREEN_H rows of `stride` pixels.
+ *   Reads gs and atlas only, so frames may be drawn concurrently. */
+void render_frame(const GameState *gs, const TextureAtlas *atlas,
+                  uint32_t *fb, int stride);
+
+/* ── Auxiliary outputs ────────────────────────────────────────────── */
+/* Written in the same pass as the colour, pixel for pixel: the
+ * perpendicular distance of whatever was drawn (floor and ceiling at
+ * their row distance) and its object ID (MAKE_ID in game_globals.h).
+ * Either buffer may be NULL; both use the colour buffer's stride. */
+typedef struct RenderAux {
+    float    *depth;              /* map units from the camera plane     */
+    uint32_t *ids;                /* ID_KIND / ID_MATERIAL / ID_OBJECT   */
+} RenderAux;
+
+/**  render_frame() that also fills aux->depth and aux->ids. */
+void render_frame_aux(const GameState *gs, const TextureAtlas *atlas,
+                      uint32_t *fb, int stride, const RenderAux *aux);
+
+/* ── Parallel drawing ─────────────────────────────────────────────── */
+#define RENDER_BAND_W  64         /* fewest columns per render job       */
+
+struct JobPool;
+
+/**  render_frame_aux() (aux may be NULL) split into column bands on
+ *   pool; NULL draws on the caller.  Pixels are identical either way. */
+void render_frame_jobs(const GameState *gs, const TextureAtlas *atlas,
+                       uint32_t *fb, int stride, const RenderAux *aux,
+                       struct JobPool *pool);
+
+#endif /* RENDER_H */
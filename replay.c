@@ -0,0 +1,229 @@
+/*  replay.c  –  compact binary log of per-tick input
+ *  ─────────────────────────────────────────────────────────────────
+ *  The simulation is deterministic for a given map, spawn, tick length
+ *  and input sequence, so a session is fully described by those.  Input
+ *  changes rarely between ticks, so it is stored as runs.
+ *
+ *  File layout (all integers little-endian):
+ *    0  "RCRP"                magic
+ *    4  u16 version           REPLAY_VERSION
+ *    6  u16 flags             REPLAY_CHASE, …
+ *    8  f32 dt
+ *   12  u64 map hash
+ *   20  6 × f32               spawn x, y, dir_x, dir_y, plane_x, plane_y
+ *   44  i32 npc count
+ *   48  runs: u8 input bits, varint run length (LEB128)
+ *       u8 0xFF               end of runs
+ *       u64 ticks, u64 final state hash
+ */
+#include "replay.h"
+#include "sim.h"
+
+#include <string.h>
+
+#define REPLAY_VERSION  1
+#define HEADER_BYTES    48
+#define RUN_END         0xFF     /* input bits never reach this value   */
+
+/* ── Little-endian helpers ─────────────────────────────────────────── */
+
+static void put_u32(uint8_t *b, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) b[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t get_u32(const uint8_t *b)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)b[i] << (8 * i);
+    return v;
+}
+
+static void put_u64(uint8_t *b, uint64_t v)
+{
+    put_u32(b,     (uint32_t)v);
+    put_u32(b + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t get_u64(const uint8_t *b)
+{
+    return get_u32(b) | ((uint64_t)get_u32(b + 4) << 32);
+}
+
+static void put_f32(uint8_t *b, float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    put_u32(b, v);
+}
+
+static float get_f32(const uint8_t *b)
+{
+    uint32_t v = get_u32(b);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+/* ── Runs ──────────────────────────────────────────────────────────── */
+
+static void write_run(Replay *r)
+{
+    if (r->run_left == 0) return;
+    fputc(r->run_bits, r->fp);
+    uint32_t n = r->run_left;
+    do {
+        uint8_t byte = n & 0x7F;
+        n >>= 7;
+        fputc(n ? byte | 0x80 : byte, r->fp);
+    } while (n);
+    r->run_left = 0;
+}
+
+static bool read_varint(FILE *fp, uint32_t *out)
+{
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int c = fgetc(fp);
+        if (c == EOF) return false;
+        v |= (uint32_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ── Writing ───────────────────────────────────────────────────────── */
+
+bool replay_open_write(Replay *r, const char *path, const ReplayHeader *h)
+{
+    memset(r, 0, sizeof(*r));
+    r->fp = fopen(path, "wb");
+    if (!r->fp) {
+        fprintf(stderr, "replay_open_write: cannot create '%s'\n", path);
+        return false;
+    }
+    r->writing = true;
+    r->header  = *h;
+
+    uint8_t hdr[HEADER_BYTES];
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, "RCRP", 4);
+    hdr[4] = REPLAY_VERSION & 0xFF;
+    hdr[5] = REPLAY_VERSION >> 8;
+    hdr[6] = h->flags & 0xFF;
+    hdr[7] = h->flags >> 8;
+    put_f32(hdr + 8,  h->dt);
+    put_u64(hdr + 12, h->map_hash);
+    put_f32(hdr + 20, h->spawn.x);
+    put_f32(hdr + 24, h->spawn.y);
+    put_f32(hdr + 28, h->spawn.dir_x);
+    put_f32(hdr + 32, h->spawn.dir_y);
+    put_f32(hdr + 36, h->spawn.plane_x);
+    put_f32(hdr + 40, h->spawn.plane_y);
+    put_u32(hdr + 44, (uint32_t)h->npc_count);
+
+    if (fwrite(hdr, 1, sizeof(hdr), r->fp) != sizeof(hdr)) {
+        fprintf(stderr, "replay_open_write: write error on '%s'\n", path);
+        fclose(r->fp);
+        r->fp = NULL;
+        return false;
+    }
+    return true;
+}
+
+void replay_record(Replay *r, const Input *in)
+{
+    uint8_t bits = (uint8_t)sim_pack_input(in);
+    if (r->run_left > 0 && (bits != r->run_bits || r->run_left == UINT32_MAX))
+        write_run(r);
+    r->run_bits = bits;
+    r->run_left++;
+    r->ticks++;
+}
+
+bool replay_close_write(Replay *r, uint64_t state_hash)
+{
+    write_run(r);
+    uint8_t footer[1 + 16];
+    footer[0] = RUN_END;
+    put_u64(footer + 1, r->ticks);
+    put_u64(footer + 9, state_hash);
+
+    bool ok = fwrite(footer, 1, sizeof(footer), r->fp) == sizeof(footer);
+    ok = fclose(r->fp) == 0 && ok;
+    r->fp = NULL;
+    if (!ok) fprintf(stderr, "replay_close_write: write error\n");
+    return ok;
+}
+
+/* ── Reading ───────────────────────────────────────────────────────── */
+
+bool replay_open_read(Replay *r, const char *path)
+{
+    memset(r, 0, sizeof(*r));
+    r->fp = fopen(path, "rb");
+    if (!r->fp) {
+        fprintf(stderr, "replay_open_read: cannot open '%s'\n", path);
+        return false;
+    }
+
+    uint8_t hdr[HEADER_BYTES];
+    if (fread(hdr, 1, sizeof(hdr), r->fp) != sizeof(hdr)
+        || memcmp(hdr, "RCRP", 4) != 0
+        || (hdr[4] | (hdr[5] << 8)) != REPLAY_VERSION) {
+        fprintf(stderr, "replay_open_read: '%s' is not a version %d replay\n",
+                path, REPLAY_VERSION);
+        fclose(r->fp);
+        r->fp = NULL;
+        return false;
+    }
+
+    ReplayHeader *h = &r->header;
+    h->dt            = get_f32(hdr + 8);
+    h->map_hash      = get_u64(hdr + 12);
+    h->spawn.x       = get_f32(hdr + 20);
+    h->spawn.y       = get_f32(hdr + 24);
+    h->spawn.dir_x   = get_f32(hdr + 28);
+    h->spawn.dir_y   = get_f32(hdr + 32);
+    h->spawn.plane_x = get_f32(hdr + 36);
+    h->spawn.plane_y = get_f32(hdr + 40);
+    h->npc_count     = (int32_t)get_u32(hdr + 44);
+    h->flags         = (uint16_t)(hdr[6] | (hdr[7] << 8));
+    return true;
+}
+
+bool replay_next(Replay *r, Input *in)
+{
+    while (r->run_left == 0) {
+        int c = fgetc(r->fp);
+        if (c == EOF) {
+            fprintf(stderr, "replay_next: log truncated after %llu ticks\n",
+                    (unsigned long long)r->ticks);
+            return false;
+        }
+        if (c == RUN_END) {
+            uint8_t footer[16];
+            if (fread(footer, 1, sizeof(footer), r->fp) == sizeof(footer)) {
+                r->end_ticks = get_u64(footer);
+                r->end_hash  = get_u64(footer + 8);
+            }
+            return false;
+        }
+        r->run_bits = (uint8_t)c;
+        if (!read_varint(r->fp, &r->run_left)) return false;
+    }
+
+    sim_unpack_input((unsigned)r->run_bits, in);
+    r->run_left--;
+    r->ticks++;
+    return true;
+}
+
+void replay_close(Replay *r)
+{
+    if (r->fp) fclose(r->fp);
+    r->fp = NULL;
+}
@@ -0,0 +1,53 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "game_globals.h"
+
+#include <stdio.h>
+
+/* ── Session header: everything needed to recreate tick 0 ─────────── */
+typedef struct ReplayHeader {
+    uint64_t map_hash;           /* map_hash() of the starting map      */
+    float    dt;                 /* seconds per tick                    */
+    Player   spawn;              /* player pose at tick 0               */
+    int32_t  npc_count;          /* wanderers from ent_populate(…, 1)   */
+    uint16_t flags;              /* REPLAY_* session options            */
+} ReplayHeader;
+
+#define REPLAY_CHASE  1u         /* flags: npcs follow the player's flow*/
+
+/* ── Input log, run-length encoded ────────────────────────────────── */
+typedef struct Replay {
+    FILE        *fp;
+    bool         writing;
+    ReplayHeader header;
+    uint8_t      run_bits;       /* input of the current run            */
+    uint32_t     run_left;       /* writer: run length; reader: ticks   */
+                                 /* still to return from this run       */
+    uint64_t     ticks;          /* ticks written / read so far         */
+    uint64_t     end_ticks;      /* reader: tick count from the footer  */
+    uint64_t     end_hash;       /* reader: final state hash (footer)   */
+} Replay;
+
+/**  Create a log and write its header.  Returns false on I/O failure. */
+bool replay_open_write(Replay *r, const char *path, const ReplayHeader *h);
+
+/**  Append one tick's input. */
+void replay_record(Replay *r, const Input *in);
+
+/**  Flush the last run, write the footer (tick count and state_hash of
+ *   the final state) and close.  Returns false on I/O failure. */
+bool replay_close_write(Replay *r, uint64_t state_hash);
+
+/**  Open a log and read its header.  Returns false if the file is
+ *   missing or not a replay of this version. */
+bool replay_open_read(Replay *r, const char *path);
+
+/**  Next tick's input.  Returns false at the end of the log, after which
+ *   end_ticks and end_hash are valid. */
+bool replay_next(Replay *r, Input *in);
+
+/**  Close a log opened for reading. */
+void replay_close(Replay *r);
+
+#endif /* REPLAY_H */
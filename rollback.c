@@ -0,0 +1,297 @@
+/*  rollback.c  –  delta-compressed snapshot ring for rollback and resim
+ *  ─────────────────────────────────────────────────────────────────
+ *  Each tick the authoritative state (SimState pose and flags, the
+ *  entity arrays and the tile plane) is flattened into a fixed-layout
+ *  image.  The ring keeps the newest image raw and every older one as
+ *  an XOR delta against its successor, with unchanged bytes skipped by
+ *  run-length coding.  Rolling back N ticks decodes N small deltas and
+ *  writes the image back into the world; resimulating runs the stored
+ *  inputs forward again through sim_world_tick().
+ *  No SDL headers.  No allocation: everything lives in the Rollback.
+ */
+#include "rollback.h"
+#include "map_edit.h"
+
+#include <string.h>
+
+_Static_assert(sizeof(Player) + 4 * sizeof(int32_t) == RB_HEADER_SIZE,
+               "RB_HEADER_SIZE does not match the image header");
+
+#define RB_MIN_GAP 8             /* shorter equal runs stay in a literal*/
+
+/* ── State image ───────────────────────────────────────────────────── */
+
+static size_t put_array(uint8_t *img, size_t at, const void *src, size_t n)
+{
+    memcpy(img + at, src, n);
+    return at + n;
+}
+
+static size_t get_array(const uint8_t *img, size_t at, void *dst, size_t n)
+{
+    memcpy(dst, img + at, n);
+    return at + n;
+}
+
+/** Flatten the world into img.  Returns the image size. */
+static size_t capture(uint8_t *img, const SimWorld *w)
+{
+    const SimState *st = &w->state;
+    const Map      *m  = w->map;
+    int n = w->npcs.count;
+    int32_t hdr[4] = { st->game_over, st->damage_taken, n, m->w * m->h };
+
+    size_t at = put_array(img, 0, &st->player, sizeof(Player));
+    at = put_array(img, at, hdr, sizeof(hdr));
+    at = put_array(img, at, w->npcs.x,  (size_t)n * sizeof(float));
+    at = put_array(img, at, w->npcs.y,  (size_t)n * sizeof(float));
+    at = put_array(img, at, w->npcs.vx, (size_t)n * sizeof(float));
+    at = put_array(img, at, w->npcs.vy, (size_t)n * sizeof(float));
+    at = put_array(img, at, w->npcs.texture_id, (size_t)n * sizeof(uint16_t));
+    at = put_array(img, at, w->npcs.damage, (size_t)n * sizeof(uint16_t));
+    for (int r = 0; r < m->h; r++)
+        at = put_array(img, at, m->tiles[r], (size_t)m->w * sizeof(uint16_t));
+    return at;
+}
+
+/** Write an image back into the world. */
+static void apply(SimWorld *w, const uint8_t *img)
+{
+    SimState *st = &w->state;
+    Map      *m  = w->map;
+    int32_t hdr[4];
+
+    size_t at = get_array(img, 0, &st->player, sizeof(Player));
+    at = get_array(img, at, hdr, sizeof(hdr));
+    st->game_over    = hdr[0];
+    st->damage_taken = hdr[1];
+    st->events.count = 0;
+
+    int n = hdr[2];
+    w->npcs.count = n;
+    at = get_array(img, at, w->npcs.x,  (size_t)n * sizeof(float));
+    at = get_array(img, at, w->npcs.y,  (size_t)n * sizeof(float));
+    at = get_array(img, at, w->npcs.vx, (size_t)n * sizeof(float));
+    at = get_array(img, at, w->npcs.vy, (size_t)n * sizeof(float));
+    at = get_array(img, at, w->npcs.texture_id, (size_t)n * sizeof(uint16_t));
+    at = get_array(img, at, w->npcs.damage, (size_t)n * sizeof(uint16_t));
+
+    /* Only the cells that differ, and through the change log, so the
+     * occupancy grid and trigger index resync incrementally */
+    for (int r = 0; r < m->h; r++)
+        for (int c = 0; c < m->w; c++) {
+            uint16_t v;
+            at = get_array(img, at, &v, sizeof(v));
+            if (m->tiles[r][c] == v) continue;
+            if (st->cow) w->map = m = map_cow_write(st->cow);
+            map_set_tile(m, c, r, v);
+        }
+
+    /* Nothing to blend from after a jump in time */
+    w->prev_player = st->player;
+    memcpy(w->npc_prev_x, w->npcs.x, (size_t)n * sizeof(float));
+    memcpy(w->npc_prev_y, w->npcs.y, (size_t)n * sizeof(float));
+}
+
+/* ── Delta coding ──────────────────────────────────────────────────── */
+/* A delta is a list of (equal run, literal length, literal XOR bytes),
+ * lengths as LEB128.  Equal runs shorter than RB_MIN_GAP are folded
+ * into the literal, so the encoding never exceeds the image by more
+ * than one token header. */
+
+static size_t put_varint(uint8_t *b, uint32_t n)
+{
+    size_t i = 0;
+    do {
+        uint8_t byte = n & 0x7F;
+        n >>= 7;
+        b[i++] = n ? byte | 0x80 : byte;
+    } while (n);
+    return i;
+}
+
+static size_t get_varint(const uint8_t *b, uint32_t *out)
+{
+    uint32_t v = 0;
+    size_t   i = 0;
+    for (int shift = 0; ; shift += 7) {
+        uint8_t byte = b[i++];
+        v |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    *out = v;
+    return i;
+}
+
+static size_t encode_delta(uint8_t *out, const uint8_t *a, const uint8_t *b,
+                           size_t n)
+{
+    size_t o = 0, i = 0;
+    while (i < n) {
+        size_t lit = i;
+        while (lit < n && a[lit] == b[lit]) lit++;
+
+        size_t end = lit, gap = 0;
+        for (size_t j = lit; j < n; j++) {
+            if (a[j] != b[j]) {
+                end = j + 1;
+                gap = 0;
+            } else if (++gap == RB_MIN_GAP) {
+                break;
+            }
+        }
+
+        o += put_varint(out + o, (uint32_t)(lit - i));
+        o += put_varint(out + o, (uint32_t)(end - lit));
+        for (size_t k = lit; k < end; k++)
+            out[o++] = a[k] ^ b[k];
+        i = end;
+    }
+    return o;
+}
+
+/** XOR a delta into img, turning one side of the pair into the other. */
+static void apply_delta(uint8_t *img, const uint8_t *d, size_t size)
+{
+    size_t at = 0, i = 0;
+    while (i < size) {
+        uint32_t skip, lit;
+        i += get_varint(d + i, &skip);
+        i += get_varint(d + i, &lit);
+        at += skip;
+        for (uint32_t k = 0; k < lit; k++)
+            img[at++] ^= d[i++];
+    }
+}
+
+/* ── Ring ──────────────────────────────────────────────────────────── */
+
+static RbEntry *entry(Rollback *rb, int i)
+{
+    return &rb->entries[(rb->first + i) % RB_MAX_TICKS];
+}
+
+static void drop_oldest(Rollback *rb)
+{
+    rb->first = (rb->first + 1) % RB_MAX_TICKS;
+    rb->count--;
+}
+
+static bool overlaps(uint32_t a, uint32_t an, uint32_t b, uint32_t bn)
+{
+    return a < b + bn && b < a + an;
+}
+
+/** Reserve size bytes at the pool head, evicting the oldest deltas it
+ *  would overwrite.  Deltas sit in allocation order, so the first one
+ *  in the way is always the oldest. */
+static uint32_t pool_alloc(Rollback *rb, uint32_t size)
+{
+    uint32_t at = rb->pool_head;
+    if (at + size > RB_POOL_SIZE) {
+        /* Wrap: anything stored past the head predates the start */
+        while (rb->count > 0 && entry(rb, 0)->offset >= at)
+            drop_oldest(rb);
+        at = 0;
+    }
+    while (rb->count > 0) {
+        const RbEntry *old = entry(rb, 0);
+        if (!overlaps(at, size, old->offset, old->size)) break;
+        drop_oldest(rb);
+    }
+    if (rb->count == 0) at = 0;
+    rb->pool_head = at + size;
+    return at;
+}
+
+static void push(Rollback *rb, const Input *in, size_t size)
+{
+    if (rb->count == RB_MAX_TICKS) drop_oldest(rb);
+    uint32_t at = pool_alloc(rb, (uint32_t)size);
+    memcpy(rb->pool + at, rb->delta, size);
+
+    RbEntry *e = entry(rb, rb->count++);
+    e->tick   = rb->head_tick;
+    e->input  = *in;
+    e->offset = at;
+    e->size   = (uint32_t)size;
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+void rb_reset(Rollback *rb, const SimWorld *w, uint64_t tick)
+{
+    rb->first      = 0;
+    rb->count      = 0;
+    rb->pool_head  = 0;
+    rb->image_size = capture(rb->image, w);
+    rb->head_tick  = tick;
+    rb->map_epoch  = w->map_epoch;
+}
+
+void rb_advance(Rollback *rb, SimWorld *w, const Input *in, float dt)
+{
+    if (rb->image_size == 0 || rb->map_epoch != w->map_epoch)
+        rb_reset(rb, w, rb->head_tick);
+
+    sim_world_tick(w, in, dt);
+
+    /* A new level shares nothing with the old one: start over */
+    size_t n = capture(rb->next, w);
+    if (rb->map_epoch != w->map_epoch || n != rb->image_size) {
+        rb_reset(rb, w, rb->head_tick + 1);
+        return;
+    }
+
+    push(rb, in, encode_delta(rb->delta, rb->image, rb->next, n));
+    memcpy(rb->image, rb->next, n);
+    rb->head_tick++;
+}
+
+uint64_t rb_oldest(const Rollback *rb)
+{
+    return rb->count ? rb->entries[rb->first].tick : rb->head_tick;
+}
+
+bool rb_restore(Rollback *rb, SimWorld *w, uint64_t tick)
+{
+    if (rb->image_size == 0 || rb->map_epoch != w->map_epoch ||
+        tick > rb->head_tick || tick < rb_oldest(rb))
+        return false;
+
+    while (rb->head_tick > tick) {
+        const RbEntry *e = entry(rb, rb->count - 1);
+        apply_delta(rb->image, rb->pool + e->offset, e->size);
+        rb->pool_head = e->offset;
+        rb->head_tick = e->tick;
+        rb->count--;
+    }
+    apply(w, rb->image);
+    return true;
+}
+
+int rb_resimulate(Rollback *rb, SimWorld *w, uint64_t tick,
+                  const Input *in, float dt)
+{
+    if (tick >= rb->head_tick || tick < rb_oldest(rb)) return -1;
+
+    Input inputs[RB_MAX_TICKS];
+    int n = (int)(rb->head_tick - tick);
+    int from = (int)(tick - rb_oldest(rb));
+    for (int i = 0; i < n; i++)
+        inputs[i] = entry(rb, from + i)->input;
+    inputs[0] = *in;
+
+    if (!rb_restore(rb, w, tick)) return -1;
+    for (int i = 0; i < n; i++)
+        rb_advance(rb, w, &inputs[i], dt);
+    return n;
+}
+
+size_t rb_bytes(const Rollback *rb)
+{
+    size_t total = 0;
+    for (int i = 0; i < rb->count; i++)
+        total += rb->entries[(rb->first + i) % RB_MAX_TICKS].size;
+    return total;
+}
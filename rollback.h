@@ -0,0 +1,70 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "game_globals.h"
+#include "entity.h"
+#include "sim.h"
+
+/* ── Rollback limits ──────────────────────────────────────────────── */
+#define RB_MAX_TICKS   256       /* snapshots kept (~4 s at 60 Hz)      */
+#define RB_POOL_SIZE   (1 << 20) /* delta bytes shared by the ring      */
+
+/* Raw state image: pose and flags, the entity arrays, then the tiles */
+#define RB_HEADER_SIZE 40
+#define RB_IMAGE_MAX   (RB_HEADER_SIZE \
+                        + MAX_ENTITIES * (4 * sizeof(float) + 2 * sizeof(uint16_t)) \
+                        + MAP_MAX_W * MAP_MAX_H * sizeof(uint16_t))
+#define RB_DELTA_MAX   (RB_IMAGE_MAX + 16) /* worst-case encoding    */
+
+/* ── Snapshot ring ────────────────────────────────────────────────── */
+/* The newest state is kept as a raw image.  Every older tick is stored
+ * as the XOR of its image with the next one, run-length encoded, so a
+ * tick that moved the player and a few entities costs tens of bytes.
+ * Restoring walks the deltas back from the newest image. */
+typedef struct RbEntry {
+    uint64_t tick;               /* state this delta restores           */
+    Input    input;              /* input that advanced tick to tick+1  */
+    uint32_t offset;             /* encoded delta in pool               */
+    uint32_t size;
+} RbEntry;
+
+typedef struct Rollback {
+    RbEntry  entries[RB_MAX_TICKS]; /* ring, oldest at first            */
+    int      first, count;
+    uint8_t  pool[RB_POOL_SIZE];    /* circular, in allocation order    */
+    uint32_t pool_head;             /* where the next delta goes        */
+    uint8_t  image[RB_IMAGE_MAX];   /* state at head_tick               */
+    uint8_t  next[RB_IMAGE_MAX];    /* scratch for the following tick   */
+    uint8_t  delta[RB_DELTA_MAX];   /* scratch for encoding             */
+    size_t   image_size;            /* fixed while map_epoch holds      */
+    uint64_t head_tick;
+    uint32_t map_epoch;             /* world epoch of the images        */
+} Rollback;
+
+/**  Forget every snapshot and take the current world as `tick`.
+ *   Also done automatically when the level changes. */
+void rb_reset(Rollback *rb, const SimWorld *w, uint64_t tick);
+
+/**  Run one tick with sim_world_tick() and keep a snapshot of the state
+ *   it started from, together with the input it used. */
+void rb_advance(Rollback *rb, SimWorld *w, const Input *in, float dt);
+
+/**  Oldest tick that can still be restored. */
+uint64_t rb_oldest(const Rollback *rb);
+
+/**  Put the world back to the start of `tick` and drop every newer
+ *   snapshot.  Tile edits go through map_set_tile() so derived data
+ *   (occupancy, trigger index) catches up on the next tick.  Returns
+ *   false if tick is not in [rb_oldest(), head_tick]. */
+bool rb_restore(Rollback *rb, SimWorld *w, uint64_t tick);
+
+/**  Replace the input used at `tick` and resimulate up to the current
+ *   head with the recorded inputs of the later ticks.  Returns the
+ *   number of ticks run, or -1 if tick is no longer kept. */
+int rb_resimulate(Rollback *rb, SimWorld *w, uint64_t tick,
+                  const Input *in, float dt);
+
+/**  Delta bytes currently held by the ring. */
+size_t rb_bytes(const Rollback *rb);
+
+#endif /* ROLLBACK_H */
@@ -0,0 +1,562 @@
+/*  server.c  –  localhost control server: remote input in, state and frames out
+ *  ─────────────────────────────────────────────────────────────────
+ *  A bot, test harness or remote viewer connects over a Unix-domain
+ *  socket or loopback TCP, sends input bits, and gets back state deltas
+ *  (only the fields that changed since it last heard) and optionally
+ *  frames, XOR-coded against the last frame it received so a still
+ *  scene costs a few bytes.  One thread runs a poll() loop over
+ *  non-blocking sockets; the render thread never touches a socket.
+ *  No SDL headers.  POSIX sockets + poll.
+ */
+#define _POSIX_C_SOURCE 200809L  /* socket(), poll(), pipe(), fcntl() */
+
+#include "server.h"
+#include "memstat.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SRV_MIN_GAP  2            /* shorter equal runs stay in a literal*/
+#define MSG_HEADER   8            /* u32 type + u32 length               */
+
+/* ── Frame coding ──────────────────────────────────────────────────── */
+/* Like the rollback deltas, but over whole pixels: a list of (equal
+ * run, literal length, literal XOR words), lengths as LEB128.  Every
+ * token but the last ends in at least SRV_MIN_GAP equal pixels, so the
+ * coding never outgrows the raw frame by more than one token header. */
+
+static size_t put_varint(uint8_t *b, uint32_t n)
+{
+    size_t i = 0;
+    do {
+        uint8_t byte = n & 0x7F;
+        n >>= 7;
+        b[i++] = n ? byte | 0x80 : byte;
+    } while (n);
+    return i;
+}
+
+/** Bounded: returns 0 on a truncated or over-long varint. */
+static size_t get_varint(const uint8_t *b, size_t len, uint32_t *out)
+{
+    uint32_t v = 0;
+    for (size_t i = 0; i < len && i < 5; i++) {
+        v |= (uint32_t)(b[i] & 0x7F) << (7 * i);
+        if (!(b[i] & 0x80)) {
+            *out = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/** Code cur against prev into out.  False if cap is too small. */
+static bool encode_frame(uint8_t *out, size_t cap, size_t *len,
+                         const uint32_t *cur, const uint32_t *prev, int n)
+{
+    size_t o = 0;
+    int    i = 0;
+    while (i < n) {
+        int lit = i;
+        while (lit < n && cur[lit] == prev[lit]) lit++;
+        if (lit == n) break;                     /* the rest is unchanged */
+
+        int end = lit, gap = 0;
+        for (int j = lit; j < n; j++) {
+            if (cur[j] != prev[j]) {
+                end = j + 1;
+                gap = 0;
+            } else if (++gap == SRV_MIN_GAP) {
+                break;
+            }
+        }
+
+        if (cap - o < 10 + (size_t)(end - lit) * 4) return false;
+        o += put_varint(out + o, (uint32_t)(lit - i));
+        o += put_varint(out + o, (uint32_t)(end - lit));
+        for (int k = lit; k < end; k++) {
+            uint32_t x = cur[k] ^ prev[k];
+            memcpy(out + o, &x, 4);
+            o += 4;
+        }
+        i = end;
+    }
+    *len = o;
+    return true;
+}
+
+bool srv_frame_apply(uint32_t *frame, const uint8_t *data, size_t len)
+{
+    const size_t n = (size_t)SCREEN_W * SCREEN_H;
+    size_t at = 0, i = 0;
+    while (i < len) {
+        uint32_t skip, lit;
+        size_t a = get_varint(data + i, len - i, &skip);
+        if (!a) return false;
+        i += a;
+        size_t b = get_varint(data + i, len - i, &lit);
+        if (!b) return false;
+        i += b;
+        if (skip > n - at || lit > n - at - skip || lit > (len - i) / 4)
+            return false;
+        at += skip;
+        for (uint32_t k = 0; k < lit; k++, i += 4) {
+            uint32_t x;
+            memcpy(&x, data + i, 4);
+            frame[at++] ^= x;
+        }
+    }
+    return true;
+}
+
+/* ── State deltas ──────────────────────────────────────────────────── */
+
+static unsigned state_changes(const SrvState *now, const SrvState *seen)
+{
+    unsigned m = 0;
+    if (now->tick != seen->tick)                                 m |= SRV_F_TICK;
+    if (memcmp(&now->player, &seen->player, sizeof(Player)))    m |= SRV_F_POSE;
+    if (now->game_over != seen->game_over)                       m |= SRV_F_GAME_OVER;
+    if (now->damage_taken != seen->damage_taken)                 m |= SRV_F_DAMAGE;
+    if (now->map_epoch != seen->map_epoch
+        || now->map_revision != seen->map_revision)              m |= SRV_F_MAP;
+    return m;
+}
+
+static size_t put(uint8_t *b, size_t o, const void *v, size_t n)
+{
+    memcpy(b + o, v, n);
+    return o + n;
+}
+
+static size_t encode_state(uint8_t *b, unsigned mask, const SrvState *s)
+{
+    uint32_t m = mask;
+    size_t   o = put(b, 0, &m, 4);
+    if (mask & SRV_F_TICK)      o = put(b, o, &s->tick, 8);
+    if (mask & SRV_F_POSE)      o = put(b, o, &s->player, sizeof(Player));
+    if (mask & SRV_F_GAME_OVER) o = put(b, o, &s->game_over, 4);
+    if (mask & SRV_F_DAMAGE)    o = put(b, o, &s->damage_taken, 4);
+    if (mask & SRV_F_MAP) {
+        o = put(b, o, &s->map_epoch, 4);
+        o = put(b, o, &s->map_revision, 4);
+    }
+    return o;
+}
+
+/** Read n bytes at *o into v if they are there. */
+static bool take(const uint8_t *b, size_t len, size_t *o, void *v, size_t n)
+{
+    if (len - *o < n) return false;
+    memcpy(v, b + *o, n);
+    *o += n;
+    return true;
+}
+
+bool srv_state_apply(SrvState *st, const uint8_t *data, size_t len)
+{
+    SrvState s = *st;
+    uint32_t m;
+    size_t   o = 0;
+    bool ok = take(data, len, &o, &m, 4);
+    if (ok && (m & SRV_F_TICK))      ok = take(data, len, &o, &s.tick, 8);
+    if (ok && (m & SRV_F_POSE))      ok = take(data, len, &o, &s.player, sizeof(Player));
+    if (ok && (m & SRV_F_GAME_OVER)) ok = take(data, len, &o, &s.game_over, 4);
+    if (ok && (m & SRV_F_DAMAGE))    ok = take(data, len, &o, &s.damage_taken, 4);
+    if (ok && (m & SRV_F_MAP))       ok = take(data, len, &o, &s.map_epoch, 4)
+                                          && take(data, len, &o, &s.map_revision, 4);
+    if (!ok || o != len) return false;
+    *st = s;
+    return true;
+}
+
+/* ── Sockets ───────────────────────────────────────────────────────── */
+
+static bool set_nonblocking(int fd)
+{
+    int fl = fcntl(fd, F_GETFL);
+    return fl >= 0 && fcntl(fd, F_SETFL, fl | O_NONBLOCK) == 0;
+}
+
+static int listen_unix(Server *srv, const char *path)
+{
+    struct sockaddr_un sa = { .sun_family = AF_UNIX };
+    if (!*path || strlen(path) >= sizeof(sa.sun_path)) {
+        fprintf(stderr, "srv_start: bad socket path '%s'\n", path);
+        return -1;
+    }
+    strcpy(sa.sun_path, path);
+
+    /* A socket file left by a crashed run would make bind() fail */
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) { perror("srv_start: socket"); return -1; }
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) {
+        perror("srv_start: bind");
+        close(fd);
+        return -1;
+    }
+    snprintf(srv->path, sizeof(srv->path), "%s", path);
+    return fd;
+}
+
+static int listen_tcp(Server *srv, const char *port)
+{
+    char *end;
+    long p = strtol(port, &end, 10);
+    if (!*port || *end || p < 0 || p > 65535) {
+        fprintf(stderr, "srv_start: bad port '%s'\n", port);
+        return -1;
+    }
+    struct sockaddr_in sa = {
+        .sin_family = AF_INET,
+        .sin_port   = htons((uint16_t)p),
+        .sin_addr   = { htonl(INADDR_LOOPBACK) },  /* never off-host */
+    };
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { perror("srv_start: socket"); return -1; }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    socklen_t sl = sizeof(sa);
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0
+        || getsockname(fd, (struct sockaddr *)&sa, &sl) != 0) {
+        perror("srv_start: bind");
+        close(fd);
+        return -1;
+    }
+    srv->port = ntohs(sa.sin_port);
+    return fd;
+}
+
+/* ── Connections ───────────────────────────────────────────────────── */
+
+static void update_input(Server *srv)
+{
+    unsigned bits = 0;
+    for (int i = 0; i < SRV_MAX_CLIENTS; i++)
+        if (srv->clients[i].fd >= 0) bits |= srv->clients[i].input;
+    if (atomic_exchange(&srv->input, bits) != bits && srv->on_input)
+        srv->on_input(srv->on_input_arg);
+}
+
+static void drop_client(Server *srv, SrvClient *c)
+{
+    close(c->fd);
+    c->fd = -1;
+    if (c->subs & SRV_SUB_FRAMES) atomic_fetch_sub(&srv->frame_subs, 1);
+    c->subs = 0;
+    update_input(srv);
+}
+
+static void accept_clients(Server *srv)
+{
+    for (;;) {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        if (fd < 0) return;                      /* EAGAIN: none waiting */
+
+        SrvClient *c = NULL;
+        for (int i = 0; i < SRV_MAX_CLIENTS && !c; i++)
+            if (srv->clients[i].fd < 0) c = &srv->clients[i];
+        if (!c || !set_nonblocking(fd)) {
+            close(fd);
+            continue;
+        }
+        int one = 1;                             /* fails on AF_UNIX: fine */
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        c->fd         = fd;
+        c->subs       = 0;
+        c->input      = 0;
+        c->in_len     = 0;
+        c->out_len    = 0;
+        c->out_sent   = 0;
+        c->have_state = false;
+        c->frame_seq  = 0;
+        memset(c->prev, 0, sizeof(c->prev));     /* what the client starts from */
+    }
+}
+
+static void handle_message(Server *srv, SrvClient *c, uint32_t type,
+                           const uint8_t *body, uint32_t len)
+{
+    uint32_t v;
+    if (len != 4) return;                        /* unknown shape: ignore */
+    memcpy(&v, body, 4);
+    if (type == SRV_MSG_INPUT) {
+        c->input = v;
+        update_input(srv);
+    } else if (type == SRV_MSG_SUBSCRIBE) {
+        bool had = c->subs & SRV_SUB_FRAMES, has = v & SRV_SUB_FRAMES;
+        if (has != had) atomic_fetch_add(&srv->frame_subs, has ? 1 : -1);
+        if (!(c->subs & SRV_SUB_STATE)) c->have_state = false;
+        c->subs = v & (SRV_SUB_STATE | SRV_SUB_FRAMES);
+    }
+}
+
+/** Read what is there and act on every whole message.  False = drop. */
+static bool read_client(Server *srv, SrvClient *c)
+{
+    for (;;) {
+        ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len, 0);
+        if (n == 0) return false;                /* peer closed */
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        c->in_len += (size_t)n;
+
+        size_t o = 0;
+        while (c->in_len - o >= MSG_HEADER) {
+            uint32_t type, len;
+            memcpy(&type, c->in + o, 4);
+            memcpy(&len,  c->in + o + 4, 4);
+            if (len > sizeof(c->in) - MSG_HEADER) return false;
+            if (c->in_len - o < MSG_HEADER + len) break;
+            handle_message(srv, c, type, c->in + o + MSG_HEADER, len);
+            o += MSG_HEADER + len;
+        }
+        memmove(c->in, c->in + o, c->in_len - o);
+        c->in_len -= o;
+    }
+}
+
+/** Write as much as the socket takes.  False = drop. */
+static bool flush_client(SrvClient *c)
+{
+    while (c->out_sent < c->out_len) {
+        ssize_t n = send(c->fd, c->out + c->out_sent, c->out_len - c->out_sent,
+                         MSG_NOSIGNAL);
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        c->out_sent += (size_t)n;
+    }
+    c->out_len = c->out_sent = 0;
+    return true;
+}
+
+/** Room for a message of `len` payload bytes, after compacting. */
+static uint8_t *begin_message(SrvClient *c, uint32_t type, size_t room)
+{
+    if (c->out_sent) {
+        memmove(c->out, c->out + c->out_sent, c->out_len - c->out_sent);
+        c->out_len -= c->out_sent;
+        c->out_sent = 0;
+    }
+    if (sizeof(c->out) - c->out_len < MSG_HEADER + room) return NULL;
+    memcpy(c->out + c->out_len, &type, 4);
+    return c->out + c->out_len + MSG_HEADER;
+}
+
+static void end_message(SrvClient *c, size_t len)
+{
+    uint32_t l = (uint32_t)len;
+    memcpy(c->out + c->out_len + 4, &l, 4);
+    c->out_len += MSG_HEADER + len;
+}
+
+/* ── Broadcast ─────────────────────────────────────────────────────── */
+
+static void send_state(SrvClient *c, const SrvState *now)
+{
+    unsigned mask = c->have_state ? state_changes(now, &c->sent)
+                                  : SRV_F_TICK | SRV_F_POSE | SRV_F_GAME_OVER
+                                    | SRV_F_DAMAGE | SRV_F_MAP;
+    if (!mask) return;
+    uint8_t *b = begin_message(c, SRV_MSG_STATE, 4 + sizeof(SrvState));
+    if (!b) return;                              /* retried next round */
+    end_message(c, encode_state(b, mask, now));
+    c->sent       = *now;
+    c->have_state = true;
+}
+
+/** At most one frame in flight per client: a slow one skips frames
+ *  and later gets the newest, coded against what it actually has. */
+static void send_frame(Server *srv, SrvClient *c, const uint32_t *px,
+                       uint64_t seq)
+{
+    if (c->out_len > c->out_sent) return;
+    uint8_t *b = begin_message(c, SRV_MSG_FRAME, 4);
+    if (!b) return;
+    uint32_t no = (uint32_t)seq;
+    size_t   len;
+    memcpy(b, &no, 4);
+    if (!encode_frame(b + 4, sizeof(c->out) - c->out_len - MSG_HEADER - 4, &len,
+                      px, c->prev, SCREEN_W * SCREEN_H))
+        return;
+    end_message(c, 4 + len);
+    memcpy(c->prev, px, sizeof(c->prev));
+    if (c->frame_seq) srv->frames_skipped += seq - c->frame_seq - 1;
+    c->frame_seq = seq;
+}
+
+static void broadcast(Server *srv)
+{
+    unsigned ss = sim_triple_acquire(&srv->state_buf);
+    unsigned fs = sim_triple_acquire(&srv->frame_buf);
+    const SrvState *state = srv->state_seq[ss] ? &srv->states[ss] : NULL;
+    uint64_t        seq   = srv->frame_seq[fs];
+
+    for (int i = 0; i < SRV_MAX_CLIENTS; i++) {
+        SrvClient *c = &srv->clients[i];
+        if (c->fd < 0) continue;
+        if ((c->subs & SRV_SUB_STATE) && state) send_state(c, state);
+        if ((c->subs & SRV_SUB_FRAMES) && seq > c->frame_seq)
+            send_frame(srv, c, srv->frames[fs], seq);
+    }
+}
+
+/* ── Event loop ────────────────────────────────────────────────────── */
+
+static int server_main(void *arg)
+{
+    Server *srv = arg;
+    struct pollfd fds[2 + SRV_MAX_CLIENTS];
+    SrvClient    *polled[SRV_MAX_CLIENTS];
+
+    while (!atomic_load(&srv->quit)) {
+        int n = 0, nc = 0;
+        fds[n++] = (struct pollfd){ .fd = srv->wake[0],   .events = POLLIN };
+        fds[n++] = (struct pollfd){ .fd = srv->listen_fd, .events = POLLIN };
+        for (int i = 0; i < SRV_MAX_CLIENTS; i++) {
+            SrvClient *c = &srv->clients[i];
+            if (c->fd < 0) continue;
+            short ev = POLLIN | (c->out_len > c->out_sent ? POLLOUT : 0);
+            fds[n++] = (struct pollfd){ .fd = c->fd, .events = ev };
+            polled[nc++] = c;
+        }
+        if (poll(fds, (nfds_t)n, SRV_POLL_MS) < 0 && errno != EINTR) {
+            perror("srv: poll");
+            break;
+        }
+
+        char drain[64];
+        if (fds[0].revents & POLLIN)
+            while (read(srv->wake[0], drain, sizeof(drain)) > 0) {}
+        if (fds[1].revents & POLLIN) accept_clients(srv);
+        for (int i = 0; i < nc; i++)
+            if ((fds[2 + i].revents & (POLLIN | POLLHUP | POLLERR))
+                && !read_client(srv, polled[i]))
+                drop_client(srv, polled[i]);
+
+        broadcast(srv);
+        for (int i = 0; i < SRV_MAX_CLIENTS; i++) {
+            SrvClient *c = &srv->clients[i];
+            if (c->fd >= 0 && c->out_len > c->out_sent && !flush_client(c))
+                drop_client(srv, c);
+        }
+    }
+    return 0;
+}
+
+static void wake(Server *srv)
+{
+    char b = 1;
+    if (write(srv->wake[1], &b, 1) < 0) {}       /* full pipe: already woken */
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+bool srv_start(Server *srv, const char *addr)
+{
+    srv->listen_fd = -1;
+    srv->running   = false;
+    srv->port      = 0;
+    srv->path[0]   = '\0';
+    srv->wake[0] = srv->wake[1] = -1;
+    srv->frames_skipped = 0;
+    srv->state_next = srv->frame_next = 0;
+    memset(srv->state_seq, 0, sizeof(srv->state_seq));
+    memset(srv->frame_seq, 0, sizeof(srv->frame_seq));
+    atomic_init(&srv->quit, false);
+    atomic_init(&srv->input, 0u);
+    atomic_init(&srv->frame_subs, 0);
+    sim_triple_init(&srv->state_buf);
+    sim_triple_init(&srv->frame_buf);
+    for (int i = 0; i < SRV_MAX_CLIENTS; i++) srv->clients[i].fd = -1;
+
+    if (!addr) addr = "";
+    if (strncmp(addr, "unix:", 5) == 0)     srv->listen_fd = listen_unix(srv, addr + 5);
+    else if (strncmp(addr, "tcp:", 4) == 0) srv->listen_fd = listen_tcp(srv, addr + 4);
+    else {
+        fprintf(stderr, "srv_start: address '%s' is not unix:PATH or tcp:PORT\n", addr);
+        return false;
+    }
+    if (srv->listen_fd < 0) return false;
+
+    if (listen(srv->listen_fd, SRV_MAX_CLIENTS) != 0
+        || !set_nonblocking(srv->listen_fd)
+        || pipe(srv->wake) != 0
+        || !set_nonblocking(srv->wake[0]) || !set_nonblocking(srv->wake[1])) {
+        perror("srv_start: listen");
+        srv_stop(srv);
+        return false;
+    }
+    if (thrd_create(&srv->thread, server_main, srv) != thrd_success) {
+        fprintf(stderr, "srv_start: cannot start the server thread\n");
+        srv_stop(srv);
+        return false;
+    }
+    srv->running = true;
+    mem_account(MEM_FRAMES, sizeof(*srv));
+    return true;
+}
+
+void srv_stop(Server *srv)
+{
+    if (srv->running) {
+        atomic_store(&srv->quit, true);
+        wake(srv);
+        thrd_join(srv->thread, NULL);
+        srv->running = false;
+        mem_release(MEM_FRAMES, sizeof(*srv));
+    }
+    for (int i = 0; i < SRV_MAX_CLIENTS; i++)
+        if (srv->clients[i].fd >= 0) drop_client(srv, &srv->clients[i]);
+    if (srv->wake[0] >= 0) close(srv->wake[0]);
+    if (srv->wake[1] >= 0) close(srv->wake[1]);
+    srv->wake[0] = srv->wake[1] = -1;
+    if (srv->listen_fd >= 0) close(srv->listen_fd);
+    srv->listen_fd = -1;
+    if (srv->path[0]) unlink(srv->path);
+    srv->path[0] = '\0';
+}
+
+unsigned srv_input(Server *srv)
+{
+    return atomic_load(&srv->input);
+}
+
+void srv_publish_state(Server *srv, const SrvState *st)
+{
+    unsigned b = srv->state_buf.back;
+    srv->states[b]    = *st;
+    srv->state_seq[b] = ++srv->state_next;
+    sim_triple_publish(&srv->state_buf);
+    wake(srv);
+}
+
+bool srv_wants_frames(Server *srv)
+{
+    return atomic_load(&srv->frame_subs) > 0;
+}
+
+uint32_t *srv_frame_begin(Server *srv)
+{
+    return srv->frames[srv->frame_buf.back];
+}
+
+void srv_frame_publish(Server *srv)
+{
+    srv->frame_seq[srv->frame_buf.back] = ++srv->frame_next;
+    sim_triple_publish(&srv->frame_buf);
+    wake(srv);
+}
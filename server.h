@@ -0,0 +1,120 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "game_globals.h"
+#include "sim.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <threads.h>
+
+/* ── Local control server ─────────────────────────────────────────── */
+#define SRV_MAX_CLIENTS  4        /* connections served at once          */
+#define SRV_IN_BYTES     256      /* per-client receive buffer           */
+#define SRV_OUT_BYTES    (SCREEN_W * SCREEN_H * 4 + 4096) /* coded frame bound */
+#define SRV_POLL_MS      100      /* event loop wake-up without traffic  */
+#define SRV_ADDR_MAX     108      /* "unix:/path" or "tcp:PORT"          */
+
+/* ── Wire format (native byte order: the peer is on the same host) ── */
+/* Every message is a u32 type, a u32 payload length, then the payload. */
+#define SRV_MSG_INPUT     1u      /* → u32 input bits (sim_pack_input)   */
+#define SRV_MSG_SUBSCRIBE 2u      /* → u32 SRV_SUB_* flags               */
+#define SRV_MSG_STATE     16u     /* ← u32 SRV_F_* mask, changed fields  */
+#define SRV_MSG_FRAME     17u     /* ← u32 frame no., coded XOR delta    */
+
+#define SRV_SUB_STATE     1u      /* send state deltas                   */
+#define SRV_SUB_FRAMES    2u      /* send frames                         */
+
+#define SRV_F_TICK        1u      /* u64 tick                            */
+#define SRV_F_POSE        2u      /* Player                              */
+#define SRV_F_GAME_OVER   4u      /* i32                                 */
+#define SRV_F_DAMAGE      8u      /* i32                                 */
+#define SRV_F_MAP         16u     /* u32 epoch, u32 revision             */
+
+/* What a state message describes; a client applies each delta to its
+ * own copy with srv_state_apply(). */
+typedef struct SrvState {
+    uint64_t tick;
+    Player   player;
+    int32_t  game_over;
+    int32_t  damage_taken;
+    uint32_t map_epoch;
+    uint32_t map_revision;
+} SrvState;
+
+typedef struct SrvClient {
+    int      fd;                  /* -1 = free                           */
+    unsigned subs;                /* SRV_SUB_* flags                     */
+    unsigned input;               /* last input bits it sent             */
+    uint8_t  in[SRV_IN_BYTES];
+    size_t   in_len;
+    uint8_t  out[SRV_OUT_BYTES];
+    size_t   out_len, out_sent;
+    SrvState sent;                /* state as this client last saw it    */
+    bool     have_state;
+    uint64_t frame_seq;           /* last frame queued to it, 0 = none   */
+    uint32_t prev[SCREEN_H * SCREEN_W]; /* frame as this client has it  */
+} SrvClient;
+
+/* The render thread hands states and frames over through triple buffers
+ * (the same scheme as the simulation snapshots) and pokes a wake-up
+ * pipe; the server thread owns every socket and never blocks on one.
+ * A client whose send buffer is too full for the next frame skips it. */
+typedef struct Server {
+    int          listen_fd;
+    int          wake[2];         /* self-pipe: render thread → loop     */
+    int          port;            /* bound TCP port (tcp: addresses)     */
+    char         path[SRV_ADDR_MAX]; /* socket file (unix: addresses)   */
+    thrd_t       thread;
+    bool         running;         /* thread started                      */
+    atomic_bool  quit;
+    atomic_uint  input;           /* OR of every client's input bits     */
+    void       (*on_input)(void *arg); /* input changed, NULL = no hook */
+    void        *on_input_arg;
+    atomic_int   frame_subs;      /* clients subscribed to frames        */
+
+    TripleBuffer state_buf;
+    SrvState     states[3];
+    uint64_t     state_seq[3], state_next; /* 0 = slot never published */
+    TripleBuffer frame_buf;
+    uint32_t     frames[3][SCREEN_H * SCREEN_W];
+    uint64_t     frame_seq[3], frame_next;
+    uint64_t     frames_skipped;  /* frames a client was too slow for    */
+
+    SrvClient    clients[SRV_MAX_CLIENTS];
+} Server;
+
+/**  Listen on addr ("unix:/path/to.sock" or "tcp:PORT" on 127.0.0.1;
+ *   port 0 picks a free one, stored in srv->port) and start the event
+ *   loop thread.  If srv->on_input is set beforehand, the loop calls it
+ *   whenever srv_input() changes, so an idle render loop can wake up.
+ *   Returns false on a bad address or socket error. */
+bool srv_start(Server *srv, const char *addr);
+
+/**  Stop the loop, close every connection and remove the socket file. */
+void srv_stop(Server *srv);
+
+/**  OR of the input bits the connected clients last sent (any thread). */
+unsigned srv_input(Server *srv);
+
+/**  Queue the current state for every state subscriber (render thread). */
+void srv_publish_state(Server *srv, const SrvState *st);
+
+/**  True while at least one client wants frames (any thread). */
+bool srv_wants_frames(Server *srv);
+
+/**  The SCREEN_W x SCREEN_H buffer to draw the next frame into, then
+ *   srv_frame_publish() (render thread). */
+uint32_t *srv_frame_begin(Server *srv);
+void      srv_frame_publish(Server *srv);
+
+/**  Client side: apply a SRV_MSG_STATE payload to st.  Returns false
+ *   if the payload is malformed. */
+bool srv_state_apply(SrvState *st, const uint8_t *data, size_t len);
+
+/**  Client side: apply the coded part of a SRV_MSG_FRAME payload (after
+ *   the frame number) to `frame`, which holds the previous frame (zeros
+ *   before the first).  Returns false if the data is malformed. */
+bool srv_frame_apply(uint32_t *frame, const uint8_t *data, size_t len);
+
+#endif /* SERVER_H */
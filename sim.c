@@ -0,0 +1,360 @@
+/*  sim.c  –  fixed-rate simulation thread with snapshot publishing
+ *  ─────────────────────────────────────────────────────────────────
+ *  The simulation thread owns the world (map, player, entities, level
+ *  and stream state) and ticks it at SIM_TICK_RATE on its own clock.
+ *  After each batch of ticks it copies what the renderer needs into a
+ *  SimSnapshot and publishes it through a triple buffer, so a slow
+ *  frame never delays a tick and a slow tick never blocks a frame.
+ *  No SDL headers.  C11 threads and atomics, the POSIX monotonic clock
+ *  for the tick schedule.
+ */
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime(CLOCK_MONOTONIC) */
+
+#include "sim.h"
+#include "jobs.h"
+#include "memstat.h"
+#include "raycaster.h"
+#include "replay.h"
+#include "trigger.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ── Triple buffer ─────────────────────────────────────────────────── */
+
+void sim_triple_init(TripleBuffer *tb)
+{
+    tb->back  = 0;
+    tb->front = 1;
+    atomic_init(&tb->middle, 2u);
+}
+
+unsigned sim_triple_publish(TripleBuffer *tb)
+{
+    unsigned prev = atomic_exchange_explicit(&tb->middle,
+                                             tb->back | SIM_SLOT_FRESH,
+                                             memory_order_acq_rel);
+    tb->back = prev & ~SIM_SLOT_FRESH;
+    return tb->back;
+}
+
+unsigned sim_triple_acquire(TripleBuffer *tb)
+{
+    if (atomic_load_explicit(&tb->middle, memory_order_relaxed)
+        & SIM_SLOT_FRESH) {
+        unsigned prev = atomic_exchange_explicit(&tb->middle, tb->front,
+                                                 memory_order_acq_rel);
+        tb->front = prev & ~SIM_SLOT_FRESH;
+    }
+    return tb->front;
+}
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static void remember_previous(SimWorld *w)
+{
+    int n = w->npcs.count;
+    w->prev_player = w->state.player;
+    memcpy(w->npc_prev_x, w->npcs.x, (size_t)n * sizeof(float));
+    memcpy(w->npc_prev_y, w->npcs.y, (size_t)n * sizeof(float));
+}
+
+/** Copy the world into the writer's slot and publish it. */
+static void publish(Sim *sim, uint64_t tick, double tick_time)
+{
+    const SimWorld *w = &sim->world;
+    SimSnapshot    *s = &sim->snaps[sim->buffer.back];
+
+    s->tick         = tick;
+    s->tick_time    = tick_time;
+    s->dt           = sim->dt;
+    s->prev_player  = w->prev_player;
+    s->player       = w->state.player;
+    s->game_over    = w->state.game_over;
+    s->damage_taken = w->state.damage_taken;
+
+    /* The map is large and rarely changes: copy it only when this slot
+     * holds an older revision or a different level */
+    if (s->map_epoch != w->map_epoch || s->map.revision != w->map->revision) {
+        memcpy(&s->map, w->map, sizeof(s->map));
+        s->map_epoch = w->map_epoch;
+    }
+
+    int n = w->npcs.count;
+    s->npcs.count = n;
+    memcpy(s->npcs.x,  w->npcs.x,  (size_t)n * sizeof(float));
+    memcpy(s->npcs.y,  w->npcs.y,  (size_t)n * sizeof(float));
+    memcpy(s->npcs.texture_id, w->npcs.texture_id,
+           (size_t)n * sizeof(uint16_t));
+    memcpy(s->npc_prev_x, w->npc_prev_x, (size_t)n * sizeof(float));
+    memcpy(s->npc_prev_y, w->npc_prev_y, (size_t)n * sizeof(float));
+
+    sim_triple_publish(&sim->buffer);
+}
+
+/* ── World step ────────────────────────────────────────────────────── */
+
+#define SIM_ENT_GRAIN 1024       /* fewest entities per update job      */
+
+typedef struct EntJob {
+    EntityPool         *npcs;
+    const MapOccupancy *occupancy;
+    float               dt;
+} EntJob;
+
+static void update_entities(void *arg, int begin, int end)
+{
+    const EntJob *j = arg;
+    ent_update_range(j->npcs, j->occupancy, j->dt, begin, end);
+}
+
+/** Entities fire the same triggers as the player: one cell lookup per
+ *  entity, queued and dispatched like the player's events.  A full
+ *  queue is dispatched early rather than dropping events. */
+static void touch_entities(SimWorld *w)
+{
+    SimState   *st = &w->state;
+    EntityPool *ep = &w->npcs;
+    for (int i = 0; i < ep->count; i++) {
+        if (st->events.count == MAX_EVENTS)
+            trig_dispatch(st->triggers, &st->events, st, w->map, ep);
+        trig_touch(st->triggers, w->map, &st->events, i,
+                   w->npc_prev_x[i], w->npc_prev_y[i], ep->x[i], ep->y[i]);
+    }
+    trig_dispatch(st->triggers, &st->events, st, w->map, ep);
+    if (st->cow) w->map = st->cow->map;      /* a switch privatised it */
+}
+
+void sim_world_tick(SimWorld *w, const Input *in, float dt)
+{
+    remember_previous(w);
+    w->state.npcs = &w->npcs;                 /* doors never close on them */
+    rc_update(&w->state, w->map, in, dt);
+    if (w->state.cow) w->map = w->state.cow->map;   /* privatised by a door */
+    map_occupancy_sync(w->occupancy, w->map);
+    if (w->jumps) path_sync(w->jumps, w->map);
+
+    /* Chasers share one field toward the player's cell */
+    if (w->flows) {
+        flow_sync(w->flows, w->map, w->jobs);
+        const FlowField *f = flow_get(w->flows, w->map,
+                                      (int)w->state.player.x,
+                                      (int)w->state.player.y);
+        if (f) flow_steer(f, &w->npcs);
+    }
+    EntJob ej = { &w->npcs, w->occupancy, dt };
+    job_parallel_for(w->jobs, 0, w->npcs.count, SIM_ENT_GRAIN,
+                     update_entities, &ej);
+    touch_entities(w);
+
+    /* Commit streamed chunks and prefetch around the player */
+    if (w->stream) {
+        map_stream_update(w->stream, w->map, &w->state.player);
+        if (w->stream_triggers) trig_sync(w->stream_triggers, w->map);
+    }
+
+    /* Player reached the endgame trigger: swap in the preloaded next
+     * level, or leave game_over set after the last one */
+    if (w->state.game_over && w->levels && level_advance(w->levels)) {
+        Level *lv = w->levels->active;
+        w->map = &lv->map;
+        memset(&w->state, 0, sizeof(w->state));
+        w->state.player   = lv->spawn;
+        w->state.triggers = &lv->triggers;
+        w->occupancy      = &lv->occupancy;
+        w->jumps          = &lv->jumps;
+        w->map_epoch++;
+        if (w->flows) flow_clear(w->flows);
+        ent_populate(&w->npcs, w->occupancy, w->npc_count,
+                     (uint32_t)w->levels->current + 1);
+        remember_previous(w);        /* no blending across levels */
+    }
+}
+
+/* ── State hash ────────────────────────────────────────────────────── */
+
+static uint64_t fnv_bytes(uint64_t h, const void *data, size_t n)
+{
+    const uint8_t *b = data;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ b[i]) * 0x100000001b3ull;
+    return h;
+}
+
+uint64_t sim_world_hash(const SimWorld *w)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    const Player *p = &w->state.player;
+    float pose[6] = { p->x, p->y, p->dir_x, p->dir_y, p->plane_x, p->plane_y };
+    int32_t flags[4] = {
+        w->state.game_over, w->state.damage_taken, w->npcs.count,
+        w->levels ? w->levels->current : 0,
+    };
+    h = fnv_bytes(h, pose, sizeof(pose));
+    h = fnv_bytes(h, flags, sizeof(flags));
+    /* Tile contents rather than map->revision: a rollback restores the
+     * tiles but can only move the revision forward */
+    for (int r = 0; r < w->map->h; r++)
+        h = fnv_bytes(h, w->map->tiles[r],
+                      (size_t)w->map->w * sizeof(w->map->tiles[r][0]));
+
+    size_t n = (size_t)w->npcs.count * sizeof(float);
+    h = fnv_bytes(h, w->npcs.x,  n);
+    h = fnv_bytes(h, w->npcs.y,  n);
+    h = fnv_bytes(h, w->npcs.vx, n);
+    h = fnv_bytes(h, w->npcs.vy, n);
+    return h;
+}
+
+/* ── Input packing ─────────────────────────────────────────────────── */
+
+unsigned sim_pack_input(const Input *in)
+{
+    return (in->forward    ? 1u : 0u) | (in->back       ? 2u : 0u)
+         | (in->turn_left  ? 4u : 0u) | (in->turn_right ? 8u : 0u);
+}
+
+void sim_unpack_input(unsigned bits, Input *in)
+{
+    in->forward    = bits & 1u;
+    in->back       = bits & 2u;
+    in->turn_left  = bits & 4u;
+    in->turn_right = bits & 8u;
+}
+
+/* ── Thread ────────────────────────────────────────────────────────── */
+
+static int sim_thread(void *arg)
+{
+    Sim     *sim  = arg;
+    uint64_t tick = 0;
+    double   next = sim_clock();
+
+    while (!atomic_load(&sim->quit)) {
+        Input in;
+        sim_unpack_input(atomic_load(&sim->input), &in);
+
+        /* Run every tick that is due, but never spiral after a stall */
+        double now  = sim_clock();
+        double last = next;
+        int    ran  = 0;
+        while (now >= next && ran < SIM_MAX_CATCHUP) {
+            if (sim->record) replay_record(sim->record, &in);
+            sim_world_tick(&sim->world, &in, sim->dt);
+            last  = next;
+            next += sim->dt;
+            tick++;
+            ran++;
+        }
+        if (ran == SIM_MAX_CATCHUP) next = now;
+        if (ran > 0) publish(sim, tick, last);
+
+        /* Sleep until the next tick is due */
+        double wait = next - sim_clock();
+        if (wait > 0.0) {
+            struct timespec ts = {
+                .tv_sec  = (time_t)wait,
+                .tv_nsec = (long)((wait - (double)(time_t)wait) * 1e9),
+            };
+            thrd_sleep(&ts, NULL);
+        }
+    }
+    return 0;
+}
+
+/** Report the world and the three snapshots: map copies as map data,
+ *  entity pools and their history as entities, the rest as sim. */
+static void account(const Sim *sim, bool hold)
+{
+    const SimWorld *w = &sim->world;
+    const SimSnapshot *s = &sim->snaps[0];
+    size_t maps = sizeof(s->map) * 3;
+    size_t ents = sizeof(w->npcs) + sizeof(w->npc_prev_x) + sizeof(w->npc_prev_y)
+                + (sizeof(s->npcs) + sizeof(s->npc_prev_x)
+                   + sizeof(s->npc_prev_y)) * 3;
+    void (*op)(MemTag, size_t) = hold ? mem_account : mem_release;
+    op(MEM_MAP, maps);
+    op(MEM_ENTITIES, ents);
+    op(MEM_SIM, sizeof(*sim) - maps - ents);
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+bool sim_start(Sim *sim)
+{
+    sim_triple_init(&sim->buffer);
+    atomic_init(&sim->input, 0u);
+    atomic_init(&sim->quit, false);
+    if (sim->world.map_epoch == 0) sim->world.map_epoch = 1;
+    if (sim->dt <= 0.0f) sim->dt = SIM_DT;
+
+    /* The renderer must always find a valid snapshot */
+    remember_previous(&sim->world);
+    publish(sim, 0, sim_clock());
+    sim_triple_acquire(&sim->buffer);
+
+    if (thrd_create(&sim->thread, sim_thread, sim) != thrd_success) {
+        fprintf(stderr, "sim_start: cannot start simulation thread\n");
+        return false;
+    }
+    account(sim, true);
+    return true;
+}
+
+void sim_set_input(Sim *sim, const Input *in)
+{
+    atomic_store(&sim->input, sim_pack_input(in));
+}
+
+const SimSnapshot *sim_latest(Sim *sim)
+{
+    return &sim->snaps[sim_triple_acquire(&sim->buffer)];
+}
+
+double sim_clock(void)
+{
+    /* Monotonic: a wall-clock step must not freeze or rush the ticks */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+float sim_alpha(const SimSnapshot *s, double now)
+{
+    float alpha = (float)((now - s->tick_time) / s->dt);
+    if (alpha < 0.0f) return 0.0f;
+    if (alpha > 1.0f) return 1.0f;
+    return alpha;
+}
+
+bool sim_snapshot_still(const SimSnapshot *s)
+{
+    if (memcmp(&s->player, &s->prev_player, sizeof(Player)) != 0) return false;
+    size_t n = (size_t)s->npcs.count * sizeof(float);
+    return memcmp(s->npcs.x, s->npc_prev_x, n) == 0
+        && memcmp(s->npcs.y, s->npc_prev_y, n) == 0;
+}
+
+void sim_lerp_npcs(const SimSnapshot *s, float alpha, EntityPool *out)
+{
+    int n = s->npcs.count;
+    for (int i = 0; i < n; i++) {
+        float px = s->npc_prev_x[i], py = s->npc_prev_y[i];
+        float dx = s->npcs.x[i] - px, dy = s->npcs.y[i] - py;
+        /* A teleport jumps, as in rc_lerp_player(), not slides */
+        float a  = dx * dx + dy * dy > LERP_SNAP_DIST * LERP_SNAP_DIST
+                 ? 1.0f : alpha;
+        out->x[i] = px + dx * a;
+        out->y[i] = py + dy * a;
+    }
+    memcpy(out->texture_id, s->npcs.texture_id, (size_t)n * sizeof(uint16_t));
+    out->count = n;
+}
+
+void sim_stop(Sim *sim)
+{
+    atomic_store(&sim->quit, true);
+    thrd_join(sim->thread, NULL);
+    account(sim, false);
+}
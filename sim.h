@@ -0,0 +1,136 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "game_globals.h"
+#include "entity.h"
+#include "flow.h"
+#include "level.h"
+#include "map_stream.h"
+#include "path.h"
+#include "trigger.h"
+
+#include <stdatomic.h>
+#include <threads.h>
+
+/* ── Simulation timing ────────────────────────────────────────────── */
+#define SIM_TICK_RATE    60      /* logic updates per second            */
+#define SIM_DT           (1.0f / SIM_TICK_RATE)
+#define SIM_MAX_CATCHUP  15      /* ticks run back-to-back after a stall*/
+
+/* ── Published simulation state (read-only for the render thread) ─── */
+typedef struct SimSnapshot {
+    uint64_t   tick;             /* ticks simulated so far              */
+    double     tick_time;        /* sim_clock() when the last tick ran  */
+    float      dt;               /* seconds per tick                    */
+    Player     prev_player;      /* pose before the last tick           */
+    Player     player;
+    bool       game_over;
+    int        damage_taken;
+    uint32_t   map_epoch;        /* SimWorld.map_epoch of this map copy */
+    Map        map;              /* re-copied only when the map changed */
+    EntityPool npcs;             /* only [0, npcs.count) is copied      */
+    float      npc_prev_x[MAX_ENTITIES]; /* positions before last tick */
+    float      npc_prev_y[MAX_ENTITIES];
+} SimSnapshot;
+
+/* ── Lock-free triple buffer of slot indices ──────────────────────── */
+/* The writer fills slot `back`, then swaps it with `middle`; the reader
+ * swaps `middle` into `front` when the fresh bit is set.  Neither side
+ * ever waits and each slot is owned by exactly one side at a time. */
+#define SIM_SLOT_FRESH 4u        /* set in middle when it holds new data*/
+
+typedef struct TripleBuffer {
+    atomic_uint middle;          /* slot index | SIM_SLOT_FRESH         */
+    unsigned    back;            /* writer-owned slot                   */
+    unsigned    front;           /* reader-owned slot                   */
+} TripleBuffer;
+
+/* ── World owned by the simulation thread ─────────────────────────── */
+typedef struct SimWorld {
+    Map          *map;
+    SimState      state;         /* player, triggers, events            */
+    MapOccupancy *occupancy;     /* collision bits for entities         */
+    JumpTable    *jumps;         /* pathfinding table, NULL = none      */
+    FlowCache    *flows;         /* NPCs chase the player, NULL = wander*/
+    EntityPool    npcs;
+    int           npc_count;     /* wanderers spawned per level         */
+    Player        prev_player;   /* state before the latest tick, kept  */
+    float         npc_prev_x[MAX_ENTITIES]; /* for render interpolation */
+    float         npc_prev_y[MAX_ENTITIES];
+    LevelManager *levels;        /* NULL unless playing a level list    */
+    MapStream    *stream;        /* NULL unless streaming               */
+    TriggerSet   *stream_triggers; /* resynced after streaming updates  */
+    uint32_t      map_epoch;     /* bumped whenever *map is replaced    */
+    struct JobPool *jobs;        /* shared workers, NULL = tick alone   */
+} SimWorld;
+
+struct Replay;                   /* input log, see replay.h             */
+
+typedef struct Sim {
+    SimWorld     world;          /* sim thread only, once started       */
+    SimSnapshot  snaps[3];
+    TripleBuffer buffer;
+    float        dt;             /* seconds per tick, 0 = SIM_DT        */
+    struct Replay *record;       /* per-tick input log, NULL = off      */
+    atomic_uint  input;          /* latest Input, packed as bits        */
+    atomic_bool  quit;
+    thrd_t       thread;
+} Sim;
+
+/**  Reset a triple buffer: writer owns slot 0, reader slot 1. */
+void sim_triple_init(TripleBuffer *tb);
+
+/**  Writer: publish the back slot.  Returns the next slot to fill. */
+unsigned sim_triple_publish(TripleBuffer *tb);
+
+/**  Reader: take the newest published slot if there is one.  Returns
+ *   the slot to read, which stays valid until the next acquire. */
+unsigned sim_triple_acquire(TripleBuffer *tb);
+
+/**  Advance the world by one fixed step: player, triggers, entities
+ *   (steered along the player's flow field when chasing) and the
+ *   triggers they touch, streaming, and the switch to the next level
+ *   on reaching the endgame.  The state before the step is kept for
+ *   interpolation. */
+void sim_world_tick(SimWorld *w, const Input *in, float dt);
+
+/**  FNV-1a hash of the simulated state (player, game flags, entities,
+ *   tiles and level).  Equal hashes after a replay mean the run
+ *   was reproduced exactly. */
+uint64_t sim_world_hash(const SimWorld *w);
+
+/**  Input as a 4-bit mask, for the atomic hand-off and the replay log. */
+unsigned sim_pack_input(const Input *in);
+void     sim_unpack_input(unsigned bits, Input *in);
+
+/**  Publish an initial snapshot of sim->world and start the thread,
+ *   which then ticks every sim->dt seconds (SIM_DT if 0).
+ *   Returns false on failure. */
+bool sim_start(Sim *sim);
+
+/**  Hand the current input to the simulation (any thread). */
+void sim_set_input(Sim *sim, const Input *in);
+
+/**  Newest published snapshot (render thread only). */
+const SimSnapshot *sim_latest(Sim *sim);
+
+/**  Monotonic clock used for tick times (seconds, arbitrary origin). */
+double sim_clock(void);
+
+/**  How far the render time `now` lies between the snapshot's last two
+ *   ticks: 0 = prev_player, 1 = player.  Clamped to [0, 1]. */
+float sim_alpha(const SimSnapshot *s, double now);
+
+/**  True if the snapshot's last tick moved nothing: the player and every
+ *   entity are where they were before it, so any alpha draws the same. */
+bool sim_snapshot_still(const SimSnapshot *s);
+
+/**  Fill out with the snapshot's entities blended at alpha.  Entities
+ *   that moved further than LERP_SNAP_DIST (teleports) are drawn where
+ *   they arrived. */
+void sim_lerp_npcs(const SimSnapshot *s, float alpha, EntityPool *out);
+
+/**  Stop and join the simulation thread. */
+void sim_stop(Sim *sim);
+
+#endif /* SIM_H */
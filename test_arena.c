@@ -0,0 +1,285 @@
+/*  test_arena.c  –  unit tests for the frame arena
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against arena.o, raycaster.o and jobs.o — no SDL dependency.
+ *  Checks bump allocation, alignment, O(1) reset and release, failure
+ *  accounting and the per-thread arenas, then that a cast returns its
+ *  scratch, sizes it by the map and survives a full arena.  Finally
+ *  prints the scratch a serial and a parallel cast really need.
+ *  Build:  make test
+ *  Run:    ./test_arena
+ */
+#include "arena.h"
+#include "jobs.h"
+#include "raycaster.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+static alignas(ARENA_ALIGN) unsigned char buf[1024];
+
+/** A w x h room with a ring of sprites around the middle. */
+static void build_map(Map *m, int w, int h)
+{
+    memset(m, 0, sizeof(*m));
+    m->w = w;
+    m->h = h;
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++) {
+            if (x == 0 || y == 0 || x == w - 1 || y == h - 1)
+                m->tiles[y][x] = 1;
+            else if ((x + y) % 5 == 0)
+                m->sprites[y][x] = 1;
+        }
+}
+
+static void place_player(GameState *gs, float x, float y, float angle)
+{
+    memset(gs, 0, sizeof(*gs));
+    gs->player.x = x;
+    gs->player.y = y;
+    gs->player.dir_x = cosf(angle);
+    gs->player.dir_y = sinf(angle);
+    gs->player.plane_x = -gs->player.dir_y * 0.66f;
+    gs->player.plane_y =  gs->player.dir_x * 0.66f;
+}
+
+/* Runs fn on a new thread, so it starts with a fresh thread arena */
+typedef struct Probe {
+    void      (*fn)(struct Probe *);
+    const Map  *map;
+    JobPool    *pool;
+    Arena      *arena;            /* that thread's arena                 */
+    size_t      used, high;       /* its marks when fn returned          */
+    unsigned    failed;
+    int         sprites;
+} Probe;
+
+static int probe_main(void *arg)
+{
+    Probe *p = arg;
+    p->arena = arena_thread();
+    if (p->fn) p->fn(p);
+    p->used   = p->arena->used;
+    p->high   = p->arena->high;
+    p->failed = p->arena->failed;
+    return 0;
+}
+
+static void run_probe(Probe *p)
+{
+    thrd_t t;
+    assert(thrd_create(&t, probe_main, p) == thrd_success);
+    thrd_join(t, NULL);
+}
+
+static void cast_serial(Probe *p)
+{
+    static GameState gs;
+    place_player(&gs, p->map->w / 2.0f + 0.5f, p->map->h / 2.0f + 0.5f, 0.3f);
+    rc_cast(&gs, p->map);
+    p->sprites = gs.visible_sprite_count;
+}
+
+static void cast_pooled(Probe *p)
+{
+    static GameState gs;
+    place_player(&gs, p->map->w / 2.0f + 0.5f, p->map->h / 2.0f + 0.5f, 0.3f);
+    rc_cast_jobs(&gs, p->map, p->pool);
+    p->sprites = gs.visible_sprite_count;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Arena tests                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_alloc_bumps_aligned(void)
+{
+    Arena a;
+    arena_init(&a, buf, sizeof(buf));
+    unsigned char *p = arena_alloc(&a, 3);
+    unsigned char *q = arena_alloc(&a, 5);
+    assert(p == buf);
+    assert(q == buf + ARENA_ALIGN);
+    assert((uintptr_t)q % ARENA_ALIGN == 0);
+    assert(a.used == ARENA_ALIGN + 5);
+    assert(a.high == a.used);
+}
+
+static void test_alloc_fails_when_full(void)
+{
+    Arena a;
+    arena_init(&a, buf, sizeof(buf));
+    assert(arena_alloc(&a, 1000) != NULL);
+    assert(arena_alloc(&a, 100) == NULL);
+    assert(a.failed == 1);
+    assert(a.used == 1000);
+    /* The mark records what would have been needed */
+    assert(a.high == 1008 + 100);
+    assert(arena_alloc(&a, SIZE_MAX) == NULL);
+    assert(a.failed == 2);
+    assert(arena_alloc(&a, 16) != NULL);
+}
+
+static void test_reset_and_release(void)
+{
+    Arena a;
+    arena_init(&a, buf, sizeof(buf));
+    arena_alloc(&a, 100);
+    size_t m = arena_mark(&a);
+    unsigned char *p = arena_alloc(&a, 200);
+    arena_release(&a, m);
+    assert(a.used == 100);
+    assert(arena_alloc(&a, 200) == p);
+    arena_reset(&a);
+    assert(a.used == 0);
+    assert(arena_alloc(&a, 1) == buf);
+    assert(a.high == 112 + 200);          /* marks outlive resets */
+}
+
+static void test_thread_arenas_are_separate(void)
+{
+    Probe p = {0};
+    run_probe(&p);
+    Arena *mine = arena_thread();
+    assert(mine == arena_thread());
+    assert(p.arena != mine);
+    assert(mine->cap == ARENA_THREAD_SIZE);
+    assert((uintptr_t)mine->base % ARENA_ALIGN == 0);
+}
+
+static void test_peak_folds_across_threads(void)
+{
+    Arena *a = arena_thread();
+    size_t m = arena_mark(a);
+    arena_alloc(a, 5000);
+    arena_alloc(a, ARENA_THREAD_SIZE);    /* fails */
+    arena_release(a, m);
+    unsigned failed;
+    size_t peak = arena_thread_peak(&failed);
+    assert(peak >= 5008 + ARENA_THREAD_SIZE);
+    assert(failed >= 1);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Cast scratch tests                                                */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_cast_returns_scratch(void)
+{
+    static Map map;
+    static GameState gs;
+    build_map(&map, 20, 20);
+    Arena *a = arena_thread();
+    arena_alloc(a, 24);
+    size_t before = a->used;
+    place_player(&gs, 10.5f, 10.5f, 0.0f);
+    rc_cast(&gs, &map);
+    assert(a->used == before);
+    assert(gs.visible_sprite_count > 0);
+    arena_reset(a);
+}
+
+static void test_cast_scratch_follows_map(void)
+{
+    static Map small, large;
+    build_map(&small, 8, 8);
+    build_map(&large, MAP_MAX_W, MAP_MAX_H);
+    Probe ps = { .fn = cast_serial, .map = &small };
+    Probe pl = { .fn = cast_serial, .map = &large };
+    run_probe(&ps);
+    run_probe(&pl);
+    assert(ps.used == 0 && pl.used == 0);
+    assert(ps.high == 8 * 8);
+    assert(pl.high == MAP_MAX_W * MAP_MAX_H);
+}
+
+static void test_full_arena_still_casts_walls(void)
+{
+    static Map map;
+    static GameState a, b;
+    build_map(&map, 20, 20);
+    place_player(&a, 10.5f, 10.5f, 0.0f);
+    rc_cast(&a, &map);
+
+    Arena *ar = arena_thread();
+    unsigned failed = ar->failed;
+    arena_alloc(ar, ARENA_THREAD_SIZE - 16);
+    place_player(&b, 10.5f, 10.5f, 0.0f);
+    rc_cast(&b, &map);
+    assert(memcmp(a.hits, b.hits, sizeof(a.hits)) == 0);
+    assert(b.visible_sprite_count == 0);
+    assert(ar->failed == failed + 1);
+    arena_reset(ar);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Sizing report                                                     */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void report_cast_scratch(void)
+{
+    static Map map;
+    static JobPool pool;
+    build_map(&map, MAP_MAX_W, MAP_MAX_H);
+    assert(job_pool_start(&pool, 2));
+    Probe s = { .fn = cast_serial, .map = &map };
+    Probe p = { .fn = cast_pooled, .map = &map, .pool = &pool };
+    run_probe(&s);
+    run_probe(&p);
+    job_pool_stop(&pool);
+    assert(s.sprites == p.sprites);
+    assert(s.failed == 0 && p.failed == 0);
+    printf("  rc_cast       %6zu bytes of scratch (%dx%d map)\n",
+           s.high, map.w, map.h);
+    printf("  rc_cast_jobs  %6zu bytes on the caller, of %d\n",
+           p.high, ARENA_THREAD_SIZE);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── arena ───────────────────────────────────────────────\n");
+    RUN_TEST(test_alloc_bumps_aligned);
+    RUN_TEST(test_alloc_fails_when_full);
+    RUN_TEST(test_reset_and_release);
+    RUN_TEST(test_thread_arenas_are_separate);
+    RUN_TEST(test_peak_folds_across_threads);
+
+    printf("\n── cast scratch ────────────────────────────────────────\n");
+    RUN_TEST(test_cast_returns_scratch);
+    RUN_TEST(test_cast_scratch_follows_map);
+    RUN_TEST(test_full_arena_still_casts_walls);
+
+    printf("\n── sizing ──────────────────────────────────────────────\n");
+    report_cast_scratch();
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
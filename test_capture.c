@@ -0,0 +1,259 @@
+/*  test_capture.c  –  tests for YUV conversion and the Y4M writer
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against capture.o — no SDL dependency.  Checks the colour maths
+ *  against known BT.601 values, that the SIMD path matches the scalar
+ *  one bit for bit, and that a stalled consumer costs dropped frames
+ *  rather than a blocked caller.
+ *  Build:  make test
+ *  Run:    ./test_capture
+ */
+#define _POSIX_C_SOURCE 200809L  /* pipe(), fdopen() */
+
+#include "capture.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+#define HEADER_30 "YUV4MPEG2 W800 H600 F30:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n"
+
+static uint32_t rgba(int r, int g, int b)
+{
+    return (uint32_t)r << 24 | (uint32_t)g << 16 | (uint32_t)b << 8 | 0xFFu;
+}
+
+static void fill(uint32_t *fb, uint32_t c)
+{
+    for (int i = 0; i < SCREEN_W * SCREEN_H; i++) fb[i] = c;
+}
+
+/** Deterministic noise covering the whole 0..255 range per channel. */
+static void fill_noise(uint32_t *fb, uint32_t seed)
+{
+    for (int i = 0; i < SCREEN_W * SCREEN_H; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        fb[i] = seed;
+    }
+}
+
+static void convert(const uint32_t *fb, uint8_t *out)
+{
+    cap_convert(fb, SCREEN_W, SCREEN_W, SCREEN_H,
+                out, out + CAP_Y_BYTES, out + CAP_Y_BYTES + CAP_C_BYTES);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Conversion tests                                                  */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_known_colours(void)
+{
+    static uint32_t fb[SCREEN_W * SCREEN_H];
+    static uint8_t  out[CAP_FRAME_BYTES];
+    const struct { uint32_t c; uint8_t y, u, v; } cases[] = {
+        { rgba(255, 255, 255), 235, 128, 128 },
+        { rgba(  0,   0,   0),  16, 128, 128 },
+        { rgba(255,   0,   0),  82,  90, 240 },
+        { rgba(  0,   0, 255),  41, 240, 110 },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        fill(fb, cases[i].c);
+        convert(fb, out);
+        assert(out[0] == cases[i].y && out[CAP_Y_BYTES - 1] == cases[i].y);
+        assert(out[CAP_Y_BYTES] == cases[i].u);
+        assert(out[CAP_Y_BYTES + CAP_C_BYTES] == cases[i].v);
+    }
+}
+
+static void test_chroma_averages_block(void)
+{
+    /* One 2x2 block of black and white: luma per pixel, chroma of grey */
+    static uint32_t fb[SCREEN_W * SCREEN_H];
+    static uint8_t  out[CAP_FRAME_BYTES];
+    fill(fb, rgba(0, 0, 0));
+    fb[0]            = rgba(255, 255, 255);
+    fb[SCREEN_W + 1] = rgba(255, 255, 255);
+    convert(fb, out);
+    assert(out[0] == 235 && out[1] == 16);
+    assert(out[SCREEN_W] == 16 && out[SCREEN_W + 1] == 235);
+    assert(out[CAP_Y_BYTES] == 128 && out[CAP_Y_BYTES + CAP_C_BYTES] == 128);
+    assert(out[2] == 16);                              /* next block */
+}
+
+static void test_simd_matches_scalar(void)
+{
+    static uint32_t fb[SCREEN_W * SCREEN_H];
+    static uint8_t  a[CAP_FRAME_BYTES], b[CAP_FRAME_BYTES];
+    for (uint32_t seed = 1; seed <= 3; seed++) {
+        fill_noise(fb, seed);
+        convert(fb, a);
+        cap_convert_scalar(fb, SCREEN_W, SCREEN_W, SCREEN_H,
+                           b, b + CAP_Y_BYTES, b + CAP_Y_BYTES + CAP_C_BYTES);
+        assert(memcmp(a, b, sizeof(a)) == 0);
+    }
+
+    /* A width that is not a multiple of eight takes the scalar tail */
+    int w = SCREEN_W - 6, h = 10;
+    memset(a, 0, sizeof(a));
+    memset(b, 0, sizeof(b));
+    cap_convert(fb, SCREEN_W, w, h, a, a + w * h, a + w * h + w * h / 4);
+    cap_convert_scalar(fb, SCREEN_W, w, h, b, b + w * h, b + w * h + w * h / 4);
+    assert(memcmp(a, b, (size_t)(w * h * 3 / 2)) == 0);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Writer tests                                                      */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_stream_layout(void)
+{
+    static uint32_t fb[SCREEN_W * SCREEN_H];
+    static uint8_t  want[CAP_FRAME_BYTES], got[CAP_FRAME_BYTES];
+    static Capture  cap;
+    FILE *f = tmpfile();
+    assert(f);
+    assert(cap_open(&cap, f, 30));
+    for (uint32_t s = 1; s <= 3; s++) {
+        fill_noise(fb, s);
+        assert(cap_submit(&cap, fb, SCREEN_W));         /* queue has room */
+    }
+    assert(cap_close(&cap) == 3);
+    assert(cap.dropped == 0 && !atomic_load(&cap.io_error));
+
+    rewind(f);
+    char line[128];
+    assert(fgets(line, sizeof(line), f) && strcmp(line, HEADER_30) == 0);
+    for (uint32_t s = 1; s <= 3; s++) {
+        assert(fgets(line, sizeof(line), f) && strcmp(line, "FRAME\n") == 0);
+        assert(fread(got, 1, sizeof(got), f) == sizeof(got));
+        fill_noise(fb, s);
+        convert(fb, want);
+        assert(memcmp(got, want, sizeof(got)) == 0);
+    }
+    assert(fgetc(f) == EOF);
+    fclose(f);
+}
+
+static int drain_pipe(void *arg)
+{
+    int    fd    = *(int *)arg;
+    static char buf[65536];
+    size_t total = 0;
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) total += (size_t)n;
+    *(int *)arg = (int)total;
+    return 0;
+}
+
+static void test_full_queue_drops_frames(void)
+{
+    /* Nobody reads the pipe, so the writer blocks inside the first
+     * frame: the queue holds CAP_QUEUE frames and the rest drop */
+    static uint32_t fb[SCREEN_W * SCREEN_H];
+    static Capture  cap;
+    int fds[2];
+    assert(pipe(fds) == 0);
+    FILE *w = fdopen(fds[1], "wb");
+    assert(w);
+    assert(cap_open(&cap, w, 30));
+
+    fill(fb, rgba(10, 20, 30));
+    int accepted = 0;
+    for (int i = 0; i < 20; i++) accepted += cap_submit(&cap, fb, SCREEN_W);
+    assert(accepted == CAP_QUEUE);
+    assert(cap.submitted == 20 && cap.dropped == 20 - CAP_QUEUE);
+
+    /* Once the consumer catches up, every queued frame arrives whole */
+    int arg = fds[0];
+    thrd_t t;
+    assert(thrd_create(&t, drain_pipe, &arg) == thrd_success);
+    assert(cap_close(&cap) == CAP_QUEUE);
+    fclose(w);
+    thrd_join(t, NULL);
+    close(fds[0]);
+    assert((size_t)arg == strlen(HEADER_30) + CAP_QUEUE * (6 + CAP_FRAME_BYTES));
+}
+
+static void test_repeat_duplicates_last_frame(void)
+{
+    static uint32_t fb[SCREEN_W * SCREEN_H];
+    static uint8_t  want[CAP_FRAME_BYTES], got[CAP_FRAME_BYTES];
+    static Capture  cap;
+    FILE *f = tmpfile();
+    assert(f);
+    assert(cap_open(&cap, f, 30));
+    assert(cap_repeat(&cap, 2) == 0);                    /* nothing yet */
+    fill_noise(fb, 9);
+    assert(cap_submit(&cap, fb, SCREEN_W));
+    assert(cap_repeat(&cap, 2) == 2);
+    assert(cap_close(&cap) == 3);
+
+    rewind(f);
+    char line[128];
+    assert(fgets(line, sizeof(line), f) && strcmp(line, HEADER_30) == 0);
+    convert(fb, want);
+    for (int i = 0; i < 3; i++) {
+        assert(fgets(line, sizeof(line), f) && strcmp(line, "FRAME\n") == 0);
+        assert(fread(got, 1, sizeof(got), f) == sizeof(got));
+        assert(memcmp(got, want, sizeof(got)) == 0);
+    }
+    assert(fgetc(f) == EOF);
+    fclose(f);
+}
+
+static void test_clock_counts_stream_frames(void)
+{
+    /* 30 fps: frames fall due every 1/30 s whatever the call rate */
+    static Capture cap;
+    FILE *f = tmpfile();
+    assert(f);
+    assert(cap_open(&cap, f, 30));
+    assert(cap_frames_due(&cap, 10.0) == 1);             /* first frame */
+    assert(cap_frames_due(&cap, 10.01) == 0);            /* drawn early */
+    assert(cap_frames_due(&cap, 10.04) == 1);
+    assert(cap_frames_due(&cap, 10.45) == 12);           /* idle stretch */
+    assert(cap_frames_due(&cap, 10.45) == 0);
+    cap_close(&cap);
+    fclose(f);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── conversion ──────────────────────────────────────────\n");
+    RUN_TEST(test_known_colours);
+    RUN_TEST(test_chroma_averages_block);
+    RUN_TEST(test_simd_matches_scalar);
+
+    printf("\n── writer ──────────────────────────────────────────────\n");
+    RUN_TEST(test_stream_layout);
+    RUN_TEST(test_full_queue_drops_frames);
+    RUN_TEST(test_repeat_duplicates_last_frame);
+    RUN_TEST(test_clock_counts_stream_frames);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+/*  test_entity.c  –  tests for the structure-of-arrays entity pool
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o, entity.o and map_edit.o — no SDL
+ *  dependency.  Maps are built inline, so these tests are
+ *  filesystem-independent.
+ *  Build:  make test
+ *  Run:    ./test_entity
+ */
+#include "raycaster.h"
+#include "entity.h"
+#include "map_edit.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DT (1.0f / 60.0f)
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+#define ASSERT_NEAR(a, b, eps)                                          \
+    do {                                                                \
+        float _a = (a), _b = (b), _e = (eps);                          \
+        if (fabsf(_a - _b) > _e) {                                     \
+            printf(" FAIL\n    %s:%d: %.4f != %.4f (eps %.4f)\n",       \
+                   __FILE__, __LINE__, _a, _b, _e);                     \
+            assert(0);                                                  \
+        }                                                               \
+    } while (0)
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Pool tests                                                        */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_spawn_until_full(void)
+{
+    static EntityPool ep;
+    ent_clear(&ep);
+    for (int i = 0; i < MAX_ENTITIES; i++)
+        assert(ent_spawn(&ep, 1.5f, 1.5f, 0.0f, 0.0f, 0) == i);
+    assert(ent_spawn(&ep, 1.5f, 1.5f, 0.0f, 0.0f, 0) == -1);
+    assert(ep.count == MAX_ENTITIES);
+}
+
+static void test_populate_on_free_cells(void)
+{
+    static Map map;
+    static EntityPool a, b;
+    init_box(&map, 20, 20);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    assert(ent_populate(&a, &occ, 500, 7) == 500);
+    assert(ent_populate(&b, &occ, 500, 7) == 500);
+    for (int i = 0; i < a.count; i++) {
+        assert(!map_occupancy_solid(&occ, (int)a.x[i], (int)a.y[i]));
+        assert(a.x[i] == b.x[i] && a.vy[i] == b.vy[i]);
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Update tests                                                      */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_update_moves_freely(void)
+{
+    static Map map;
+    static EntityPool ep;
+    init_box(&map, 20, 20);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    ent_clear(&ep);
+    ent_spawn(&ep, 5.5f, 5.5f, 1.0f, 0.5f, 0);
+    for (int i = 0; i < 60; i++) ent_update(&ep, &occ, DT);
+    ASSERT_NEAR(ep.x[0], 6.5f, 0.01f);
+    ASSERT_NEAR(ep.y[0], 6.0f, 0.01f);
+}
+
+static void test_update_bounces_off_wall(void)
+{
+    static Map map;
+    static EntityPool ep;
+    init_box(&map, 10, 10);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    /* Head east into the wall at x = 9, sliding north along it */
+    ent_clear(&ep);
+    ent_spawn(&ep, 8.5f, 5.5f, 2.0f, -0.5f, 0);
+    for (int i = 0; i < 30; i++) ent_update(&ep, &occ, DT);
+
+    assert(ep.vx[0] < 0.0f);           /* X reversed by the wall      */
+    assert(ep.vy[0] < 0.0f);           /* Y kept sliding              */
+    assert(ep.x[0] < 9.0f - ENT_RADIUS + 1e-4f);
+}
+
+static void test_update_never_enters_walls(void)
+{
+    static Map map;
+    static EntityPool ep;
+    init_box(&map, 24, 24);
+    for (int i = 3; i < 20; i += 4) map.tiles[i][i] = 2;   /* pillars */
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    ent_populate(&ep, &occ, 1000, 42);
+    for (int t = 0; t < 600; t++) {
+        ent_update(&ep, &occ, DT);
+        for (int i = 0; i < ep.count; i++)
+            assert(!map_occupancy_solid(&occ, (int)ep.x[i], (int)ep.y[i]));
+    }
+}
+
+static void test_update_matches_player_slide(void)
+{
+    /* An entity and the player pushed along the same vector must stop
+     * at the same distance from a wall */
+    static Map map;
+    static EntityPool ep;
+    static SimState st;
+    init_box(&map, 10, 10);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    memset(&st, 0, sizeof(st));
+    st.player.x = 5.5f;  st.player.y = 5.5f;
+    st.player.dir_x = 1.0f;  st.player.plane_y = 0.66f;
+    Input in;
+    memset(&in, 0, sizeof(in));
+    in.forward = true;
+
+    ent_clear(&ep);
+    ent_spawn(&ep, 5.5f, 5.5f, 3.0f, 0.0f, 0);   /* player MOVE_SPD */
+
+    for (int i = 0; i < 40; i++) {
+        rc_update(&st, &map, &in, DT);
+        ent_update(&ep, &occ, DT);
+        if (ep.vx[0] < 0.0f) break;            /* first contact */
+    }
+    ASSERT_NEAR(ep.x[0], st.player.x, 1e-4f);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Sprite tests                                                      */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_collect_sprites_in_front_sorted(void)
+{
+    static Map map;
+    static EntityPool ep;
+    static GameState gs;
+    init_box(&map, 20, 20);
+
+    memset(&gs, 0, sizeof(gs));
+    gs.player.x = 2.5f;  gs.player.y = 10.5f;
+    gs.player.dir_x = 1.0f;  gs.player.plane_y = 0.66f;
+    rc_cast(&gs, &map);
+    assert(gs.visible_sprite_count == 0);
+
+    ent_clear(&ep);
+    ent_spawn(&ep, 6.0f, 10.5f, 0.0f, 0.0f, 1);   /* near, ahead    */
+    ent_spawn(&ep, 12.0f, 10.0f, 0.0f, 0.0f, 2);  /* far, ahead     */
+    ent_spawn(&ep, 1.2f, 10.5f, 0.0f, 0.0f, 3);   /* behind         */
+    ent_spawn(&ep, 3.0f, 18.5f, 0.0f, 0.0f, 3);   /* far off to side*/
+    ent_collect_sprites(&ep, &gs);
+
+    assert(gs.visible_sprite_count == 2);
+    assert(gs.visible_sprites[0].texture_id == 2);   /* farthest first */
+    assert(gs.visible_sprites[1].texture_id == 1);
+    ASSERT_NEAR(gs.visible_sprites[1].perp_dist, 3.5f, 1e-4f);
+}
+
+static void test_collect_sprites_capped(void)
+{
+    static Map map;
+    static EntityPool ep;
+    static GameState gs;
+    init_box(&map, 20, 20);
+
+    memset(&gs, 0, sizeof(gs));
+    gs.player.x = 2.5f;  gs.player.y = 10.5f;
+    gs.player.dir_x = 1.0f;  gs.player.plane_y = 0.66f;
+    rc_cast(&gs, &map);
+
+    ent_clear(&ep);
+    for (int i = 0; i < 1000; i++)
+        ent_spawn(&ep, 8.0f, 10.5f, 0.0f, 0.0f, 0);
+    ent_collect_sprites(&ep, &gs);
+    assert(gs.visible_sprite_count == MAX_VISIBLE_SPRITES);
+}
+
+static void test_collect_sprites_keeps_nearest(void)
+{
+    static Map map;
+    static EntityPool ep;
+    static GameState gs;
+    init_box(&map, 40, 20);
+
+    memset(&gs, 0, sizeof(gs));
+    gs.player.x = 2.5f;  gs.player.y = 10.5f;
+    gs.player.dir_x = 1.0f;  gs.player.plane_y = 0.66f;
+    rc_cast(&gs, &map);
+
+    /* Far entities first, so index order alone would keep only them */
+    ent_clear(&ep);
+    for (int i = 0; i < 1000; i++)
+        ent_spawn(&ep, 30.0f, 10.5f, 0.0f, 0.0f, 0);
+    for (int i = 0; i < 100; i++)
+        ent_spawn(&ep, 5.0f + i * 0.01f, 10.5f, 0.0f, 0.0f, 1);
+    ent_collect_sprites(&ep, &gs);
+
+    assert(gs.visible_sprite_count == MAX_VISIBLE_SPRITES);
+    int near = 0;
+    for (int i = 0; i < gs.visible_sprite_count; i++)
+        near += gs.visible_sprites[i].texture_id == 1;
+    assert(near == 100);
+    for (int i = 1; i < gs.visible_sprite_count; i++)   /* still sorted */
+        assert(gs.visible_sprites[i - 1].perp_dist
+               >= gs.visible_sprites[i].perp_dist);
+    ASSERT_NEAR(gs.visible_sprites[MAX_VISIBLE_SPRITES - 1].perp_dist,
+                2.5f, 1e-4f);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── entity pool ─────────────────────────────────────────\n");
+    RUN_TEST(test_spawn_until_full);
+    RUN_TEST(test_populate_on_free_cells);
+
+    printf("\n── ent_update ──────────────────────────────────────────\n");
+    RUN_TEST(test_update_moves_freely);
+    RUN_TEST(test_update_bounces_off_wall);
+    RUN_TEST(test_update_never_enters_walls);
+    RUN_TEST(test_update_matches_player_slide);
+
+    printf("\n── entity sprites ──────────────────────────────────────\n");
+    RUN_TEST(test_collect_sprites_in_front_sorted);
+    RUN_TEST(test_collect_sprites_capped);
+    RUN_TEST(test_collect_sprites_keeps_nearest);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
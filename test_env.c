@@ -0,0 +1,436 @@
+/*  test_env.c  –  tests for the multi-instance environment and the
+ *                  software renderer
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against env.o, render.o and the simulation objects — no SDL
+ *  dependency.  Checks that instances are independent, that running on
+ *  the job pool never changes a result, that the level stays shared
+ *  until an instance edits it, that the memory it reports grows by a
+ *  fixed amount per instance, and that frames and their depth and ID
+ *  buffers come out as drawn.
+ *  Build:  make test
+ *  Run:    ./test_env   (from the build dir, which has assets/)
+ */
+#include "env.h"
+#include "jobs.h"
+#include "raycaster.h"
+#include "render.h"
+#include "map_edit.h"
+#include "memstat.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+static JobPool pool;                     /* shared by the pooled tests  */
+
+static EnvConfig box_config(SharedMap *map, int count, JobPool *pool)
+{
+    EnvConfig c = {
+        .count     = count,
+        .map       = map,
+        .spawn     = { .x = 5.5f, .y = 5.5f, .dir_x = 1.0f, .plane_y = 0.66f },
+        .npc_count = 8,
+        .obs       = ENV_OBS_HITS,
+        .pool      = pool,
+    };
+    return c;
+}
+
+/** Instance i: odd ones walk forward, every third one turns left. */
+static void scripted_inputs(Input *in, int count, int step)
+{
+    memset(in, 0, sizeof(Input) * (size_t)count);
+    for (int i = 0; i < count; i++) {
+        in[i].forward   = (i & 1) && step < 40;
+        in[i].turn_left = i % 3 == 0;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Environment tests                                                 */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_instances_are_independent(void)
+{
+    static Map map;
+    static SharedMap sm;
+    static Env env;
+    init_box(&map, 20, 20);
+    map_share_init(&sm, &map);
+    EnvConfig c = box_config(&sm, 6, &pool);
+    assert(env_create(&env, &c));
+
+    Input in[6];
+    for (int s = 0; s < 30; s++) {
+        scripted_inputs(in, 6, s);
+        env_step(&env, in);
+    }
+    assert(env.steps == 30);
+
+    /* Instance 0 only turned, 1 only walked, 2 and 4 stood still */
+    const Player *p0 = &env.inst[0].world.state.player;
+    const Player *p1 = &env.inst[1].world.state.player;
+    assert(p0->x == 5.5f && p0->y == 5.5f && p0->dir_x != 1.0f);
+    assert(p1->x > 6.5f && p1->dir_x == 1.0f);
+    assert(env.inst[0].world.map == &sm.map);
+
+    /* Observations follow each instance's own view */
+    assert(memcmp(env.hits[2], env.hits[4], sizeof(env.hits[0])) == 0);
+    assert(memcmp(env.hits[0], env.hits[2], sizeof(env.hits[0])) != 0);
+    assert(memcmp(env.hits[1], env.hits[2], sizeof(env.hits[0])) != 0);
+    env_destroy(&env);
+}
+
+static void test_pool_does_not_change_results(void)
+{
+    static Map map;
+    static SharedMap sm;
+    static Env serial, pooled;
+    init_box(&map, 24, 18);
+    map.tiles[8][10] = 3;
+    map_share_init(&sm, &map);
+    EnvConfig c1 = box_config(&sm, 12, NULL);
+    EnvConfig c4 = box_config(&sm, 12, &pool);
+    assert(env_create(&serial, &c1));
+    unsigned before = atomic_load(&pool.executed);
+    assert(env_create(&pooled, &c4));
+    assert(atomic_load(&pool.executed) > before);
+
+    Input in[12];
+    for (int s = 0; s < 60; s++) {
+        scripted_inputs(in, 12, s);
+        env_step(&serial, in);
+        env_step(&pooled, in);
+    }
+    for (int i = 0; i < 12; i++) {
+        assert(sim_world_hash(&serial.inst[i].world)
+               == sim_world_hash(&pooled.inst[i].world));
+        assert(memcmp(serial.hits[i], pooled.hits[i], sizeof(serial.hits[i])) == 0);
+    }
+    env_destroy(&serial);
+    env_destroy(&pooled);
+}
+
+static void test_done_holds_until_reset(void)
+{
+    /* The endgame cell sits two steps ahead of the spawn */
+    static Map map;
+    static SharedMap sm;
+    static Env env;
+    init_box(&map, 12, 12);
+    map.info[5][7] = INFO_TRIGGER_ENDGAME;
+    map_share_init(&sm, &map);
+    EnvConfig c = box_config(&sm, 2, &pool);
+    assert(env_create(&env, &c));
+
+    static RayHit start[SCREEN_W];
+    memcpy(start, env.hits[1], sizeof(start));
+
+    Input in[2];
+    memset(in, 0, sizeof(in));
+    in[1].forward = true;
+    for (int s = 0; s < 2 * SIM_TICK_RATE && !env.done[1]; s++)
+        env_step(&env, in);
+    assert(env.done[1] && !env.done[0]);
+
+    float x = env.inst[1].world.state.player.x;
+    env_step(&env, in);
+    assert(env.inst[1].world.state.player.x == x);      /* held still */
+
+    env_reset(&env, 1);
+    assert(!env.done[1]);
+    assert(env.inst[1].world.state.player.x == 5.5f);
+    assert(memcmp(start, env.hits[1], sizeof(start)) == 0);
+    env_destroy(&env);
+}
+
+static void test_map_shared_until_door_moves(void)
+{
+    /* A switch two steps ahead of the spawn opens a door elsewhere */
+    static Map map;
+    static SharedMap sm;
+    static Env env;
+    init_box(&map, 12, 12);
+    map.info[5][7]  = INFO_TRIGGER_SWITCH;
+    map.tiles[9][3] = 4;
+    map.info[9][3]  = INFO_DOOR;
+    map_share_init(&sm, &map);
+    EnvConfig c = box_config(&sm, 3, &pool);
+    c.npc_count = 0;
+    assert(env_create(&env, &c));
+    assert(atomic_load(&sm.refs) == 1 + 1 + 3);   /* caller, env, games */
+    for (int i = 0; i < 3; i++)
+        assert(env.inst[i].world.map == &sm.map);
+
+    Input in[3];
+    memset(in, 0, sizeof(in));
+    in[1].forward = true;
+    for (int s = 0; s < SIM_TICK_RATE; s++)
+        env_step(&env, in);
+
+    /* Only the instance that hit the switch owns a copy */
+    assert(env.inst[1].world.map == &env.own[1]);
+    assert(env.own[1].tiles[9][3] == TILE_FLOOR);
+    assert(sm.map.tiles[9][3] == 4);
+    assert(env.inst[0].world.map == &sm.map && env.inst[2].world.map == &sm.map);
+    assert(atomic_load(&sm.refs) == 1 + 1 + 2);
+
+    /* A reset shares the level again */
+    env_reset(&env, 1);
+    assert(env.inst[1].world.map == &sm.map);
+    assert(atomic_load(&sm.refs) == 1 + 1 + 3);
+    env_destroy(&env);
+    assert(atomic_load(&sm.refs) == 1);
+}
+
+static void test_sense_observation(void)
+{
+    static Map map;
+    static SharedMap sm;
+    static Env env;
+    init_box(&map, 16, 16);
+    map.tiles[5][9] = 3;
+    map_share_init(&sm, &map);
+
+    float angles[32];
+    rc_sense_spread(angles, 32, 6.2831853f, 0.0f);
+    EnvConfig c = box_config(&sm, 4, &pool);
+    c.obs          = ENV_OBS_SENSE;
+    c.sense_angles = angles;
+    c.sense_count  = 32;
+    assert(env_create(&env, &c));
+    angles[0] = 99.0f;                 /* the env keeps its own copy */
+
+    Input in[4];
+    for (int s = 0; s < 20; s++) {
+        scripted_inputs(in, 4, s);
+        env_step(&env, in);
+    }
+
+    /* Each reading is exactly what rc_sense() sees from that pose */
+    rc_sense_spread(angles, 32, 6.2831853f, 0.0f);
+    for (int i = 0; i < 4; i++) {
+        SenseHit want[32];
+        rc_sense(env.inst[i].world.map, &env.inst[i].world.state.player,
+                 angles, 32, 0.0f, want);
+        for (int r = 0; r < 32; r++) {
+            assert(want[r].dist == env.sense[i][r].dist);
+            assert(want[r].cell == env.sense[i][r].cell);
+            assert(want[r].tile_type == env.sense[i][r].tile_type);
+        }
+        assert(env.sense[i][16].cell != ID_NO_CELL);
+    }
+    env_destroy(&env);
+
+    c.sense_count = 0;
+    assert(!env_create(&env, &c));
+}
+
+static void test_bad_config_rejected(void)
+{
+    static Map map;
+    static SharedMap sm;
+    static Env env;
+    init_box(&map, 8, 8);
+    map_share_init(&sm, &map);
+    EnvConfig c = box_config(&sm, 0, NULL);
+    assert(!env_create(&env, &c));
+    c.count = ENV_MAX_INSTANCES + 1;
+    assert(!env_create(&env, &c));
+    c.count = 1;
+    c.obs   = ENV_OBS_PIXELS;                  /* no atlas */
+    assert(!env_create(&env, &c));
+    assert(atomic_load(&sm.refs) == 1);        /* nothing retained */
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Renderer tests                                                    */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_pixels_show_ceiling_wall_floor(void)
+{
+    static Map map;
+    static SharedMap sm;
+    static Env env;
+    static SharedAtlas atlas;
+    render_atlas_solid(&atlas.atlas);
+    render_atlas_share(&atlas);
+    init_box(&map, 12, 12);
+    map_share_init(&sm, &map);
+    EnvConfig c = box_config(&sm, 2, &pool);
+    c.npc_count = 0;
+    c.obs       = ENV_OBS_PIXELS;
+    c.atlas     = &atlas;
+    assert(env_create(&env, &c));
+    assert(atomic_load(&atlas.refs) == 2);
+
+    /* Facing +x from (5.5, 5.5): the east wall fills the middle rows */
+    const uint32_t *fb = env.pixels[0];
+    int mid = SCREEN_W / 2;
+    assert(fb[0 * SCREEN_W + mid] == COL_CEIL);
+    assert(fb[(SCREEN_H - 1) * SCREEN_W + mid] == COL_FLOOR);
+    assert(fb[(SCREEN_H / 2) * SCREEN_W + mid] == COL_WALL);
+    assert(memcmp(env.pixels[0], env.pixels[1], sizeof(env.pixels[0])) == 0);
+    env_destroy(&env);
+    assert(atomic_load(&atlas.refs) == 1);
+}
+
+static void test_aux_buffers_match_frame(void)
+{
+    /* A map sprite three cells ahead, walls behind it */
+    static Map map;
+    static SharedMap sm;
+    static Env env;
+    static SharedAtlas atlas;
+    render_atlas_solid(&atlas.atlas);
+    render_atlas_share(&atlas);
+    init_box(&map, 12, 12);
+    map.sprites[5][8] = 1;
+    map_share_init(&sm, &map);
+    EnvConfig c = box_config(&sm, 1, NULL);
+    c.npc_count = 0;
+    c.obs       = ENV_OBS_AUX;
+    c.atlas     = &atlas;
+    assert(env_create(&env, &c));
+
+    const uint32_t *fb  = env.pixels[0];
+    const uint32_t *ids = env.ids[0];
+    const float    *zb  = env.depth[0];
+    int mid = (SCREEN_H / 2) * SCREEN_W + SCREEN_W / 2;
+    assert(ids[mid] == MAKE_ID(ID_SPRITE, 0, 5 * MAP_MAX_W + 8));
+    assert(zb[mid] > 2.99f && zb[mid] < 3.01f);
+    assert(ID_KIND(ids[SCREEN_W / 2]) == ID_CEIL);
+    assert(ID_KIND(ids[(SCREEN_H - 1) * SCREEN_W]) == ID_FLOOR);
+    assert(zb[(SCREEN_H - 1) * SCREEN_W] < zb[(SCREEN_H / 2 + 1) * SCREEN_W]);
+
+    /* Every pixel's ID agrees with the colour drawn there, and walls
+     * report their column's distance and a solid cell */
+    for (int y = 0; y < SCREEN_H; y++)
+        for (int x = 0; x < SCREEN_W; x++) {
+            uint32_t id = ids[y * SCREEN_W + x], col = fb[y * SCREEN_W + x];
+            switch (ID_KIND(id)) {
+            case ID_CEIL:   assert(col == COL_CEIL);   break;
+            case ID_FLOOR:  assert(col == COL_FLOOR);  break;
+            case ID_SPRITE: assert(col == COL_SPRITE); break;
+            case ID_WALL: {
+                uint32_t cell = ID_OBJECT(id);
+                assert(col != COL_CEIL && col != COL_FLOOR && col != COL_SPRITE);
+                assert(zb[y * SCREEN_W + x] == env.hits[0][x].wall_dist);
+                assert(map.tiles[cell / MAP_MAX_W][cell % MAP_MAX_W] > 0);
+                break;
+            }
+            default: assert(!"unexpected object kind");
+            }
+        }
+    env_destroy(&env);
+}
+
+static void test_atlas_loads_bmp(void)
+{
+    static TextureAtlas atlas;
+    assert(render_atlas_load(&atlas, "assets/texture_tiles.bmp",
+                             "assets/texture_sprites.bmp"));
+
+    /* Real textures are not one flat colour, and sprites use the
+     * transparent key somewhere */
+    bool varied = false, keyed = false;
+    for (int i = 1; i < TEX_SIZE * TEX_SIZE; i++)
+        varied |= atlas.tiles[i] != atlas.tiles[0];
+    for (int i = 0; i < SPRITE_TEX_COUNT * TEX_SIZE * TEX_SIZE; i++)
+        keyed |= atlas.sprites[i] == SPRITE_ALPHA_KEY;
+    assert(varied && keyed);
+    assert((atlas.tiles[0] & 0xFF) == 0xFF);
+
+    assert(!render_atlas_load(&atlas, "assets/missing.bmp",
+                              "assets/texture_sprites.bmp"));
+    assert(atlas.tiles[0] == COL_WALL && atlas.tiles[TEX_SIZE * TEX_SIZE - 1] == COL_WALL);
+}
+
+static void test_memory_accounted_per_instance(void)
+{
+    static Map map;
+    static SharedMap sm;
+    static Env env;
+    static SharedAtlas atlas;
+    render_atlas_solid(&atlas.atlas);
+    render_atlas_share(&atlas);
+    init_box(&map, 12, 12);
+    map_share_init(&sm, &map);
+
+    /* Scratch depends on which threads ran, so compare the rest */
+    static const MemTag tags[] = { MEM_MAP, MEM_DERIVED, MEM_ENTITIES,
+                                   MEM_SIM, MEM_VIEW, MEM_FRAMES };
+    enum { NTAGS = sizeof(tags) / sizeof(tags[0]) };
+    size_t base[NTAGS], one[NTAGS], three[NTAGS];
+    for (int t = 0; t < NTAGS; t++) base[t] = mem_bytes(tags[t]);
+
+    EnvConfig c = box_config(&sm, 1, NULL);
+    c.obs   = ENV_OBS_PIXELS;
+    c.atlas = &atlas;
+    assert(env_create(&env, &c));
+    for (int t = 0; t < NTAGS; t++) one[t] = mem_bytes(tags[t]) - base[t];
+    env_destroy(&env);
+    for (int t = 0; t < NTAGS; t++) assert(mem_bytes(tags[t]) == base[t]);
+
+    c.count = 3;
+    assert(env_create(&env, &c));
+    for (int t = 0; t < NTAGS; t++) three[t] = mem_bytes(tags[t]) - base[t];
+    env_destroy(&env);
+
+    /* Each instance adds the same amount; the trigger index is shared */
+    assert(one[5] == sizeof(env.pixels[0]));
+    assert(one[0] == sizeof(Map) + sizeof(MapCow));
+    for (int t = 0; t < NTAGS; t++) {
+        size_t shared = tags[t] == MEM_DERIVED ? sizeof(env.triggers) : 0;
+        assert(three[t] - shared == 3 * (one[t] - shared));
+    }
+    assert(atomic_load(&atlas.refs) == 1);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    assert(job_pool_start(&pool, 3));
+
+    printf("\n── environment ─────────────────────────────────────────\n");
+    RUN_TEST(test_instances_are_independent);
+    RUN_TEST(test_pool_does_not_change_results);
+    RUN_TEST(test_done_holds_until_reset);
+    RUN_TEST(test_map_shared_until_door_moves);
+    RUN_TEST(test_sense_observation);
+    RUN_TEST(test_bad_config_rejected);
+    RUN_TEST(test_memory_accounted_per_instance);
+
+    printf("\n── software renderer ───────────────────────────────────\n");
+    RUN_TEST(test_pixels_show_ceiling_wall_floor);
+    RUN_TEST(test_aux_buffers_match_frame);
+    RUN_TEST(test_atlas_loads_bmp);
+
+    job_pool_stop(&pool);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
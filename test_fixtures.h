@@ -0,0 +1,87 @@
+#ifndef TEST_FIXTURES_H
+#define TEST_FIXTURES_H
+
+/*  test_fixtures.h  –  maps and worlds shared by the unit tests
+ *  ────────────────────────────────────────────────────────────────────
+ *  Included by the test_*.c files only.  Everything is static inline,
+ *  so a test that never builds a world does not have to link sim.o.
+ */
+#include "entity.h"
+#include "map_edit.h"
+#include "sim.h"
+
+#include <string.h>
+
+/* ── Maps ─────────────────────────────────────────────────────────── */
+
+/** w x h cells of floor inside a one-cell wall. */
+static inline void init_box(Map *map, int w, int h)
+{
+    memset(map, 0, sizeof(*map));
+    map->w = w;
+    map->h = h;
+    for (int r = 0; r < h; r++)
+        for (int c = 0; c < w; c++)
+            map->tiles[r][c] =
+                (r == 0 || r == h - 1 || c == 0 || c == w - 1) ? 1 : 0;
+}
+
+/** xorshift32: the same sequence on every platform. */
+static inline uint32_t next_rand(uint32_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+/** Border walls plus roughly `percent` random solid cells. */
+static inline void init_random(Map *map, int w, int h, int percent,
+                               uint32_t seed)
+{
+    memset(map, 0, sizeof(*map));
+    map->w = w;
+    map->h = h;
+    for (int r = 0; r < h; r++)
+        for (int c = 0; c < w; c++) {
+            bool edge = r == 0 || r == h - 1 || c == 0 || c == w - 1;
+            map->tiles[r][c] = (edge || (int)(next_rand(&seed) % 100) < percent)
+                             ? 1 : 0;
+        }
+}
+
+static inline bool open_cell(const Map *m, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < m->w && y < m->h && m->tiles[y][x] == 0;
+}
+
+/** A random open cell of m (m must have one). */
+static inline void random_open_cell(const Map *m, uint32_t *seed,
+                                    int *x, int *y)
+{
+    do {
+        *x = (int)(next_rand(seed) % (uint32_t)m->w);
+        *y = (int)(next_rand(seed) % (uint32_t)m->h);
+    } while (!open_cell(m, *x, *y));
+}
+
+/* ── Worlds ───────────────────────────────────────────────────────── */
+
+/** A 24 x 24 box with three pillars, the player at (2.5, 2.5) facing
+ *  east and `npcs` wanderers seeded with 1. */
+static inline void init_world(SimWorld *w, Map *map, MapOccupancy *occ,
+                              int npcs)
+{
+    init_box(map, 24, 24);
+    for (int i = 4; i < 20; i += 5) map->tiles[i][i] = 3;   /* pillars */
+    map_occupancy_build(occ, map);
+
+    memset(w, 0, sizeof(*w));
+    w->map       = map;
+    w->occupancy = occ;
+    w->state.player.x = 2.5f;  w->state.player.y = 2.5f;
+    w->state.player.dir_x = 1.0f;  w->state.player.plane_y = 0.66f;
+    ent_populate(&w->npcs, occ, npcs, 1);
+}
+
+#endif /* TEST_FIXTURES_H */
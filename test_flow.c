@@ -0,0 +1,307 @@
+/*  test_flow.c  –  tests for flow fields and the per-goal cache
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against flow.o, entity.o, raycaster.o and map_edit.o — no SDL
+ *  dependency.  Maps are built inline; costs are checked against a
+ *  plain relaxation over the same 8-way grid, and every repaired field
+ *  against a fresh build.
+ *  Build:  make test
+ *  Run:    ./test_flow
+ */
+#include "flow.h"
+#include "jobs.h"
+#include "map_edit.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+/** Reference: relax every cell until nothing changes.  Slow but
+ *  obviously right.  Diagonals only between two open sides. */
+static void reference_costs(const Map *m, int gx, int gy,
+                            uint32_t cost[MAP_MAX_H][MAP_MAX_W])
+{
+    for (int y = 0; y < MAP_MAX_H; y++)
+        for (int x = 0; x < MAP_MAX_W; x++)
+            cost[y][x] = FLOW_UNREACHED;
+    if (!open_cell(m, gx, gy)) return;
+    cost[gy][gx] = 0;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int y = 0; y < m->h; y++)
+            for (int x = 0; x < m->w; x++) {
+                if (!open_cell(m, x, y)) continue;
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dx = -1; dx <= 1; dx++) {
+                        int nx = x + dx, ny = y + dy;
+                        if ((!dx && !dy) || !open_cell(m, nx, ny)) continue;
+                        if (dx && dy && (!open_cell(m, nx, y) || !open_cell(m, x, ny)))
+                            continue;
+                        if (cost[ny][nx] == FLOW_UNREACHED) continue;
+                        uint32_t c = cost[ny][nx] + (dx && dy ? PATH_COST_DIAGONAL
+                                                              : PATH_COST_STRAIGHT);
+                        if (c < cost[y][x]) {
+                            cost[y][x] = c;
+                            changed = true;
+                        }
+                    }
+            }
+    }
+}
+
+static void assert_same_field(const FlowField *a, const FlowField *b)
+{
+    assert(memcmp(a->cost, b->cost, sizeof(a->cost)) == 0);
+    assert(memcmp(a->dir,  b->dir,  sizeof(a->dir))  == 0);
+    assert(memcmp(a->open, b->open, sizeof(a->open)) == 0);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Field tests                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_build_matches_reference(void)
+{
+    static Map map;
+    static FlowField f;
+    static uint32_t ref[MAP_MAX_H][MAP_MAX_W];
+    uint32_t seed = 11;
+    init_random(&map, 40, 30, 25, 2);
+
+    for (int i = 0; i < 5; i++) {
+        int gx, gy;
+        random_open_cell(&map, &seed, &gx, &gy);
+        flow_build(&f, &map, gx, gy);
+        reference_costs(&map, gx, gy, ref);
+        for (int y = 0; y < map.h; y++)
+            for (int x = 0; x < map.w; x++)
+                assert(f.cost[y][x] == ref[y][x]);
+        assert(f.dir[gy][gx] == FLOW_NONE);
+    }
+}
+
+static void test_steps_follow_cost_to_goal(void)
+{
+    static Map map;
+    static FlowField f;
+    init_random(&map, 40, 30, 25, 4);
+    uint32_t seed = 3;
+    int gx, gy;
+    random_open_cell(&map, &seed, &gx, &gy);
+    flow_build(&f, &map, gx, gy);
+
+    /* From every reachable cell the steps are legal and add up to
+     * exactly the stored cost */
+    for (int y = 0; y < map.h; y++)
+        for (int x = 0; x < map.w; x++) {
+            int dx, dy;
+            if (f.cost[y][x] == FLOW_UNREACHED) {
+                assert(!flow_step(&f, x, y, &dx, &dy));
+                continue;
+            }
+            uint32_t total = 0;
+            int cx = x, cy = y;
+            while (flow_step(&f, cx, cy, &dx, &dy)) {
+                assert(open_cell(&map, cx + dx, cy + dy));
+                if (dx && dy)
+                    assert(open_cell(&map, cx + dx, cy) && open_cell(&map, cx, cy + dy));
+                total += dx && dy ? PATH_COST_DIAGONAL : PATH_COST_STRAIGHT;
+                cx += dx;
+                cy += dy;
+            }
+            assert(cx == gx && cy == gy);
+            assert(total == f.cost[y][x]);
+        }
+    int dx, dy;
+    assert(!flow_step(&f, -1, 0, &dx, &dy));
+}
+
+static void test_sync_matches_rebuild(void)
+{
+    static Map map;
+    static FlowField synced, fresh;
+    uint32_t seed = 9;
+    init_random(&map, 40, 30, 25, 6);
+    int gx, gy;
+    random_open_cell(&map, &seed, &gx, &gy);
+    flow_build(&synced, &map, gx, gy);
+
+    /* Open and close cells a few at a time (the goal now and then),
+     * syncing after each batch */
+    for (int round = 0; round < 200; round++) {
+        int edits = 1 + (int)(next_rand(&seed) % 4);
+        for (int i = 0; i < edits; i++) {
+            int x = 1 + (int)(next_rand(&seed) % 38);
+            int y = 1 + (int)(next_rand(&seed) % 28);
+            if (round % 50 == 49 && i == 0) { x = gx; y = gy; }
+            map_set_tile(&map, x, y, map.tiles[y][x] ? 0 : 2);
+        }
+        map_set_info(&map, 1, 1, (uint16_t)round);   /* not a tile edit */
+        flow_field_sync(&synced, &map);
+        flow_build(&fresh, &map, gx, gy);
+        assert_same_field(&synced, &fresh);
+        assert(synced.revision == map.revision);
+    }
+}
+
+static void test_sync_after_log_wrap(void)
+{
+    static Map map;
+    static FlowField synced, fresh;
+    init_random(&map, 20, 20, 10, 5);
+    flow_build(&synced, &map, 2, 2);
+    for (int i = 0; i < MAP_CHANGE_LOG + 10; i++)
+        map_set_tile(&map, 5 + i % 10, 5, (uint16_t)(i & 1));
+    flow_field_sync(&synced, &map);
+    flow_build(&fresh, &map, 2, 2);
+    assert_same_field(&synced, &fresh);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Cache tests                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_cache_reuses_and_evicts(void)
+{
+    static Map map;
+    static FlowCache fc;
+    memset(&fc, 0, sizeof(fc));
+    init_random(&map, 30, 20, 0, 1);
+
+    const FlowField *a = flow_get(&fc, &map, 3, 3);
+    assert(a && a->gx == 3 && a->gy == 3);
+    assert(flow_get(&fc, &map, 3, 3) == a);
+    assert(fc.builds == 1 && fc.repairs == 0);
+    assert(flow_get(&fc, &map, -1, 3) == NULL);
+    assert(flow_get(&fc, &map, 30, 3) == NULL);
+
+    /* An edit is repaired in place, not rebuilt */
+    map_set_tile(&map, 10, 10, 1);
+    assert(flow_get(&fc, &map, 3, 3) == a);
+    assert(fc.builds == 1 && fc.repairs == 1);
+    assert(a->revision == map.revision);
+
+    /* Fill the cache; the next new goal evicts the least recently used
+     * field, which is (1,1) since (3,3) was just touched again */
+    const FlowField *first = flow_get(&fc, &map, 1, 1);
+    for (int i = 2; i < FLOW_MAX_FIELDS; i++)
+        flow_get(&fc, &map, 1, 1 + i);
+    assert(flow_get(&fc, &map, 3, 3) == a);
+    const FlowField *evicted = flow_get(&fc, &map, 20, 15);
+    assert(evicted == first);
+    assert(fc.builds == FLOW_MAX_FIELDS + 1);
+
+    flow_clear(&fc);
+    flow_get(&fc, &map, 3, 3);
+    assert(fc.builds == FLOW_MAX_FIELDS + 2);
+}
+
+static void test_parallel_sync_matches_rebuild(void)
+{
+    static Map map;
+    static FlowCache fc;
+    static FlowField fresh;
+    static JobPool pool;
+    assert(job_pool_start(&pool, 3));
+    memset(&fc, 0, sizeof(fc));
+    uint32_t seed = 21;
+    init_random(&map, 48, 40, 20, 8);
+    for (int i = 0; i < FLOW_MAX_FIELDS; i++) {
+        int gx, gy;
+        random_open_cell(&map, &seed, &gx, &gy);
+        flow_get(&fc, &map, gx, gy);
+    }
+
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 6; i++) {
+            int x = 1 + (int)(next_rand(&seed) % 46);
+            int y = 1 + (int)(next_rand(&seed) % 38);
+            map_set_tile(&map, x, y, map.tiles[y][x] ? 0 : 2);
+        }
+        flow_sync(&fc, &map, &pool);
+        for (int i = 0; i < FLOW_MAX_FIELDS; i++) {
+            const FlowField *f = &fc.fields[i];
+            if (!f->valid) continue;
+            assert(f->revision == map.revision);
+            flow_build(&fresh, &map, f->gx, f->gy);
+            assert_same_field(f, &fresh);
+        }
+    }
+    job_pool_stop(&pool);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Steering tests                                                    */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_steer_brings_entities_to_goal(void)
+{
+    /* A wall splits the room; agents on the far side must go round */
+    static Map map;
+    static MapOccupancy occ;
+    static EntityPool ep;
+    static FlowField f;
+    init_random(&map, 20, 12, 0, 1);
+    for (int y = 1; y <= 8; y++) map.tiles[y][10] = 1;
+    map_occupancy_build(&occ, &map);
+    flow_build(&f, &map, 17, 2);
+
+    ent_clear(&ep);
+    for (int i = 0; i < 20; i++)
+        ent_spawn(&ep, 2.5f + (float)(i % 5), 2.5f + (float)(i / 5) * 2.0f,
+                  0.0f, 0.0f, 0);
+
+    for (int tick = 0; tick < 60 * 30; tick++) {
+        flow_steer(&f, &ep);
+        ent_update(&ep, &occ, 1.0f / 60.0f);
+    }
+    for (int i = 0; i < ep.count; i++) {
+        float dx = ep.x[i] - 17.5f, dy = ep.y[i] - 2.5f;
+        assert(dx * dx + dy * dy < 2.0f * 2.0f);
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── fields ──────────────────────────────────────────────\n");
+    RUN_TEST(test_build_matches_reference);
+    RUN_TEST(test_steps_follow_cost_to_goal);
+    RUN_TEST(test_sync_matches_rebuild);
+    RUN_TEST(test_sync_after_log_wrap);
+
+    printf("\n── cache ───────────────────────────────────────────────\n");
+    RUN_TEST(test_cache_reuses_and_evicts);
+    RUN_TEST(test_parallel_sync_matches_rebuild);
+
+    printf("\n── steering ────────────────────────────────────────────\n");
+    RUN_TEST(test_steer_brings_entities_to_goal);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+/*  test_frame_ring.c  –  tests for the shared-memory frame ring
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against frame_ring.o — no SDL dependency.  The reader maps the
+ *  ring separately from the producer, exactly as another process would,
+ *  and checks that frames arrive in place and that a read overlapping
+ *  a rewrite is always caught.
+ *  Build:  make test
+ *  Run:    ./test_frame_ring
+ */
+#define _POSIX_C_SOURCE 200809L  /* getpid(), shm_open(), ftruncate() */
+
+#include "frame_ring.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <threads.h>
+#include <unistd.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+/** A per-process name, so parallel test runs never collide. */
+static const char *ring_name(void)
+{
+    static char name[FRING_NAME_MAX];
+    snprintf(name, sizeof(name), "/raycaster-test-%ld", (long)getpid());
+    return name;
+}
+
+static void fill(uint32_t *fb, uint32_t v)
+{
+    for (int i = 0; i < SCREEN_W * SCREEN_H; i++) fb[i] = v;
+}
+
+static bool uniform(const uint32_t *fb, uint32_t v)
+{
+    for (int i = 0; i < SCREEN_W * SCREEN_H; i++)
+        if (fb[i] != v) return false;
+    return true;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Frame ring tests                                                  */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_reader_sees_published_frame(void)
+{
+    static FrameRing prod, cons;
+    assert(fring_create(&prod, ring_name()));
+    assert(fring_attach(&cons, ring_name()));
+
+    uint64_t frame = 0;
+    assert(fring_read_begin(&cons, &frame) == NULL);      /* none yet */
+
+    uint32_t *fb = fring_acquire(&prod);
+    fill(fb, 0x11223344);
+    assert(fring_read_begin(&cons, &frame) == NULL);      /* not published */
+    fring_publish(&prod);
+
+    /* Same pages, different mapping: no copy on either side */
+    const uint32_t *px = fring_read_begin(&cons, &frame);
+    assert(px && frame == 1);
+    assert((const void *)px != (const void *)fb);
+    assert(uniform(px, 0x11223344));
+    assert(fring_read_end(&cons, frame));
+
+    fring_close(&cons);
+    fring_close(&prod);
+}
+
+static void test_busy_slot_keeps_last_frame(void)
+{
+    static FrameRing prod, cons;
+    assert(fring_create(&prod, ring_name()));
+    assert(fring_attach(&cons, ring_name()));
+    fill(fring_acquire(&prod), 1);
+    fring_publish(&prod);
+
+    /* While frame 2 is being drawn, readers still get frame 1 */
+    fill(fring_acquire(&prod), 2);
+    uint64_t frame = 0;
+    const uint32_t *px = fring_read_begin(&cons, &frame);
+    assert(px && frame == 1 && uniform(px, 1));
+    assert(fring_read_end(&cons, frame));
+    fring_publish(&prod);
+    px = fring_read_begin(&cons, &frame);
+    assert(px && frame == 2 && uniform(px, 2));
+
+    fring_close(&cons);
+    fring_close(&prod);
+}
+
+static void test_overwrite_detected(void)
+{
+    static FrameRing prod, cons;
+    assert(fring_create(&prod, ring_name()));
+    assert(fring_attach(&cons, ring_name()));
+    fill(fring_acquire(&prod), 1);
+    fring_publish(&prod);
+
+    uint64_t frame = 0;
+    assert(fring_read_begin(&cons, &frame) && frame == 1);
+
+    /* The producer never waits: a full lap reuses frame 1's slot */
+    for (uint32_t n = 2; n <= FRING_SLOTS; n++) {
+        fill(fring_acquire(&prod), n);
+        fring_publish(&prod);
+    }
+    assert(fring_read_end(&cons, frame));                 /* not yet */
+    fring_acquire(&prod);
+    assert(!fring_read_end(&cons, frame));                /* being rewritten */
+
+    fring_close(&cons);
+    fring_close(&prod);
+}
+
+static void test_attach_rejects_missing(void)
+{
+    static FrameRing r;
+    assert(!fring_attach(&r, "/raycaster-test-missing"));
+    assert(!fring_attach(&r, "no-slash"));
+    assert(!fring_create(&r, NULL));
+}
+
+static void test_attach_rejects_truncated(void)
+{
+    /* A valid header page with the slots cut off must not be mapped */
+    static FrameRing prod, cons;
+    assert(fring_create(&prod, ring_name()));
+    int fd = shm_open(ring_name(), O_RDWR, 0);
+    assert(fd >= 0 && ftruncate(fd, 4096) == 0);
+    close(fd);
+    assert(!fring_attach(&cons, ring_name()));
+    fring_close(&prod);
+}
+
+static void test_close_unlinks_name(void)
+{
+    static FrameRing prod, cons;
+    assert(fring_create(&prod, ring_name()));
+    assert(fring_attach(&cons, ring_name()));
+    fill(fring_acquire(&prod), 7);
+    fring_publish(&prod);
+    fring_close(&prod);
+
+    /* An attached reader keeps its mapping; new readers find nothing */
+    uint64_t frame = 0;
+    const uint32_t *px = fring_read_begin(&cons, &frame);
+    assert(px && uniform(px, 7));
+    fring_close(&cons);
+    static FrameRing late;
+    assert(!fring_attach(&late, ring_name()));
+}
+
+/* ── Concurrency ──────────────────────────────────────────────────── */
+
+#define STRESS_FRAMES 400
+
+static int stress_producer(void *arg)
+{
+    FrameRing *prod = arg;
+    for (uint32_t n = 1; n <= STRESS_FRAMES; n++) {
+        fill(fring_acquire(prod), n);
+        fring_publish(prod);
+    }
+    return 0;
+}
+
+static void test_concurrent_reads_never_torn(void)
+{
+    static FrameRing prod, cons;
+    assert(fring_create(&prod, ring_name()));
+    assert(fring_attach(&cons, ring_name()));
+
+    thrd_t t;
+    assert(thrd_create(&t, stress_producer, &prod) == thrd_success);
+
+    /* Every read that validates must be one whole frame */
+    int good = 0;
+    uint64_t last = 0, frame = 0;
+    while (last < STRESS_FRAMES) {
+        const uint32_t *px = fring_read_begin(&cons, &frame);
+        if (!px) continue;
+        bool same = uniform(px, (uint32_t)frame);
+        if (fring_read_end(&cons, frame)) {
+            assert(same);
+            assert(frame >= last);
+            last = frame;
+            good++;
+        }
+    }
+    thrd_join(t, NULL);
+    assert(good > 0);
+
+    fring_close(&cons);
+    fring_close(&prod);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── frame ring ──────────────────────────────────────────\n");
+    RUN_TEST(test_reader_sees_published_frame);
+    RUN_TEST(test_busy_slot_keeps_last_frame);
+    RUN_TEST(test_overwrite_detected);
+    RUN_TEST(test_attach_rejects_missing);
+    RUN_TEST(test_attach_rejects_truncated);
+    RUN_TEST(test_close_unlinks_name);
+    RUN_TEST(test_concurrent_reads_never_torn);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,434 @@
+/*  test_jobs.c  –  tests and microbenchmarks for the work-stealing pool
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against jobs.o, raycaster.o, render.o and entity.o — no SDL
+ *  dependency.  Checks that parallel-for covers every index exactly
+ *  once, that dependency counters order stages, that callers on other
+ *  threads can share the pool, and that the parallel cast, draw and
+ *  entity update match their serial versions bit for bit.  Then times
+ *  the job overhead and the frame stages, serial against pooled.
+ *  Build:  make test
+ *  Run:    ./test_jobs
+ */
+#include "jobs.h"
+#include "entity.h"
+#include "map_edit.h"
+#include "raycaster.h"
+#include "render.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+#define WORKERS  3
+#define COVER_N  100000
+
+static JobPool pool;
+
+static atomic_int hits[COVER_N];
+
+static void mark(void *arg, int begin, int end)
+{
+    (void)arg;
+    for (int i = begin; i < end; i++) atomic_fetch_add(&hits[i], 1);
+}
+
+static bool covered_once(int begin, int end)
+{
+    for (int i = 0; i < COVER_N; i++) {
+        int want = (i >= begin && i < end) ? 1 : 0;
+        if (atomic_load(&hits[i]) != want) return false;
+    }
+    return true;
+}
+
+static void clear_hits(void)
+{
+    for (int i = 0; i < COVER_N; i++) atomic_store(&hits[i], 0);
+}
+
+/** A 48x48 room with pillars and a few sprites. */
+static void build_map(Map *m)
+{
+    memset(m, 0, sizeof(*m));
+    m->w = m->h = 48;
+    for (int y = 0; y < m->h; y++)
+        for (int x = 0; x < m->w; x++) {
+            bool edge = x == 0 || y == 0 || x == m->w - 1 || y == m->h - 1;
+            bool pillar = x % 6 == 3 && y % 6 == 3;
+            if (edge || pillar) m->tiles[y][x] = (uint16_t)(1 + (x + y) % 4);
+            else if ((x * 7 + y * 3) % 23 == 0) m->sprites[y][x] = 1 + (x % 3);
+        }
+}
+
+static void place_player(GameState *gs, float x, float y, float angle)
+{
+    memset(gs, 0, sizeof(*gs));
+    gs->player.x = x;
+    gs->player.y = y;
+    gs->player.dir_x = cosf(angle);
+    gs->player.dir_y = sinf(angle);
+    gs->player.plane_x = -gs->player.dir_y * 0.66f;
+    gs->player.plane_y =  gs->player.dir_x * 0.66f;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Scheduling tests                                                  */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_parallel_for_covers_range(void)
+{
+    const int cases[][3] = {         /* begin, end, grain */
+        { 0, COVER_N, 1 }, { 0, COVER_N, 1000 }, { 17, 9001, 64 },
+        { 5, 6, 1 }, { 0, 0, 1 }, { 10, 5, 1 }, { 0, 100, 1000 },
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        clear_hits();
+        job_parallel_for(&pool, cases[c][0], cases[c][1], cases[c][2], mark, NULL);
+        assert(covered_once(cases[c][0], cases[c][1] > cases[c][0] ? cases[c][1]
+                                                                   : cases[c][0]));
+    }
+
+    /* Without a pool the caller does it all in one call */
+    clear_hits();
+    job_parallel_for(NULL, 0, COVER_N, 8, mark, NULL);
+    assert(covered_once(0, COVER_N));
+}
+
+static void nested(void *arg, int begin, int end)
+{
+    (void)arg;
+    for (int i = begin; i < end; i++)
+        job_parallel_for(&pool, i * 1000, (i + 1) * 1000, 50, mark, NULL);
+}
+
+static void test_nested_parallel_for(void)
+{
+    /* Jobs that wait for jobs run others meanwhile instead of blocking */
+    clear_hits();
+    job_parallel_for(&pool, 0, COVER_N / 1000, 1, nested, NULL);
+    assert(covered_once(0, COVER_N));
+}
+
+typedef struct Stage {
+    int a[JOB_FOR_CHUNKS];
+    int b[JOB_FOR_CHUNKS];
+} Stage;
+
+static void stage_a(void *arg, int begin, int end)
+{
+    Stage *s = arg;
+    for (int i = begin; i < end; i++) s->a[i] = i * 3;
+}
+
+static void stage_b(void *arg, int begin, int end)
+{
+    /* Reads every result of stage A, not just its own */
+    Stage *s = arg;
+    int sum = 0;
+    for (int i = 0; i < JOB_FOR_CHUNKS; i++) sum += s->a[i];
+    for (int i = begin; i < end; i++) s->b[i] = sum + i;
+}
+
+static void test_counter_releases_next_stage(void)
+{
+    static Stage s;
+    for (int round = 0; round < 50; round++) {
+        memset(&s, 0, sizeof(s));
+        JobCounter a_done, b_done;
+        job_counter_init(&a_done);
+        job_counter_init(&b_done);
+
+        /* Stage B is registered first, then A is submitted in one go */
+        for (int i = 0; i < 4; i++) {
+            Job b = { stage_b, &s, i * 16, (i + 1) * 16, &b_done };
+            assert(job_then(&a_done, &b));
+        }
+        Job a[JOB_FOR_CHUNKS];
+        for (int i = 0; i < JOB_FOR_CHUNKS; i++)
+            a[i] = (Job){ stage_a, &s, i, i + 1, &a_done };
+        job_submit(&pool, a, JOB_FOR_CHUNKS);
+
+        /* Waiting on B alone is enough: it cannot drain before A does */
+        job_wait(&pool, &b_done);
+        int sum = 3 * JOB_FOR_CHUNKS * (JOB_FOR_CHUNKS - 1) / 2;
+        for (int i = 0; i < JOB_FOR_CHUNKS; i++) assert(s.b[i] == sum + i);
+    }
+
+    JobCounter c;
+    job_counter_init(&c);
+    Job j = { stage_b, &s, 0, 1, NULL };
+    for (int i = 0; i < JOB_MAX_THEN; i++) assert(job_then(&c, &j));
+    assert(!job_then(&c, &j));
+}
+
+static void test_overflow_runs_inline(void)
+{
+    /* More jobs than a deque holds: the excess runs on the submitter */
+    enum { N = JOB_DEQUE_SIZE * 3 };
+    static Job jobs[N];
+    JobCounter done;
+    job_counter_init(&done);
+    clear_hits();
+    for (int i = 0; i < N; i++)
+        jobs[i] = (Job){ mark, NULL, i * 10, (i + 1) * 10, &done };
+    job_submit(&pool, jobs, N);
+    job_wait(&pool, &done);
+    assert(covered_once(0, N * 10));
+}
+
+static int outside_caller(void *arg)
+{
+    /* Like the simulation thread: its own ranges, its own waits */
+    int half = *(int *)arg;
+    for (int r = 0; r < 20; r++)
+        job_parallel_for(&pool, half * (COVER_N / 2) + r * 2500,
+                         half * (COVER_N / 2) + (r + 1) * 2500, 100, mark, NULL);
+    return 0;
+}
+
+static void test_two_outside_threads_share_pool(void)
+{
+    clear_hits();
+    int halves[2] = { 0, 1 };
+    thrd_t t[2];
+    for (int i = 0; i < 2; i++)
+        assert(thrd_create(&t[i], outside_caller, &halves[i]) == thrd_success);
+    for (int i = 0; i < 2; i++) thrd_join(t[i], NULL);
+    assert(covered_once(0, COVER_N));
+}
+
+static void test_zero_workers_run_on_waiter(void)
+{
+    static JobPool solo;
+    assert(job_pool_start(&solo, 0));
+    JobCounter done;
+    job_counter_init(&done);
+    clear_hits();
+    Job j[4];
+    for (int i = 0; i < 4; i++) j[i] = (Job){ mark, NULL, i * 100, (i + 1) * 100, &done };
+    job_submit(&solo, j, 4);
+    assert(atomic_load(&hits[0]) == 0);                  /* nobody ran it */
+    job_wait(&solo, &done);
+    assert(covered_once(0, 400));
+    job_pool_stop(&solo);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Frame stage tests                                                 */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_cast_matches_serial(void)
+{
+    static Map map;
+    static GameState a, b;
+    build_map(&map);
+    for (int k = 0; k < 16; k++) {
+        float x = 2.5f + (float)(k * 5 % 43), y = 2.5f + (float)(k * 11 % 43);
+        if (map.tiles[(int)y][(int)x]) x += 1.0f;
+        place_player(&a, x, y, 0.4f * (float)k);
+        place_player(&b, x, y, 0.4f * (float)k);
+        rc_cast(&a, &map);
+        rc_cast_jobs(&b, &map, &pool);
+        assert(memcmp(a.hits, b.hits, sizeof(a.hits)) == 0);
+        assert(memcmp(a.z_buffer, b.z_buffer, sizeof(a.z_buffer)) == 0);
+        assert(a.visible_sprite_count == b.visible_sprite_count);
+        for (int i = 0; i < a.visible_sprite_count; i++) {
+            assert(a.visible_sprites[i].id == b.visible_sprites[i].id);
+            assert(a.visible_sprites[i].perp_dist == b.visible_sprites[i].perp_dist);
+        }
+    }
+}
+
+static void test_render_matches_serial(void)
+{
+    static Map map;
+    static GameState gs;
+    static TextureAtlas atlas;
+    static uint32_t fa[SCREEN_W * SCREEN_H], fb[SCREEN_W * SCREEN_H];
+    static float    za[SCREEN_W * SCREEN_H], zb[SCREEN_W * SCREEN_H];
+    static uint32_t ia[SCREEN_W * SCREEN_H], ib[SCREEN_W * SCREEN_H];
+    build_map(&map);
+    render_atlas_solid(&atlas);
+    for (int k = 0; k < 8; k++) {
+        place_player(&gs, 4.5f + (float)k, 5.5f, 0.7f * (float)k);
+        rc_cast(&gs, &map);
+        RenderAux aa = { za, ia }, ab = { zb, ib };
+        render_frame_aux(&gs, &atlas, fa, SCREEN_W, &aa);
+        render_frame_jobs(&gs, &atlas, fb, SCREEN_W, &ab, &pool);
+        assert(memcmp(fa, fb, sizeof(fa)) == 0);
+        assert(memcmp(za, zb, sizeof(za)) == 0);
+        assert(memcmp(ia, ib, sizeof(ia)) == 0);
+    }
+}
+
+typedef struct EntArgs {
+    EntityPool         *ep;
+    const MapOccupancy *occ;
+} EntArgs;
+
+static void ent_range(void *arg, int begin, int end)
+{
+    const EntArgs *e = arg;
+    ent_update_range(e->ep, e->occ, 1.0f / 60.0f, begin, end);
+}
+
+static void test_entity_ranges_match_serial(void)
+{
+    static Map map;
+    static MapOccupancy occ;
+    static EntityPool a, b;
+    build_map(&map);
+    map_occupancy_build(&occ, &map);
+    ent_populate(&a, &occ, 5000, 7);
+    b = a;
+    EntArgs args = { &b, &occ };
+    for (int t = 0; t < 120; t++) {
+        ent_update(&a, &occ, 1.0f / 60.0f);
+        job_parallel_for(&pool, 0, b.count, 333, ent_range, &args);
+    }
+    assert(memcmp(a.x, b.x, sizeof(float) * (size_t)a.count) == 0);
+    assert(memcmp(a.y, b.y, sizeof(float) * (size_t)a.count) == 0);
+    assert(memcmp(a.vx, b.vx, sizeof(float) * (size_t)a.count) == 0);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Microbenchmarks (reported, not asserted)                          */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void nothing(void *arg, int begin, int end)
+{
+    (void)arg; (void)begin; (void)end;
+}
+
+static void bench_job_overhead(void)
+{
+    enum { N = 200, ROUNDS = 200 };
+    static Job jobs[N];
+    double t0 = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        JobCounter done;
+        job_counter_init(&done);
+        for (int i = 0; i < N; i++) jobs[i] = (Job){ nothing, NULL, 0, 0, &done };
+        job_submit(&pool, jobs, N);
+        job_wait(&pool, &done);
+    }
+    double per = (now() - t0) / (N * ROUNDS);
+    printf("  %-42s %9.0f ns\n", "empty job, submit to done", per * 1e9);
+}
+
+static void bench_frame_stages(void)
+{
+    enum { FRAMES = 60 };
+    static Map map;
+    static GameState gs;
+    static TextureAtlas atlas;
+    static uint32_t fb[SCREEN_W * SCREEN_H];
+    build_map(&map);
+    render_atlas_solid(&atlas);
+
+    JobPool *pools[2] = { NULL, &pool };
+    double cast[2], draw[2];
+    for (int p = 0; p < 2; p++) {
+        double tc = 0.0, td = 0.0;
+        for (int f = 0; f < FRAMES; f++) {
+            place_player(&gs, 10.5f, 20.5f, 0.1f * (float)f);
+            double t0 = now();
+            rc_cast_jobs(&gs, &map, pools[p]);
+            double t1 = now();
+            render_frame_jobs(&gs, &atlas, fb, SCREEN_W, NULL, pools[p]);
+            tc += t1 - t0;
+            td += now() - t1;
+        }
+        cast[p] = tc / FRAMES;
+        draw[p] = td / FRAMES;
+    }
+    printf("  %-42s %9.1f us  ->  %7.1f us\n", "rc_cast, serial -> pooled",
+           cast[0] * 1e6, cast[1] * 1e6);
+    printf("  %-42s %9.1f us  ->  %7.1f us\n", "render_frame, serial -> pooled",
+           draw[0] * 1e6, draw[1] * 1e6);
+}
+
+static void bench_entities(void)
+{
+    enum { TICKS = 100 };
+    static Map map;
+    static MapOccupancy occ;
+    static EntityPool ep;
+    build_map(&map);
+    map_occupancy_build(&occ, &map);
+    ent_populate(&ep, &occ, MAX_ENTITIES, 3);
+    EntArgs args = { &ep, &occ };
+
+    double t0 = now();
+    for (int t = 0; t < TICKS; t++) ent_update(&ep, &occ, 1.0f / 60.0f);
+    double t1 = now();
+    for (int t = 0; t < TICKS; t++)
+        job_parallel_for(&pool, 0, ep.count, 1024, ent_range, &args);
+    double t2 = now();
+    char name[64];
+    snprintf(name, sizeof(name), "ent_update x%d, serial -> pooled", ep.count);
+    printf("  %-42s %9.1f us  ->  %7.1f us\n", name,
+           (t1 - t0) / TICKS * 1e6, (t2 - t1) / TICKS * 1e6);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    assert(job_pool_start(&pool, WORKERS));
+
+    printf("\n── scheduling ──────────────────────────────────────────\n");
+    RUN_TEST(test_parallel_for_covers_range);
+    RUN_TEST(test_nested_parallel_for);
+    RUN_TEST(test_counter_releases_next_stage);
+    RUN_TEST(test_overflow_runs_inline);
+    RUN_TEST(test_two_outside_threads_share_pool);
+    RUN_TEST(test_zero_workers_run_on_waiter);
+
+    printf("\n── frame stages ────────────────────────────────────────\n");
+    RUN_TEST(test_cast_matches_serial);
+    RUN_TEST(test_render_matches_serial);
+    RUN_TEST(test_entity_ranges_match_serial);
+
+    printf("\n── benchmarks (%d workers + caller) ─────────────────────\n",
+           WORKERS);
+    bench_job_overhead();
+    bench_frame_stages();
+    bench_entities();
+    printf("  %u jobs run, %u stolen\n", atomic_load(&pool.executed),
+           atomic_load(&pool.stolen));
+    job_pool_stop(&pool);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/*  test_level.c  –  tests for level switching and background preloading
+ *  ─────────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o, level.o, map_edit.o, map_cache.o and
+ *  map_manager_ascii.o — no SDL dependency.  Writes temporary level
+ *  lists that point at the map assets copied next to the test binary.
+ *  Build:  make test
+ *  Run:    ./test_level
+ */
+#include "raycaster.h"
+#include "level.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+#define LIST_PATH "test_levels.txt"
+#define LEVEL1    "assets/map_tiles.txt assets/map_sprites.txt assets/map_info.txt\n"
+#define LEVEL2    "assets/level2_tiles.txt assets/level2_sprites.txt assets/level2_info.txt\n"
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static void write_list(const char *contents)
+{
+    FILE *fp = fopen(LIST_PATH, "w");
+    assert(fp);
+    fputs(contents, fp);
+    fclose(fp);
+}
+
+static bool wait_next_ready(LevelManager *lm)
+{
+    for (int i = 0; i < 2000; i++) {
+        if (level_next_ready(lm)) return true;
+        thrd_sleep(&(struct timespec){ .tv_nsec = 1000000 }, NULL);
+    }
+    return false;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Level manager tests                                               */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_level_open_loads_first(void)
+{
+    write_list("# two levels\n" LEVEL1 "\n" LEVEL2);
+
+    static LevelManager lm;
+    assert(level_open(&lm, LIST_PATH, NULL));
+    assert(lm.count == 2);
+    assert(lm.current == 0);
+    assert(lm.active->map.w > 0);
+
+    /* Spawn pose comes from the first level's info plane */
+    int sx = (int)lm.active->spawn.x, sy = (int)lm.active->spawn.y;
+    assert(lm.active->map.info[sy][sx] == INFO_SPAWN_PLAYER_E);
+
+    level_close(&lm);
+}
+
+static void test_level_preloads_next(void)
+{
+    write_list(LEVEL1 LEVEL2);
+
+    static LevelManager lm;
+    level_open(&lm, LIST_PATH, NULL);
+    assert(wait_next_ready(&lm));
+
+    /* The spare slot holds level 2 and its derived occupancy bits */
+    assert(lm.next->map.w == 24);
+    assert(map_occupancy_solid(&lm.next->occupancy, 0, 0));
+    assert(lm.next->occupancy.revision == lm.next->map.revision);
+
+    level_close(&lm);
+}
+
+static void test_level_advance_swaps_slots(void)
+{
+    write_list(LEVEL1 LEVEL2);
+
+    static LevelManager lm;
+    level_open(&lm, LIST_PATH, NULL);
+    assert(wait_next_ready(&lm));
+
+    Level *old_active = lm.active;
+    Level *old_next   = lm.next;
+    assert(level_advance(&lm));
+
+    /* A pointer swap: no copy of the map planes */
+    assert(lm.active == old_next);
+    assert(lm.next == old_active);
+    assert(lm.current == 1);
+    assert(lm.active->map.w == 24);
+
+    level_close(&lm);
+}
+
+static void test_level_advance_past_last(void)
+{
+    write_list(LEVEL1);
+
+    static LevelManager lm;
+    level_open(&lm, LIST_PATH, NULL);
+    assert(!level_next_ready(&lm));
+    assert(!level_advance(&lm));
+    assert(lm.current == 0);
+
+    level_close(&lm);
+}
+
+static void test_level_advance_without_waiting(void)
+{
+    /* Advancing immediately blocks until the preload completes */
+    write_list(LEVEL1 LEVEL2 LEVEL1);
+
+    static LevelManager lm;
+    level_open(&lm, LIST_PATH, NULL);
+    assert(level_advance(&lm));
+    assert(level_advance(&lm));
+    assert(lm.current == 2);
+    assert(lm.active->map.w == 16);
+    assert(!level_advance(&lm));
+
+    level_close(&lm);
+}
+
+static void test_level_missing_next_map(void)
+{
+    write_list(LEVEL1 "nonexistent.txt - nonexistent.txt\n");
+
+    static LevelManager lm;
+    assert(level_open(&lm, LIST_PATH, NULL));
+    assert(!level_advance(&lm));
+
+    level_close(&lm);
+}
+
+static void test_level_reuses_cache(void)
+{
+    write_list(LEVEL1);
+
+    /* First open may hit or miss (earlier runs); the second must hit */
+    static LevelManager lm;
+    assert(level_open(&lm, LIST_PATH, "test_level_cache"));
+    level_close(&lm);
+
+    assert(level_open(&lm, LIST_PATH, "test_level_cache"));
+    assert(lm.active->cache_hits == 3);   /* occupancy, triggers, jumps */
+    assert(map_occupancy_solid(&lm.active->occupancy, 0, 0));
+    assert(!path_open(&lm.active->jumps, 0, 0));
+    level_close(&lm);
+}
+
+static void test_level_bad_list(void)
+{
+    static LevelManager lm;
+    assert(!level_open(&lm, "nonexistent_levels.txt", NULL));
+
+    write_list("# only comments\n\n");
+    assert(!level_open(&lm, LIST_PATH, NULL));
+
+    write_list("assets/map_tiles.txt assets/map_info.txt\n");
+    assert(!level_open(&lm, LIST_PATH, NULL));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── level switching ─────────────────────────────────────\n");
+    RUN_TEST(test_level_open_loads_first);
+    RUN_TEST(test_level_preloads_next);
+    RUN_TEST(test_level_advance_swaps_slots);
+    RUN_TEST(test_level_advance_past_last);
+    RUN_TEST(test_level_advance_without_waiting);
+    RUN_TEST(test_level_missing_next_map);
+    RUN_TEST(test_level_reuses_cache);
+    RUN_TEST(test_level_bad_list);
+
+    remove(LIST_PATH);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
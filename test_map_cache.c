@@ -0,0 +1,233 @@
+/*  test_map_cache.c  –  tests for the derived-data cache
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o, map_cache.o and map_edit.o — no SDL
+ *  dependency.  Maps are built inline; cache entries are written to a
+ *  scratch directory next to the test binary.
+ *  Build:  make test
+ *  Run:    ./test_map_cache
+ */
+#include "raycaster.h"
+#include "map_cache.h"
+#include "map_edit.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CACHE_DIR "test_cache"
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helper: walled box map with one pillar ───────────────────────── */
+
+static void init_walled(Map *map, int w, int h)
+{
+    init_box(map, w, h);
+    map->tiles[3][4] = 2;
+}
+
+/* ── Helper: counting occupancy builder ───────────────────────────── */
+
+static int builds = 0;
+
+static void build_occupancy(void *data, const Map *map)
+{
+    builds++;
+    map_occupancy_build(data, map);
+}
+
+/** Remove the cache entry for a map so each test starts cold. */
+static void clear_entry(const Map *map, const char *name)
+{
+    char path[MAP_CACHE_PATH_MAX + 64];
+    snprintf(path, sizeof(path), "%s/%016llx-%s.bin", CACHE_DIR,
+             (unsigned long long)map_hash(map), name);
+    remove(path);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Hash tests                                                        */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_hash_deterministic(void)
+{
+    static Map a, b;
+    init_walled(&a, 12, 10);
+    init_walled(&b, 12, 10);
+    assert(map_hash(&a) == map_hash(&b));
+}
+
+static void test_hash_sees_every_plane(void)
+{
+    static Map map;
+    init_walled(&map, 12, 10);
+    uint64_t h0 = map_hash(&map);
+
+    map.tiles[5][5] = 3;
+    uint64_t h1 = map_hash(&map);
+    map.info[5][5] = INFO_TRIGGER_DAMAGE;
+    uint64_t h2 = map_hash(&map);
+    map.sprites[5][5] = 1;
+    uint64_t h3 = map_hash(&map);
+
+    assert(h0 != h1 && h1 != h2 && h2 != h3);
+}
+
+static void test_hash_sees_size(void)
+{
+    static Map a, b;
+    init_walled(&a, 12, 10);
+    init_walled(&b, 12, 10);
+    b.w = 13;                    /* extra column is all floor */
+    assert(map_hash(&a) != map_hash(&b));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Cache tests                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_miss_then_hit(void)
+{
+    static Map map;
+    init_walled(&map, 12, 10);
+    clear_entry(&map, "occupancy");
+
+    MapCache mc;
+    MapOccupancy first, second;
+    builds = 0;
+
+    map_cache_open(&mc, CACHE_DIR, &map);
+    assert(!map_cache_fetch(&mc, "occupancy", MAP_OCCUPANCY_VERSION, &first,
+                            sizeof(first), build_occupancy, &map));
+    assert(builds == 1);
+
+    map_cache_open(&mc, CACHE_DIR, &map);
+    memset(&second, 0xAB, sizeof(second));
+    assert(map_cache_fetch(&mc, "occupancy", MAP_OCCUPANCY_VERSION, &second,
+                           sizeof(second), build_occupancy, &map));
+    assert(builds == 1);
+    assert(mc.hits == 1 && mc.misses == 0);
+    assert(memcmp(&first, &second, sizeof(first)) == 0);
+}
+
+static void test_version_mismatch_rebuilds(void)
+{
+    static Map map;
+    init_walled(&map, 12, 10);
+    clear_entry(&map, "occupancy");
+
+    MapCache mc;
+    MapOccupancy occ;
+    map_cache_open(&mc, CACHE_DIR, &map);
+    map_cache_fetch(&mc, "occupancy", 1, &occ, sizeof(occ),
+                    build_occupancy, &map);
+
+    builds = 0;
+    assert(!map_cache_fetch(&mc, "occupancy", 2, &occ, sizeof(occ),
+                            build_occupancy, &map));
+    assert(builds == 1);
+    /* The rebuilt entry replaced the old one */
+    assert(map_cache_fetch(&mc, "occupancy", 2, &occ, sizeof(occ),
+                           build_occupancy, &map));
+}
+
+static void test_edited_map_misses(void)
+{
+    static Map map;
+    init_walled(&map, 12, 10);
+    clear_entry(&map, "occupancy");
+
+    MapCache mc;
+    MapOccupancy occ;
+    map_cache_open(&mc, CACHE_DIR, &map);
+    map_cache_fetch(&mc, "occupancy", 1, &occ, sizeof(occ),
+                    build_occupancy, &map);
+
+    map.tiles[6][6] = 5;
+    clear_entry(&map, "occupancy");
+    map_cache_open(&mc, CACHE_DIR, &map);
+    assert(!map_cache_fetch(&mc, "occupancy", 1, &occ, sizeof(occ),
+                            build_occupancy, &map));
+    assert(map_occupancy_solid(&occ, 6, 6));
+}
+
+static void test_corrupt_entry_rebuilds(void)
+{
+    static Map map;
+    init_walled(&map, 12, 10);
+    clear_entry(&map, "occupancy");
+
+    MapCache mc;
+    MapOccupancy occ;
+    map_cache_open(&mc, CACHE_DIR, &map);
+    map_cache_fetch(&mc, "occupancy", 1, &occ, sizeof(occ),
+                    build_occupancy, &map);
+
+    /* Truncate the entry behind the cache's back */
+    char path[MAP_CACHE_PATH_MAX + 64];
+    snprintf(path, sizeof(path), "%s/%016llx-occupancy.bin", CACHE_DIR,
+             (unsigned long long)mc.hash);
+    FILE *fp = fopen(path, "wb");
+    assert(fp);
+    fputs("RCDC", fp);
+    fclose(fp);
+
+    builds = 0;
+    assert(!map_cache_fetch(&mc, "occupancy", 1, &occ, sizeof(occ),
+                            build_occupancy, &map));
+    assert(builds == 1);
+    assert(map_occupancy_solid(&occ, 4, 3));
+}
+
+static void test_disabled_always_builds(void)
+{
+    static Map map;
+    init_walled(&map, 12, 10);
+
+    MapCache mc;
+    MapOccupancy occ;
+    builds = 0;
+    map_cache_open(&mc, NULL, &map);
+    for (int i = 0; i < 3; i++)
+        assert(!map_cache_fetch(&mc, "occupancy", 1, &occ, sizeof(occ),
+                                build_occupancy, &map));
+    assert(builds == 3);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── map hash ────────────────────────────────────────────\n");
+    RUN_TEST(test_hash_deterministic);
+    RUN_TEST(test_hash_sees_every_plane);
+    RUN_TEST(test_hash_sees_size);
+
+    printf("\n── derived-data cache ──────────────────────────────────\n");
+    RUN_TEST(test_miss_then_hit);
+    RUN_TEST(test_version_mismatch_rebuilds);
+    RUN_TEST(test_edited_map_misses);
+    RUN_TEST(test_corrupt_entry_rebuilds);
+    RUN_TEST(test_disabled_always_builds);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,282 @@
+/*  test_map_edit.c  –  tests for the map mutation API and derived data
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o and map_edit.o — no SDL dependency.
+ *  Maps are built inline, so these tests are filesystem-independent.
+ *  Build:  make test
+ *  Run:    ./test_map_edit
+ */
+#include "raycaster.h"
+#include "map_edit.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helper: compare incremental occupancy against a fresh build ──── */
+
+static bool occupancy_matches_rebuild(const MapOccupancy *occ, const Map *map)
+{
+    MapOccupancy fresh;
+    map_occupancy_build(&fresh, map);
+    for (int y = 0; y < map->h; y++)
+        if (fresh.rows[y] != occ->rows[y]) return false;
+    return fresh.revision == occ->revision;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Mutation API tests                                                */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_set_tile_bumps_revision(void)
+{
+    static Map map;
+    init_box(&map, 10, 10);
+    assert(map.revision == 0);
+
+    assert(map_set_tile(&map, 4, 5, 3));
+    assert(map.tiles[5][4] == 3);
+    assert(map.revision == 1);
+
+    MapChange c = map_change_at(&map, 1);
+    assert(c.x == 4 && c.y == 5);
+}
+
+static void test_set_same_value_is_noop(void)
+{
+    static Map map;
+    init_box(&map, 10, 10);
+
+    assert(!map_set_tile(&map, 0, 0, 1));   /* already a wall */
+    assert(!map_set_info(&map, 3, 3, INFO_EMPTY));
+    assert(map.revision == 0);
+}
+
+static void test_set_out_of_bounds_ignored(void)
+{
+    static Map map;
+    init_box(&map, 10, 10);
+
+    assert(!map_set_tile(&map, -1, 2, 1));
+    assert(!map_set_sprite(&map, 10, 2, 1));
+    assert(!map_set_info(&map, 2, 10, INFO_TRIGGER_ENDGAME));
+    assert(map.revision == 0);
+}
+
+static void test_set_info_and_sprite_planes(void)
+{
+    static Map map;
+    init_box(&map, 10, 10);
+
+    assert(map_set_info(&map, 2, 3, INFO_TRIGGER_ENDGAME));
+    assert(map_set_sprite(&map, 6, 7, 2));
+    assert(map.info[3][2] == INFO_TRIGGER_ENDGAME);
+    assert(map.sprites[7][6] == 2);
+    assert(map.revision == 2);
+    assert(map_change_at(&map, 2).x == 6);
+}
+
+static void test_changes_available_window(void)
+{
+    static Map map;
+    init_box(&map, 10, 10);
+
+    assert(map_changes_available(&map, 0));
+    for (int i = 0; i < MAP_CHANGE_LOG; i++)
+        map_set_tile(&map, 5, 5, (uint16_t)(i % 2 ? 0 : 2));
+    assert(map_changes_available(&map, 0));
+
+    /* One more edit pushes revision 1 out of the ring */
+    map_set_tile(&map, 4, 4, 2);
+    assert(!map_changes_available(&map, 0));
+    assert(map_changes_available(&map, 1));
+}
+
+static void test_invalidate_forces_rebuild(void)
+{
+    static Map map;
+    init_box(&map, 10, 10);
+    map_set_tile(&map, 2, 2, 1);
+
+    uint32_t before = map.revision;
+    map_invalidate(&map);
+    assert(map.revision > before);
+    assert(!map_changes_available(&map, before));
+    assert(map_changes_available(&map, map.revision));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Occupancy tests                                                   */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_occupancy_build(void)
+{
+    static Map map;
+    init_box(&map, 64, 20);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    assert(map_occupancy_solid(&occ, 0, 5));
+    assert(map_occupancy_solid(&occ, 63, 5));
+    assert(!map_occupancy_solid(&occ, 5, 5));
+    assert(map_occupancy_solid(&occ, -1, 5));
+    assert(map_occupancy_solid(&occ, 5, 20));
+}
+
+static void test_occupancy_incremental_door(void)
+{
+    /* Opening and closing a door only touches its cell */
+    static Map map;
+    init_box(&map, 10, 10);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    map_set_tile(&map, 5, 5, 4);
+    map_occupancy_sync(&occ, &map);
+    assert(map_occupancy_solid(&occ, 5, 5));
+
+    map_set_tile(&map, 5, 5, TILE_FLOOR);
+    map_set_tile(&map, 0, 3, TILE_FLOOR);
+    map_occupancy_sync(&occ, &map);
+    assert(!map_occupancy_solid(&occ, 5, 5));
+    assert(!map_occupancy_solid(&occ, 0, 3));
+    assert(occupancy_matches_rebuild(&occ, &map));
+}
+
+static void test_occupancy_many_edits_match_rebuild(void)
+{
+    /* Hundreds of pseudo-random door toggles per "tick" */
+    static Map map;
+    init_box(&map, 64, 64);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    uint32_t seed = 12345u;
+    for (int tick = 0; tick < 20; tick++) {
+        for (int i = 0; i < 300; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            int x = (int)((seed >> 8) % 64);
+            int y = (int)((seed >> 16) % 64);
+            map_set_tile(&map, x, y, (seed >> 4) & 1 ? 2 : TILE_FLOOR);
+        }
+        map_occupancy_sync(&occ, &map);
+        assert(occupancy_matches_rebuild(&occ, &map));
+    }
+}
+
+static void test_occupancy_sync_after_invalidate(void)
+{
+    static Map map;
+    init_box(&map, 10, 10);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, &map);
+
+    /* Bulk write behind the API's back, then invalidate */
+    for (int x = 1; x < 9; x++) map.tiles[4][x] = 1;
+    map_invalidate(&map);
+    map_occupancy_sync(&occ, &map);
+    assert(map_occupancy_solid(&occ, 3, 4));
+    assert(occupancy_matches_rebuild(&occ, &map));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Shared maps                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_cow_copies_on_first_write(void)
+{
+    static Map src, own_a, own_b;
+    static SharedMap sm;
+    init_box(&src, 10, 10);
+    map_share_init(&sm, &src);
+
+    MapCow a, b;
+    map_cow_init(&a, &sm, &own_a);
+    map_cow_init(&b, &sm, &own_b);
+    assert(a.map == &sm.map && b.map == &sm.map);
+    assert(atomic_load(&sm.refs) == 3);
+
+    /* Only the writer gets a copy; the shared planes never change */
+    Map *m = map_cow_write(&a);
+    assert(m == &own_a && a.map == &own_a && a.shared == NULL);
+    assert(map_set_tile(m, 4, 4, 2));
+    assert(sm.map.tiles[4][4] == 0 && b.map->tiles[4][4] == 0);
+    assert(atomic_load(&sm.refs) == 2);
+    assert(map_cow_write(&a) == &own_a);        /* copies once */
+
+    map_cow_release(&a);
+    map_cow_release(&b);
+    assert(map_share_release(&sm));             /* the last one */
+}
+
+static void test_cow_keeps_derived_data_in_sync(void)
+{
+    static Map src, own;
+    static SharedMap sm;
+    init_box(&src, 10, 10);
+    assert(map_set_tile(&src, 5, 5, 1));
+    map_share_init(&sm, &src);
+
+    MapCow cow;
+    map_cow_init(&cow, &sm, &own);
+    MapOccupancy occ;
+    map_occupancy_build(&occ, cow.map);
+
+    /* The copy keeps the revision and change log, so occupancy built
+     * on the shared map follows the private edits incrementally */
+    Map *m = map_cow_write(&cow);
+    assert(m->revision == sm.map.revision);
+    map_set_tile(m, 5, 5, 0);
+    map_set_tile(m, 2, 7, 3);
+    assert(map_changes_available(m, occ.revision));
+    map_occupancy_sync(&occ, m);
+    assert(!map_occupancy_solid(&occ, 5, 5) && map_occupancy_solid(&occ, 2, 7));
+    assert(occupancy_matches_rebuild(&occ, m));
+    map_cow_release(&cow);
+    assert(map_share_release(&sm));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── map mutation ────────────────────────────────────────\n");
+    RUN_TEST(test_set_tile_bumps_revision);
+    RUN_TEST(test_set_same_value_is_noop);
+    RUN_TEST(test_set_out_of_bounds_ignored);
+    RUN_TEST(test_set_info_and_sprite_planes);
+    RUN_TEST(test_changes_available_window);
+    RUN_TEST(test_invalidate_forces_rebuild);
+
+    printf("\n── occupancy ───────────────────────────────────────────\n");
+    RUN_TEST(test_occupancy_build);
+    RUN_TEST(test_occupancy_incremental_door);
+    RUN_TEST(test_occupancy_many_edits_match_rebuild);
+    RUN_TEST(test_occupancy_sync_after_invalidate);
+
+    printf("\n── shared maps ─────────────────────────────────────────\n");
+    RUN_TEST(test_cow_copies_on_first_write);
+    RUN_TEST(test_cow_keeps_derived_data_in_sync);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
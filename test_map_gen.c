@@ -0,0 +1,284 @@
+/*  test_map_gen.c  –  tests for the procedural map generator
+ *  ──────────────────────────────────────────────────────────
+ *  Links against raycaster.o, map_gen.o and map_manager_ascii.o — no SDL
+ *  dependency.  Besides checking generated maps directly, it writes them
+ *  as ASCII triplets and reloads them through the real parser.
+ *  Build:  make test
+ *  Run:    ./test_map_gen
+ */
+#include "raycaster.h"
+#include "map_gen.h"
+#include "map_manager.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+#define GEN_TILES   "test_gen_tiles.txt"
+#define GEN_SPRITES "test_gen_sprites.txt"
+#define GEN_INFO    "test_gen_info.txt"
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+#define ASSERT_NEAR(a, b, eps)                                          \
+    do {                                                                \
+        float _a = (a), _b = (b), _e = (eps);                          \
+        if (fabsf(_a - _b) > _e) {                                     \
+            printf(" FAIL\n    %s:%d: %.4f != %.4f (eps %.4f)\n",       \
+                   __FILE__, __LINE__, _a, _b, _e);                     \
+            assert(0);                                                  \
+        }                                                               \
+    } while (0)
+
+/* ── Helper: is the endgame trigger reachable from the player? ────── */
+
+static bool endgame_reachable(const Map *map, const Player *p)
+{
+    static bool seen[MAP_MAX_H][MAP_MAX_W];
+    static int  queue[MAP_MAX_W * MAP_MAX_H];
+    memset(seen, 0, sizeof(seen));
+
+    int head = 0, tail = 0;
+    int sx = (int)p->x, sy = (int)p->y;
+    seen[sy][sx] = true;
+    queue[tail++] = sy * MAP_MAX_W + sx;
+
+    while (head < tail) {
+        int x = queue[head] % MAP_MAX_W, y = queue[head] / MAP_MAX_W;
+        head++;
+        if (map->info[y][x] == INFO_TRIGGER_ENDGAME) return true;
+
+        const int dx[4] = { 1, -1, 0, 0 }, dy[4] = { 0, 0, 1, -1 };
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d], ny = y + dy[d];
+            if (nx < 0 || ny < 0 || nx >= map->w || ny >= map->h) continue;
+            if (seen[ny][nx] || map->tiles[ny][nx] != TILE_FLOOR) continue;
+            seen[ny][nx] = true;
+            queue[tail++] = ny * MAP_MAX_W + nx;
+        }
+    }
+    return false;
+}
+
+static bool border_is_walled(const Map *map)
+{
+    for (int x = 0; x < map->w; x++)
+        if (map->tiles[0][x] == TILE_FLOOR || map->tiles[map->h - 1][x] == TILE_FLOOR)
+            return false;
+    for (int y = 0; y < map->h; y++)
+        if (map->tiles[y][0] == TILE_FLOOR || map->tiles[y][map->w - 1] == TILE_FLOOR)
+            return false;
+    return true;
+}
+
+static int count_sprites(const Map *map)
+{
+    int n = 0;
+    for (int y = 0; y < map->h; y++)
+        for (int x = 0; x < map->w; x++)
+            if (map->sprites[y][x] != SPRITE_EMPTY) n++;
+    return n;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  map_gen tests                                                     */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_gen_deterministic(void)
+{
+    static Map a, b;
+    Player pa, pb;
+    for (int k = 0; k < MAP_GEN_KIND_COUNT; k++) {
+        assert(map_gen(&a, &pa, (MapGenKind)k, 48, 40, 7u));
+        assert(map_gen(&b, &pb, (MapGenKind)k, 48, 40, 7u));
+        assert(memcmp(&a, &b, sizeof(a)) == 0);
+        assert(pa.x == pb.x && pa.y == pb.y);
+    }
+}
+
+static void test_gen_seed_changes_map(void)
+{
+    static Map a, b;
+    Player p;
+    map_gen(&a, &p, MAP_GEN_MAZE, 32, 32, 1u);
+    map_gen(&b, &p, MAP_GEN_MAZE, 32, 32, 2u);
+    assert(memcmp(a.tiles, b.tiles, sizeof(a.tiles)) != 0);
+}
+
+static void test_gen_all_kinds_playable(void)
+{
+    /* Every kind, at several sizes up to the engine maximum, has a walled
+     * border, a floor spawn and a reachable endgame trigger */
+    static const int sizes[][2] = { { 5, 5 }, { 16, 9 }, { 33, 64 },
+                                    { MAP_MAX_W, MAP_MAX_H } };
+    static Map map;
+    Player p;
+
+    for (int k = 0; k < MAP_GEN_KIND_COUNT; k++) {
+        for (int s = 0; s < 4; s++) {
+            for (uint32_t seed = 0; seed < 8; seed++) {
+                assert(map_gen(&map, &p, (MapGenKind)k,
+                               sizes[s][0], sizes[s][1], seed));
+                assert(map.w == sizes[s][0] && map.h == sizes[s][1]);
+                assert(border_is_walled(&map));
+                assert(map.tiles[(int)p.y][(int)p.x] == TILE_FLOOR);
+                assert(map.info[(int)p.y][(int)p.x] == INFO_SPAWN_PLAYER_E);
+                assert(endgame_reachable(&map, &p));
+            }
+        }
+    }
+}
+
+static void test_gen_rejects_bad_size(void)
+{
+    static Map map;
+    Player p;
+    assert(!map_gen(&map, &p, MAP_GEN_MAZE, 4, 10, 1u));
+    assert(!map_gen(&map, &p, MAP_GEN_MAZE, MAP_MAX_W + 1, 10, 1u));
+    assert(!map_gen(&map, &p, MAP_GEN_KIND_COUNT, 10, 10, 1u));
+}
+
+static void test_gen_arena_is_sprite_dense(void)
+{
+    static Map map;
+    Player p;
+    map_gen(&map, &p, MAP_GEN_ARENA, MAP_MAX_W, MAP_MAX_H, 3u);
+    /* Roughly a quarter of ~3,800 floor cells */
+    assert(count_sprites(&map) > 500);
+}
+
+static void test_gen_player_pose(void)
+{
+    static Map map;
+    Player p;
+    map_gen(&map, &p, MAP_GEN_CAVERN, 40, 40, 9u);
+
+    ASSERT_NEAR(p.x - (int)p.x, 0.5f, 0.0001f);
+    ASSERT_NEAR(p.dir_x, 1.0f, 0.0001f);
+    ASSERT_NEAR(p.plane_y, tanf(FOV_DEG * 0.5f * 3.14159265f / 180.0f), 0.001f);
+}
+
+static void test_gen_kind_from_name(void)
+{
+    MapGenKind k;
+    assert(map_gen_kind_from_name("maze", &k) && k == MAP_GEN_MAZE);
+    assert(map_gen_kind_from_name("cavern", &k) && k == MAP_GEN_CAVERN);
+    assert(map_gen_kind_from_name("arena", &k) && k == MAP_GEN_ARENA);
+    assert(!map_gen_kind_from_name("dungeon", &k));
+}
+
+static void test_gen_ascii_round_trip(void)
+{
+    /* Differential check: generator output == parser(writer(output)) */
+    static Map gen, loaded;
+    Player pg, pl;
+
+    for (int k = 0; k < MAP_GEN_KIND_COUNT; k++) {
+        map_gen(&gen, &pg, (MapGenKind)k, MAP_MAX_W, MAP_MAX_H, 11u);
+        assert(map_gen_write_ascii(&gen, GEN_TILES, GEN_SPRITES, GEN_INFO));
+        assert(map_load(&loaded, &pl, GEN_TILES, GEN_SPRITES, GEN_INFO));
+
+        assert(loaded.w == gen.w && loaded.h == gen.h);
+        assert(memcmp(loaded.tiles, gen.tiles, sizeof(gen.tiles)) == 0);
+        assert(memcmp(loaded.info, gen.info, sizeof(gen.info)) == 0);
+        assert(memcmp(loaded.sprites, gen.sprites, sizeof(gen.sprites)) == 0);
+        ASSERT_NEAR(pl.x, pg.x, 0.0001f);
+        ASSERT_NEAR(pl.y, pg.y, 0.0001f);
+    }
+
+    remove(GEN_TILES);
+    remove(GEN_SPRITES);
+    remove(GEN_INFO);
+}
+
+/* Two threads generating at once must each get the serial result */
+typedef struct GenJob {
+    MapGenKind kind;
+    Map        maps[8];
+} GenJob;
+
+static int gen_worker(void *arg)
+{
+    GenJob *job = arg;
+    Player p;
+    for (int i = 0; i < 8; i++)
+        if (!map_gen(&job->maps[i], &p, job->kind, MAP_MAX_W, MAP_MAX_H,
+                     (uint32_t)i + 1))
+            return 1;
+    return 0;
+}
+
+static void test_gen_concurrent_calls(void)
+{
+    static GenJob jobs[2] = { { .kind = MAP_GEN_CAVERN },
+                              { .kind = MAP_GEN_MAZE } };
+    static Map want;
+    Player p;
+    thrd_t t[2];
+    for (int j = 0; j < 2; j++)
+        assert(thrd_create(&t[j], gen_worker, &jobs[j]) == thrd_success);
+    for (int j = 0; j < 2; j++) {
+        int rc;
+        assert(thrd_join(t[j], &rc) == thrd_success && rc == 0);
+    }
+    for (int j = 0; j < 2; j++)
+        for (int i = 0; i < 8; i++) {
+            assert(map_gen(&want, &p, jobs[j].kind, MAP_MAX_W, MAP_MAX_H,
+                           (uint32_t)i + 1));
+            assert(memcmp(&want, &jobs[j].maps[i], sizeof(want)) == 0);
+        }
+}
+
+static void test_gen_cast_large_map(void)
+{
+    /* A full-size cavern renders without any ray escaping the map */
+    static Map map;
+    static GameState gs;
+    memset(&gs, 0, sizeof(gs));
+    map_gen(&map, &gs.player, MAP_GEN_CAVERN, MAP_MAX_W, MAP_MAX_H, 5u);
+
+    rc_cast(&gs, &map);
+    for (int x = 0; x < SCREEN_W; x++) {
+        assert(gs.hits[x].wall_dist > 0.0f);
+        assert(gs.hits[x].wall_dist < (float)(MAP_MAX_W + MAP_MAX_H));
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── map_gen ─────────────────────────────────────────────\n");
+    RUN_TEST(test_gen_deterministic);
+    RUN_TEST(test_gen_seed_changes_map);
+    RUN_TEST(test_gen_all_kinds_playable);
+    RUN_TEST(test_gen_rejects_bad_size);
+    RUN_TEST(test_gen_arena_is_sprite_dense);
+    RUN_TEST(test_gen_player_pose);
+    RUN_TEST(test_gen_kind_from_name);
+    RUN_TEST(test_gen_ascii_round_trip);
+    RUN_TEST(test_gen_concurrent_calls);
+    RUN_TEST(test_gen_cast_large_map);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -282,14 +282,14 @@ static void test_load_map_info_dimensions_match_tiles(void)
 
 static void test_load_map_game_state_unaffected(void)
 {
-    /* map_load should not touch GameState — only Map and Player */
-    GameState gs;
+    /* map_load should not touch SimState — only Map and Player */
+    SimState st;
     Map map;
-    memset(&gs, 0, sizeof(gs));
+    memset(&st, 0, sizeof(st));
     memset(&map, 0, sizeof(map));
-    map_load(&map, &gs.player, "assets/map_tiles.txt", "assets/map_info.txt", "assets/map_sprites.txt");
+    map_load(&map, &st.player, "assets/map_tiles.txt", "assets/map_info.txt", "assets/map_sprites.txt");
 
-    assert(!gs.game_over);
+    assert(!st.game_over);
 }
 
 /* ═══════════════════════════════════════════════════════════════════ */
@@ -0,0 +1,253 @@
+/*  test_map_stream.c  –  tests for the chunked streaming map backend
+ *  ──────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o and map_stream.o — no SDL dependency.
+ *  Each test writes a generated 64×64 map to a temporary chunked file,
+ *  opens it and drives map_stream_update() like the game loop would.
+ *  Build:  make test
+ *  Run:    ./test_map_stream
+ */
+#include "raycaster.h"
+#include "map_stream.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+#define TEST_PATH "test_map_stream.rcm"
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+#define ASSERT_NEAR(a, b, eps)                                          \
+    do {                                                                \
+        float _a = (a), _b = (b), _e = (eps);                          \
+        if (fabsf(_a - _b) > _e) {                                     \
+            printf(" FAIL\n    %s:%d: %.4f != %.4f (eps %.4f)\n",       \
+                   __FILE__, __LINE__, _a, _b, _e);                     \
+            assert(0);                                                  \
+        }                                                               \
+    } while (0)
+
+/* ── Helper: write a walled 64×64 map with one sprite per chunk ───── */
+
+static void write_test_map(void)
+{
+    static Map map;
+    memset(&map, 0, sizeof(map));
+    map.w = MAP_MAX_W;
+    map.h = MAP_MAX_H;
+
+    for (int r = 0; r < map.h; r++)
+        for (int c = 0; c < map.w; c++)
+            map.tiles[r][c] =
+                (r == 0 || r == map.h - 1 || c == 0 || c == map.w - 1) ? 2 : 0;
+
+    /* Marker sprite in the middle of every chunk */
+    for (int cy = 0; cy < MAP_CHUNKS_Y; cy++)
+        for (int cx = 0; cx < MAP_CHUNKS_X; cx++)
+            map.sprites[cy * MAP_CHUNK_SIZE + 8][cx * MAP_CHUNK_SIZE + 8] =
+                (uint16_t)((cx + cy) % 4 + 1);
+
+    Player spawn = { 8.5f, 8.5f, 1.0f, 0.0f, 0.0f, 0.66f };
+    bool ok = map_stream_write(&map, &spawn, TEST_PATH);
+    assert(ok);
+}
+
+/* ── Helper: pump updates until the cell's chunk is resident ──────── */
+
+static bool pump_until_resident(MapStream *ms, Map *map, const Player *p,
+                                int x, int y)
+{
+    for (int i = 0; i < 2000; i++) {
+        map_stream_update(ms, map, p);
+        if (map_stream_is_resident(ms, x, y)) return true;
+        thrd_sleep(&(struct timespec){ .tv_nsec = 1000000 }, NULL);
+    }
+    return false;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  map_stream tests                                                  */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_stream_open_header(void)
+{
+    write_test_map();
+
+    static Map map;
+    static MapStream ms;
+    Player p;
+    bool ok = map_stream_open(&ms, &map, &p, TEST_PATH, 0, 0);
+    assert(ok);
+
+    assert(map.w == MAP_MAX_W);
+    assert(map.h == MAP_MAX_H);
+    ASSERT_NEAR(p.x, 8.5f, 0.0001f);
+    ASSERT_NEAR(p.y, 8.5f, 0.0001f);
+    ASSERT_NEAR(p.dir_x, 1.0f, 0.0001f);
+    ASSERT_NEAR(p.plane_y, 0.66f, 0.0001f);
+
+    map_stream_close(&ms);
+}
+
+static void test_stream_spawn_chunk_resident(void)
+{
+    write_test_map();
+
+    static Map map;
+    static MapStream ms;
+    Player p;
+    map_stream_open(&ms, &map, &p, TEST_PATH, 0, 0);
+
+    /* Spawn chunk holds real data, including its marker sprite */
+    assert(map_stream_is_resident(&ms, 8, 8));
+    assert(map.tiles[0][0] == 2);
+    assert(map.tiles[8][8] == TILE_FLOOR);
+    assert(map.sprites[8][8] == 1);
+
+    map_stream_close(&ms);
+}
+
+static void test_stream_far_chunks_are_solid(void)
+{
+    write_test_map();
+
+    static Map map;
+    static MapStream ms;
+    Player p;
+    map_stream_open(&ms, &map, &p, TEST_PATH, 0, 0);
+
+    /* Far chunk has not been read: solid filler, no sprites */
+    assert(!map_stream_is_resident(&ms, 56, 56));
+    for (int r = 48; r < 64; r++) {
+        for (int c = 48; c < 64; c++) {
+            assert(map.tiles[r][c] == TILE_UNLOADED);
+            assert(map.sprites[r][c] == SPRITE_EMPTY);
+        }
+    }
+
+    map_stream_close(&ms);
+}
+
+static void test_stream_prefetch_neighbour(void)
+{
+    write_test_map();
+
+    static Map map;
+    static MapStream ms;
+    Player p;
+    map_stream_open(&ms, &map, &p, TEST_PATH, 0, 1 << 20);
+
+    /* With a generous budget the adjacent ring is read ahead */
+    assert(pump_until_resident(&ms, &map, &p, 24, 8));
+    assert(map.tiles[8][24] == TILE_FLOOR);
+    assert(map.sprites[8][24] == 2);
+
+    /* Two rings away stays unloaded */
+    assert(!map_stream_is_resident(&ms, 40, 8));
+
+    map_stream_close(&ms);
+}
+
+static void test_stream_lru_eviction(void)
+{
+    write_test_map();
+
+    static Map map;
+    static MapStream ms;
+    Player p;
+    map_stream_open(&ms, &map, &p, TEST_PATH, 0, 2 * MAP_CHUNK_BYTES);
+
+    /* Walk east one chunk at a time */
+    p.x = 24.5f;
+    assert(pump_until_resident(&ms, &map, &p, 24, 8));
+    p.x = 40.5f;
+    assert(pump_until_resident(&ms, &map, &p, 40, 8));
+    map_stream_update(&ms, &map, &p);
+
+    /* Budget of two: the oldest chunk (spawn) was evicted */
+    assert(ms.resident_count <= 2);
+    assert(!map_stream_is_resident(&ms, 8, 8));
+    assert(map.tiles[8][8] == TILE_UNLOADED);
+    assert(map.sprites[8][8] == SPRITE_EMPTY);
+    assert(map_stream_is_resident(&ms, 40, 8));
+
+    map_stream_close(&ms);
+}
+
+static void test_stream_cast_stops_at_unloaded(void)
+{
+    write_test_map();
+
+    static Map map;
+    static MapStream ms;
+    static GameState gs;
+    memset(&gs, 0, sizeof(gs));
+    map_stream_open(&ms, &map, &gs.player, TEST_PATH, 0, 0);
+
+    /* Looking east from (8.5, 8.5): the next chunk starts at x = 16 */
+    rc_cast(&gs, &map);
+    ASSERT_NEAR(gs.hits[SCREEN_W / 2].wall_dist, 7.5f, 0.01f);
+    assert(gs.hits[SCREEN_W / 2].tile_type == TILE_UNLOADED - 1);
+
+    map_stream_close(&ms);
+}
+
+static void test_stream_open_missing_file(void)
+{
+    static Map map;
+    static MapStream ms;
+    Player p;
+    assert(!map_stream_open(&ms, &map, &p, "nonexistent.rcm", 1, 0));
+}
+
+static void test_stream_open_bad_magic(void)
+{
+    FILE *fp = fopen(TEST_PATH, "wb");
+    assert(fp);
+    fputs("this is not a chunked map file at all", fp);
+    fclose(fp);
+
+    static Map map;
+    static MapStream ms;
+    Player p;
+    assert(!map_stream_open(&ms, &map, &p, TEST_PATH, 1, 0));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── map_stream ──────────────────────────────────────────\n");
+    RUN_TEST(test_stream_open_header);
+    RUN_TEST(test_stream_spawn_chunk_resident);
+    RUN_TEST(test_stream_far_chunks_are_solid);
+    RUN_TEST(test_stream_prefetch_neighbour);
+    RUN_TEST(test_stream_lru_eviction);
+    RUN_TEST(test_stream_cast_stops_at_unloaded);
+    RUN_TEST(test_stream_open_missing_file);
+    RUN_TEST(test_stream_open_bad_magic);
+
+    remove(TEST_PATH);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
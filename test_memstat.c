@@ -0,0 +1,184 @@
+/*  test_memstat.c  –  unit tests for memory accounting
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against memstat.o, arena.o and jobs.o — no SDL dependency.
+ *  Checks per-tag and total counts and peaks, that concurrent updates
+ *  balance, the report format and the SIGUSR1 request flag, and that
+ *  thread arenas and the job pool give back what they report.
+ *  Build:  make test
+ *  Run:    ./test_memstat
+ */
+#include "memstat.h"
+#include "arena.h"
+#include "jobs.h"
+
+#include <assert.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+#define THREADS 4
+#define ROUNDS  10000
+
+static int churn(void *arg)
+{
+    MemTag tag = *(const MemTag *)arg;
+    for (int i = 0; i < ROUNDS; i++) {
+        mem_account(tag, 100);
+        mem_release(tag, 100);
+    }
+    return 0;
+}
+
+static int touch_arena(void *arg)
+{
+    size_t *seen = arg;
+    arena_thread();
+    *seen = mem_bytes(MEM_SCRATCH);
+    return 0;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Accounting tests                                                  */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_account_and_release(void)
+{
+    size_t total = mem_total();
+    mem_account(MEM_MAP, 1000);
+    mem_account(MEM_MAP, 500);
+    mem_account(MEM_ATLAS, 200);
+    assert(mem_bytes(MEM_MAP) == 1500);
+    assert(mem_bytes(MEM_ATLAS) == 200);
+    assert(mem_total() == total + 1700);
+    mem_release(MEM_MAP, 1500);
+    mem_release(MEM_ATLAS, 200);
+    assert(mem_bytes(MEM_MAP) == 0 && mem_bytes(MEM_ATLAS) == 0);
+    assert(mem_total() == total);
+}
+
+static void test_peaks_are_kept(void)
+{
+    mem_account(MEM_VIEW, 4000);
+    mem_release(MEM_VIEW, 4000);
+    mem_account(MEM_VIEW, 1000);
+    assert(mem_bytes(MEM_VIEW) == 1000);
+    assert(mem_peak(MEM_VIEW) == 4000);
+    assert(mem_total_peak() >= mem_total() + 3000);
+    mem_release(MEM_VIEW, 1000);
+}
+
+static void test_concurrent_updates_balance(void)
+{
+    thrd_t t[THREADS];
+    MemTag tag = MEM_SIM;
+    size_t before = mem_bytes(tag);
+    for (int i = 0; i < THREADS; i++)
+        assert(thrd_create(&t[i], churn, &tag) == thrd_success);
+    for (int i = 0; i < THREADS; i++) thrd_join(t[i], NULL);
+    assert(mem_bytes(tag) == before);
+    assert(mem_peak(tag) >= 100 && mem_peak(tag) <= before + 100 * THREADS);
+}
+
+static void test_report_lists_used_tags(void)
+{
+    mem_account(MEM_FRAMES, 3 * 1024);
+    FILE *f = tmpfile();
+    assert(f);
+    mem_report(f);
+    rewind(f);
+    char line[128];
+    bool header = false, frames = false, entities = false;
+    while (fgets(line, sizeof(line), f)) {
+        header   |= strncmp(line, "memory: ", 8) == 0;
+        frames   |= strstr(line, "frames") && strstr(line, " 3 KB");
+        entities |= strstr(line, "entities") != NULL;
+    }
+    fclose(f);
+    assert(header && frames);
+    assert(!entities);                    /* never used: not listed */
+    mem_release(MEM_FRAMES, 3 * 1024);
+
+    for (int t = 0; t < MEM_TAG_COUNT; t++)
+        for (int u = t + 1; u < MEM_TAG_COUNT; u++)
+            assert(strcmp(mem_tag_name((MemTag)t), mem_tag_name((MemTag)u)) != 0);
+}
+
+static void test_signal_requests_report(void)
+{
+    assert(!mem_report_requested());
+    mem_watch_signal();
+#ifdef SIGUSR1
+    raise(SIGUSR1);
+    assert(mem_report_requested());
+    raise(SIGUSR1);                       /* the handler stays installed */
+    assert(mem_report_requested());
+#endif
+    assert(!mem_report_requested());
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Subsystem tests                                                   */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_thread_arena_counted_while_alive(void)
+{
+    arena_thread();                       /* this thread's, once */
+    size_t before = mem_bytes(MEM_SCRATCH);
+    size_t during = 0;
+    thrd_t t;
+    assert(thrd_create(&t, touch_arena, &during) == thrd_success);
+    thrd_join(t, NULL);
+    assert(during == before + ARENA_THREAD_SIZE);
+    assert(mem_bytes(MEM_SCRATCH) == before);
+}
+
+static void test_job_pool_gives_back(void)
+{
+    static JobPool pool;
+    size_t before = mem_bytes(MEM_SCRATCH);
+    assert(job_pool_start(&pool, 2));
+    assert(mem_bytes(MEM_SCRATCH) >= before + sizeof(pool));
+    job_pool_stop(&pool);
+    assert(mem_bytes(MEM_SCRATCH) == before);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── accounting ──────────────────────────────────────────\n");
+    RUN_TEST(test_account_and_release);
+    RUN_TEST(test_peaks_are_kept);
+    RUN_TEST(test_concurrent_updates_balance);
+    RUN_TEST(test_report_lists_used_tags);
+    RUN_TEST(test_signal_requests_report);
+
+    printf("\n── subsystems ──────────────────────────────────────────\n");
+    RUN_TEST(test_thread_arena_counted_while_alive);
+    RUN_TEST(test_job_pool_gives_back);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/*  test_pace.c  –  tests for the frame-rate cap
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against pace.o — no SDL dependency.  Timing bounds are loose
+ *  so the tests hold on a loaded machine; they check that frames are
+ *  held back, never rushed, and that the statistics add up.
+ *  Build:  make test
+ *  Run:    ./test_pace
+ */
+#include "pace.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <threads.h>
+#include <time.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+static void sleep_ms(long ms)
+{
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L };
+    thrd_sleep(&ts, NULL);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Pacing tests                                                      */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_uncapped_returns_at_once(void)
+{
+    Pacer p;
+    pace_init(&p, 0);
+    double start = pace_clock();
+    for (int i = 0; i < 1000; i++)
+        assert(pace_wait(&p) == 0.0);
+    assert(pace_clock() - start < 0.05);
+
+    double mean, max;
+    assert(pace_take_stats(&p, &mean, &max) == 0);
+    assert(mean == 0.0 && max == 0.0);
+}
+
+static void test_cap_holds_frame_rate(void)
+{
+    /* 40 frames at 200 fps take at least 0.2 s (less one period for the
+     * first frame) and never much more */
+    Pacer p;
+    pace_init(&p, 200);
+    double start = pace_clock();
+    for (int i = 0; i < 40; i++)
+        assert(pace_wait(&p) >= 0.0);
+    double took = pace_clock() - start;
+    assert(took >= 0.2 - 0.005);
+    assert(took < 0.5);
+
+    /* Every frame is counted, on time or late; errors cannot exceed
+     * the whole run */
+    double mean, max;
+    assert(pace_take_stats(&p, &mean, &max) == 40);
+    assert(mean >= 0.0 && mean <= max && max < took);
+    assert(pace_take_stats(&p, &mean, &max) == 0);   /* interval reset */
+}
+
+static void test_stall_restarts_grid(void)
+{
+    /* After a long stall the next frames are spaced normally instead of
+     * being rushed out to catch up */
+    Pacer p;
+    pace_init(&p, 100);
+    pace_wait(&p);
+    sleep_ms(60);
+    assert(pace_wait(&p) >= 0.04);            /* late, grid restarted */
+    double start = pace_clock();
+    for (int i = 0; i < 5; i++) pace_wait(&p);
+    assert(pace_clock() - start >= 0.05 - 0.005);
+
+    /* The late frame is in the stats, not dropped */
+    double mean, max;
+    assert(pace_take_stats(&p, &mean, &max) == 7);
+    assert(max >= 0.04);
+}
+
+static void test_restart_skips_pause(void)
+{
+    /* A deliberate pause is neither measured nor caught up on, and the
+     * frame drawn after it has a whole period (20 ms) for its work */
+    Pacer p;
+    pace_init(&p, 50);
+    pace_wait(&p);
+    sleep_ms(60);
+    pace_restart(&p);
+    sleep_ms(12);                             /* drawing the frame */
+    assert(pace_wait(&p) < 0.008);
+
+    double mean, max;
+    assert(pace_take_stats(&p, &mean, &max) == 2);
+    assert(max < 0.008);
+}
+
+static void test_spin_tail_stays_bounded(void)
+{
+    Pacer p;
+    pace_init(&p, 250);
+    for (int i = 0; i < 50; i++) {
+        pace_wait(&p);
+        assert(p.spin_tail >= PACE_SPIN_MIN * 0.99);
+        assert(p.spin_tail <= PACE_SPIN_MAX);
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── pacing ──────────────────────────────────────────────\n");
+    RUN_TEST(test_uncapped_returns_at_once);
+    RUN_TEST(test_cap_holds_frame_rate);
+    RUN_TEST(test_stall_restarts_grid);
+    RUN_TEST(test_restart_skips_pause);
+    RUN_TEST(test_spin_tail_stays_bounded);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,295 @@
+/*  test_path.c  –  tests for JPS+ pathfinding and its jump tables
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against path.o, jobs.o, memstat.o and map_edit.o — no SDL
+ *  dependency.  Maps are built inline, and every search is checked
+ *  against a plain 8-way Dijkstra over the same grid.
+ *  Build:  make test
+ *  Run:    ./test_path
+ */
+#include "path.h"
+#include "jobs.h"
+#include "map_edit.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+/** Reference: 8-way Dijkstra, diagonals only between two open sides.
+ *  Returns the cost, or -1 if unreachable. */
+static int dijkstra(const Map *m, int sx, int sy, int gx, int gy)
+{
+    static int cost[MAP_MAX_H][MAP_MAX_W];
+    static bool done[MAP_MAX_H][MAP_MAX_W];
+    if (!open_cell(m, sx, sy) || !open_cell(m, gx, gy)) return -1;
+    for (int y = 0; y < m->h; y++)
+        for (int x = 0; x < m->w; x++) {
+            cost[y][x] = -1;
+            done[y][x] = false;
+        }
+    cost[sy][sx] = 0;
+
+    for (;;) {
+        int bx = -1, by = -1;
+        for (int y = 0; y < m->h; y++)
+            for (int x = 0; x < m->w; x++)
+                if (!done[y][x] && cost[y][x] >= 0
+                    && (bx < 0 || cost[y][x] < cost[by][bx])) {
+                    bx = x;
+                    by = y;
+                }
+        if (bx < 0) return -1;
+        if (bx == gx && by == gy) return cost[by][bx];
+        done[by][bx] = true;
+
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dx = -1; dx <= 1; dx++) {
+                int nx = bx + dx, ny = by + dy;
+                if ((!dx && !dy) || !open_cell(m, nx, ny)) continue;
+                if (dx && dy && (!open_cell(m, nx, by) || !open_cell(m, bx, ny)))
+                    continue;
+                int c = cost[by][bx] + (dx && dy ? PATH_COST_DIAGONAL
+                                                 : PATH_COST_STRAIGHT);
+                if (cost[ny][nx] < 0 || c < cost[ny][nx]) cost[ny][nx] = c;
+            }
+    }
+}
+
+/** Walk the waypoints cell by cell: every leg must be a straight or
+ *  diagonal line of legal steps, and the legs must add up to the cost. */
+static void check_path(const Map *m, const Path *p, int sx, int sy,
+                       int gx, int gy)
+{
+    assert(p->count >= 1);
+    assert(p->points[0].x == sx && p->points[0].y == sy);
+    assert(p->points[p->count - 1].x == gx && p->points[p->count - 1].y == gy);
+
+    int total = 0;
+    for (int i = 1; i < p->count; i++) {
+        int x = p->points[i - 1].x, y = p->points[i - 1].y;
+        int ddx = p->points[i].x - x, ddy = p->points[i].y - y;
+        assert(ddx == 0 || ddy == 0 || abs(ddx) == abs(ddy));
+        int dx = (ddx > 0) - (ddx < 0), dy = (ddy > 0) - (ddy < 0);
+        while (x != p->points[i].x || y != p->points[i].y) {
+            assert(open_cell(m, x + dx, y + dy));
+            if (dx && dy)
+                assert(open_cell(m, x + dx, y) && open_cell(m, x, y + dy));
+            total += dx && dy ? PATH_COST_DIAGONAL : PATH_COST_STRAIGHT;
+            x += dx;
+            y += dy;
+        }
+    }
+    assert(total == p->cost);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Jump table tests                                                  */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_build_corridor_distances(void)
+{
+    /* A 1-high corridor: runs go all the way to the walls */
+    static Map map;
+    static JumpTable jt;
+    init_random(&map, 10, 3, 0, 1);
+    path_build(&jt, &map);
+
+    /* Cell (1,1): 7 open steps east, none west, no diagonals */
+    assert(jt.dist[1][1][2] == -7);
+    assert(jt.dist[1][1][6] == 0);
+    assert(jt.dist[1][1][1] == 0 && jt.dist[1][1][3] == 0);
+    assert(!path_open(&jt, 0, 1) && path_open(&jt, 1, 1));
+}
+
+static void test_build_marks_jump_point(void)
+{
+    /* Walking east along row 2 past the end of a wall in row 1 */
+    static Map map;
+    static JumpTable jt;
+    init_random(&map, 12, 6, 0, 1);
+    for (int x = 1; x <= 4; x++) map.tiles[1][x] = 1;
+    path_build(&jt, &map);
+
+    /* (5,2) has (5,1) open beside it where (4,1) was solid */
+    assert(jt.dist[2][1][2] == 4);
+    assert(jt.dist[2][5][2] == -5);
+}
+
+static void test_sync_matches_rebuild(void)
+{
+    static Map map;
+    static JumpTable synced, fresh;
+    uint32_t seed = 7;
+    init_random(&map, 40, 30, 25, 3);
+    path_build(&synced, &map);
+
+    /* Open and close cells a few at a time, syncing after each batch */
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 3; i++) {
+            int x = 1 + (int)(next_rand(&seed) % 38);
+            int y = 1 + (int)(next_rand(&seed) % 28);
+            map_set_tile(&map, x, y, map.tiles[y][x] ? 0 : 2);
+        }
+        map_set_info(&map, 1, 1, (uint16_t)round);   /* not a tile edit */
+        path_sync(&synced, &map);
+        path_build(&fresh, &map);
+        assert(memcmp(synced.dist, fresh.dist, sizeof(fresh.dist)) == 0);
+        assert(memcmp(synced.open, fresh.open, sizeof(fresh.open)) == 0);
+        assert(synced.revision == map.revision);
+    }
+}
+
+static void test_sync_after_log_wrap(void)
+{
+    static Map map;
+    static JumpTable synced, fresh;
+    init_random(&map, 20, 20, 10, 5);
+    path_build(&synced, &map);
+    for (int i = 0; i < MAP_CHANGE_LOG + 10; i++)
+        map_set_tile(&map, 5 + i % 10, 5, (uint16_t)(i & 1));
+    path_sync(&synced, &map);
+    path_build(&fresh, &map);
+    assert(memcmp(synced.dist, fresh.dist, sizeof(fresh.dist)) == 0);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Search tests                                                      */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_find_matches_dijkstra(void)
+{
+    static Map map;
+    static JumpTable jt;
+    static Path p;
+    uint32_t seed = 11;
+
+    for (int m = 0; m < 6; m++) {
+        init_random(&map, 48, 40, 10 + 5 * m, 100 + (uint32_t)m);
+        path_build(&jt, &map);
+        for (int q = 0; q < 40; q++) {
+            int sx, sy, gx, gy;
+            random_open_cell(&map, &seed, &sx, &sy);
+            random_open_cell(&map, &seed, &gx, &gy);
+            int want = dijkstra(&map, sx, sy, gx, gy);
+            bool found = path_find(&jt, sx, sy, gx, gy, &p);
+            assert(found == (want >= 0));
+            if (!found) continue;
+            assert(p.cost == want);
+            check_path(&map, &p, sx, sy, gx, gy);
+        }
+    }
+}
+
+static void test_find_after_edit(void)
+{
+    /* Close a wall's only gap: the path must go round */
+    static Map map;
+    static JumpTable jt;
+    static Path p;
+    init_random(&map, 20, 12, 0, 1);
+    for (int y = 1; y < 10; y++) map.tiles[y][10] = 1;   /* gap at y=10 */
+    path_build(&jt, &map);
+    assert(path_find(&jt, 2, 2, 17, 2, &p));
+    check_path(&map, &p, 2, 2, 17, 2);
+
+    map_set_tile(&map, 10, 10, 1);
+    path_sync(&jt, &map);
+    assert(!path_find(&jt, 2, 2, 17, 2, &p));
+    assert(p.count == 0);
+
+    map_set_tile(&map, 10, 4, 0);                        /* new gap */
+    path_sync(&jt, &map);
+    assert(path_find(&jt, 2, 2, 17, 2, &p));
+    assert(p.cost == dijkstra(&map, 2, 2, 17, 2));
+}
+
+static void test_find_trivial_cases(void)
+{
+    static Map map;
+    static JumpTable jt;
+    static Path p;
+    init_random(&map, 10, 10, 0, 1);
+    path_build(&jt, &map);
+
+    assert(path_find(&jt, 3, 3, 3, 3, &p));
+    assert(p.count == 1 && p.cost == 0);
+    assert(path_find(&jt, 1, 1, 8, 8, &p));
+    assert(p.count == 2 && p.cost == 7 * PATH_COST_DIAGONAL);
+    assert(!path_find(&jt, 0, 0, 5, 5, &p));             /* solid start */
+    assert(!path_find(&jt, 5, 5, 50, 5, &p));            /* off the map */
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Batch tests                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_batch_matches_serial(void)
+{
+    static Map map;
+    static JumpTable jt;
+    static PathQuery batch[300];
+    static Path p;
+    static JobPool pool;
+    uint32_t seed = 99;
+    init_random(&map, MAP_MAX_W, MAP_MAX_H, 30, 42);
+    path_build(&jt, &map);
+
+    for (int i = 0; i < 300; i++) {
+        random_open_cell(&map, &seed, &batch[i].sx, &batch[i].sy);
+        random_open_cell(&map, &seed, &batch[i].gx, &batch[i].gy);
+    }
+    assert(job_pool_start(&pool, 3));
+    path_find_batch(&jt, batch, 300, &pool);
+    job_pool_stop(&pool);
+
+    for (int i = 0; i < 300; i++) {
+        const PathQuery *q = &batch[i];
+        bool found = path_find(&jt, q->sx, q->sy, q->gx, q->gy, &p);
+        assert(q->path.count == p.count && q->path.cost == p.cost);
+        if (found) check_path(&map, &q->path, q->sx, q->sy, q->gx, q->gy);
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── jump tables ─────────────────────────────────────────\n");
+    RUN_TEST(test_build_corridor_distances);
+    RUN_TEST(test_build_marks_jump_point);
+    RUN_TEST(test_sync_matches_rebuild);
+    RUN_TEST(test_sync_after_log_wrap);
+
+    printf("\n── search ──────────────────────────────────────────────\n");
+    RUN_TEST(test_find_matches_dijkstra);
+    RUN_TEST(test_find_after_edit);
+    RUN_TEST(test_find_trivial_cases);
+
+    printf("\n── batch ───────────────────────────────────────────────\n");
+    RUN_TEST(test_batch_matches_serial);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -43,12 +43,11 @@ static int tests_passed = 0;
 
 /* ── Helper: build a Map + GameState with an inline box map ───────── */
 
-static void init_box_map(Map *map, GameState *gs, int w, int h,
-                         float px, float py,
-                         float dir_x, float dir_y)
+static void init_box(Map *map, Player *p, int w, int h,
+                     float px, float py,
+                     float dir_x, float dir_y)
 {
     memset(map, 0, sizeof(*map));
-    memset(gs, 0, sizeof(*gs));
     map->w = w;
     map->h = h;
 
@@ -58,16 +57,34 @@ static void init_box_map(Map *map, GameState *gs, int w, int h,
             map->tiles[r][c] =
                 (r == 0 || r == h - 1 || c == 0 || c == w - 1) ? 1 : 0;
 
-    gs->player.x     = px;
-    gs->player.y     = py;
-    gs->player.dir_x = dir_x;
-    gs->player.dir_y = dir_y;
+    p->x     = px;
+    p->y     = py;
+    p->dir_x = dir_x;
+    p->dir_y = dir_y;
 
     /* Derive camera plane from FOV_DEG, perpendicular to direction */
     float half_fov = (FOV_DEG * 0.5f) * (PI / 180.0f);
     float plane_len = tanf(half_fov);
-    gs->player.plane_x = -dir_y * plane_len;
-    gs->player.plane_y =  dir_x * plane_len;
+    p->plane_x = -dir_y * plane_len;
+    p->plane_y =  dir_x * plane_len;
+}
+
+/** Box map with the camera of a render state placed inside. */
+static void init_box_map(Map *map, GameState *gs, int w, int h,
+                         float px, float py,
+                         float dir_x, float dir_y)
+{
+    memset(gs, 0, sizeof(*gs));
+    init_box(map, &gs->player, w, h, px, py, dir_x, dir_y);
+}
+
+/** Box map with the player of a simulation state placed inside. */
+static void init_box_sim(Map *map, SimState *st, int w, int h,
+                         float px, float py,
+                         float dir_x, float dir_y)
+{
+    memset(st, 0, sizeof(*st));
+    init_box(map, &st->player, w, h, px, py, dir_x, dir_y);
 }
 
 /* ── Helper: load the fake map ────────────────────────────────────── */
@@ -80,6 +97,14 @@ static void load_fake_map(Map *map, GameState *gs)
     assert(ok);
 }
 
+static void load_fake_sim(Map *map, SimState *st)
+{
+    memset(map, 0, sizeof(*map));
+    memset(st, 0, sizeof(*st));
+    bool ok = map_load(map, &st->player, "ignored", "ignored", "ignored");
+    assert(ok);
+}
+
 /* ═══════════════════════════════════════════════════════════════════ */
 /*  Fake map structure tests                                          */
 /*                                                                    */
@@ -280,65 +305,65 @@ static void test_fake_map_all_tile_types_present(void)
 static void test_update_no_input(void)
 {
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 10, 10, 5.5f, 5.5f, 1.0f, 0.0f);
+    SimState st;
+    init_box_sim(&map, &st, 10, 10, 5.5f, 5.5f, 1.0f, 0.0f);
 
     Input in;
     memset(&in, 0, sizeof(in));
 
-    float old_x = gs.player.x;
-    float old_y = gs.player.y;
+    float old_x = st.player.x;
+    float old_y = st.player.y;
 
-    rc_update(&gs, &map, &in, 1.0f / 60.0f);
+    rc_update(&st, &map, &in, 1.0f / 60.0f);
 
     /* Player should not move */
-    ASSERT_NEAR(gs.player.x, old_x, 0.0001f);
-    ASSERT_NEAR(gs.player.y, old_y, 0.0001f);
+    ASSERT_NEAR(st.player.x, old_x, 0.0001f);
+    ASSERT_NEAR(st.player.y, old_y, 0.0001f);
 }
 
 static void test_update_forward(void)
 {
     Map map;
-    GameState gs;
+    SimState st;
     /* Facing east in a big box, plenty of room */
-    init_box_map(&map, &gs, 20, 20, 5.5f, 10.5f, 1.0f, 0.0f);
+    init_box_sim(&map, &st, 20, 20, 5.5f, 10.5f, 1.0f, 0.0f);
 
     Input in;
     memset(&in, 0, sizeof(in));
     in.forward = true;
 
-    float old_x = gs.player.x;
-    rc_update(&gs, &map, &in, 1.0f);
+    float old_x = st.player.x;
+    rc_update(&st, &map, &in, 1.0f);
 
     /* Should have moved ~3.0 units east (MOVE_SPD = 3.0) */
-    assert(gs.player.x > old_x);
-    ASSERT_NEAR(gs.player.x - old_x, 3.0f, 0.01f);
+    assert(st.player.x > old_x);
+    ASSERT_NEAR(st.player.x - old_x, 3.0f, 0.01f);
 }
 
 static void test_update_backward(void)
 {
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 20, 20, 10.5f, 10.5f, 1.0f, 0.0f);
+    SimState st;
+    init_box_sim(&map, &st, 20, 20, 10.5f, 10.5f, 1.0f, 0.0f);
 
     Input in;
     memset(&in, 0, sizeof(in));
     in.back = true;
 
-    float old_x = gs.player.x;
-    rc_update(&gs, &map, &in, 1.0f);
+    float old_x = st.player.x;
+    rc_update(&st, &map, &in, 1.0f);
 
     /* Should have moved ~3.0 units west */
-    assert(gs.player.x < old_x);
-    ASSERT_NEAR(old_x - gs.player.x, 3.0f, 0.01f);
+    assert(st.player.x < old_x);
+    ASSERT_NEAR(old_x - st.player.x, 3.0f, 0.01f);
 }
 
 static void test_update_wall_collision(void)
 {
     Map map;
-    GameState gs;
+    SimState st;
     /* Player near north wall (row 0 = wall), facing north (-y) */
-    init_box_map(&map, &gs, 10, 10, 5.5f, 1.5f, 0.0f, -1.0f);
+    init_box_sim(&map, &st, 10, 10, 5.5f, 1.5f, 0.0f, -1.0f);
 
     Input in;
     memset(&in, 0, sizeof(in));
@@ -346,70 +371,70 @@ static void test_update_wall_collision(void)
 
     /* Walk into wall for a full second */
     for (int i = 0; i < 60; i++)
-        rc_update(&gs, &map, &in, 1.0f / 60.0f);
+        rc_update(&st, &map, &in, 1.0f / 60.0f);
 
     /* Player should be stopped by the wall, not inside or beyond it */
-    assert(gs.player.y > 0.5f);
+    assert(st.player.y > 0.5f);
 }
 
 static void test_update_wall_sliding(void)
 {
     Map map;
-    GameState gs;
+    SimState st;
     /* Facing northeast into a north wall — should slide east */
     float inv_sqrt2 = 1.0f / sqrtf(2.0f);
-    init_box_map(&map, &gs, 20, 20, 5.5f, 1.5f, inv_sqrt2, -inv_sqrt2);
+    init_box_sim(&map, &st, 20, 20, 5.5f, 1.5f, inv_sqrt2, -inv_sqrt2);
 
     Input in;
     memset(&in, 0, sizeof(in));
     in.forward = true;
 
-    float old_x = gs.player.x;
+    float old_x = st.player.x;
     for (int i = 0; i < 60; i++)
-        rc_update(&gs, &map, &in, 1.0f / 60.0f);
+        rc_update(&st, &map, &in, 1.0f / 60.0f);
 
     /* Should have slid east (x increased) while y stayed near wall */
-    assert(gs.player.x > old_x + 0.5f);
-    assert(gs.player.y > 0.5f);
+    assert(st.player.x > old_x + 0.5f);
+    assert(st.player.y > 0.5f);
 }
 
 static void test_update_rotation_left(void)
 {
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 10, 10, 5.5f, 5.5f, 1.0f, 0.0f);
+    SimState st;
+    init_box_sim(&map, &st, 10, 10, 5.5f, 5.5f, 1.0f, 0.0f);
 
     Input in;
     memset(&in, 0, sizeof(in));
     in.turn_left = true;
 
-    rc_update(&gs, &map, &in, 1.0f);
+    rc_update(&st, &map, &in, 1.0f);
 
     /* Rotating left (counter-clockwise) should change direction */
     /* After ~2.5 radians of rotation, dir_x should be negative */
-    float len = sqrtf(gs.player.dir_x * gs.player.dir_x +
-                      gs.player.dir_y * gs.player.dir_y);
+    float len = sqrtf(st.player.dir_x * st.player.dir_x +
+                      st.player.dir_y * st.player.dir_y);
     ASSERT_NEAR(len, 1.0f, 0.01f);  /* direction vector stays unit length */
 }
 
 static void test_update_rotation_right(void)
 {
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 10, 10, 5.5f, 5.5f, 1.0f, 0.0f);
+    SimState st;
+    init_box_sim(&map, &st, 10, 10, 5.5f, 5.5f, 1.0f, 0.0f);
 
     Input in;
     memset(&in, 0, sizeof(in));
     in.turn_right = true;
 
     /* Small rotation: 1/60th second */
-    rc_update(&gs, &map, &in, 1.0f / 60.0f);
+    rc_update(&st, &map, &in, 1.0f / 60.0f);
 
     /* dir_y should become positive (clockwise) */
-    assert(gs.player.dir_y > 0.0f);
+    assert(st.player.dir_y > 0.0f);
     /* direction vector should stay unit length */
-    float len = sqrtf(gs.player.dir_x * gs.player.dir_x +
-                      gs.player.dir_y * gs.player.dir_y);
+    float len = sqrtf(st.player.dir_x * st.player.dir_x +
+                      st.player.dir_y * st.player.dir_y);
     ASSERT_NEAR(len, 1.0f, 0.001f);
 }
 
@@ -417,8 +442,8 @@ static void test_update_endgame_tile_walkable(void)
 {
     /* Endgame trigger tile is floor in tiles plane — always walkable */
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 10, 10, 3.5f, 5.5f, 1.0f, 0.0f);
+    SimState st;
+    init_box_sim(&map, &st, 10, 10, 3.5f, 5.5f, 1.0f, 0.0f);
 
     /* Place an endgame trigger in the info plane (tile stays floor) */
     map.info[5][5] = INFO_TRIGGER_ENDGAME;
@@ -427,12 +452,12 @@ static void test_update_endgame_tile_walkable(void)
     memset(&in, 0, sizeof(in));
     in.forward = true;
 
-    float old_x = gs.player.x;
+    float old_x = st.player.x;
     for (int i = 0; i < 60; i++)
-        rc_update(&gs, &map, &in, 1.0f / 60.0f);
+        rc_update(&st, &map, &in, 1.0f / 60.0f);
 
     /* Player should have moved past the trigger cell (not blocked) */
-    assert(gs.player.x > 5.0f);
+    assert(st.player.x > 5.0f);
     (void)old_x;
 }
 
@@ -440,13 +465,13 @@ static void test_update_endgame_triggers_game_over(void)
 {
     /* Walking onto an endgame trigger should set game_over */
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 10, 10, 4.5f, 5.5f, 1.0f, 0.0f);
+    SimState st;
+    init_box_sim(&map, &st, 10, 10, 4.5f, 5.5f, 1.0f, 0.0f);
 
     /* Place endgame trigger in info plane at col 5 */
     map.info[5][5] = INFO_TRIGGER_ENDGAME;
 
-    assert(!gs.game_over);
+    assert(!st.game_over);
 
     Input in;
     memset(&in, 0, sizeof(in));
@@ -454,55 +479,103 @@ static void test_update_endgame_triggers_game_over(void)
 
     /* Walk forward until we reach the trigger cell */
     for (int i = 0; i < 60; i++) {
-        rc_update(&gs, &map, &in, 1.0f / 60.0f);
-        if (gs.game_over) break;
+        rc_update(&st, &map, &in, 1.0f / 60.0f);
+        if (st.game_over) break;
     }
 
-    assert(gs.game_over);
+    assert(st.game_over);
 }
 
 static void test_update_endgame_requires_centre(void)
 {
     /* Entering the trigger cell near its edge should not trigger game_over */
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 10, 10, 5.5f, 5.5f, 1.0f, 0.0f);
+    SimState st;
+    init_box_sim(&map, &st, 10, 10, 5.5f, 5.5f, 1.0f, 0.0f);
 
     /* Place endgame trigger at col 6, centre at (6.5, 5.5) */
     map.info[5][6] = INFO_TRIGGER_ENDGAME;
 
     /* Put player just inside the cell but far from centre */
-    gs.player.x = 6.05f;
-    gs.player.y = 5.5f;
+    st.player.x = 6.05f;
+    st.player.y = 5.5f;
 
     Input in;
     memset(&in, 0, sizeof(in));
 
-    rc_update(&gs, &map, &in, 1.0f / 60.0f);
-    assert(!gs.game_over);
+    rc_update(&st, &map, &in, 1.0f / 60.0f);
+    assert(!st.game_over);
 
     /* Now move to the centre */
-    gs.player.x = 6.5f;
-    gs.player.y = 5.5f;
-    rc_update(&gs, &map, &in, 1.0f / 60.0f);
-    assert(gs.game_over);
+    st.player.x = 6.5f;
+    st.player.y = 5.5f;
+    rc_update(&st, &map, &in, 1.0f / 60.0f);
+    assert(st.game_over);
 }
 
 static void test_update_no_trigger_no_game_over(void)
 {
     /* Walking on normal floor should not set game_over */
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 20, 20, 5.5f, 10.5f, 1.0f, 0.0f);
+    SimState st;
+    init_box_sim(&map, &st, 20, 20, 5.5f, 10.5f, 1.0f, 0.0f);
 
     Input in;
     memset(&in, 0, sizeof(in));
     in.forward = true;
 
     for (int i = 0; i < 60; i++)
-        rc_update(&gs, &map, &in, 1.0f / 60.0f);
+        rc_update(&st, &map, &in, 1.0f / 60.0f);
+
+    assert(!st.game_over);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  rc_lerp_player tests                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_lerp_endpoints_and_midpoint(void)
+{
+    Player a = { .x = 2.0f, .y = 3.0f, .dir_x = 1.0f, .plane_y = 0.66f };
+    Player b = a;
+    b.x = 2.1f;
+    b.y = 3.05f;
+
+    Player out;
+    rc_lerp_player(&out, &a, &b, 0.0f);
+    ASSERT_NEAR(out.x, 2.0f, 1e-5f);
+    rc_lerp_player(&out, &a, &b, 1.0f);
+    ASSERT_NEAR(out.x, 2.1f, 1e-5f);
+    rc_lerp_player(&out, &a, &b, 0.5f);
+    ASSERT_NEAR(out.x, 2.05f, 1e-5f);
+    ASSERT_NEAR(out.y, 3.025f, 1e-5f);
+}
 
-    assert(!gs.game_over);
+static void test_lerp_rotation_keeps_lengths(void)
+{
+    Player a = { .x = 2.0f, .y = 2.0f, .dir_x = 1.0f, .plane_y = 0.66f };
+    Player b = a;
+    b.dir_x   = 0.0f;  b.dir_y   = 1.0f;     /* 90° turn */
+    b.plane_x = -0.66f; b.plane_y = 0.0f;
+
+    Player out;
+    rc_lerp_player(&out, &a, &b, 0.5f);
+    ASSERT_NEAR(sqrtf(out.dir_x * out.dir_x + out.dir_y * out.dir_y),
+                1.0f, 1e-4f);
+    ASSERT_NEAR(sqrtf(out.plane_x * out.plane_x + out.plane_y * out.plane_y),
+                0.66f, 1e-4f);
+    ASSERT_NEAR(out.dir_x, out.dir_y, 1e-4f);  /* halfway: 45° */
+}
+
+static void test_lerp_snaps_on_teleport(void)
+{
+    Player a = { .x = 2.0f, .y = 2.0f, .dir_x = 1.0f, .plane_y = 0.66f };
+    Player b = a;
+    b.x = 9.5f;
+
+    Player out;
+    rc_lerp_player(&out, &a, &b, 0.25f);
+    ASSERT_NEAR(out.x, 9.5f, 1e-6f);
 }
 
 /* ═══════════════════════════════════════════════════════════════════ */
@@ -522,6 +595,7 @@ static void test_cast_straight_east(void)
     int mid = SCREEN_W / 2;
     ASSERT_NEAR(gs.hits[mid].wall_dist, 6.5f, 0.15f);
     assert(gs.hits[mid].side == 0);  /* x-side hit */
+    assert(gs.hits[mid].cell == 1 * MAP_MAX_W + 9);  /* the cell it hit */
 }
 
 static void test_cast_straight_north(void)
@@ -726,8 +800,9 @@ static void test_load_then_cast(void)
 static void test_walk_and_cast(void)
 {
     Map map;
-    GameState gs;
-    init_box_map(&map, &gs, 20, 20, 10.5f, 10.5f, 1.0f, 0.0f);
+    SimState st;
+    static GameState gs;
+    init_box_sim(&map, &st, 20, 20, 10.5f, 10.5f, 1.0f, 0.0f);
 
     Input in;
     memset(&in, 0, sizeof(in));
@@ -735,8 +810,9 @@ static void test_walk_and_cast(void)
 
     /* Walk forward for half a second then cast */
     for (int i = 0; i < 30; i++)
-        rc_update(&gs, &map, &in, 1.0f / 60.0f);
+        rc_update(&st, &map, &in, 1.0f / 60.0f);
 
+    gs.player = st.player;
     rc_cast(&gs, &map);
 
     /* After walking east, the east wall should be closer */
@@ -751,10 +827,10 @@ static void test_fake_map_endgame_triggers_game_over(void)
 {
     /* Walk from player spawn towards the endgame trigger and confirm game_over */
     Map map;
-    GameState gs;
-    load_fake_map(&map, &gs);
+    SimState st;
+    load_fake_sim(&map, &st);
 
-    assert(!gs.game_over);
+    assert(!st.game_over);
 
     Input in;
     memset(&in, 0, sizeof(in));
@@ -763,11 +839,11 @@ static void test_fake_map_endgame_triggers_game_over(void)
     /* Player at (1.5, 1.5) facing east, trigger at col 3, row 1.
      * Walk east until reaching trigger centre (3.5, 1.5). */
     for (int i = 0; i < 120; i++) {
-        rc_update(&gs, &map, &in, 1.0f / 60.0f);
-        if (gs.game_over) break;
+        rc_update(&st, &map, &in, 1.0f / 60.0f);
+        if (st.game_over) break;
     }
 
-    assert(gs.game_over);
+    assert(st.game_over);
 }
 
 /* ═══════════════════════════════════════════════════════════════════ */
@@ -937,6 +1013,103 @@ static void test_z_buffer_matches_hits(void)
     }
 }
 
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  rc_sense() – sparse ray sensor                                     */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_sense_matches_cast(void)
+{
+    /* Rays through screen columns agree with rc_cast() once the range
+     * is projected onto the facing direction */
+    Map map;
+    GameState gs;
+    init_box_map(&map, &gs, 12, 9, 4.3f, 3.7f, 1.0f, 0.0f);
+    map.tiles[2][8] = 4;
+    rc_cast(&gs, &map);
+
+    float plane_len = tanf(FOV_DEG * 0.5f * (PI / 180.0f));
+    int   cols[]    = { 0, 123, SCREEN_W / 2, 517, SCREEN_W - 1 };
+    float angles[5];
+    for (int i = 0; i < 5; i++)
+        angles[i] = atanf((2.0f * cols[i] / SCREEN_W - 1.0f) * plane_len);
+
+    SenseHit out[5];
+    rc_sense(&map, &gs.player, angles, 5, 0.0f, out);
+    for (int i = 0; i < 5; i++) {
+        const RayHit *h = &gs.hits[cols[i]];
+        ASSERT_NEAR(out[i].dist * cosf(angles[i]), h->wall_dist, 0.01f);
+        assert(out[i].cell == h->cell);
+        assert(out[i].tile_type == h->tile_type);
+        assert(out[i].side == h->side);
+    }
+}
+
+static void test_sense_full_sweep(void)
+{
+    /* Four rays round the compass from the centre of a 9x9 box: walls
+     * (cells 0 and 8) are 4 cells away, so every range is 3.5 */
+    Map map;
+    GameState gs;
+    init_box_map(&map, &gs, 9, 9, 4.5f, 4.5f, 1.0f, 0.0f);
+    float angles[4];
+    rc_sense_spread(angles, 4, 2.0f * PI, 0.0f);
+    ASSERT_NEAR(angles[0], -PI, 1e-5f);
+    ASSERT_NEAR(angles[2], 0.0f, 1e-5f);
+
+    SenseHit out[4];
+    rc_sense(&map, &gs.player, angles, 4, 0.0f, out);
+    for (int i = 0; i < 4; i++) ASSERT_NEAR(out[i].dist, 3.5f, 1e-4f);
+    assert(out[2].cell == 4 * MAP_MAX_W + 8);           /* ahead: east */
+    assert(out[0].cell == 4 * MAP_MAX_W + 0);           /* behind: west */
+    assert(out[3].cell == 8 * MAP_MAX_W + 4);           /* right: south */
+    assert(out[1].cell == 0 * MAP_MAX_W + 4);           /* left: north */
+
+    /* A dense sweep never escapes a closed box */
+    float many[360];
+    SenseHit hits[360];
+    rc_sense_spread(many, 360, 2.0f * PI, 0.0f);
+    rc_sense(&map, &gs.player, many, 360, 0.0f, hits);
+    for (int i = 0; i < 360; i++) {
+        assert(hits[i].cell != ID_NO_CELL);
+        assert(hits[i].dist >= 3.5f - 1e-4f && hits[i].dist <= 3.5f * 1.4143f);
+    }
+}
+
+static void test_sense_max_range(void)
+{
+    Map map;
+    GameState gs;
+    init_box_map(&map, &gs, 9, 9, 4.5f, 4.5f, 1.0f, 0.0f);
+    float angles[8];
+    SenseHit out[8];
+    rc_sense_spread(angles, 8, 2.0f * PI, 0.0f);
+    rc_sense(&map, &gs.player, angles, 8, 1.0f, out);
+    for (int i = 0; i < 8; i++) {
+        assert(out[i].dist == 1.0f);
+        assert(out[i].cell == ID_NO_CELL);
+    }
+}
+
+static void test_sense_spread_focus(void)
+{
+    float even[9], dense[9];
+    rc_sense_spread(even, 9, 1.0f, 0.0f);
+    rc_sense_spread(dense, 9, 1.0f, 2.0f);
+
+    /* Both span the whole fov; focus narrows the centre gaps only */
+    ASSERT_NEAR(even[0], -0.5f, 1e-6f);
+    ASSERT_NEAR(even[8],  0.5f, 1e-6f);
+    ASSERT_NEAR(dense[0], -0.5f, 1e-6f);
+    ASSERT_NEAR(dense[8],  0.5f, 1e-6f);
+    ASSERT_NEAR(even[4] - even[3], even[1] - even[0], 1e-6f);
+    assert(dense[4] - dense[3] < dense[1] - dense[0]);
+    for (int i = 0; i < 9; i++) ASSERT_NEAR(dense[i], -dense[8 - i], 1e-6f);
+
+    float one;
+    rc_sense_spread(&one, 1, 1.0f, 0.0f);
+    assert(one == 0.0f);
+}
+
 /* ═══════════════════════════════════════════════════════════════════ */
 /*  Main                                                              */
 /* ═══════════════════════════════════════════════════════════════════ */
@@ -969,6 +1142,11 @@ int main(void)
     RUN_TEST(test_update_endgame_requires_centre);
     RUN_TEST(test_update_no_trigger_no_game_over);
 
+    printf("\n── rc_lerp_player ──────────────────────────────────────\n");
+    RUN_TEST(test_lerp_endpoints_and_midpoint);
+    RUN_TEST(test_lerp_rotation_keeps_lengths);
+    RUN_TEST(test_lerp_snaps_on_teleport);
+
     printf("\n── rc_cast ─────────────────────────────────────────────\n");
     RUN_TEST(test_cast_straight_east);
     RUN_TEST(test_cast_straight_north);
@@ -1000,6 +1178,12 @@ int main(void)
     RUN_TEST(test_z_buffer_filled);
     RUN_TEST(test_z_buffer_matches_hits);
 
+    printf("\n── rc_sense ────────────────────────────────────────────\n");
+    RUN_TEST(test_sense_matches_cast);
+    RUN_TEST(test_sense_full_sweep);
+    RUN_TEST(test_sense_max_range);
+    RUN_TEST(test_sense_spread_focus);
+
     printf("\n══════════════════════════════════════════════════════════\n");
     printf("  %d / %d tests passed\n", tests_passed, tests_run);
     printf("══════════════════════════════════════════════════════════\n\n");
@@ -0,0 +1,186 @@
+/*  test_replay.c  –  tests for input recording and deterministic replay
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o, replay.o, sim.o and the modules sim.o
+ *  uses — no SDL dependency.  Maps are built inline; logs are written
+ *  to the working directory.
+ *  Build:  make test
+ *  Run:    ./test_replay
+ */
+#include "raycaster.h"
+#include "replay.h"
+#include "sim.h"
+#include "map_cache.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_PATH "test_replay.rcr"
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+/** Deterministic but varied input: changes every few ticks. */
+static void scripted_input(int tick, Input *in)
+{
+    unsigned bits = (unsigned)((tick / 7) * 2654435761u >> 28);
+    sim_unpack_input(bits, in);
+}
+
+static long file_size(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    assert(fp);
+    fseek(fp, 0, SEEK_END);
+    long n = ftell(fp);
+    fclose(fp);
+    return n;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Log format tests                                                  */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_inputs_round_trip(void)
+{
+    ReplayHeader h = { .map_hash = 0x1234567890abcdefull, .dt = 1.0f / 60.0f,
+                       .spawn = { 1.5f, 2.5f, 0.0f, -1.0f, 0.66f, 0.0f },
+                       .npc_count = 42 };
+    Replay r;
+    assert(replay_open_write(&r, LOG_PATH, &h));
+    Input in;
+    for (int t = 0; t < 1000; t++) {
+        scripted_input(t, &in);
+        replay_record(&r, &in);
+    }
+    assert(replay_close_write(&r, 99));
+
+    assert(replay_open_read(&r, LOG_PATH));
+    assert(r.header.map_hash == h.map_hash);
+    assert(r.header.dt == h.dt);
+    assert(r.header.spawn.dir_y == -1.0f && r.header.spawn.plane_x == 0.66f);
+    assert(r.header.npc_count == 42);
+
+    Input got, want;
+    for (int t = 0; t < 1000; t++) {
+        assert(replay_next(&r, &got));
+        scripted_input(t, &want);
+        assert(memcmp(&got, &want, sizeof(got)) == 0);
+    }
+    assert(!replay_next(&r, &got));
+    assert(r.end_ticks == 1000 && r.end_hash == 99);
+    replay_close(&r);
+}
+
+static void test_runs_are_compact(void)
+{
+    ReplayHeader h = { .dt = 1.0f / 60.0f };
+    Replay r;
+    assert(replay_open_write(&r, LOG_PATH, &h));
+    Input in;
+    memset(&in, 0, sizeof(in));
+    in.forward = true;
+    for (int t = 0; t < 100000; t++) replay_record(&r, &in);
+    assert(replay_close_write(&r, 0));
+
+    /* header + one run (1 + 3 bytes) + footer */
+    assert(file_size(LOG_PATH) == 48 + 4 + 17);
+}
+
+static void test_rejects_bad_file(void)
+{
+    FILE *fp = fopen(LOG_PATH, "wb");
+    assert(fp);
+    fputs("not a replay log, just some text padding it out", fp);
+    fclose(fp);
+
+    Replay r;
+    assert(!replay_open_read(&r, LOG_PATH));
+    assert(!replay_open_read(&r, "nonexistent.rcr"));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Determinism tests                                                 */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_replay_reproduces_state(void)
+{
+    static Map map_a, map_b;
+    static MapOccupancy occ_a, occ_b;
+    static SimWorld a, b;
+    init_world(&a, &map_a, &occ_a, 300);
+
+    ReplayHeader h = { .map_hash = map_hash(&map_a), .dt = SIM_DT,
+                       .spawn = a.state.player, .npc_count = 300 };
+    Replay r;
+    assert(replay_open_write(&r, LOG_PATH, &h));
+    Input in;
+    for (int t = 0; t < 2000; t++) {
+        scripted_input(t, &in);
+        replay_record(&r, &in);
+        sim_world_tick(&a, &in, SIM_DT);
+    }
+    assert(replay_close_write(&r, sim_world_hash(&a)));
+
+    /* A fresh world rebuilt from the header alone */
+    init_world(&b, &map_b, &occ_b, 0);
+    assert(replay_open_read(&r, LOG_PATH));
+    assert(r.header.map_hash == map_hash(&map_b));
+    b.state.player = r.header.spawn;
+    ent_populate(&b.npcs, &occ_b, r.header.npc_count, 1);
+    while (replay_next(&r, &in)) sim_world_tick(&b, &in, r.header.dt);
+    replay_close(&r);
+
+    assert(r.ticks == 2000 && r.end_ticks == 2000);
+    assert(sim_world_hash(&b) == r.end_hash);
+    assert(b.state.player.x == a.state.player.x);
+}
+
+static void test_hash_detects_divergence(void)
+{
+    static Map map;
+    static MapOccupancy occ;
+    static SimWorld w;
+    init_world(&w, &map, &occ, 10);
+    uint64_t h0 = sim_world_hash(&w);
+    w.npcs.x[3] += 1e-5f;
+    assert(sim_world_hash(&w) != h0);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── replay log ──────────────────────────────────────────\n");
+    RUN_TEST(test_inputs_round_trip);
+    RUN_TEST(test_runs_are_compact);
+    RUN_TEST(test_rejects_bad_file);
+
+    printf("\n── determinism ─────────────────────────────────────────\n");
+    RUN_TEST(test_replay_reproduces_state);
+    RUN_TEST(test_hash_detects_divergence);
+
+    remove(LOG_PATH);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
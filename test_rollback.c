@@ -0,0 +1,257 @@
+/*  test_rollback.c  –  tests for the delta-compressed snapshot ring
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o, rollback.o, sim.o and the modules sim.o
+ *  uses — no SDL dependency.  Maps are built inline.
+ *  Build:  make test
+ *  Run:    ./test_rollback
+ */
+#include "raycaster.h"
+#include "rollback.h"
+#include "sim.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+/** Deterministic but varied input: changes every few ticks. */
+static void scripted_input(int tick, Input *in)
+{
+    unsigned bits = (unsigned)((tick / 7) * 2654435761u >> 28);
+    sim_unpack_input(bits, in);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Restore tests                                                     */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_restore_returns_exact_state(void)
+{
+    static Map map;
+    static MapOccupancy occ;
+    static SimWorld w;
+    static Rollback rb;
+    static uint64_t hashes[101];
+    init_world(&w, &map, &occ, 300);
+    rb_reset(&rb, &w, 0);
+
+    Input in;
+    for (int t = 0; t < 100; t++) {
+        hashes[t] = sim_world_hash(&w);
+        scripted_input(t, &in);
+        rb_advance(&rb, &w, &in, SIM_DT);
+    }
+    hashes[100] = sim_world_hash(&w);
+    assert(rb.head_tick == 100);
+
+    assert(rb_restore(&rb, &w, 100));
+    assert(sim_world_hash(&w) == hashes[100]);
+    assert(rb_restore(&rb, &w, 73));
+    assert(sim_world_hash(&w) == hashes[73]);
+    assert(rb_restore(&rb, &w, 0));
+    assert(sim_world_hash(&w) == hashes[0]);
+    assert(rb.head_tick == 0 && rb.count == 0);
+}
+
+static void test_restore_out_of_range(void)
+{
+    static Map map;
+    static MapOccupancy occ;
+    static SimWorld w;
+    static Rollback rb;
+    init_world(&w, &map, &occ, 20);
+    rb_reset(&rb, &w, 1000);
+
+    Input in;
+    memset(&in, 0, sizeof(in));
+    for (int t = 0; t < RB_MAX_TICKS + 10; t++)
+        rb_advance(&rb, &w, &in, SIM_DT);
+
+    /* Only the last RB_MAX_TICKS ticks are kept */
+    assert(rb.head_tick == 1000 + RB_MAX_TICKS + 10);
+    assert(rb_oldest(&rb) == 1010);
+    assert(!rb_restore(&rb, &w, 1009));
+    assert(!rb_restore(&rb, &w, rb.head_tick + 1));
+    assert(rb_resimulate(&rb, &w, rb.head_tick, &in, SIM_DT) == -1);
+    assert(rb_restore(&rb, &w, 1010));
+}
+
+static void test_restore_undoes_door_toggle(void)
+{
+    static Map map;
+    static MapOccupancy occ;
+    static SimWorld w;
+    static TriggerSet ts;
+    static Rollback rb;
+    init_world(&w, &map, &occ, 0);
+    map.info[2][4]  = INFO_TRIGGER_SWITCH;
+    map.info[2][10] = INFO_DOOR;
+    map.tiles[2][10] = 5;
+    map_occupancy_build(&occ, &map);
+    trig_build(&ts, &map);
+    w.state.triggers = &ts;
+    rb_reset(&rb, &w, 0);
+
+    /* Walk east over the switch: the door opens */
+    Input in;
+    memset(&in, 0, sizeof(in));
+    in.forward = true;
+    for (int t = 0; t < 40; t++) rb_advance(&rb, &w, &in, SIM_DT);
+    assert(map.tiles[2][10] == TILE_FLOOR);
+    assert(!map_occupancy_solid(&occ, 10, 2));
+
+    /* Back to before the switch: door closed, and the occupancy grid
+     * follows on the next tick through the change log */
+    assert(rb_restore(&rb, &w, 0));
+    assert(map.tiles[2][10] == 5);
+    memset(&in, 0, sizeof(in));
+    rb_advance(&rb, &w, &in, SIM_DT);
+    assert(map_occupancy_solid(&occ, 10, 2));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Resimulation tests                                                */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_resimulate_same_input_is_identity(void)
+{
+    static Map map;
+    static MapOccupancy occ;
+    static SimWorld w;
+    static Rollback rb;
+    init_world(&w, &map, &occ, 300);
+    rb_reset(&rb, &w, 0);
+
+    Input in;
+    for (int t = 0; t < 200; t++) {
+        scripted_input(t, &in);
+        rb_advance(&rb, &w, &in, SIM_DT);
+    }
+    uint64_t h = sim_world_hash(&w);
+
+    scripted_input(150, &in);
+    assert(rb_resimulate(&rb, &w, 150, &in, SIM_DT) == 50);
+    assert(rb.head_tick == 200);
+    assert(sim_world_hash(&w) == h);
+}
+
+static void test_resimulate_corrects_prediction(void)
+{
+    static Map map_a, map_b;
+    static MapOccupancy occ_a, occ_b;
+    static SimWorld a, b;
+    static Rollback rb;
+    init_world(&a, &map_a, &occ_a, 300);
+    init_world(&b, &map_b, &occ_b, 300);
+    rb_reset(&rb, &b, 0);
+
+    /* a sees the real input; b predicted "no input" at tick 120 */
+    Input in, none;
+    memset(&none, 0, sizeof(none));
+    for (int t = 0; t < 180; t++) {
+        scripted_input(t, &in);
+        sim_world_tick(&a, &in, SIM_DT);
+        rb_advance(&rb, &b, t == 120 ? &none : &in, SIM_DT);
+    }
+    scripted_input(120, &in);
+    assert(in.forward || in.back || in.turn_left || in.turn_right);
+    assert(sim_world_hash(&a) != sim_world_hash(&b));
+
+    /* The late input arrives: roll back and replay the 60 ticks since */
+    assert(rb_resimulate(&rb, &b, 120, &in, SIM_DT) == 60);
+    assert(sim_world_hash(&a) == sim_world_hash(&b));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Storage tests                                                     */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_deltas_are_compact(void)
+{
+    static Map map;
+    static MapOccupancy occ;
+    static SimWorld w;
+    static Rollback rb;
+    init_world(&w, &map, &occ, 10);
+    rb_reset(&rb, &w, 0);
+
+    Input in;
+    for (int t = 0; t < 100; t++) {
+        scripted_input(t, &in);
+        rb_advance(&rb, &w, &in, SIM_DT);
+    }
+    /* A tick moves the player and ten entities: a few dozen bytes, not
+     * a copy of the map */
+    assert(rb.count == 100);
+    assert(rb_bytes(&rb) < 100 * rb.image_size / 10);
+}
+
+static void test_pool_wraps_and_evicts(void)
+{
+    static Map map;
+    static MapOccupancy occ;
+    static SimWorld w;
+    static Rollback rb;
+    static uint64_t hashes[400];
+    init_world(&w, &map, &occ, 3000);
+    assert(w.npcs.count == 3000);
+    rb_reset(&rb, &w, 0);
+
+    /* Every entity moves every tick, so the pool fills long before the
+     * entry ring does and old deltas are evicted to make room */
+    Input in;
+    for (int t = 0; t < 400; t++) {
+        hashes[t] = sim_world_hash(&w);
+        scripted_input(t, &in);
+        rb_advance(&rb, &w, &in, SIM_DT);
+    }
+    assert(rb.count < RB_MAX_TICKS);
+    assert(rb_bytes(&rb) <= RB_POOL_SIZE);
+
+    uint64_t oldest = rb_oldest(&rb);
+    assert(oldest > 400 - RB_MAX_TICKS);
+    assert(rb_restore(&rb, &w, oldest));
+    assert(sim_world_hash(&w) == hashes[oldest]);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── restore ─────────────────────────────────────────────\n");
+    RUN_TEST(test_restore_returns_exact_state);
+    RUN_TEST(test_restore_out_of_range);
+    RUN_TEST(test_restore_undoes_door_toggle);
+
+    printf("\n── resimulate ──────────────────────────────────────────\n");
+    RUN_TEST(test_resimulate_same_input_is_identity);
+    RUN_TEST(test_resimulate_corrects_prediction);
+
+    printf("\n── storage ─────────────────────────────────────────────\n");
+    RUN_TEST(test_deltas_are_compact);
+    RUN_TEST(test_pool_wraps_and_evicts);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
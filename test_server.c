@@ -0,0 +1,366 @@
+/*  test_server.c  –  tests for the localhost control server
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against server.o and sim.o — no SDL dependency.  Each test is
+ *  a real client on a real socket: input must reach the game, state
+ *  must arrive as deltas, frames must decode to exactly what was drawn,
+ *  and a client that stops reading must cost skipped frames, not a
+ *  stalled server.
+ *  Build:  make test
+ *  Run:    ./test_server
+ */
+#define _POSIX_C_SOURCE 200809L  /* socket(), poll(), getpid() */
+
+#include "server.h"
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+#define FRAME_PX   (SCREEN_W * SCREEN_H)
+#define WAIT_MS    2000
+
+static Server srv;
+
+/** A per-process socket path, so parallel test runs never collide. */
+static const char *sock_addr(void)
+{
+    static char addr[SRV_ADDR_MAX];
+    snprintf(addr, sizeof(addr), "unix:/tmp/raycaster-test-%ld.sock", (long)getpid());
+    return addr;
+}
+
+static int connect_unix(const char *addr)
+{
+    struct sockaddr_un sa = { .sun_family = AF_UNIX };
+    snprintf(sa.sun_path, sizeof(sa.sun_path), "%s", addr + 5);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    assert(connect(fd, (struct sockaddr *)&sa, sizeof(sa)) == 0);
+    return fd;
+}
+
+static int connect_tcp(int port)
+{
+    struct sockaddr_in sa = {
+        .sin_family = AF_INET,
+        .sin_port   = htons((uint16_t)port),
+        .sin_addr   = { htonl(INADDR_LOOPBACK) },
+    };
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    assert(connect(fd, (struct sockaddr *)&sa, sizeof(sa)) == 0);
+    return fd;
+}
+
+static void send_msg(int fd, uint32_t type, uint32_t value)
+{
+    uint32_t m[3] = { type, 4, value };
+    assert(send(fd, m, sizeof(m), 0) == sizeof(m));
+}
+
+static bool readable(int fd, int ms)
+{
+    struct pollfd p = { .fd = fd, .events = POLLIN };
+    return poll(&p, 1, ms) == 1;
+}
+
+static void recv_all(int fd, void *buf, size_t n)
+{
+    for (size_t got = 0; got < n; ) {
+        assert(readable(fd, WAIT_MS));
+        ssize_t r = recv(fd, (uint8_t *)buf + got, n - got, 0);
+        assert(r > 0);
+        got += (size_t)r;
+    }
+}
+
+/** Next message from the server: its type, payload in buf, length. */
+static size_t recv_msg(int fd, uint32_t *type, uint8_t *buf, size_t cap)
+{
+    uint32_t h[2];
+    recv_all(fd, h, sizeof(h));
+    assert(h[1] <= cap);
+    recv_all(fd, buf, h[1]);
+    *type = h[0];
+    return h[1];
+}
+
+/** Poll a condition the server thread brings about. */
+#define WAIT_FOR(cond)                                                  \
+    do {                                                                \
+        int waited_ = 0;                                                \
+        while (!(cond)) {                                               \
+            assert(waited_++ < WAIT_MS);                                \
+            thrd_sleep(&(struct timespec){ .tv_nsec = 1000000 }, NULL); \
+        }                                                               \
+    } while (0)
+
+static SrvState sample_state(void)
+{
+    SrvState s = { .tick = 42, .game_over = 0, .damage_taken = 3,
+                   .map_epoch = 1, .map_revision = 7 };
+    s.player.x = 3.5f;
+    s.player.y = 4.5f;
+    s.player.dir_x = 1.0f;
+    return s;
+}
+
+static bool same_state(const SrvState *a, const SrvState *b)
+{
+    return a->tick == b->tick
+        && a->player.x == b->player.x && a->player.y == b->player.y
+        && a->player.dir_x == b->player.dir_x
+        && a->game_over == b->game_over && a->damage_taken == b->damage_taken
+        && a->map_epoch == b->map_epoch && a->map_revision == b->map_revision;
+}
+
+static void fill_noise(uint32_t *px, uint32_t seed)
+{
+    for (int i = 0; i < FRAME_PX; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        px[i] = seed;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Input and state tests                                             */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_input_reaches_game(void)
+{
+    assert(srv_start(&srv, sock_addr()));
+    int fd = connect_unix(sock_addr());
+    send_msg(fd, SRV_MSG_INPUT, 0x5);
+    WAIT_FOR(srv_input(&srv) == 0x5);
+
+    /* A client that goes away stops pressing its keys */
+    close(fd);
+    WAIT_FOR(srv_input(&srv) == 0);
+    srv_stop(&srv);
+    assert(access(sock_addr() + 5, F_OK) != 0);           /* file removed */
+}
+
+static atomic_int input_wakes;
+
+static void count_wake(void *arg)
+{
+    (void)arg;
+    atomic_fetch_add(&input_wakes, 1);
+}
+
+static void test_input_change_calls_hook(void)
+{
+    srv.on_input = count_wake;
+    assert(srv_start(&srv, sock_addr()));
+    int fd = connect_unix(sock_addr());
+    send_msg(fd, SRV_MSG_INPUT, 0x5);
+    WAIT_FOR(atomic_load(&input_wakes) == 1);
+    send_msg(fd, SRV_MSG_INPUT, 0x5);             /* unchanged: no call */
+    send_msg(fd, SRV_MSG_INPUT, 0x1);
+    WAIT_FOR(atomic_load(&input_wakes) == 2);
+    assert(srv_input(&srv) == 0x1);
+
+    close(fd);                                    /* keys released      */
+    WAIT_FOR(atomic_load(&input_wakes) == 3);
+    srv_stop(&srv);
+    srv.on_input = NULL;
+}
+
+static void test_state_arrives_as_deltas(void)
+{
+    static uint8_t buf[256];
+    assert(srv_start(&srv, sock_addr()));
+    int fd = connect_unix(sock_addr());
+    send_msg(fd, SRV_MSG_SUBSCRIBE, SRV_SUB_STATE);
+
+    /* The first message carries everything */
+    SrvState s = sample_state(), got = { 0 };
+    srv_publish_state(&srv, &s);
+    uint32_t type, mask;
+    size_t len = recv_msg(fd, &type, buf, sizeof(buf));
+    assert(type == SRV_MSG_STATE);
+    assert(srv_state_apply(&got, buf, len) && same_state(&got, &s));
+
+    /* Then only what moved */
+    s.tick++;
+    s.player.x += 0.25f;
+    srv_publish_state(&srv, &s);
+    len = recv_msg(fd, &type, buf, sizeof(buf));
+    memcpy(&mask, buf, 4);
+    assert(type == SRV_MSG_STATE && mask == (SRV_F_TICK | SRV_F_POSE));
+    assert(len == 4 + 8 + sizeof(Player));
+    assert(srv_state_apply(&got, buf, len) && same_state(&got, &s));
+
+    /* And nothing at all when nothing changed */
+    srv_publish_state(&srv, &s);
+    assert(!readable(fd, 200));
+
+    close(fd);
+    srv_stop(&srv);
+}
+
+static void test_tcp_merges_clients(void)
+{
+    assert(srv_start(&srv, "tcp:0"));
+    assert(srv.port > 0);                                 /* picked for us */
+    int a = connect_tcp(srv.port), b = connect_tcp(srv.port);
+    send_msg(a, SRV_MSG_INPUT, 0x1);
+    send_msg(b, SRV_MSG_INPUT, 0x4);
+    WAIT_FOR(srv_input(&srv) == 0x5);
+    send_msg(a, SRV_MSG_INPUT, 0);
+    WAIT_FOR(srv_input(&srv) == 0x4);
+    close(a);
+    close(b);
+    srv_stop(&srv);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Frame tests                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_frames_decode_exactly(void)
+{
+    static uint8_t  buf[SRV_OUT_BYTES];
+    static uint32_t want[FRAME_PX], have[FRAME_PX];
+    assert(srv_start(&srv, sock_addr()));
+    int fd = connect_unix(sock_addr());
+    assert(!srv_wants_frames(&srv));
+    send_msg(fd, SRV_MSG_SUBSCRIBE, SRV_SUB_FRAMES);
+    WAIT_FOR(srv_wants_frames(&srv));
+
+    fill_noise(want, 9);
+    memcpy(srv_frame_begin(&srv), want, sizeof(want));
+    srv_frame_publish(&srv);
+    uint32_t type, no;
+    size_t len = recv_msg(fd, &type, buf, sizeof(buf));
+    memcpy(&no, buf, 4);
+    assert(type == SRV_MSG_FRAME && no == 1);
+    assert(srv_frame_apply(have, buf + 4, len - 4));
+    assert(memcmp(have, want, sizeof(want)) == 0);
+
+    /* A small change costs a small message */
+    for (int y = 100; y < 110; y++)
+        for (int x = 200; x < 210; x++) want[y * SCREEN_W + x] ^= 0xFF00FF00u;
+    memcpy(srv_frame_begin(&srv), want, sizeof(want));
+    srv_frame_publish(&srv);
+    len = recv_msg(fd, &type, buf, sizeof(buf));
+    memcpy(&no, buf, 4);
+    assert(type == SRV_MSG_FRAME && no == 2);
+    assert(len < 4 + 10 * (10 * 4 + 6));
+    assert(srv_frame_apply(have, buf + 4, len - 4));
+    assert(memcmp(have, want, sizeof(want)) == 0);
+
+    send_msg(fd, SRV_MSG_SUBSCRIBE, 0);
+    WAIT_FOR(!srv_wants_frames(&srv));
+    close(fd);
+    srv_stop(&srv);
+}
+
+static void test_slow_client_skips_frames(void)
+{
+    /* The client reads nothing while 20 noisy frames go out: the socket
+     * fills on the first, the rest are skipped, and once it catches up
+     * it gets the newest frame intact */
+    static uint8_t  buf[SRV_OUT_BYTES];
+    static uint32_t want[FRAME_PX], have[FRAME_PX];
+    assert(srv_start(&srv, sock_addr()));
+    int fd = connect_unix(sock_addr());
+    send_msg(fd, SRV_MSG_SUBSCRIBE, SRV_SUB_FRAMES);
+    WAIT_FOR(srv_wants_frames(&srv));
+
+    for (uint32_t n = 1; n <= 20; n++) {
+        fill_noise(srv_frame_begin(&srv), n);
+        srv_frame_publish(&srv);
+    }
+    fill_noise(want, 20);
+
+    int received = 0;
+    uint32_t no = 0, type;
+    while (no < 20) {
+        size_t len = recv_msg(fd, &type, buf, sizeof(buf));
+        assert(type == SRV_MSG_FRAME);
+        memcpy(&no, buf, 4);
+        assert(srv_frame_apply(have, buf + 4, len - 4));
+        received++;
+    }
+    assert(received < 20);
+    assert(memcmp(have, want, sizeof(want)) == 0);
+
+    close(fd);
+    srv_stop(&srv);
+    assert(srv.frames_skipped > 0 && srv.frames_skipped <= (uint64_t)(20 - received));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Validation tests                                                  */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_rejects_bad_input(void)
+{
+    assert(!srv_start(&srv, "udp:1"));
+    assert(!srv_start(&srv, "tcp:x"));
+    assert(!srv_start(&srv, "tcp:70000"));
+    assert(!srv_start(&srv, "unix:"));
+    assert(!srv_start(&srv, NULL));
+
+    static uint32_t frame[FRAME_PX];
+    const uint8_t truncated[] = { 0x00, 0x02, 0xAA, 0xBB, 0xCC, 0xDD };
+    const uint8_t past_end[]  = { 0xFF, 0xFF, 0x7F, 0x01, 0, 0, 0, 0 };
+    const uint8_t open_varint[] = { 0x80 };
+    assert(!srv_frame_apply(frame, truncated, sizeof(truncated)));
+    assert(!srv_frame_apply(frame, past_end, sizeof(past_end)));
+    assert(!srv_frame_apply(frame, open_varint, sizeof(open_varint)));
+
+    SrvState s = { 0 };
+    uint8_t short_state[6] = { SRV_F_TICK, 0, 0, 0, 1, 2 };
+    assert(!srv_state_apply(&s, short_state, sizeof(short_state)));
+    assert(s.tick == 0);                                   /* untouched */
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── input and state ─────────────────────────────────────\n");
+    RUN_TEST(test_input_reaches_game);
+    RUN_TEST(test_input_change_calls_hook);
+    RUN_TEST(test_state_arrives_as_deltas);
+    RUN_TEST(test_tcp_merges_clients);
+
+    printf("\n── frames ──────────────────────────────────────────────\n");
+    RUN_TEST(test_frames_decode_exactly);
+    RUN_TEST(test_slow_client_skips_frames);
+
+    printf("\n── validation ──────────────────────────────────────────\n");
+    RUN_TEST(test_rejects_bad_input);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
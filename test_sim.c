@@ -0,0 +1,340 @@
+/*  test_sim.c  –  tests for the simulation thread and triple buffer
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o, sim.o, entity.o, level.o, map_stream.o,
+ *  trigger.o, map_edit.o, map_cache.o and map_manager_ascii.o — no SDL
+ *  dependency.  Maps are built inline.
+ *  Build:  make test
+ *  Run:    ./test_sim
+ */
+#include "raycaster.h"
+#include "sim.h"
+#include "trigger.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+static void sleep_ms(long ms)
+{
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L };
+    thrd_sleep(&ts, NULL);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Triple buffer tests                                               */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_triple_slots_distinct(void)
+{
+    TripleBuffer tb;
+    sim_triple_init(&tb);
+    for (int i = 0; i < 10; i++) {
+        unsigned mid = atomic_load(&tb.middle) & ~SIM_SLOT_FRESH;
+        assert(tb.back != tb.front && tb.back != mid && tb.front != mid);
+        if (i % 2) sim_triple_publish(&tb);
+        else       sim_triple_acquire(&tb);
+    }
+}
+
+static void test_triple_reader_gets_latest(void)
+{
+    TripleBuffer tb;
+    int slots[3] = {0};
+    sim_triple_init(&tb);
+
+    /* Publish 1, 2, 3 without reading: the reader sees only 3 */
+    for (int v = 1; v <= 3; v++) {
+        slots[tb.back] = v;
+        sim_triple_publish(&tb);
+    }
+    assert(slots[sim_triple_acquire(&tb)] == 3);
+
+    /* Nothing new: the same slot is returned again */
+    unsigned again = sim_triple_acquire(&tb);
+    assert(slots[again] == 3);
+}
+
+/* Writer thread for the stress test: both halves of a slot must always
+ * match when the reader looks at it */
+typedef struct Pair { long a, b; } Pair;
+static Pair         pairs[3];
+static TripleBuffer stress_tb;
+static atomic_bool  stress_done;
+
+static int stress_writer(void *arg)
+{
+    (void)arg;
+    for (long v = 1; v <= 200000; v++) {
+        pairs[stress_tb.back].a = v;
+        pairs[stress_tb.back].b = v;
+        sim_triple_publish(&stress_tb);
+    }
+    atomic_store(&stress_done, true);
+    return 0;
+}
+
+static void test_triple_no_tearing(void)
+{
+    memset(pairs, 0, sizeof(pairs));
+    sim_triple_init(&stress_tb);
+    atomic_init(&stress_done, false);
+
+    thrd_t t;
+    assert(thrd_create(&t, stress_writer, NULL) == thrd_success);
+    long last = 0;
+    while (!atomic_load(&stress_done)) {
+        const Pair *p = &pairs[sim_triple_acquire(&stress_tb)];
+        assert(p->a == p->b);
+        assert(p->a >= last);          /* never goes back in time */
+        last = p->a;
+    }
+    thrd_join(t, NULL);
+    assert(pairs[sim_triple_acquire(&stress_tb)].a == 200000);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Simulation thread tests                                           */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_world_tick_moves_player_and_npcs(void)
+{
+    static Map map;
+    static SimWorld w;
+    static MapOccupancy occ;
+    init_box(&map, 20, 20);
+    map_occupancy_build(&occ, &map);
+
+    memset(&w, 0, sizeof(w));
+    w.map = &map;
+    w.occupancy = &occ;
+    w.state.player.x = 5.5f;  w.state.player.y = 5.5f;
+    w.state.player.dir_x = 1.0f;  w.state.player.plane_y = 0.66f;
+    ent_spawn(&w.npcs, 10.5f, 10.5f, 0.0f, 1.0f, 0);
+
+    Input in;
+    memset(&in, 0, sizeof(in));
+    in.forward = true;
+    for (int i = 0; i < SIM_TICK_RATE; i++) sim_world_tick(&w, &in, SIM_DT);
+
+    assert(w.state.player.x > 8.0f);
+    assert(w.npcs.y[0] > 11.0f);
+}
+
+static void test_world_tick_fires_entity_triggers(void)
+{
+    static Map map;
+    static SimWorld w;
+    static MapOccupancy occ;
+    static TriggerSet ts;
+    init_box(&map, 12, 12);
+    map.info[5][3] = INFO_TRIGGER_TELEPORT;
+    map.info[5][9] = INFO_TRIGGER_TELEPORT;
+    map.info[8][6] = INFO_TRIGGER_DAMAGE;
+    map_occupancy_build(&occ, &map);
+    trig_build(&ts, &map);
+
+    memset(&w, 0, sizeof(w));
+    w.map = &map;
+    w.occupancy = &occ;
+    w.state.triggers = &ts;
+    w.state.player.x = 1.5f;  w.state.player.y = 1.5f;
+    w.state.player.dir_x = 1.0f;  w.state.player.plane_y = 0.66f;
+    ent_spawn(&w.npcs, 2.99f, 5.5f, 2.0f, 0.0f, 0);  /* walks onto a pad */
+    ent_spawn(&w.npcs, 6.5f, 8.5f, 0.0f, 0.0f, 0);   /* stands in damage */
+
+    Input in;
+    memset(&in, 0, sizeof(in));
+    sim_world_tick(&w, &in, SIM_DT);
+
+    assert(w.npcs.x[0] > 9.0f && w.npcs.x[0] < 9.2f);
+    assert(w.npcs.damage[1] > 0);
+    assert(w.npcs.damage[0] == 0);
+    assert(w.state.damage_taken == 0);
+}
+
+static void test_sim_thread_ticks_and_publishes(void)
+{
+    static Map map;
+    static Sim sim;
+    static MapOccupancy occ;
+    init_box(&map, 20, 20);
+    map_occupancy_build(&occ, &map);
+
+    memset(&sim, 0, sizeof(sim));
+    sim.world.map = &map;
+    sim.world.occupancy = &occ;
+    sim.world.state.player.x = 2.5f;  sim.world.state.player.y = 5.5f;
+    sim.world.state.player.dir_x = 1.0f;  sim.world.state.player.plane_y = 0.66f;
+    assert(sim_start(&sim));
+
+    /* Initial snapshot is available immediately */
+    const SimSnapshot *s = sim_latest(&sim);
+    assert(s->map.w == 20);
+
+    Input in;
+    memset(&in, 0, sizeof(in));
+    in.forward = true;
+    sim_set_input(&sim, &in);
+    sleep_ms(200);
+
+    s = sim_latest(&sim);
+    assert(s->tick > 0);
+    assert(s->player.x > 2.5f);
+    assert(s->map.w == 20 && s->map.tiles[0][0] == 1);
+
+    sim_stop(&sim);
+}
+
+static void test_sim_tick_rate_under_render_load(void)
+{
+    static Map map;
+    static Sim sim;
+    static MapOccupancy occ;
+    init_box(&map, 20, 20);
+    map_occupancy_build(&occ, &map);
+
+    memset(&sim, 0, sizeof(sim));
+    sim.world.map = &map;
+    sim.world.occupancy = &occ;
+    sim.world.state.player.x = 5.5f;  sim.world.state.player.y = 5.5f;
+    sim.world.state.player.dir_x = 1.0f;  sim.world.state.player.plane_y = 0.66f;
+    assert(sim_start(&sim));
+
+    /* A "renderer" that spends 50 ms per frame must not slow the ticks */
+    uint64_t t0 = sim_latest(&sim)->tick;
+    for (int i = 0; i < 6; i++) {
+        sleep_ms(50);
+        (void)sim_latest(&sim);
+    }
+    uint64_t ticks = sim_latest(&sim)->tick - t0;
+    sim_stop(&sim);
+
+    /* ~18 ticks in 300 ms at 60 Hz; allow for scheduler noise */
+    assert(ticks >= 12 && ticks <= 24);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Interpolation tests                                               */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_world_tick_keeps_previous_state(void)
+{
+    static Map map;
+    static SimWorld w;
+    static MapOccupancy occ;
+    init_box(&map, 20, 20);
+    map_occupancy_build(&occ, &map);
+
+    memset(&w, 0, sizeof(w));
+    w.map = &map;
+    w.occupancy = &occ;
+    w.state.player.x = 5.5f;  w.state.player.y = 5.5f;
+    w.state.player.dir_x = 1.0f;  w.state.player.plane_y = 0.66f;
+    ent_spawn(&w.npcs, 10.5f, 10.5f, 1.0f, 0.0f, 0);
+
+    Input in;
+    memset(&in, 0, sizeof(in));
+    in.forward = true;
+    sim_world_tick(&w, &in, SIM_DT);
+    float x1 = w.state.player.x, n1 = w.npcs.x[0];
+    sim_world_tick(&w, &in, SIM_DT);
+
+    assert(w.prev_player.x == x1);
+    assert(w.npc_prev_x[0] == n1);
+    assert(w.state.player.x > x1);
+}
+
+static void test_alpha_clamped(void)
+{
+    static SimSnapshot s;
+    s.tick_time = 100.0;
+    s.dt        = 0.1f;
+    assert(sim_alpha(&s, 99.0) == 0.0f);
+    assert(fabsf(sim_alpha(&s, 100.05) - 0.5f) < 1e-3f);
+    assert(sim_alpha(&s, 101.0) == 1.0f);
+}
+
+static void test_lerp_npcs(void)
+{
+    static SimSnapshot s;
+    static EntityPool out;
+    memset(&s, 0, sizeof(s));
+    s.npcs.count = 3;
+    s.npc_prev_x[0] = 1.0f;  s.npcs.x[0] = 1.4f;
+    s.npc_prev_y[1] = 4.0f;  s.npcs.y[1] = 3.6f;
+    s.npcs.texture_id[1] = 3;
+    s.npc_prev_x[2] = 3.5f;  s.npcs.x[2] = 9.5f;      /* teleported */
+
+    sim_lerp_npcs(&s, 0.25f, &out);
+    assert(out.count == 3);
+    assert(fabsf(out.x[0] - 1.1f) < 1e-6f);
+    assert(fabsf(out.y[1] - 3.9f) < 1e-6f);
+    assert(out.texture_id[1] == 3);
+    assert(out.x[2] == 9.5f);                         /* jumps, no slide */
+}
+
+static void test_snapshot_still(void)
+{
+    static SimSnapshot s;
+    memset(&s, 0, sizeof(s));
+    s.player.x = s.prev_player.x = 2.5f;
+    s.npcs.count = 1;
+    s.npcs.x[0] = s.npc_prev_x[0] = 3.0f;
+    assert(sim_snapshot_still(&s));
+
+    s.npcs.y[0] = 0.5f;                  /* an entity moved */
+    assert(!sim_snapshot_still(&s));
+    s.npc_prev_y[0] = 0.5f;
+    s.player.dir_x = 1.0f;               /* the player turned */
+    assert(!sim_snapshot_still(&s));
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── triple buffer ───────────────────────────────────────\n");
+    RUN_TEST(test_triple_slots_distinct);
+    RUN_TEST(test_triple_reader_gets_latest);
+    RUN_TEST(test_triple_no_tearing);
+
+    printf("\n── simulation thread ───────────────────────────────────\n");
+    RUN_TEST(test_world_tick_moves_player_and_npcs);
+    RUN_TEST(test_world_tick_fires_entity_triggers);
+    RUN_TEST(test_sim_thread_ticks_and_publishes);
+    RUN_TEST(test_sim_tick_rate_under_render_load);
+
+    printf("\n── interpolation ───────────────────────────────────────\n");
+    RUN_TEST(test_world_tick_keeps_previous_state);
+    RUN_TEST(test_alpha_clamped);
+    RUN_TEST(test_lerp_npcs);
+    RUN_TEST(test_snapshot_still);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
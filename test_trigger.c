@@ -0,0 +1,297 @@
+/*  test_trigger.c  –  tests for the trigger index and event dispatch
+ *  ────────────────────────────────────────────────────────────────────
+ *  Links against raycaster.o, trigger.o and map_edit.o — no SDL
+ *  dependency.  Maps are built inline, so these tests are
+ *  filesystem-independent.
+ *  Build:  make test
+ *  Run:    ./test_trigger
+ */
+#include "raycaster.h"
+#include "trigger.h"
+#include "map_edit.h"
+#include "test_fixtures.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ── Minimal test harness ─────────────────────────────────────────── */
+
+static int tests_run    = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(fn)                                                    \
+    do {                                                                \
+        tests_run++;                                                    \
+        printf("  %-50s", #fn);                                         \
+        fn();                                                           \
+        tests_passed++;                                                 \
+        printf(" OK\n");                                                \
+    } while (0)
+
+/* ── Helper: player in the centre of a cell, facing east ──────────── */
+
+static void init_player(SimState *st, int x, int y)
+{
+    memset(st, 0, sizeof(*st));
+    st->player.x       = x + 0.5f;
+    st->player.y       = y + 0.5f;
+    st->player.dir_x   = 1.0f;
+    st->player.plane_y = 0.66f;
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Index tests                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_build_indexes_cells(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    init_box(&map, 10, 10);
+    map.info[2][3] = INFO_TRIGGER_DAMAGE;
+    map.info[5][6] = INFO_TRIGGER_SWITCH;
+    map.info[1][1] = INFO_SPAWN_PLAYER_E;
+    trig_build(&ts, &map);
+
+    assert(ts.count == 2);
+    assert(ts.cell[2][3] != 0);
+    assert(ts.triggers[ts.cell[2][3] - 1].type == INFO_TRIGGER_DAMAGE);
+    assert(ts.triggers[ts.cell[5][6] - 1].type == INFO_TRIGGER_SWITCH);
+    assert(ts.cell[1][1] == 0);
+}
+
+static void test_build_pairs_teleports(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    init_box(&map, 10, 10);
+    map.info[2][2] = INFO_TRIGGER_TELEPORT;
+    map.info[7][6] = INFO_TRIGGER_TELEPORT;
+    trig_build(&ts, &map);
+
+    const Trigger *a = &ts.triggers[ts.cell[2][2] - 1];
+    const Trigger *b = &ts.triggers[ts.cell[7][6] - 1];
+    assert(a->dest_x == 6 && a->dest_y == 7);
+    assert(b->dest_x == 2 && b->dest_y == 2);
+}
+
+static void test_sync_ignores_tile_edits(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    init_box(&map, 10, 10);
+    map.info[4][4] = INFO_TRIGGER_DAMAGE;
+    trig_build(&ts, &map);
+
+    map_set_tile(&map, 5, 5, 2);
+    trig_sync(&ts, &map);
+    assert(ts.revision == map.revision);
+    assert(ts.count == 1);
+}
+
+static void test_sync_rebuilds_on_info_edit(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    init_box(&map, 10, 10);
+    trig_build(&ts, &map);
+    assert(ts.count == 0);
+
+    map_set_info(&map, 3, 3, INFO_TRIGGER_ENDGAME);
+    trig_sync(&ts, &map);
+    assert(ts.count == 1);
+    assert(ts.cell[3][3] != 0);
+}
+
+static void test_sync_drops_removed_door(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    init_box(&map, 10, 10);
+    map.info[5][7] = INFO_DOOR;
+    trig_build(&ts, &map);
+    assert(ts.door_count == 1);
+
+    map_set_info(&map, 7, 5, INFO_EMPTY);
+    trig_sync(&ts, &map);
+    assert(ts.door_count == 0);
+    assert(ts.revision == map.revision);
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Event tests                                                       */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+static void test_damage_every_tick_inside(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    static SimState st;
+    init_box(&map, 10, 10);
+    map.info[3][3] = INFO_TRIGGER_DAMAGE;
+    trig_build(&ts, &map);
+    init_player(&st, 3, 3);
+    st.triggers = &ts;
+
+    Input in;
+    memset(&in, 0, sizeof(in));
+    for (int i = 0; i < 5; i++) rc_update(&st, &map, &in, 1.0f / 60.0f);
+    assert(st.damage_taken == 5 * TRIG_DAMAGE_PER_TICK);
+    assert(st.events.count == 0);
+}
+
+static void test_teleport_moves_player_once(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    static SimState st;
+    init_box(&map, 12, 10);
+    map.info[3][3] = INFO_TRIGGER_TELEPORT;
+    map.info[6][8] = INFO_TRIGGER_TELEPORT;
+    trig_build(&ts, &map);
+    init_player(&st, 2, 3);
+    st.triggers = &ts;
+
+    /* Walk east into the pad at (3, 3) */
+    Input in;
+    memset(&in, 0, sizeof(in));
+    in.forward = true;
+    for (int i = 0; i < 20 && (int)st.player.y == 3; i++)
+        rc_update(&st, &map, &in, 1.0f / 60.0f);
+    assert((int)st.player.x == 8 && (int)st.player.y == 6);
+
+    /* Standing on the destination pad must not bounce back */
+    in.forward = false;
+    for (int i = 0; i < 10; i++) rc_update(&st, &map, &in, 1.0f / 60.0f);
+    assert((int)st.player.x == 8 && (int)st.player.y == 6);
+}
+
+static void test_switch_toggles_doors(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    static SimState st;
+    init_box(&map, 10, 10);
+    map.tiles[5][7] = 4;
+    map.info[5][7]  = INFO_DOOR;
+    map.info[2][3]  = INFO_TRIGGER_SWITCH;
+    trig_build(&ts, &map);
+    init_player(&st, 2, 2);
+    st.triggers = &ts;
+
+    /* Entering the switch opens the door through the mutation API */
+    trig_touch(&ts, &map, &st.events, TRIG_ENTITY_PLAYER,
+               2.5f, 2.5f, 3.5f, 2.5f);
+    uint32_t rev = map.revision;
+    trig_dispatch(&ts, &st.events, &st, &map, NULL);
+    assert(map.tiles[5][7] == TILE_FLOOR);
+    assert(map.revision == rev + 1);
+
+    /* Staying on it does nothing; re-entering closes the door again */
+    trig_touch(&ts, &map, &st.events, TRIG_ENTITY_PLAYER,
+               3.4f, 2.5f, 3.5f, 2.5f);
+    assert(st.events.count == 0);
+    trig_touch(&ts, &map, &st.events, TRIG_ENTITY_PLAYER,
+               2.5f, 2.5f, 3.5f, 2.5f);
+    trig_dispatch(&ts, &st.events, &st, &map, NULL);
+    assert(map.tiles[5][7] == 4);
+}
+
+static void test_switch_never_closes_occupied_door(void)
+{
+    /* Three open doors: the player stands in one, an entity in another */
+    static Map map;
+    static TriggerSet ts;
+    static SimState st;
+    static EntityPool ep;
+    init_box(&map, 10, 10);
+    map.info[5][7] = map.info[7][4] = map.info[8][8] = INFO_DOOR;
+    map.info[2][3] = INFO_TRIGGER_SWITCH;
+    trig_build(&ts, &map);
+    init_player(&st, 7, 5);
+    st.triggers = &ts;
+    memset(&ep, 0, sizeof(ep));
+    ep.count = 1;
+    ep.x[0]  = 4.5f;  ep.y[0] = 7.5f;
+    st.npcs  = &ep;
+
+    trig_touch(&ts, &map, &st.events, TRIG_ENTITY_PLAYER,
+               2.5f, 2.5f, 3.5f, 2.5f);
+    trig_dispatch(&ts, &st.events, &st, &map, NULL);
+    assert(map.tiles[5][7] == TILE_FLOOR);
+    assert(map.tiles[7][4] == TILE_FLOOR);
+    assert(map.tiles[8][8] > TILE_FLOOR);
+
+    /* Once the cell is clear the next switch closes it */
+    st.player.x = 1.5f;
+    trig_touch(&ts, &map, &st.events, TRIG_ENTITY_PLAYER,
+               2.5f, 2.5f, 3.5f, 2.5f);
+    trig_dispatch(&ts, &st.events, &st, &map, NULL);
+    assert(map.tiles[5][7] > TILE_FLOOR);
+    assert(map.tiles[7][4] == TILE_FLOOR);
+    assert(map.tiles[8][8] == TILE_FLOOR);
+}
+
+static void test_endgame_without_trigger_set(void)
+{
+    static Map map;
+    static SimState st;
+    init_box(&map, 10, 10);
+    map.info[4][4] = INFO_TRIGGER_ENDGAME;
+    init_player(&st, 4, 4);
+
+    Input in;
+    memset(&in, 0, sizeof(in));
+    rc_update(&st, &map, &in, 1.0f / 60.0f);
+    assert(st.game_over);
+}
+
+static void test_queue_overflow_counts_drops(void)
+{
+    static Map map;
+    static TriggerSet ts;
+    static SimState st;
+    init_box(&map, 10, 10);
+    map.info[3][3] = INFO_TRIGGER_DAMAGE;
+    trig_build(&ts, &map);
+    memset(&st, 0, sizeof(st));
+
+    /* Many entities standing in the same zone */
+    for (int e = 0; e < MAX_EVENTS + 10; e++)
+        trig_touch(&ts, &map, &st.events, e, 3.5f, 3.5f, 3.5f, 3.5f);
+    assert(st.events.count == MAX_EVENTS);
+    assert(st.events.dropped == 10);
+
+    trig_dispatch(&ts, &st.events, &st, &map, NULL);
+    assert(st.events.count == 0);
+    assert(st.damage_taken == 0);    /* none of them was the player */
+}
+
+/* ═══════════════════════════════════════════════════════════════════ */
+/*  Main                                                              */
+/* ═══════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n── trigger index ───────────────────────────────────────\n");
+    RUN_TEST(test_build_indexes_cells);
+    RUN_TEST(test_build_pairs_teleports);
+    RUN_TEST(test_sync_ignores_tile_edits);
+    RUN_TEST(test_sync_rebuilds_on_info_edit);
+    RUN_TEST(test_sync_drops_removed_door);
+
+    printf("\n── events ──────────────────────────────────────────────\n");
+    RUN_TEST(test_damage_every_tick_inside);
+    RUN_TEST(test_teleport_moves_player_once);
+    RUN_TEST(test_switch_toggles_doors);
+    RUN_TEST(test_switch_never_closes_occupied_door);
+    RUN_TEST(test_endgame_without_trigger_set);
+    RUN_TEST(test_queue_overflow_counts_drops);
+
+    printf("\n══════════════════════════════════════════════════════════\n");
+    printf("  %d / %d tests passed\n", tests_passed, tests_run);
+    printf("══════════════════════════════════════════════════════════\n\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -12,8 +12,7 @@
 
 /* ── Internal pixel buffers ──────────────────────────────────────── */
 
-static unsigned int pixels[TEX_COUNT * TEX_SIZE * TEX_SIZE];
-static unsigned int sprite_pixels[SPRITE_TEX_COUNT * TEX_SIZE * TEX_SIZE];
+static TextureAtlas atlas;       /* tiles + sprites, RGBA8888         */
 static bool tile_atlas_loaded   = false;  /* true only when tile BMP loaded  */
 static bool sprite_atlas_loaded = false;  /* true only when sprite BMP loaded*/
 
@@ -23,19 +22,19 @@ static void fill_solid(void)
 {
     int total = TEX_COUNT * TEX_SIZE * TEX_SIZE;
     for (int i = 0; i < total; i++)
-        pixels[i] = COL_WALL;
+        atlas.tiles[i] = COL_WALL;
 }
 
 static void fill_sprite_solid(void)
 {
     int total = SPRITE_TEX_COUNT * TEX_SIZE * TEX_SIZE;
     for (int i = 0; i < total; i++)
-        sprite_pixels[i] = 0xFF00FFFF;  /* bright magenta fallback */
+        atlas.sprites[i] = COL_SPRITE;  /* bright magenta fallback */
 }
 
 /* ── Helper: load a horizontal atlas strip into a pixel buffer ───── */
 
-static bool load_atlas(const char *path, unsigned int *buf,
+static bool load_atlas(const char *path, uint32_t *buf,
                        int tex_count, const char *label)
 {
     SDL_Surface *surf = SDL_LoadBMP(path);
@@ -84,10 +83,10 @@ static bool load_atlas(const char *path, unsigned int *buf,
 
 bool tm_init_tiles(const char *atlas_path)
 {
-    memset(pixels, 0, sizeof(pixels));
+    memset(atlas.tiles, 0, sizeof(atlas.tiles));
     tile_atlas_loaded = false;
 
-    if (load_atlas(atlas_path, pixels, TEX_COUNT, "tiles")) {
+    if (load_atlas(atlas_path, atlas.tiles, TEX_COUNT, "tiles")) {
         tile_atlas_loaded = true;
     } else {
         fill_solid();
@@ -98,10 +97,10 @@ bool tm_init_tiles(const char *atlas_path)
 
 bool tm_init_sprites(const char *atlas_path)
 {
-    memset(sprite_pixels, 0, sizeof(sprite_pixels));
+    memset(atlas.sprites, 0, sizeof(atlas.sprites));
     sprite_atlas_loaded = false;
 
-    if (load_atlas(atlas_path, sprite_pixels, SPRITE_TEX_COUNT, "sprite")) {
+    if (load_atlas(atlas_path, atlas.sprites, SPRITE_TEX_COUNT, "sprite")) {
         sprite_atlas_loaded = true;
     } else {
         fill_sprite_solid();
@@ -116,6 +115,11 @@ void tm_shutdown(void)
     sprite_atlas_loaded = false;
 }
 
+const TextureAtlas *tm_atlas(void)
+{
+    return &atlas;
+}
+
 unsigned int tm_get_tile_pixel(uint16_t tile_type, int tex_x, int tex_y)
 {
     if (!tile_atlas_loaded) return COL_WALL;
@@ -127,12 +131,12 @@ unsigned int tm_get_tile_pixel(uint16_t tile_type, int tex_x, int tex_y)
     if (tex_y < 0)             tex_y = 0;
     if (tex_y >= TEX_SIZE)     tex_y = TEX_SIZE - 1;
 
-    return pixels[tile_type * TEX_SIZE * TEX_SIZE + tex_y * TEX_SIZE + tex_x];
+    return atlas.tiles[tile_type * TEX_SIZE * TEX_SIZE + tex_y * TEX_SIZE + tex_x];
 }
 
 unsigned int tm_get_sprite_pixel(uint16_t tex_id, int tex_x, int tex_y)
 {
-    if (!sprite_atlas_loaded) return 0xFF00FFFF;
+    if (!sprite_atlas_loaded) return COL_SPRITE;
 
     /* Clamp inputs */
     if (tex_id >= SPRITE_TEX_COUNT) tex_id = SPRITE_TEX_COUNT - 1;
@@ -141,5 +145,5 @@ unsigned int tm_get_sprite_pixel(uint16_t tex_id, int tex_x, int tex_y)
     if (tex_y < 0)                  tex_y = 0;
     if (tex_y >= TEX_SIZE)          tex_y = TEX_SIZE - 1;
 
-    return sprite_pixels[tex_id * TEX_SIZE * TEX_SIZE + tex_y * TEX_SIZE + tex_x];
+    return atlas.sprites[tex_id * TEX_SIZE * TEX_SIZE + tex_y * TEX_SIZE + tex_x];
 }
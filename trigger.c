@@ -0,0 +1,230 @@
+/*  trigger.c  –  per-cell trigger index and tick event queue
+ *  ─────────────────────────────────────────────────────────────────
+ *  Detection and effects are split: trig_touch() only looks up the
+ *  entity's cell and queues a TriggerEvent, trig_dispatch() applies the
+ *  whole queue once per tick.  Detection therefore stays one array read
+ *  per moving entity, however many triggers the map has.
+ *  No SDL headers.  Pure C.
+ */
+#include "trigger.h"
+#include "entity.h"
+#include "map_edit.h"
+#include "raycaster.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TRIG_CENTRE_RADIUS 0.15f /* endgame reach distance (map units) */
+
+/* ── Index ─────────────────────────────────────────────────────────── */
+
+static bool is_trigger(uint16_t info)
+{
+    return info >= INFO_TRIGGER_ENDGAME && info <= INFO_TRIGGER_SWITCH;
+}
+
+void trig_build(TriggerSet *ts, const Map *map)
+{
+    memset(ts, 0, sizeof(*ts));
+    int pending = -1;                    /* unpaired teleport index     */
+
+    for (int y = 0; y < map->h; y++) {
+        for (int x = 0; x < map->w; x++) {
+            uint16_t info = map->info[y][x];
+
+            if (info == INFO_DOOR) {
+                if (ts->door_count >= MAX_DOORS) {
+                    fprintf(stderr, "trig_build: more than %d doors\n",
+                            MAX_DOORS);
+                    continue;
+                }
+                Door *d = &ts->doors[ts->door_count++];
+                d->x    = (uint16_t)x;
+                d->y    = (uint16_t)y;
+                d->tile = map->tiles[y][x] > TILE_FLOOR ? map->tiles[y][x] : 1;
+                continue;
+            }
+            if (!is_trigger(info)) continue;
+
+            if (ts->count >= MAX_TRIGGERS) {
+                fprintf(stderr, "trig_build: more than %d triggers\n",
+                        MAX_TRIGGERS);
+                continue;
+            }
+            int i = ts->count++;
+            Trigger *t = &ts->triggers[i];
+            t->type   = info;
+            t->x      = t->dest_x = (uint16_t)x;
+            t->y      = t->dest_y = (uint16_t)y;
+            ts->cell[y][x] = (uint16_t)(i + 1);
+
+            if (info == INFO_TRIGGER_TELEPORT) {
+                if (pending < 0) {
+                    pending = i;
+                } else {
+                    Trigger *a = &ts->triggers[pending];
+                    a->dest_x = t->x;  a->dest_y = t->y;
+                    t->dest_x = a->x;  t->dest_y = a->y;
+                    pending = -1;
+                }
+            }
+        }
+    }
+    ts->revision = map->revision;
+}
+
+static bool is_door(const TriggerSet *ts, int x, int y)
+{
+    for (int i = 0; i < ts->door_count; i++)
+        if (ts->doors[i].x == x && ts->doors[i].y == y) return true;
+    return false;
+}
+
+void trig_sync(TriggerSet *ts, const Map *map)
+{
+    if (ts->revision == map->revision) return;
+
+    if (!map_changes_available(map, ts->revision)) {
+        trig_build(ts, map);
+        return;
+    }
+
+    /* Only info edits at (or onto) a trigger or door cell matter.  The
+     * cell index holds triggers only, so doors are looked up apart */
+    for (uint32_t r = ts->revision + 1; r <= map->revision; r++) {
+        MapChange c = map_change_at(map, r);
+        uint16_t info = map->info[c.y][c.x];
+        uint16_t idx  = ts->cell[c.y][c.x];
+        uint16_t had  = idx ? ts->triggers[idx - 1].type : INFO_EMPTY;
+        bool door_changed = (info == INFO_DOOR) != is_door(ts, c.x, c.y);
+        if (door_changed
+            || (info != had && (is_trigger(info) || is_trigger(had)))) {
+            trig_build(ts, map);
+            return;
+        }
+    }
+    ts->revision = map->revision;
+}
+
+/* ── Detection ─────────────────────────────────────────────────────── */
+
+static void push_event(EventQueue *q, uint16_t type, int x, int y, int entity)
+{
+    if (q->count >= MAX_EVENTS) {
+        q->dropped++;
+        return;
+    }
+    TriggerEvent *e = &q->events[q->count++];
+    e->type   = type;
+    e->x      = (uint16_t)x;
+    e->y      = (uint16_t)y;
+    e->entity = entity;
+}
+
+void trig_touch(const TriggerSet *ts, const Map *map, EventQueue *q,
+                int entity, float ox, float oy, float nx, float ny)
+{
+    int cx = (int)nx;
+    int cy = (int)ny;
+    if (nx < 0.0f || ny < 0.0f || cx >= map->w || cy >= map->h) return;
+
+    uint16_t type;
+    if (ts) {
+        uint16_t idx = ts->cell[cy][cx];
+        if (!idx) return;
+        type = ts->triggers[idx - 1].type;
+    } else {
+        type = map->info[cy][cx];
+    }
+
+    bool entered = (int)ox != cx || (int)oy != cy;
+
+    switch (type) {
+    case INFO_TRIGGER_ENDGAME: {
+        float ex = nx - (cx + 0.5f);
+        float ey = ny - (cy + 0.5f);
+        if (ex * ex + ey * ey <= TRIG_CENTRE_RADIUS * TRIG_CENTRE_RADIUS)
+            push_event(q, type, cx, cy, entity);
+        break;
+    }
+    case INFO_TRIGGER_DAMAGE:
+        push_event(q, type, cx, cy, entity);
+        break;
+    case INFO_TRIGGER_TELEPORT:
+    case INFO_TRIGGER_SWITCH:
+        if (entered) push_event(q, type, cx, cy, entity);
+        break;
+    default:
+        break;
+    }
+}
+
+/* ── Dispatch ──────────────────────────────────────────────────────── */
+
+/** True if the player or an entity of st->npcs stands in the door's
+ *  cell: closing it would wall them in. */
+static bool door_blocked(const Door *d, const SimState *st)
+{
+    if ((int)st->player.x == d->x && (int)st->player.y == d->y) return true;
+    const EntityPool *ep = st->npcs;
+    for (int i = 0; ep && i < ep->count; i++)
+        if ((int)ep->x[i] == d->x && (int)ep->y[i] == d->y) return true;
+    return false;
+}
+
+/** Open every closed door and close every open one that is clear. */
+static void toggle_doors(const TriggerSet *ts, const SimState *st, Map *map)
+{
+    for (int i = 0; i < ts->door_count; i++) {
+        const Door *d = &ts->doors[i];
+        bool closed = map->tiles[d->y][d->x] > TILE_FLOOR;
+        if (!closed && door_blocked(d, st)) continue;
+        map_set_tile(map, d->x, d->y, closed ? TILE_FLOOR : d->tile);
+    }
+}
+
+void trig_dispatch(const TriggerSet *ts, EventQueue *q, SimState *st,
+                   Map *map, EntityPool *ep)
+{
+    for (int i = 0; i < q->count; i++) {
+        const TriggerEvent *e = &q->events[i];
+        bool player = e->entity == TRIG_ENTITY_PLAYER;
+        int  ent    = ep && e->entity >= 0 && e->entity < ep->count
+                    ? e->entity : -1;
+        if (!player && ent < 0 && e->type != INFO_TRIGGER_SWITCH) continue;
+
+        switch (e->type) {
+        case INFO_TRIGGER_ENDGAME:
+            if (player) st->game_over = true;
+            break;
+        case INFO_TRIGGER_DAMAGE:
+            if (player)
+                st->damage_taken += TRIG_DAMAGE_PER_TICK;
+            else if (ep->damage[ent] <= UINT16_MAX - TRIG_DAMAGE_PER_TICK)
+                ep->damage[ent] += TRIG_DAMAGE_PER_TICK;
+            break;
+        case INFO_TRIGGER_TELEPORT: {
+            uint16_t idx = ts ? ts->cell[e->y][e->x] : 0;
+            if (!idx) break;
+            const Trigger *t = &ts->triggers[idx - 1];
+            /* Keep the sub-cell offset so the arrival is seamless */
+            float dx = (float)t->dest_x - t->x, dy = (float)t->dest_y - t->y;
+            if (player) {
+                st->player.x += dx;
+                st->player.y += dy;
+            } else {
+                ep->x[ent] += dx;
+                ep->y[ent] += dy;
+            }
+            break;
+        }
+        case INFO_TRIGGER_SWITCH:
+            /* A shared map is privatised before the first edit */
+            if (ts) toggle_doors(ts, st, st->cow ? map_cow_write(st->cow) : map);
+            break;
+        default:
+            break;
+        }
+    }
+    q->count = 0;
+}
@@ -0,0 +1,62 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include "game_globals.h"
+
+struct EntityPool;               /* entities that fire triggers too     */
+
+/* ── Trigger limits ───────────────────────────────────────────────── */
+#define MAX_TRIGGERS        512  /* trigger cells per map               */
+#define MAX_DOORS           256  /* INFO_DOOR cells per map             */
+#define TRIG_ENTITY_PLAYER  (-1) /* TriggerEvent.entity for the player  */
+#define TRIG_DAMAGE_PER_TICK  1  /* damage_taken per tick in a zone     */
+#define TRIGGER_SET_VERSION   1  /* bump when TriggerSet changes (cache) */
+
+/* ── One trigger cell ─────────────────────────────────────────────── */
+typedef struct Trigger {
+    uint16_t type;               /* INFO_TRIGGER_*                      */
+    uint16_t x, y;               /* cell                                */
+    uint16_t dest_x, dest_y;     /* teleport: paired pad (else x, y)    */
+} Trigger;
+
+/* ── Door cell opened / closed by switches ────────────────────────── */
+typedef struct Door {
+    uint16_t x, y;
+    uint16_t tile;               /* wall tile restored when closing     */
+} Door;
+
+/* ── Per-cell trigger index built from the info plane ─────────────── */
+typedef struct TriggerSet {
+    uint16_t cell[MAP_MAX_H][MAP_MAX_W]; /* trigger index + 1, 0 = none */
+    Trigger  triggers[MAX_TRIGGERS];
+    int      count;
+    Door     doors[MAX_DOORS];
+    int      door_count;
+    uint32_t revision;           /* Map.revision the index matches      */
+} TriggerSet;
+
+/**  Index every trigger and door cell of the info plane.  Teleport pads
+ *   are paired in row-major order (1st with 2nd, 3rd with 4th, …). */
+void trig_build(TriggerSet *ts, const Map *map);
+
+/**  Bring the index up to date with the map.  Tile-only edits (doors
+ *   toggled by switches) cost nothing; info edits trigger a rebuild. */
+void trig_sync(TriggerSet *ts, const Map *map);
+
+/**  O(1) trigger check for one entity that moved from (ox, oy) to
+ *   (nx, ny).  Teleports and switches fire on entering a cell, damage
+ *   zones every tick inside, the endgame at the cell centre.  ts may be
+ *   NULL, in which case the info plane alone is used. */
+void trig_touch(const TriggerSet *ts, const Map *map, EventQueue *q,
+                int entity, float ox, float oy, float nx, float ny);
+
+/**  Apply and clear every queued event in order.  Player events move
+ *   or damage st->player, entity events move or damage entity i of ep
+ *   (ignored when ep is NULL).  Switches, fired by either, toggle doors
+ *   through map_set_tile(), on st->cow's private copy when the map is
+ *   shared, but leave open a door the player or one of st->npcs stands
+ *   in.  Teleports and switches need ts and are ignored without it. */
+void trig_dispatch(const TriggerSet *ts, EventQueue *q, SimState *st,
+                   Map *map, struct EntityPool *ep);
+
+#endif /* TRIGGER_H */